@@ -11,6 +11,7 @@ yum install \
   libuuid-devel \
   jansson-devel \
   lz4-devel \
+  libzstd-devel \
   libarchive-devel \
   hwloc-devel \
   sqlite-devel \
@@ -0,0 +1,71 @@
+from pathlib import Path
+
+from cffi import FFI
+
+ffi = FFI()
+
+ffi.set_source(
+    "_flux._rv1pool",
+    """
+#include "src/common/librlist/rv1pool.h"
+
+// TODO: remove this when we can use cffi 1.10
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+    """,
+)
+
+ffi.cdef(
+    """
+typedef struct {
+    char text[160];
+} flux_error_t;
+
+struct idset;
+struct rv1pool;
+
+struct rv1pool_request {
+    int nnodes;
+    int nnodes_max;
+    int nslots;
+    int nslots_max;
+    int slot_size;
+    int gpu_per_slot;
+    bool exclusive;
+};
+
+struct rv1pool *rv1pool_create (const char *R, flux_error_t *errp);
+struct rv1pool *rv1pool_copy (const struct rv1pool *pool);
+void rv1pool_destroy (struct rv1pool *pool);
+int rv1pool_nnodes (const struct rv1pool *pool);
+
+int rv1pool_mark_up (struct rv1pool *pool, const char *ids);
+int rv1pool_mark_down (struct rv1pool *pool, const char *ids);
+int rv1pool_remove_ranks (struct rv1pool *pool, const char *ids);
+
+int rv1pool_set_allocated (struct rv1pool *pool, const char *R);
+int rv1pool_clear_allocated (struct rv1pool *pool, const char *R);
+
+char *rv1pool_alloc (struct rv1pool *pool,
+                     const struct rv1pool_request *req,
+                     const struct idset *ranks,
+                     flux_error_t *errp);
+int rv1pool_check_feasibility (const struct rv1pool *pool,
+                               const struct rv1pool_request *req,
+                               const struct idset *ranks,
+                               flux_error_t *errp);
+
+char *rv1pool_allocated (const struct rv1pool *pool);
+char *rv1pool_down (const struct rv1pool *pool);
+
+struct idset *idset_decode (const char *s);
+void idset_destroy (struct idset *idset);
+
+void free (void *);
+"""
+)
+
+if __name__ == "__main__":
+    ffi.emit_c_code("_rv1pool.c")
+    Path("_rv1pool.c").touch()
@@ -204,6 +204,7 @@ class OutputHeaderEvent(EventLogEvent):
         self.stdout_count = self.context["count"]["stdout"]
         self.stdout_encoding = self.context["encoding"]["stdout"]
         self.stderr_encoding = self.context["encoding"]["stderr"]
+        self.binary = self.context.get("options", {}).get("binary", False)
 
 
 class RedirectEvent(EventLogEvent):
@@ -427,11 +428,25 @@ def job_output(
         raise
 
     #  Output eventlog is ready, synchronously gather all output
+    binary = False
     for event in event_watch(flux_handle, jobid, "guest.output"):
+        if event.name == "header":
+            binary = OutputHeaderEvent(event).binary
         _output_eventlog_entry_decode(
             event, stream_dict, tasks, labelio, log_stderr_level
         )
 
+    #  With the output.binary shell option, data is stored separately
+    #  and job-info decodes it into data events:
+    if binary:
+        try:
+            for event in event_watch(flux_handle, jobid, "guest.output-data"):
+                _output_eventlog_entry_decode(
+                    event, stream_dict, tasks, labelio, log_stderr_level
+                )
+        except FileNotFoundError:
+            pass
+
     #  Join lines and return JobOutput result
     results = ["".join(stream_dict.get(k)) for k in ("stdout", "stderr", "log")]
     return JobOutput(*results)
@@ -0,0 +1,281 @@
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+"""Time-indexed resource availability profile.
+
+An :class:`AvailabilityProfile` answers "when is the earliest time this
+request could start?" for a resource pool whose running jobs have known end
+times, as needed for an EASY backfill reservation.
+
+The profile is indexed by *steps*.  Step 0 is the current state of the pool,
+and step *k* is the state once every job ending at or before the *k*-th
+distinct job end time has released its resources.  Jobs without an end time
+never release their resources.  A step is represented by a copy of the pool,
+so a query runs the pool's own allocator and respects topology and
+constraints exactly as a real allocation would.
+
+Every step has at least the free resources of the step before it, so the
+first step in which a request fits is found by a search that starts from
+the previous answer and usually needs only two allocation attempts.  Only
+the steps probed by the last query are kept.  The owner applies each job
+start, free and expiration update to the pool and then reports the same
+change to the profile, which applies it to the kept steps the job is
+running in.  A job start or completion therefore costs a few pool updates
+instead of a copy of the pool and a replay of every release.
+"""
+
+import bisect
+
+from flux.resource.ResourcePoolImplementation import (
+    InfeasibleRequest,
+    InsufficientResources,
+)
+
+
+class AvailabilityProfile:
+    """Future resource availability of a pool at each running job end time.
+
+    Args:
+        pool: A :class:`~flux.resource.ResourcePool.ResourcePool` or
+            :class:`~flux.resource.ResourcePoolImplementation.ResourcePoolImplementation`.
+
+    The owner must call :meth:`alloc`, :meth:`free` and
+    :meth:`update_expiration` right after making the same change to *pool*,
+    and :meth:`reset` after any other pool change (e.g. nodes going up or
+    down).  As a safety net, the profile is rebuilt from the pool when the
+    pool generation differs from the one recorded by the last update.
+    """
+
+    def __init__(self, pool):
+        self.pool = pool
+        self.reset()
+
+    def reset(self) -> None:
+        """Discard all state.  The profile is rebuilt by the next query."""
+        self._generation = None
+        self._end = {}  # jobid -> end time, 0 if none
+        self._ending = {}  # end time -> set of jobids ending then
+        self._times = []  # sorted distinct end times > 0
+        self._steps = {}  # step time (0 for step 0) -> pool copy
+        self._hint = None  # (jobid, request, time) of the last query
+
+    def _sync(self) -> None:
+        if self._generation == self.pool.generation:
+            return
+        self.reset()
+        for jobid, end_time in self.pool.job_end_times():
+            end = self._end_time(end_time)
+            self._add_time(end)
+            self._index(jobid, end)
+        self._generation = self.pool.generation
+
+    # ------------------------------------------------------------------
+    # Step bookkeeping
+    # ------------------------------------------------------------------
+
+    @staticmethod
+    def _end_time(end) -> float:
+        return end if end and end > 0.0 else 0.0
+
+    @staticmethod
+    def _holds(t: float, end: float) -> bool:
+        """True if a job ending at *end* holds resources in the step at *t*."""
+        return t == 0.0 or end == 0.0 or t < end
+
+    def _add_time(self, end: float) -> None:
+        if end > 0.0 and end not in self._ending:
+            bisect.insort(self._times, end)
+            self._ending[end] = set()
+
+    def _index(self, jobid: int, end: float) -> None:
+        self._end[jobid] = end
+        if end > 0.0:
+            self._ending[end].add(jobid)
+
+    def _unindex(self, jobid: int) -> None:
+        """Forget *jobid*, dropping its step if no other job ends then."""
+        end = self._end.pop(jobid)
+        if end == 0.0:
+            return
+        jobs = self._ending[end]
+        jobs.discard(jobid)
+        if not jobs:
+            del self._ending[end]
+            del self._times[bisect.bisect_left(self._times, end)]
+            self._steps.pop(end, None)
+
+    def _running_steps(self, end: float):
+        """Return the kept steps in which a job ending at *end* runs."""
+        return [step for t, step in self._steps.items() if self._holds(t, end)]
+
+    def _step(self, k: int):
+        """Return step *k*, creating it from the closest earlier kept step."""
+        t = self._times[k - 1] if k > 0 else 0.0
+        step = self._steps.get(t)
+        if step is None:
+            base = max((s for s in self._steps if s < t), default=0.0)
+            if base in self._steps:
+                step = self._steps[base].copy()
+            else:
+                step = self.pool.copy()
+            for end in self._times[bisect.bisect_right(self._times, base) : k]:
+                for jobid in self._ending[end]:
+                    step.free(jobid)
+            self._steps[t] = step
+        return step
+
+    # ------------------------------------------------------------------
+    # Incremental updates
+    # ------------------------------------------------------------------
+
+    def alloc(self, jobid: int, R, end_time: float) -> None:
+        """Record that *jobid* was allocated *R* until *end_time*.
+
+        Args:
+            jobid: The job ID.
+            R: The allocation returned by the pool's ``alloc()``.
+            end_time: When the job releases *R*, or 0 if unknown.
+        """
+        if self._generation is None:
+            return
+        end = self._end_time(end_time)
+        for step in self._running_steps(end):
+            step.register_alloc(jobid, R)
+        self._add_time(end)
+        self._index(jobid, end)
+        self._generation = self.pool.generation
+
+    def free(self, jobid: int, R=None, final: bool = False) -> None:
+        """Record that *jobid* released *R*, or all its resources.
+
+        Arguments are as for the pool's ``free()``.
+        """
+        if self._generation is None:
+            return
+        if jobid in self._end:
+            partial = R is not None and not final
+            for step in self._running_steps(self._end[jobid]):
+                if partial:
+                    step.free(jobid, R)
+                else:
+                    step.free(jobid)
+            if not partial:
+                self._unindex(jobid)
+        self._generation = self.pool.generation
+
+    def update_expiration(self, jobid: int, expiration: float) -> None:
+        """Record that *jobid* now ends at *expiration* (0 if unknown)."""
+        if self._generation is None:
+            return
+        old = self._end.get(jobid)
+        new = self._end_time(expiration)
+        if old is not None and old != new:
+            if old > 0.0 and (new == 0.0 or new > old):
+                # The job now runs in steps that had released it, and its
+                # allocation is not available here to add back.  Drop them
+                # so they are recreated from an earlier step that holds it.
+                for t in [t for t in self._steps if t >= old]:
+                    if new == 0.0 or t < new:
+                        del self._steps[t]
+            else:
+                for t, step in self._steps.items():
+                    if t >= new and self._holds(t, old):
+                        step.free(jobid)
+            self._unindex(jobid)
+            self._add_time(new)
+            self._index(jobid, new)
+        self._generation = self.pool.generation
+
+    # ------------------------------------------------------------------
+    # Queries
+    # ------------------------------------------------------------------
+
+    @staticmethod
+    def _fits(step, jobid: int, request) -> bool:
+        try:
+            step.alloc(jobid, request)
+        except InsufficientResources:
+            return False
+        step.free(jobid)
+        return True
+
+    @staticmethod
+    def _search(k: int, last: int, fits):
+        """Return the first step in ``[0, last]`` that *fits*, or ``None``.
+
+        Gallops outward from step *k*, then bisects.  This relies on *fits*
+        being monotonic in the step index.
+        """
+        if fits(k):
+            lo, hi, stride = k - 1, k, 1
+            while lo >= 0 and fits(lo):
+                hi, stride = lo, stride * 2
+                lo = hi - stride
+            lo = max(lo, -1)
+        else:
+            lo, hi, stride = k, k + 1, 1
+            while hi <= last and not fits(hi):
+                lo, stride = hi, stride * 2
+                hi = lo + stride
+            if hi > last:
+                if lo == last or not fits(last):
+                    return None
+                hi = last
+        # lo does not fit (or is -1), hi fits
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if fits(mid):
+                hi = mid
+            else:
+                lo = mid
+        return hi
+
+    def earliest_start(self, jobid: int, request):
+        """Return the earliest time *request* could be allocated.
+
+        The search starts from the previous answer for the same job and
+        request, so repeated queries for a blocked job are cheap as long as
+        job starts and completions do not move its reservation far.
+
+        Args:
+            jobid: ID of the job making *request*.
+            request: A resource request from the pool's
+                ``parse_resource_request()``.
+
+        Returns:
+            0.0 if *request* fits in the current state, otherwise the job end
+            time (seconds since the epoch) after which it first fits.  Returns
+            ``None`` if the request is infeasible or does not fit even after
+            every job with an end time has released its resources.
+        """
+        self._sync()
+        last = len(self._times)
+        k = 0
+        if self._hint is not None and self._hint[:2] == (jobid, request):
+            t = self._hint[2]
+            k = 0 if t == 0.0 else bisect.bisect_left(self._times, t) + 1
+            k = min(k, last)
+        probed = {}
+
+        def fits(k):
+            if k not in probed:
+                probed[k] = self._fits(self._step(k), jobid, request)
+            return probed[k]
+
+        try:
+            k = self._search(k, last, fits)
+        except InfeasibleRequest:
+            k = None
+        # Keep only the steps probed by this query for the next one.
+        keep = {self._times[k - 1] if k > 0 else 0.0 for k in probed}
+        self._steps = {t: s for t, s in self._steps.items() if t in keep}
+        t = None if k is None else self._times[k - 1] if k > 0 else 0.0
+        self._hint = (jobid, request, float("inf") if t is None else t)
+        return t
@@ -18,7 +18,9 @@ wraps a :class:`~flux.resource.ResourceSetImplementation.ResourceSetImplementati
 Calling ``ResourcePool(R)`` dispatches to the appropriate concrete
 implementation based on the ``version`` field in the R JSON:
 
-- Version 1 → :class:`~flux.resource.Rv1Pool.Rv1Pool` (pure-Python)
+- Version 1 → :class:`~flux.resource.Rv1NativePool.Rv1NativePool` (native
+  allocator), or :class:`~flux.resource.Rv1Pool.Rv1Pool` (pure-Python) if
+  the native module is not available
 """
 
 import importlib
@@ -117,7 +119,10 @@ class ResourcePool:
             raise TypeError(f"ResourcePool cannot be instantiated from {type(arg)}")
 
         if version == 1:
-            from flux.resource.Rv1Pool import Rv1Pool
+            try:
+                from flux.resource.Rv1NativePool import Rv1NativePool as Rv1Pool
+            except ImportError:
+                from flux.resource.Rv1Pool import Rv1Pool
 
             self.impl = Rv1Pool(arg, log=log, **kwargs)
             self.version = 1
@@ -0,0 +1,322 @@
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+"""Rv1 resource pool with a native allocator.
+
+:class:`Rv1NativePool` is a drop-in :class:`~flux.resource.Rv1Pool.Rv1Pool`
+whose per-rank up/down and allocation state, candidate selection,
+feasibility checks and :meth:`~Rv1NativePool.copy` are implemented in C
+(``src/common/librlist/rv1pool.c``).  Scheduling policy, job tracking and
+logging stay in Python and are inherited unchanged from ``Rv1Pool``.
+
+The native allocator implements the default ``Rv1Pool`` worst-fit policy.
+Subclasses that override :meth:`~Rv1Pool._sort_candidates` or
+:meth:`~Rv1Pool._select_resources` never create native state and use the
+inherited Python implementation throughout.
+
+Native state is created on the first pool operation.  From then on the
+``_ranks`` dict holds only the static ``hostname``, ``cores`` and ``gpus``
+keys, which are shared between copies.  Instances that only ever serve as
+a resource set (e.g. an allocation passed to :meth:`~Rv1Pool.free`) never
+create native state and behave exactly like ``Rv1Pool``.
+
+RFC 31 constraints are evaluated in Python by
+:meth:`~flux.resource.Rv1Set.Rv1Set._matches_constraint` once per distinct
+constraint and the matching ranks are cached for later allocations.
+"""
+
+import errno
+import json
+
+from _flux._rv1pool import ffi, lib
+from flux.idset import IDset
+from flux.resource.ResourcePoolImplementation import (
+    InfeasibleRequest,
+    InsufficientResources,
+)
+from flux.resource.Rv1Pool import Rv1Pool
+from flux.resource.Rv1Set import Rv1Set, _idset_str
+
+
+def _encode_R(ranks) -> bytes:
+    """Encode ``(rank, cores, gpus)`` tuples as a minimal Rv1 JSON string."""
+    # Nodes of the same type usually share core and gpu sets, so group
+    # ranks by their children as R_lite does, to encode and decode each
+    # distinct set only once.
+    groups = {}
+    for rank, cores, gpus in ranks:
+        groups.setdefault((frozenset(cores), frozenset(gpus)), []).append(rank)
+    R_lite = []
+    for (cores, gpus), group in groups.items():
+        children = {"core": _idset_str(cores)}
+        if gpus:
+            children["gpu"] = _idset_str(gpus)
+        R_lite.append({"rank": _idset_str(group), "children": children})
+    return json.dumps({"version": 1, "execution": {"R_lite": R_lite}}).encode()
+
+
+def _encode_set(R) -> bytes:
+    """Return the native encoding of resource set *R*, cached on *R*.
+
+    The ranks of an allocation never change once it is created, and the
+    same allocation may be registered with or freed from many pool copies.
+    """
+    encoded = getattr(R, "_native_R", None)
+    if encoded is None:
+        encoded = _encode_R((r, i["cores"], i["gpus"]) for r, i in R._ranks.items())
+        R._native_R = encoded
+    return encoded
+
+
+def _decode_ranks(s):
+    """Decode and free a native ``[[rank, [cores], [gpus]], ...]`` string."""
+    try:
+        return json.loads(ffi.string(s).decode())
+    finally:
+        lib.free(s)
+
+
+def _check(rc):
+    if rc < 0:
+        raise OSError(ffi.errno, f"rv1pool: {errno.errorcode.get(ffi.errno)}")
+    return rc
+
+
+class Rv1NativePool(Rv1Pool):
+    """Rv1Pool with native allocation, feasibility and copy."""
+
+    _native = None
+    _eligible_cache = None
+    _native_policy = True
+
+    def __init_subclass__(cls, **kwargs):
+        super().__init_subclass__(**kwargs)
+        cls._native_policy = (
+            cls._sort_candidates is Rv1Pool._sort_candidates
+            and cls._select_resources is Rv1Pool._select_resources
+        )
+
+    # ------------------------------------------------------------------
+    # Native state
+    # ------------------------------------------------------------------
+
+    @property
+    def _pool(self):
+        """Native pool, created from ``_ranks`` on first use."""
+        if self._native is None:
+            self._native_create()
+        return self._native
+
+    def _native_create(self) -> None:
+        """Move up/down and allocation state from ``_ranks`` to C."""
+        down = set()
+        allocated = []
+        ranks = {}
+        for rank, info in self._ranks.items():
+            if not info.get("up", True):
+                down.add(rank)
+            cores = info.get("allocated_cores")
+            gpus = info.get("allocated_gpus")
+            if cores or gpus:
+                allocated.append((rank, cores or (), gpus or ()))
+            ranks[rank] = {
+                "hostname": info["hostname"],
+                "cores": info["cores"],
+                "gpus": info["gpus"],
+            }
+        R = _encode_R((r, i["cores"], i["gpus"]) for r, i in ranks.items())
+        error = ffi.new("flux_error_t *")
+        pool = lib.rv1pool_create(R, error)
+        if pool == ffi.NULL:
+            raise OSError(ffi.errno, ffi.string(error.text).decode())
+        self._native = ffi.gc(pool, lib.rv1pool_destroy)
+        self._ranks = ranks
+        if down:
+            _check(lib.rv1pool_mark_down(self._native, _idset_str(down).encode()))
+        if allocated:
+            _check(lib.rv1pool_set_allocated(self._native, _encode_R(allocated)))
+
+    def _eligible(self, constraint):
+        """Return a native idset of ranks matching *constraint*, or NULL."""
+        if constraint is None:
+            return ffi.NULL
+        if isinstance(constraint, str):
+            constraint = json.loads(constraint)
+        if self._eligible_cache is None:
+            self._eligible_cache = {}
+        key = json.dumps(constraint, sort_keys=True)
+        ids = self._eligible_cache.get(key)
+        if ids is None:
+            matches = [
+                rank
+                for rank, info in self._ranks.items()
+                if self._matches_constraint(rank, info, constraint)
+            ]
+            ids = lib.idset_decode(_idset_str(matches).encode())
+            if ids == ffi.NULL:
+                raise OSError(ffi.errno, "idset_decode failed")
+            ids = ffi.gc(ids, lib.idset_destroy)
+            self._eligible_cache[key] = ids
+        return ids
+
+    @staticmethod
+    def _native_request(request):
+        nnodes_max = request.nnodes_max
+        nslots_max = request.nslots_max
+        return ffi.new(
+            "struct rv1pool_request *",
+            {
+                "nnodes": request.nnodes,
+                "nnodes_max": -1 if nnodes_max is None else nnodes_max,
+                "nslots": request.nslots,
+                "nslots_max": -1 if nslots_max is None else nslots_max,
+                "slot_size": request.slot_size,
+                "gpu_per_slot": request.gpu_per_slot,
+                "exclusive": bool(request.exclusive),
+            },
+        )
+
+    # ------------------------------------------------------------------
+    # Rv1Set overrides
+    # ------------------------------------------------------------------
+
+    def set_property(self, name: str, ranks=None):
+        # Cached constraint matches may depend on properties.
+        self._eligible_cache = None
+        return super().set_property(name, ranks)
+
+    # ------------------------------------------------------------------
+    # ResourcePoolImplementation — availability management
+    # ------------------------------------------------------------------
+
+    def mark_up(self, ids: str) -> None:
+        if not self._native_policy:
+            return super().mark_up(ids)
+        _check(lib.rv1pool_mark_up(self._pool, str(ids).encode()))
+        self._bump()
+
+    def mark_down(self, ids: str) -> None:
+        if not self._native_policy:
+            return super().mark_down(ids)
+        _check(lib.rv1pool_mark_down(self._pool, str(ids).encode()))
+        self._bump()
+
+    def remove_ranks(self, ranks) -> None:
+        if self._native is not None:
+            _check(lib.rv1pool_remove_ranks(self._native, str(ranks).encode()))
+        super().remove_ranks(ranks)
+
+    # ------------------------------------------------------------------
+    # ResourcePoolImplementation — scheduling operations
+    # ------------------------------------------------------------------
+
+    def alloc(self, jobid: int, request) -> "Rv1Pool":
+        if not self._native_policy:
+            return super().alloc(jobid, request)
+        self._check_range_counts(request)
+        error = ffi.new("flux_error_t *")
+        s = lib.rv1pool_alloc(
+            self._pool,
+            self._native_request(request),
+            self._eligible(request.constraint),
+            error,
+        )
+        if s == ffi.NULL:
+            if ffi.errno == errno.ENOSPC:
+                self._check_feasibility(request)
+                raise InsufficientResources("insufficient resources")
+            raise ValueError(ffi.string(error.text).decode())
+        result = _decode_ranks(s)
+        selected = [
+            (rank, frozenset(cores), frozenset(gpus))
+            for rank, cores, gpus in result["ranks"]
+        ]
+        return self._alloc_result(jobid, request, selected, result["nslots"])
+
+    def _check_feasibility(self, request) -> None:
+        if not self._native_policy:
+            return super()._check_feasibility(request)
+        error = ffi.new("flux_error_t *")
+        if (
+            lib.rv1pool_check_feasibility(
+                self._pool,
+                self._native_request(request),
+                self._eligible(request.constraint),
+                error,
+            )
+            < 0
+        ):
+            if ffi.errno == errno.EOVERFLOW:
+                raise InfeasibleRequest(ffi.string(error.text).decode())
+            raise ValueError(ffi.string(error.text).decode())
+
+    # ------------------------------------------------------------------
+    # ResourcePoolImplementation — structural copies
+    # ------------------------------------------------------------------
+
+    def copy(self) -> "Rv1NativePool":
+        """Return a full independent copy preserving allocation state.
+
+        Static per-rank entries and cached constraint matches are shared
+        with the copy; only the native allocation state is duplicated.
+        """
+        if self._native is None:
+            return super().copy()
+        new = type(self)._from_state(
+            expiration=self._expiration,
+            starttime=self._starttime,
+            has_nodelist=getattr(self, "_has_nodelist", False),
+            properties={p: set(s) for p, s in self._properties.items()},
+            ranks=dict(self._ranks),
+            scheduling=self.scheduling,
+            job_state=dict(self._job_state),
+            log=None,
+            generation=self.generation,
+            source=self,
+        )
+        pool = lib.rv1pool_copy(self._native)
+        if pool == ffi.NULL:
+            raise OSError(ffi.errno, "rv1pool_copy failed")
+        new._native = ffi.gc(pool, lib.rv1pool_destroy)
+        new._eligible_cache = self._eligible_cache
+        return new
+
+    # ------------------------------------------------------------------
+    # Rv1Pool state hooks
+    # ------------------------------------------------------------------
+
+    def _set_allocated(self, other: Rv1Set) -> None:
+        if self._native is None:
+            return super()._set_allocated(other)
+        _check(lib.rv1pool_set_allocated(self._native, _encode_set(other)))
+
+    def _clear_allocated(self, other: Rv1Set) -> None:
+        if self._native is None:
+            return super()._clear_allocated(other)
+        _check(lib.rv1pool_clear_allocated(self._native, _encode_set(other)))
+
+    def _allocated(self) -> list:
+        if self._native is None:
+            return super()._allocated()
+        s = lib.rv1pool_allocated(self._native)
+        if s == ffi.NULL:
+            raise OSError(ffi.errno, "rv1pool_allocated failed")
+        return _decode_ranks(s)
+
+    def _down_ranks(self) -> set:
+        if self._native is None:
+            return super()._down_ranks()
+        s = lib.rv1pool_down(self._native)
+        if s == ffi.NULL:
+            raise OSError(ffi.errno, "rv1pool_down failed")
+        try:
+            return set(IDset(ffi.string(s).decode()))
+        finally:
+            lib.free(s)
@@ -293,10 +293,15 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
     #: a warning for any key in ``pool_kwargs`` not listed here.
     known_options: frozenset = frozenset()
 
+    #: True if a logger was supplied.  Copies made for simulation have none,
+    #: so their alloc and free calls skip formatting log messages.
+    _has_log: bool = False
+
     def __init__(self, R, log=None, **kwargs) -> None:
         """Construct from an R JSON string, dict, or ``None`` (empty)."""
         if log is not None:
             self.log = log
+            self._has_log = True
         if R is not None and not isinstance(R, (str, Mapping)):
             raise TypeError(f"Rv1Pool: expected str or Mapping, got {type(R)!r}")
 
@@ -366,6 +371,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         # Only set log attribute if non-None (otherwise use base class method)
         if log is not None:
             new.log = log
+            new._has_log = True
         new.generation = generation
         # Allow subclasses to initialize their attributes from source
         if source is not None:
@@ -391,12 +397,13 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             for prop, ranks in self._properties.items()
             if ranks & rank_set
         }
+        down = self._down_ranks()
         ranks = {
             rank: {
                 "hostname": self._ranks[rank]["hostname"],
                 "cores": self._ranks[rank]["cores"],
                 "gpus": self._ranks[rank]["gpus"],
-                "up": self._ranks[rank]["up"],
+                "up": rank not in down,
                 "allocated_cores": set(),
                 "allocated_gpus": set(),
             }
@@ -465,7 +472,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                 was reloaded).  The caller should raise a fatal exception on
                 the job.
         """
-        missing = set(R._ranks.keys()) - set(self._ranks.keys())
+        missing = {rank for rank in R._ranks if rank not in self._ranks}
         if missing:
             raise ValueError(
                 f"allocation contains ranks not in resource pool: " f"{sorted(missing)}"
@@ -473,7 +480,8 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         self._set_allocated(R)
         self._job_state[jobid] = (R.get_expiration(), R)
         self._bump()
-        self.log(syslog.LOG_INFO, f"hello: {JobID(jobid).f58}: {R.dumps()}")
+        if self._has_log:
+            self.log(syslog.LOG_INFO, f"hello: {JobID(jobid).f58}: {R.dumps()}")
 
     def free(self, jobid: int, R=None, final: bool = False) -> None:
         """Return a job's allocated resources to this pool.
@@ -523,17 +531,11 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             _, alloc = self._job_state.pop(jobid, (0.0, None))
             if alloc is None:
                 return
-            for rank, ainfo in alloc._ranks.items():
-                if rank in self._ranks:
-                    self._ranks[rank]["allocated_cores"] -= ainfo["cores"]
-                    self._ranks[rank]["allocated_gpus"] -= ainfo["gpus"]
-            freed_dumps = alloc.dumps()
+            self._clear_allocated(alloc)
+            freed = alloc
         elif R is not None:
-            for rank, ainfo in R._ranks.items():
-                if rank in self._ranks:
-                    self._ranks[rank]["allocated_cores"] -= ainfo["cores"]
-                    self._ranks[rank]["allocated_gpus"] -= ainfo["gpus"]
-            freed_dumps = R.dumps()
+            self._clear_allocated(R)
+            freed = R
             if jobid in self._job_state:
                 end_time, alloc = self._job_state[jobid]
                 remaining = set(alloc._ranks.keys()) - set(R._ranks.keys())
@@ -542,15 +544,14 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             _, alloc = self._job_state.pop(jobid, (0.0, None))
             if alloc is None:
                 return
-            for rank, ainfo in alloc._ranks.items():
-                if rank in self._ranks:
-                    self._ranks[rank]["allocated_cores"] -= ainfo["cores"]
-                    self._ranks[rank]["allocated_gpus"] -= ainfo["gpus"]
-            freed_dumps = alloc.dumps()
-        self.log(
-            syslog.LOG_DEBUG,
-            f"free: {JobID(jobid).f58}: {freed_dumps}" + (" (final)" if final else ""),
-        )
+            self._clear_allocated(alloc)
+            freed = alloc
+        if self._has_log:
+            self.log(
+                syslog.LOG_DEBUG,
+                f"free: {JobID(jobid).f58}: {freed.dumps()}"
+                + (" (final)" if final else ""),
+            )
         self._bump()
 
     def update_expiration(self, jobid: int, expiration: float) -> None:
@@ -587,20 +588,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             InfeasibleRequest: If the request can never be satisfied by
                 this pool's total capacity.
         """
-        # Reject stepped/IDset counts that this scheduler cannot honor.
-        # The stepped count form encodes constraints (e.g. power-of-two node
-        # counts) that the simple range allocator ignores; reject immediately
-        # rather than silently violating the constraint.
-        if request.node_count is not None and request.node_count._values is not None:
-            raise InfeasibleRequest(
-                "node count specifies discrete valid values that this scheduler "
-                "does not support; use a simple min-max range instead"
-            )
-        if request.slot_count is not None and request.slot_count._values is not None:
-            raise InfeasibleRequest(
-                "slot count specifies discrete valid values that this scheduler "
-                "does not support; use a simple min-max range instead"
-            )
+        self._check_range_counts(request)
         self._check_feasibility(request)
 
     def alloc(self, jobid: int, request) -> "Rv1Pool":
@@ -618,16 +606,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             InsufficientResources: Resources temporarily insufficient.
             InfeasibleRequest: Request structurally infeasible.
         """
-        if request.node_count is not None and request.node_count._values is not None:
-            raise InfeasibleRequest(
-                "node count specifies discrete valid values that this scheduler "
-                "does not support; use a simple min-max range instead"
-            )
-        if request.slot_count is not None and request.slot_count._values is not None:
-            raise InfeasibleRequest(
-                "slot count specifies discrete valid values that this scheduler "
-                "does not support; use a simple min-max range instead"
-            )
+        self._check_range_counts(request)
         slot_size = request.slot_size
         gpu_per_slot = request.gpu_per_slot
         exclusive = request.exclusive
@@ -661,10 +640,20 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         candidates = self._sort_candidates(candidates)
 
         selected, actual_nslots = self._select_resources(candidates, request)
+        for rank, alloc_cores, alloc_gpus in selected:
+            self._ranks[rank]["allocated_cores"] |= alloc_cores
+            self._ranks[rank]["allocated_gpus"] |= alloc_gpus
+        return self._alloc_result(jobid, request, selected, actual_nslots)
 
-        # Build result pool and update allocation state on self.
-        # selected is [(rank, alloc_cores, alloc_gpus)] — info is looked up
-        # directly so the override never holds a mutable reference to pool state.
+    def _alloc_result(self, jobid: int, request, selected, nslots) -> "Rv1Pool":
+        """Build and record the allocation for *jobid*.
+
+        *selected* is a list of ``(rank, alloc_cores, alloc_gpus)`` tuples
+        that have already been marked allocated in this pool, and *nslots*
+        is the slot count to record in the allocated R.
+        """
+        # info is looked up directly so the result never holds a mutable
+        # reference to pool state.
         selected_ranks = {rank for rank, _, _ in selected}
 
         properties = {
@@ -683,8 +672,6 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                 "allocated_gpus": set(alloc_gpus),
                 "up": True,
             }
-            info["allocated_cores"] |= alloc_cores
-            info["allocated_gpus"] |= alloc_gpus
 
         if request.duration > 0.0:
             end_time = time.time() + request.duration
@@ -704,10 +691,11 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             log=self.log,
             source=self,
         )
-        result._nslots = actual_nslots
+        result._nslots = nslots
         self._job_state[jobid] = (end_time, result)
         self._bump()
-        self.log(syslog.LOG_DEBUG, f"alloc: {JobID(jobid).f58}: {result.dumps()}")
+        if self._has_log:
+            self.log(syslog.LOG_DEBUG, f"alloc: {JobID(jobid).f58}: {result.dumps()}")
         return result
 
     # ------------------------------------------------------------------
@@ -749,12 +737,11 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         new._has_nodelist = False
         new._ranks = {
             rank: {
-                "hostname": info["hostname"],
-                "cores": frozenset(info["allocated_cores"]),
-                "gpus": frozenset(info["allocated_gpus"]),
+                "hostname": self._ranks[rank]["hostname"],
+                "cores": frozenset(cores),
+                "gpus": frozenset(gpus),
             }
-            for rank, info in self._ranks.items()
-            if info["allocated_cores"] or info["allocated_gpus"]
+            for rank, cores, gpus in self._allocated()
         }
         allocated_set = set(new._ranks)
         new._properties = {
@@ -771,6 +758,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         new._starttime = self._starttime
         new._has_nodelist = False
         new._properties = {}
+        down = self._down_ranks()
         new._ranks = {
             rank: {
                 "hostname": info["hostname"],
@@ -778,7 +766,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                 "gpus": info["gpus"],
             }
             for rank, info in self._ranks.items()
-            if not info["up"]
+            if rank in down
         }
         return new
 
@@ -814,6 +802,44 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                 self._ranks[rank]["allocated_cores"] |= oinfo["cores"]
                 self._ranks[rank]["allocated_gpus"] |= oinfo["gpus"]
 
+    def _clear_allocated(self, other: "Rv1Pool") -> None:
+        """Return resources in *other* to the free state in this pool."""
+        for rank, oinfo in other._ranks.items():
+            if rank in self._ranks:
+                self._ranks[rank]["allocated_cores"] -= oinfo["cores"]
+                self._ranks[rank]["allocated_gpus"] -= oinfo["gpus"]
+
+    def _allocated(self) -> list:
+        """Return ``(rank, cores, gpus)`` for ranks with allocated resources."""
+        return [
+            (rank, info["allocated_cores"], info["allocated_gpus"])
+            for rank, info in self._ranks.items()
+            if info["allocated_cores"] or info["allocated_gpus"]
+        ]
+
+    def _down_ranks(self) -> set:
+        """Return the set of ranks that are not schedulable."""
+        return {rank for rank, info in self._ranks.items() if not info["up"]}
+
+    @staticmethod
+    def _check_range_counts(request) -> None:
+        """Reject stepped/IDset counts that this scheduler cannot honor.
+
+        The stepped count form encodes constraints (e.g. power-of-two node
+        counts) that the simple range allocator ignores; reject immediately
+        rather than silently violating the constraint.
+        """
+        if request.node_count is not None and request.node_count._values is not None:
+            raise InfeasibleRequest(
+                "node count specifies discrete valid values that this scheduler "
+                "does not support; use a simple min-max range instead"
+            )
+        if request.slot_count is not None and request.slot_count._values is not None:
+            raise InfeasibleRequest(
+                "slot count specifies discrete valid values that this scheduler "
+                "does not support; use a simple min-max range instead"
+            )
+
     def _sort_candidates(self, candidates: list) -> list:
         """Sort *candidates* for node selection order.
 
@@ -1235,6 +1235,79 @@ error:
     json_decref (env);
 }
 
+/* Override the default stats-get method to add event multicast counters,
+ * which show how much data was copied delivering events to modules.
+ */
+static void broker_stats_get_cb (flux_t *h,
+                                 flux_msg_handler_t *mh,
+                                 const flux_msg_t *msg,
+                                 void *arg)
+{
+    broker_ctx_t *ctx = arg;
+    flux_msgcounters_t mcs;
+    json_t *mcast = NULL;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0
+        || !(mcast = modhash_event_stats (ctx->modhash)))
+        goto error;
+    flux_get_msgcounters (h, &mcs);
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:{s:i s:i s:i s:i} s:{s:i s:i s:i s:i} s:O}",
+                           "tx",
+                             "request", mcs.request_tx,
+                             "response", mcs.response_tx,
+                             "event", mcs.event_tx,
+                             "control", mcs.control_tx,
+                           "rx",
+                             "request", mcs.request_rx,
+                             "response", mcs.response_rx,
+                             "event", mcs.event_rx,
+                             "control", mcs.control_rx,
+                           "event-mcast", mcast) < 0)
+        flux_log_error (h, "error responding to broker.stats-get");
+    json_decref (mcast);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to broker.stats-get");
+    json_decref (mcast);
+}
+
+static void broker_stats_clear_cb (flux_t *h,
+                                   flux_msg_handler_t *mh,
+                                   const flux_msg_t *msg,
+                                   void *arg)
+{
+    broker_ctx_t *ctx = arg;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    flux_clr_msgcounters (h);
+    modhash_event_stats_clear (ctx->modhash);
+    if (flux_respond (h, msg, NULL) < 0)
+        flux_log_error (h, "error responding to broker.stats-clear");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to broker.stats-clear");
+}
+
+/* The default stats-clear event handler also runs and clears the message
+ * counters.  Clear event multicast counters too, so that
+ * 'flux module stats --clear-all broker' leaves no stale stats.
+ */
+static void broker_stats_clear_event_cb (flux_t *h,
+                                         flux_msg_handler_t *mh,
+                                         const flux_msg_t *msg,
+                                         void *arg)
+{
+    broker_ctx_t *ctx = arg;
+
+    if (flux_event_decode (msg, NULL, NULL) == 0)
+        modhash_event_stats_clear (ctx->modhash);
+}
+
 static void broker_conf_builtin_cb (flux_t *h,
                                     flux_msg_handler_t *mh,
                                     const flux_msg_t *msg,
@@ -1622,6 +1695,24 @@ static const struct flux_msg_handler_spec htab[] = {
         broker_setenv_cb,
         0
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "broker.stats-get",
+        broker_stats_get_cb,
+        FLUX_ROLE_ALL
+    },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "broker.stats-clear",
+        broker_stats_clear_cb,
+        0
+    },
+    {
+        FLUX_MSGTYPE_EVENT,
+        "broker.stats-clear",
+        broker_stats_clear_event_cb,
+        0
+    },
     {
         FLUX_MSGTYPE_REQUEST,
         "broker.conf-builtin",
@@ -1717,6 +1808,15 @@ static flux_msg_handler_t **broker_add_services (broker_ctx_t *ctx,
                    strerror (errno));
         return NULL;
     }
+    /* Events reach the broker's own handle only if it is subscribed.
+     */
+    if (subhash_subscribe (ctx->sub, "broker.stats-clear") < 0) {
+        errprintf (errp,
+                   "error subscribing to broker.stats-clear: %s",
+                   strerror (errno));
+        flux_msg_handler_delvec (handlers);
+        return NULL;
+    }
     return handlers;
 }
 
@@ -36,6 +36,12 @@ struct modhash {
     struct flux_msglist *trace_requests;
     flux_future_t *f_builtins_load;
     flux_future_t *f_builtins_unload;
+    struct {
+        unsigned long events;       // events multicast to modules
+        unsigned long copies;       // module deliveries (message copies)
+        unsigned long copy_bytes;   // bytes duplicated making copies
+        unsigned long shared_bytes; // payload bytes shared, not copied
+    } mcast;
 };
 
 struct modloader {
@@ -1105,8 +1111,14 @@ int modhash_event_mcast (modhash_t *mh, const flux_msg_t *msg)
     const char *topic;
     module_t *p;
 
-    if (flux_msg_get_topic (msg, &topic) < 0)
+    size_t payload_size = 0;
+    ssize_t size;
+
+    if (flux_msg_get_topic (msg, &topic) < 0
+        || (size = flux_msg_encode_size (msg)) < 0)
         return -1;
+    (void)flux_msg_get_payload (msg, NULL, &payload_size);
+    mh->mcast.events++;
     p = zhash_first (mh->zh_byuuid);
     while (p) {
         if (module_is_subscribed (p, topic)) {
@@ -1115,18 +1127,42 @@ int modhash_event_mcast (modhash_t *mh, const flux_msg_t *msg)
                               module_get_name (p),
                               mh->trace_requests,
                               msg);
+            /* The copy shares the payload buffer with msg, so only the
+             * message header (proto, topic, routes) is duplicated.
+             */
             flux_msg_t *cpy;
             if (!(cpy = flux_msg_copy (msg, true))
                 || module_sendmsg_new (p, &cpy) < 0) {
                 flux_msg_decref (cpy);
                 return -1;
             }
+            mh->mcast.copies++;
+            mh->mcast.copy_bytes += size - payload_size;
+            mh->mcast.shared_bytes += payload_size;
         }
         p = zhash_next (mh->zh_byuuid);
     }
     return 0;
 }
 
+json_t *modhash_event_stats (modhash_t *mh)
+{
+    json_t *o;
+
+    if (!(o = json_pack ("{s:I s:I s:I s:I}",
+                         "events", (json_int_t)mh->mcast.events,
+                         "copies", (json_int_t)mh->mcast.copies,
+                         "copy-bytes", (json_int_t)mh->mcast.copy_bytes,
+                         "shared-bytes", (json_int_t)mh->mcast.shared_bytes)))
+        errno = ENOMEM;
+    return o;
+}
+
+void modhash_event_stats_clear (modhash_t *mh)
+{
+    memset (&mh->mcast, 0, sizeof (mh->mcast));
+}
+
 module_t *modhash_first (modhash_t *mh)
 {
     return zhash_first (mh->zh_byuuid);
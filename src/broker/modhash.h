@@ -32,6 +32,12 @@ int modhash_destroy (modhash_t *mh);
  */
 int modhash_event_mcast (modhash_t *mh, const flux_msg_t *msg);
 
+/* Get/clear event multicast counters: events sent, module copies made,
+ * bytes duplicated by those copies, and payload bytes shared between them.
+ */
+json_t *modhash_event_stats (modhash_t *mh);
+void modhash_event_stats_clear (modhash_t *mh);
+
 /* Send a response message to the module whose uuid matches the
  * next hop in the routing stack.
  */
@@ -39,10 +39,16 @@
  */
 #define GC_WALK_WINDOW_DEFAULT 2
 
+/* Number of times to walk the roots into the reachability index again if a
+ * concurrent run left it incomplete by the time the roots are pinned.
+ */
+#define GC_PIN_RETRIES 5
+
 static int verbose = 0;
 static int no_cache = 0;
 static int walk_window = GC_WALK_WINDOW_DEFAULT;
 static int test_delay_after_list = 0;
+static int full_walk = 0;
 
 static int64_t horizon_epoch = 0;
 static int64_t horizon_high_water = 0;   // MAX(rowid) frozen at start of run
@@ -601,6 +607,245 @@ done:
     return rc;
 }
 
+/* Write any dirty content cache entries to the backing store, which walks
+ * tree objects into the reachability index directly from the store.
+ */
+static int content_flush (flux_t *h)
+{
+    flux_future_t *f;
+
+    if (!(f = flux_rpc (h, "content.flush", NULL, 0, 0))
+        || flux_rpc_get (f, NULL) < 0) {
+        log_msg ("content.flush: %s", future_strerror (f, errno));
+        flux_future_destroy (f);
+        return -1;
+    }
+    flux_future_destroy (f);
+    return 0;
+}
+
+/* Walk 'roots' into the backing store's reachability index, along with any
+ * walk left unfinished by an earlier run.  The backing store skips tree
+ * objects that are already indexed, so the work is proportional to the
+ * tree objects stored since the last run.  Each gc-index call does a
+ * bounded amount of work and hands back the trees it did not get to, which
+ * are sent again.  The walk is complete when a call with no hashes returns
+ * nothing pending.  Returns -1 with errno = ENOSYS if the backing store has
+ * no reachability index.
+ */
+static int index_roots (flux_t *h, json_t *roots, int64_t *walkedp)
+{
+    json_t *work;
+    int64_t total = 0;
+
+    if (!(work = json_copy (roots))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (;;) {
+        flux_future_t *f;
+        json_t *batch;
+        json_t *pending;
+        int walked;
+        size_t count;
+
+        if (!(batch = json_array ()))
+            goto nomem;
+        while (json_array_size (batch) < mark_batch_size
+               && (count = json_array_size (work)) > 0) {
+            if (json_array_append (batch, json_array_get (work, count - 1)) < 0
+                || json_array_remove (work, count - 1) < 0) {
+                json_decref (batch);
+                goto nomem;
+            }
+        }
+        count = json_array_size (batch);
+        if (!(f = flux_rpc_pack (h,
+                                 "content-backing.gc-index",
+                                 0,
+                                 0,
+                                 "{s:o}",
+                                 "hashes", batch))) {
+            json_decref (work);
+            return -1;
+        }
+        if (flux_rpc_get_unpack (f,
+                                 "{s:i s:o}",
+                                 "walked", &walked,
+                                 "pending", &pending) < 0) {
+            if (errno == ENOSYS) {
+                flux_future_destroy (f);
+                json_decref (work);
+                return -1;
+            }
+            log_msg_exit ("gc-index: %s", future_strerror (f, errno));
+        }
+        if (json_array_extend (work, pending) < 0) {
+            flux_future_destroy (f);
+            goto nomem;
+        }
+        total += walked;
+        if (verbose > 1)
+            log_msg ("indexed %d tree objects, %zu pending",
+                     walked,
+                     json_array_size (work));
+        flux_future_destroy (f);
+        if (count == 0 && json_array_size (work) == 0)
+            break;
+    }
+    json_decref (work);
+    *walkedp = total;
+    return 0;
+nomem:
+    json_decref (work);
+    errno = ENOMEM;
+    return -1;
+}
+
+/* Pin 'roots' as the roots of the reachability index, taken at the frozen
+ * horizon.  Returns -1 with errno = EAGAIN if the index does not yet cover
+ * them (a concurrent run may have collected part of it), or ENOSYS if the
+ * backing store has no index.
+ */
+static int pin_roots (flux_t *h, json_t *roots)
+{
+    flux_future_t *f;
+    int pinned;
+
+    if (!(f = flux_rpc_pack (h,
+                             "content-backing.gc-pin",
+                             0,
+                             0,
+                             "{s:I s:O}",
+                             "epoch", horizon_epoch,
+                             "roots", roots)))
+        return -1;
+    if (flux_rpc_get_unpack (f, "{s:b}", "pinned", &pinned) < 0) {
+        if (errno == EAGAIN || errno == ENOSYS) {
+            if (verbose && errno == EAGAIN)
+                log_msg ("gc-pin: %s", future_strerror (f, errno));
+            flux_future_destroy (f);
+            return -1;
+        }
+        log_msg_exit ("gc-pin: %s", future_strerror (f, errno));
+    }
+    /* A newer run has already pinned roots enumerated after ours, which
+     * cover everything that was live at our horizon.
+     */
+    if (verbose && !pinned)
+        log_msg ("index was pinned by a newer gc run");
+    flux_future_destroy (f);
+    return 0;
+}
+
+/* Remove objects that are no longer reachable from the pinned roots from
+ * the reachability index, so the sweep can delete them.
+ */
+static int collect_unpinned (flux_t *h)
+{
+    int done = 0;
+    int64_t total = 0;
+
+    while (!done) {
+        flux_future_t *f;
+        int collected;
+
+        if (!(f = flux_rpc (h, "content-backing.gc-collect", NULL, 0, 0)))
+            return -1;
+        if (flux_rpc_get_unpack (f,
+                                 "{s:i s:b}",
+                                 "collected", &collected,
+                                 "done", &done) < 0) {
+            if (errno == ENOSYS) {
+                flux_future_destroy (f);
+                return -1;
+            }
+            log_msg_exit ("gc-collect: %s", future_strerror (f, errno));
+        }
+        total += collected;
+        flux_future_destroy (f);
+    }
+    if (verbose)
+        log_msg ("released %jd objects from the index", (intmax_t)total);
+    return 0;
+}
+
+/* Incremental mark phase: walk the roots into the reachability index, pin
+ * them, and collect what they no longer reach.  Returns -1 with
+ * errno = ENOSYS if the backing store has no reachability index.
+ */
+static int index_all_roots (flux_t *h, json_t *roots, int64_t *walkedp)
+{
+    int64_t walked = 0;
+    int retries = 0;
+
+    if (content_flush (h) < 0)
+        return -1;
+    for (;;) {
+        int64_t n;
+
+        if (index_roots (h, roots, &n) < 0)
+            return -1;
+        walked += n;
+        if (pin_roots (h, roots) == 0)
+            break;
+        if (errno != EAGAIN || ++retries > GC_PIN_RETRIES)
+            return -1;
+    }
+    if (verbose)
+        log_msg ("indexed %jd new tree objects", (intmax_t)walked);
+    if (collect_unpinned (h) < 0)
+        return -1;
+    *walkedp = walked;
+    return 0;
+}
+
+/* Release the whole reachability index after a full mark phase, so the
+ * next incremental run rebuilds it from scratch.  The full mark protects
+ * everything reachable on its own, so nothing depends on the index here.
+ */
+static int release_index (flux_t *h)
+{
+    json_t *noroots;
+    int rc;
+
+    if (!(noroots = json_array ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    rc = pin_roots (h, noroots);
+    json_decref (noroots);
+    if (rc < 0 || collect_unpinned (h) < 0)
+        return errno == ENOSYS ? 0 : -1;
+    return 0;
+}
+
+/* Ask the backing store to sweep in the background, at its own pace.
+ * The response arrives once the sweep is complete.  Fails with ENOSYS
+ * if the backing store does not support it.
+ */
+static int sweep_background (flux_t *h, int64_t *deletedp)
+{
+    flux_future_t *f;
+    int64_t deleted;
+
+    if (!(f = flux_rpc_pack (h,
+                             "content-backing.sweep-start",
+                             0,
+                             0,
+                             "{s:I}",
+                             "epoch", horizon_epoch))
+        || flux_rpc_get_unpack (f, "{s:I}", "deleted", &deleted) < 0) {
+        if (errno != ENOSYS)
+            log_msg_exit ("sweep failed: %s", future_strerror (f, errno));
+        flux_future_destroy (f);
+        return -1;
+    }
+    flux_future_destroy (f);
+    *deletedp = deleted;
+    return 0;
+}
+
 static int sweep_blobs (flux_t *h, int64_t *deletedp)
 {
     int64_t total_deleted = 0;
@@ -609,6 +854,14 @@ static int sweep_blobs (flux_t *h, int64_t *deletedp)
     if (verbose)
         log_msg ("starting sweep phase");
 
+    if (sweep_background (h, &total_deleted) == 0) {
+        if (verbose)
+            log_msg ("background sweep complete: deleted %jd blobs",
+                     (intmax_t)total_deleted);
+        *deletedp = total_deleted;
+        return 0;
+    }
+
     /* Sweep by walking the objects table in rowid order via a cursor, bounded
      * at the frozen high-water rowid.  Each call deletes garbage in a rowid
      * window and returns an advanced cursor; termination is by the cursor
@@ -678,6 +931,7 @@ int cmd_gc (optparse_t *p, int argc, char **argv)
     if (walk_window <= 0)
         log_err_exit ("invalid value for maxreqs");
     test_delay_after_list = optparse_get_int (p, "test-delay-after-list", 0);
+    full_walk = optparse_hasopt (p, "full");
 
     if (!(h = builtin_get_flux_handle (p)))
         log_err_exit ("flux_open");
@@ -715,14 +969,26 @@ int cmd_gc (optparse_t *p, int argc, char **argv)
     if (verbose)
         log_msg ("enumerated %zu total roots", json_array_size (roots));
 
-    /* Mark phase */
-    if (mark_all_roots (h, roots, &marked) < 0)
-        log_err_exit ("mark phase failed");
+    /* Mark phase.  Unless --full was given, use the backing store's
+     * reachability index if it has one, which only needs to see the tree
+     * objects stored since the last run.  Otherwise walk every root and
+     * mark each reachable blob.
+     */
+    if (full_walk || index_all_roots (h, roots, &marked) < 0) {
+        if (!full_walk && errno != ENOSYS)
+            log_err_exit ("mark phase failed");
+        if (verbose && !full_walk)
+            log_msg ("backing store has no reachability index");
+        if (mark_all_roots (h, roots, &marked) < 0)
+            log_err_exit ("mark phase failed");
+        if (full_walk && release_index (h) < 0)
+            log_err_exit ("failed to release reachability index");
+    }
 
     /* Stop after the mark phase (testing only).  This is the same state a
      * crash between mark and sweep would leave: the mark phase is complete
-     * and durable, and the next run re-marks from scratch before sweeping,
-     * so stopping here must leave no data at risk.
+     * and durable, and the next run marks again before sweeping, so
+     * stopping here must leave no data at risk.
      */
     if (optparse_hasopt (p, "test-mark-only")) {
         log_msg ("stopping after mark phase (test)");
@@ -736,9 +1002,10 @@ int cmd_gc (optparse_t *p, int argc, char **argv)
     if (sweep_blobs (h, &deleted) < 0)
         log_err_exit ("sweep phase failed");
 
-    /* 'marked' counts blobs whose epoch this run raised (protected), and
-     * 'deleted' counts blobs actually reclaimed -- the accurate figures, in
-     * contrast to a pre-mark count that would include reachable data.
+    /* 'marked' counts blobs whose epoch this run raised (protected), or
+     * with the reachability index, tree objects newly indexed.  'deleted'
+     * counts blobs actually reclaimed -- the accurate figures, in contrast
+     * to a pre-mark count that would include reachable data.
      */
     log_msg ("gc complete: marked %jd, reclaimed %jd blobs (horizon epoch %jd)",
              (intmax_t)marked,
@@ -763,6 +1030,12 @@ static struct optparse_option gc_opts[] = {
         .usage = "Increase number of concurrent content requests during the"
                  " mark phase (default 2)",
     },
+    {
+        .name = "full",
+        .has_arg = 0,
+        .usage = "Walk the entire KVS instead of only what changed since"
+                 " the last run",
+    },
     {
         .name = "verbose",
         .key = 'v',
@@ -129,6 +129,7 @@ struct attach_ctx {
     flux_future_t *eventlog_f;
     flux_future_t *exec_eventlog_f;
     flux_future_t *output_f;
+    flux_future_t *output_data_f;
     flux_watcher_t *sigint_w;
     flux_watcher_t *sigtstp_w;
     flux_watcher_t *notify_timer;
@@ -155,6 +156,7 @@ struct attach_ctx {
     zlist_t *tail_output;
     int tail_output_len;
     bool sentinel_reached;
+    bool data_sentinel_reached;
 };
 
 struct attach_event {
@@ -401,6 +403,53 @@ void flush_tail_output (struct attach_ctx *ctx)
     }
 }
 
+static void attach_output_data_start (struct attach_ctx *ctx);
+
+/* Handle a data event decoded from guest.output-data by job-info.
+ */
+static void attach_output_data_continuation (flux_future_t *f, void *arg)
+{
+    struct attach_ctx *ctx = arg;
+    const char *entry;
+    json_t *o;
+    const char *name;
+    json_t *context;
+
+    if (flux_job_event_watch_get (f, &entry) < 0) {
+        if (errno == ENODATA || errno == ENOENT)
+            goto done;
+        log_msg_exit ("flux_job_event_watch_get: %s",
+                      future_strerror (f, errno));
+    }
+    if (optparse_hasopt (ctx->p, "tail")
+        && !ctx->data_sentinel_reached
+        && !entry) {
+        ctx->data_sentinel_reached = true;
+        flush_tail_output (ctx);
+        goto out;
+    }
+    if (!(o = eventlog_entry_decode (entry)))
+        log_err_exit ("eventlog_entry_decode");
+    if (eventlog_entry_parse (o, NULL, &name, &context) < 0)
+        log_err_exit ("eventlog_entry_parse");
+    if (streq (name, "data")) {
+        if (optparse_hasopt (ctx->p, "tail")
+            && !ctx->data_sentinel_reached)
+            store_tail_output (ctx, o, context);
+        else
+            handle_output_data (ctx, context);
+    }
+    json_decref (o);
+out:
+    flux_future_reset (f);
+    return;
+done:
+    flux_future_destroy (f);
+    ctx->output_data_f = NULL;
+    ctx->eventlog_watch_count--;
+    attach_completed_check (ctx);
+}
+
 /* Handle an event in the guest.output eventlog.
  * This is a stream of responses, one response per event, terminated with
  * an ENODATA error response (or another error if something went wrong).
@@ -443,8 +492,14 @@ void attach_output_continuation (flux_future_t *f, void *arg)
         log_err_exit ("eventlog_entry_parse");
 
     if (streq (name, "header")) {
+        int binary = 0;
         /* Future: per-stream encoding */
         ctx->output_header_parsed = true;
+        /* With output.binary, data is in guest.output-data instead.
+         */
+        (void)json_unpack (context, "{s:{s:b}}", "options", "binary", &binary);
+        if (binary)
+            attach_output_data_start (ctx);
     }
     else if (streq (name, "data")) {
         if (optparse_hasopt (ctx->p, "tail")) {
@@ -551,6 +606,10 @@ void attach_signal_cb (flux_reactor_t *r,
                 if (flux_job_event_watch_cancel (ctx->output_f) < 0)
                     log_err_exit ("flux_job_event_watch_cancel");
             }
+            if (ctx->output_data_f) {
+                if (flux_job_event_watch_cancel (ctx->output_data_f) < 0)
+                    log_err_exit ("flux_job_event_watch_cancel");
+            }
             log_msg ("detaching...");
         }
         else {
@@ -679,6 +738,34 @@ void attach_output_start (struct attach_ctx *ctx)
     ctx->eventlog_watch_count++;
 }
 
+/*  Start the guest.output-data watcher.  The key is created on the first
+ *  flush of output, so wait for it.
+ */
+static void attach_output_data_start (struct attach_ctx *ctx)
+{
+    int flags = FLUX_JOB_EVENT_WATCH_WAITCREATE;
+
+    if (ctx->output_data_f)
+        return;
+
+    if (optparse_hasopt (ctx->p, "tail"))
+        flags |= FLUX_JOB_EVENT_WATCH_INITIAL_SENTINEL;
+
+    if (!(ctx->output_data_f = flux_job_event_watch (ctx->h,
+                                                     ctx->id,
+                                                     "guest.output-data",
+                                                     flags)))
+        log_err_exit ("flux_job_event_watch");
+
+    if (flux_future_then (ctx->output_data_f,
+                          -1.,
+                          attach_output_data_continuation,
+                          ctx) < 0)
+        log_err_exit ("flux_future_then");
+
+    ctx->eventlog_watch_count++;
+}
+
 static void valid_or_exit_for_debug (struct attach_ctx *ctx)
 {
     flux_future_t *f = NULL;
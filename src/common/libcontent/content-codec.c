@@ -0,0 +1,425 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <lz4.h>
+#if HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+#include <flux/core.h>
+
+#include "src/common/libutil/errprintf.h"
+#include "ccan/array_size/array_size.h"
+#include "ccan/str/str.h"
+
+#include "content-codec.h"
+
+/* Blobs smaller than this are not worth compressing.  With a dictionary,
+ * zstd does well on much smaller blobs, since the redundancy is in the
+ * dictionary rather than the blob itself.
+ */
+static const size_t compression_threshold = 256;
+static const size_t compression_threshold_dict = 64;
+
+static const int zstd_level = 3;
+
+#define DICTS_MAX 16
+
+struct codec_dict {
+    uint32_t id;
+#if HAVE_ZSTD
+    ZSTD_CDict *cdict;
+    ZSTD_DDict *ddict;
+#endif
+};
+
+struct content_codec {
+    int id;
+#if HAVE_ZSTD
+    ZSTD_CCtx *cctx;
+    ZSTD_DCtx *dctx;
+#endif
+    struct codec_dict dicts[DICTS_MAX];
+    int dict_count;
+};
+
+static const char *codec_names[] = {
+    [CONTENT_CODEC_NONE] = "none",
+    [CONTENT_CODEC_LZ4] = "lz4",
+    [CONTENT_CODEC_ZSTD] = "zstd",
+};
+
+const char *content_codec_id_to_name (int id)
+{
+    if (id < 0 || id >= ARRAY_SIZE (codec_names))
+        return NULL;
+    return codec_names[id];
+}
+
+bool content_codec_available (int id)
+{
+    switch (id) {
+        case CONTENT_CODEC_NONE:
+        case CONTENT_CODEC_LZ4:
+            return true;
+#if HAVE_ZSTD
+        case CONTENT_CODEC_ZSTD:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+static void dict_clear (struct codec_dict *d)
+{
+#if HAVE_ZSTD
+    ZSTD_freeCDict (d->cdict);
+    ZSTD_freeDDict (d->ddict);
+#endif
+    memset (d, 0, sizeof (*d));
+}
+
+void content_codec_destroy (struct content_codec *c)
+{
+    if (c) {
+        int saved_errno = errno;
+        for (int i = 0; i < c->dict_count; i++)
+            dict_clear (&c->dicts[i]);
+#if HAVE_ZSTD
+        ZSTD_freeCCtx (c->cctx);
+        ZSTD_freeDCtx (c->dctx);
+#endif
+        free (c);
+        errno = saved_errno;
+    }
+}
+
+struct content_codec *content_codec_create (const char *name,
+                                            flux_error_t *error)
+{
+    struct content_codec *c;
+    int id = -1;
+
+    for (int i = 0; i < ARRAY_SIZE (codec_names); i++) {
+        if (streq (name, codec_names[i]))
+            id = i;
+    }
+    if (id < 0) {
+        errprintf (error, "unknown codec: %s", name);
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!content_codec_available (id)) {
+        errprintf (error, "%s support was not compiled in", name);
+        errno = ENOSYS;
+        return NULL;
+    }
+    if (!(c = calloc (1, sizeof (*c)))) {
+        errprintf (error, "out of memory");
+        return NULL;
+    }
+    c->id = id;
+    return c;
+}
+
+int content_codec_id (struct content_codec *c)
+{
+    return c->id;
+}
+
+const char *content_codec_name (struct content_codec *c)
+{
+    return codec_names[c->id];
+}
+
+bool content_codec_wanted (struct content_codec *c, size_t size)
+{
+    if (c->id == CONTENT_CODEC_NONE)
+        return false;
+    if (c->id == CONTENT_CODEC_ZSTD && c->dict_count > 0)
+        return size >= compression_threshold_dict;
+    return size >= compression_threshold;
+}
+
+size_t content_codec_bound (struct content_codec *c, size_t size)
+{
+    switch (c->id) {
+        case CONTENT_CODEC_LZ4:
+            return size <= LZ4_MAX_INPUT_SIZE ? LZ4_compressBound (size) : 0;
+#if HAVE_ZSTD
+        case CONTENT_CODEC_ZSTD:
+            return ZSTD_compressBound (size);
+#endif
+        default:
+            return size;
+    }
+}
+
+static struct codec_dict *dict_lookup (struct content_codec *c, uint32_t id)
+{
+    if (c) {
+        for (int i = 0; i < c->dict_count; i++) {
+            if (c->dicts[i].id == id)
+                return &c->dicts[i];
+        }
+    }
+    return NULL;
+}
+
+uint32_t content_codec_dict_id (struct content_codec *c)
+{
+    if (c->id != CONTENT_CODEC_ZSTD || c->dict_count == 0)
+        return 0;
+    return c->dicts[c->dict_count - 1].id;
+}
+
+bool content_codec_dict_supported (struct content_codec *c)
+{
+    return c->id == CONTENT_CODEC_ZSTD;
+}
+
+#if HAVE_ZSTD
+static ssize_t zstd_compress (struct content_codec *c,
+                              const void *src,
+                              size_t src_size,
+                              void *dst,
+                              size_t dst_size)
+{
+    size_t n;
+
+    if (!c->cctx && !(c->cctx = ZSTD_createCCtx ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (c->dict_count > 0) {
+        n = ZSTD_compress_usingCDict (c->cctx,
+                                      dst,
+                                      dst_size,
+                                      src,
+                                      src_size,
+                                      c->dicts[c->dict_count - 1].cdict);
+    }
+    else
+        n = ZSTD_compressCCtx (c->cctx,
+                               dst,
+                               dst_size,
+                               src,
+                               src_size,
+                               zstd_level);
+    if (ZSTD_isError (n)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return n;
+}
+
+static int zstd_decompress (struct content_codec *c,
+                            const void *src,
+                            size_t src_size,
+                            void *dst,
+                            size_t dst_size)
+{
+    uint32_t dict_id = ZSTD_getDictID_fromFrame (src, src_size);
+    ZSTD_DCtx *dctx = NULL;
+    size_t n;
+
+    if (c) {
+        if (!c->dctx && !(c->dctx = ZSTD_createDCtx ())) {
+            errno = ENOMEM;
+            return -1;
+        }
+        dctx = c->dctx;
+    }
+    if (dict_id != 0) {
+        struct codec_dict *d;
+
+        if (!(d = dict_lookup (c, dict_id))) {
+            errno = ENOENT;
+            return -1;
+        }
+        n = ZSTD_decompress_usingDDict (dctx,
+                                        dst,
+                                        dst_size,
+                                        src,
+                                        src_size,
+                                        d->ddict);
+    }
+    else if (dctx)
+        n = ZSTD_decompressDCtx (dctx, dst, dst_size, src, src_size);
+    else
+        n = ZSTD_decompress (dst, dst_size, src, src_size);
+    if (ZSTD_isError (n) || n != dst_size) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+#endif
+
+ssize_t content_codec_compress (struct content_codec *c,
+                                const void *src,
+                                size_t src_size,
+                                void *dst,
+                                size_t dst_size)
+{
+    int n;
+
+    switch (c->id) {
+        case CONTENT_CODEC_LZ4:
+            if (src_size > LZ4_MAX_INPUT_SIZE) {
+                errno = EINVAL;
+                return -1;
+            }
+            n = LZ4_compress_default (src,
+                                      dst,
+                                      src_size,
+                                      dst_size > INT_MAX ? INT_MAX : dst_size);
+            if (n == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            return n;
+#if HAVE_ZSTD
+        case CONTENT_CODEC_ZSTD:
+            return zstd_compress (c, src, src_size, dst, dst_size);
+#endif
+        default:
+            errno = EINVAL;
+            return -1;
+    }
+}
+
+int content_codec_decompress (struct content_codec *c,
+                              int id,
+                              const void *src,
+                              size_t src_size,
+                              void *dst,
+                              size_t dst_size)
+{
+    int n;
+
+    switch (id) {
+        case CONTENT_CODEC_NONE:
+            if (src_size != dst_size) {
+                errno = EINVAL;
+                return -1;
+            }
+            memcpy (dst, src, src_size);
+            return 0;
+        case CONTENT_CODEC_LZ4:
+            if (src_size > INT_MAX || dst_size > INT_MAX) {
+                errno = EINVAL;
+                return -1;
+            }
+            n = LZ4_decompress_safe (src, dst, src_size, dst_size);
+            if (n < 0 || n != dst_size) {
+                errno = EINVAL;
+                return -1;
+            }
+            return 0;
+#if HAVE_ZSTD
+        case CONTENT_CODEC_ZSTD:
+            return zstd_decompress (c, src, src_size, dst, dst_size);
+#endif
+        default:
+            errno = content_codec_id_to_name (id) ? ENOSYS : EINVAL;
+            return -1;
+    }
+}
+
+int64_t content_codec_dict_add (struct content_codec *c,
+                                int id,
+                                const void *dict,
+                                size_t size)
+{
+#if HAVE_ZSTD
+    struct codec_dict *d;
+    uint32_t dict_id;
+
+    if (id != CONTENT_CODEC_ZSTD
+        || !dict
+        || (dict_id = ZSTD_getDictID_fromDict (dict, size)) == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (dict_lookup (c, dict_id)) {
+        errno = EEXIST;
+        return -1;
+    }
+    if (c->dict_count == DICTS_MAX) {
+        errno = ENOSPC;
+        return -1;
+    }
+    d = &c->dicts[c->dict_count];
+    d->id = dict_id;
+    if (!(d->cdict = ZSTD_createCDict (dict, size, zstd_level))
+        || !(d->ddict = ZSTD_createDDict (dict, size))) {
+        dict_clear (d);
+        errno = ENOMEM;
+        return -1;
+    }
+    c->dict_count++;
+    return dict_id;
+#else
+    errno = id == CONTENT_CODEC_ZSTD ? ENOSYS : EINVAL;
+    return -1;
+#endif
+}
+
+int content_codec_dict_train (struct content_codec *c,
+                              const void *samples,
+                              const size_t *sizes,
+                              int count,
+                              size_t dict_size,
+                              void **dictp,
+                              size_t *sizep)
+{
+#if HAVE_ZSTD
+    void *dict;
+    size_t n;
+
+    if (c->id != CONTENT_CODEC_ZSTD
+        || !samples
+        || !sizes
+        || count <= 0
+        || dict_size == 0
+        || !dictp
+        || !sizep) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(dict = malloc (dict_size)))
+        return -1;
+    n = ZDICT_trainFromBuffer (dict, dict_size, samples, sizes, count);
+    if (ZDICT_isError (n)) {
+        free (dict);
+        errno = EINVAL;
+        return -1;
+    }
+    *dictp = dict;
+    *sizep = n;
+    return 0;
+#else
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+/*
+ * vi:ts=4 sw=4 expandtab
+ */
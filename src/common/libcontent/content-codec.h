@@ -0,0 +1,127 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* Blob compression for content backing stores.
+ *
+ * A backing store records the codec id next to each compressed blob,
+ * so blobs written with any codec can be read back regardless of which
+ * codec is currently configured for writing.  The ids are persistent
+ * and must not be renumbered.
+ *
+ * zstd can additionally use shared dictionaries, which greatly improve
+ * the ratio on small, similar blobs.  The store owns the dictionary
+ * bytes and hands them to the codec with content_codec_dict_add().
+ * zstd frames carry the id of the dictionary they were written with.
+ */
+
+#ifndef _FLUX_CONTENT_CODEC_H
+#define _FLUX_CONTENT_CODEC_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <flux/core.h>
+
+enum {
+    CONTENT_CODEC_NONE = 0,
+    CONTENT_CODEC_LZ4 = 1,
+    CONTENT_CODEC_ZSTD = 2,
+};
+
+struct content_codec;
+
+/* Create a codec context that compresses with codec 'name' ("none", "lz4",
+ * or "zstd").  Any codec may be used for decompression.
+ */
+struct content_codec *content_codec_create (const char *name,
+                                            flux_error_t *error);
+void content_codec_destroy (struct content_codec *c);
+
+/* Return the id or name of the codec used for compression.
+ */
+int content_codec_id (struct content_codec *c);
+const char *content_codec_name (struct content_codec *c);
+
+/* Look up the name of codec 'id'.  Returns NULL if unknown.
+ */
+const char *content_codec_id_to_name (int id);
+
+/* Return true if codec 'id' was compiled in.
+ */
+bool content_codec_available (int id);
+
+/* Return true if a blob of 'size' bytes should be compressed.
+ * Smaller blobs are stored as is.
+ */
+bool content_codec_wanted (struct content_codec *c, size_t size);
+
+/* Return the worst case compressed size for 'size' bytes of input.
+ */
+size_t content_codec_bound (struct content_codec *c, size_t size);
+
+/* Compress 'src' into 'dst', which should be at least
+ * content_codec_bound() bytes.  Returns the compressed size,
+ * or -1 on error with errno set.
+ */
+ssize_t content_codec_compress (struct content_codec *c,
+                                const void *src,
+                                size_t src_size,
+                                void *dst,
+                                size_t dst_size);
+
+/* Decompress 'src', written by codec 'id', into 'dst', which must be
+ * exactly the uncompressed size.  'c' may be NULL if the blob was not
+ * written with a dictionary.  Returns 0 on success, or -1 on error with
+ * errno set: ENOSYS if the codec is not compiled in, ENOENT if the blob
+ * requires a dictionary that has not been added, or EINVAL if the blob
+ * is corrupt.
+ */
+int content_codec_decompress (struct content_codec *c,
+                              int id,
+                              const void *src,
+                              size_t src_size,
+                              void *dst,
+                              size_t dst_size);
+
+/* Add a dictionary for codec 'id'.  The most recently added dictionary
+ * is used for compression from then on.  Returns the dictionary id,
+ * which is nonzero, or -1 on error with errno set.
+ */
+int64_t content_codec_dict_add (struct content_codec *c,
+                                int id,
+                                const void *dict,
+                                size_t size);
+
+/* Return the id of the dictionary used for compression, or 0 if none.
+ */
+uint32_t content_codec_dict_id (struct content_codec *c);
+
+/* Return true if the codec used for compression can use a dictionary.
+ */
+bool content_codec_dict_supported (struct content_codec *c);
+
+/* Train a dictionary of at most 'dict_size' bytes from 'count' samples,
+ * concatenated in 'samples' with their sizes in 'sizes'.  On success,
+ * the dictionary is returned in 'dictp' (caller must free) and its size
+ * in 'sizep'.  Returns 0 on success, or -1 on error with errno set.
+ */
+int content_codec_dict_train (struct content_codec *c,
+                              const void *samples,
+                              const size_t *sizes,
+                              int count,
+                              size_t dict_size,
+                              void **dictp,
+                              size_t *sizep);
+
+#endif /* !_FLUX_CONTENT_CODEC_H */
+
+/*
+ * vi:ts=4 sw=4 expandtab
+ */
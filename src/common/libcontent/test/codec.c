@@ -0,0 +1,313 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+#include "src/common/libcontent/content-codec.h"
+
+/* A compressible blob similar to what the KVS stores.
+ */
+static size_t make_blob (char *buf, size_t size, int seq)
+{
+    int n = snprintf (buf,
+                      size,
+                      "{\"timestamp\":%d.%03d,\"name\":\"submit\","
+                      "\"context\":{\"userid\":%d,\"urgency\":16,"
+                      "\"flags\":0,\"version\":1}}\n",
+                      1700000000 + seq,
+                      seq % 1000,
+                      5000 + seq % 7);
+    return n;
+}
+
+void test_badargs (void)
+{
+    flux_error_t error;
+    char buf[16];
+
+    errno = 0;
+    ok (content_codec_create ("nope", &error) == NULL && errno == EINVAL,
+        "content_codec_create name=nope fails with EINVAL");
+    like (error.text, "unknown codec",
+        "and error string was set");
+    ok (content_codec_id_to_name (-1) == NULL
+        && content_codec_id_to_name (42) == NULL,
+        "content_codec_id_to_name of unknown id returns NULL");
+    ok (!content_codec_available (42),
+        "content_codec_available of unknown id returns false");
+    errno = 0;
+    ok (content_codec_decompress (NULL, 42, "x", 1, buf, sizeof (buf)) < 0
+        && errno == EINVAL,
+        "content_codec_decompress of unknown id fails with EINVAL");
+    errno = 0;
+    ok (content_codec_decompress (NULL,
+                                  CONTENT_CODEC_NONE,
+                                  "x",
+                                  1,
+                                  buf,
+                                  sizeof (buf)) < 0
+        && errno == EINVAL,
+        "content_codec_decompress with wrong size fails with EINVAL");
+}
+
+void test_none (void)
+{
+    struct content_codec *c;
+
+    ok ((c = content_codec_create ("none", NULL)) != NULL,
+        "content_codec_create none works");
+    ok (content_codec_id (c) == CONTENT_CODEC_NONE
+        && streq (content_codec_name (c), "none"),
+        "codec id and name are correct");
+    ok (!content_codec_wanted (c, 1024*1024),
+        "compression is never wanted");
+    ok (!content_codec_dict_supported (c),
+        "dictionaries are not supported");
+    content_codec_destroy (c);
+}
+
+void test_roundtrip (const char *name, int id)
+{
+    struct content_codec *c;
+    size_t size = 64*1024;
+    char *src;
+    char *dst;
+    char *out;
+    size_t dst_size;
+    ssize_t n;
+    size_t i;
+
+    if (!(src = malloc (size)) || !(out = malloc (size)))
+        BAIL_OUT ("out of memory");
+    for (i = 0; i < size; i += make_blob (src + i, size - i, i))
+        ;
+    if (!(c = content_codec_create (name, NULL)))
+        BAIL_OUT ("content_codec_create %s failed", name);
+    ok (content_codec_id (c) == id
+        && streq (content_codec_name (c), name)
+        && streq (content_codec_id_to_name (id), name),
+        "%s: codec id and name are correct", name);
+    ok (!content_codec_wanted (c, 16) && content_codec_wanted (c, 4096),
+        "%s: compression is wanted for large blobs only", name);
+    dst_size = content_codec_bound (c, size);
+    ok (dst_size >= size,
+        "%s: content_codec_bound works", name);
+    if (!(dst = malloc (dst_size)))
+        BAIL_OUT ("out of memory");
+    n = content_codec_compress (c, src, size, dst, dst_size);
+    ok (n > 0 && n < size,
+        "%s: content_codec_compress %zu bytes to %zd", name, size, n);
+    ok (content_codec_decompress (c, id, dst, n, out, size) == 0
+        && memcmp (src, out, size) == 0,
+        "%s: content_codec_decompress restored the data", name);
+    ok (content_codec_decompress (NULL, id, dst, n, out, size) == 0
+        && memcmp (src, out, size) == 0,
+        "%s: content_codec_decompress works without a codec context", name);
+    errno = 0;
+    ok (content_codec_decompress (c, id, dst, n, out, size - 1) < 0
+        && errno == EINVAL,
+        "%s: content_codec_decompress with wrong size fails with EINVAL",
+        name);
+    errno = 0;
+    ok (content_codec_decompress (c, id, "garbage", 7, out, size) < 0
+        && errno == EINVAL,
+        "%s: content_codec_decompress of garbage fails with EINVAL", name);
+    content_codec_destroy (c);
+    free (dst);
+    free (out);
+    free (src);
+}
+
+void test_lz4_nodict (void)
+{
+    struct content_codec *c;
+
+    if (!(c = content_codec_create ("lz4", NULL)))
+        BAIL_OUT ("content_codec_create lz4 failed");
+    ok (!content_codec_dict_supported (c),
+        "lz4: dictionaries are not supported");
+    errno = 0;
+    ok (content_codec_dict_add (c, CONTENT_CODEC_LZ4, "x", 1) < 0
+        && errno == EINVAL,
+        "lz4: content_codec_dict_add fails with EINVAL");
+    content_codec_destroy (c);
+}
+
+void test_zstd_dict (void)
+{
+    struct content_codec *c;
+    struct content_codec *c2;
+    int count = 2000;
+    char *samples;
+    size_t *sizes;
+    size_t total = 0;
+    void *dict;
+    size_t dict_size;
+    int64_t dict_id;
+    char blob[256];
+    size_t blob_size;
+    char out[256];
+    char plain[512];
+    char packed[512];
+    ssize_t n_plain;
+    ssize_t n_packed;
+
+    if (!(samples = malloc (count * sizeof (blob)))
+        || !(sizes = calloc (count, sizeof (sizes[0]))))
+        BAIL_OUT ("out of memory");
+    for (int i = 0; i < count; i++) {
+        sizes[i] = make_blob (samples + total, sizeof (blob), i);
+        total += sizes[i];
+    }
+    if (!(c = content_codec_create ("zstd", NULL)))
+        BAIL_OUT ("content_codec_create zstd failed");
+    ok (content_codec_dict_supported (c),
+        "zstd: dictionaries are supported");
+    ok (content_codec_dict_id (c) == 0,
+        "zstd: no dictionary is in use initially");
+    ok (content_codec_dict_train (c,
+                                  samples,
+                                  sizes,
+                                  count,
+                                  16384,
+                                  &dict,
+                                  &dict_size) == 0,
+        "zstd: content_codec_dict_train works");
+    diag ("trained %zu byte dictionary", dict_size);
+    errno = 0;
+    ok (content_codec_dict_train (c,
+                                  samples,
+                                  sizes,
+                                  0,
+                                  16384,
+                                  &dict,
+                                  &dict_size) < 0
+        && errno == EINVAL,
+        "zstd: content_codec_dict_train with no samples fails with EINVAL");
+
+    blob_size = make_blob (blob, sizeof (blob), count + 1);
+    n_plain = content_codec_compress (c,
+                                      blob,
+                                      blob_size,
+                                      plain,
+                                      sizeof (plain));
+    ok (n_plain > 0,
+        "zstd: %zu byte blob compressed to %zd without dictionary",
+        blob_size, n_plain);
+
+    errno = 0;
+    ok (content_codec_dict_add (c, CONTENT_CODEC_ZSTD, "x", 1) < 0
+        && errno == EINVAL,
+        "zstd: content_codec_dict_add of a bogus dictionary fails");
+    ok ((dict_id = content_codec_dict_add (c,
+                                           CONTENT_CODEC_ZSTD,
+                                           dict,
+                                           dict_size)) > 0,
+        "zstd: content_codec_dict_add works");
+    ok (content_codec_dict_id (c) == dict_id,
+        "zstd: the new dictionary is in use");
+    errno = 0;
+    ok (content_codec_dict_add (c, CONTENT_CODEC_ZSTD, dict, dict_size) < 0
+        && errno == EEXIST,
+        "zstd: adding the same dictionary again fails with EEXIST");
+    ok (content_codec_wanted (c, 64),
+        "zstd: smaller blobs are compressed with a dictionary");
+
+    n_packed = content_codec_compress (c,
+                                       blob,
+                                       blob_size,
+                                       packed,
+                                       sizeof (packed));
+    ok (n_packed > 0 && n_packed < n_plain,
+        "zstd: blob compressed to %zd with dictionary", n_packed);
+    ok (content_codec_decompress (c,
+                                  CONTENT_CODEC_ZSTD,
+                                  packed,
+                                  n_packed,
+                                  out,
+                                  blob_size) == 0
+        && memcmp (out, blob, blob_size) == 0,
+        "zstd: content_codec_decompress with dictionary works");
+    ok (content_codec_decompress (c,
+                                  CONTENT_CODEC_ZSTD,
+                                  plain,
+                                  n_plain,
+                                  out,
+                                  blob_size) == 0
+        && memcmp (out, blob, blob_size) == 0,
+        "zstd: blob written before the dictionary can still be read");
+
+    if (!(c2 = content_codec_create ("lz4", NULL)))
+        BAIL_OUT ("content_codec_create lz4 failed");
+    errno = 0;
+    ok (content_codec_decompress (c2,
+                                  CONTENT_CODEC_ZSTD,
+                                  packed,
+                                  n_packed,
+                                  out,
+                                  blob_size) < 0
+        && errno == ENOENT,
+        "zstd: decompress without the dictionary fails with ENOENT");
+    ok (content_codec_dict_add (c2,
+                                CONTENT_CODEC_ZSTD,
+                                dict,
+                                dict_size) == dict_id,
+        "zstd: dictionary can be added to a codec that writes lz4");
+    ok (content_codec_decompress (c2,
+                                  CONTENT_CODEC_ZSTD,
+                                  packed,
+                                  n_packed,
+                                  out,
+                                  blob_size) == 0
+        && memcmp (out, blob, blob_size) == 0,
+        "zstd: and then the blob can be read");
+    ok (content_codec_dict_id (c2) == 0,
+        "zstd: but lz4 does not compress with it");
+
+    content_codec_destroy (c2);
+    content_codec_destroy (c);
+    free (dict);
+    free (sizes);
+    free (samples);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_badargs ();
+    test_none ();
+    test_roundtrip ("lz4", CONTENT_CODEC_LZ4);
+    test_lz4_nodict ();
+    if (content_codec_available (CONTENT_CODEC_ZSTD)) {
+        test_roundtrip ("zstd", CONTENT_CODEC_ZSTD);
+        test_zstd_dict ();
+    }
+    else {
+        errno = 0;
+        ok (content_codec_create ("zstd", NULL) == NULL && errno == ENOSYS,
+            "content_codec_create zstd fails with ENOSYS");
+    }
+
+    done_testing ();
+    return (0);
+}
+
+// vi: ts=4 sw=4 expandtab
@@ -114,7 +114,7 @@ void flux_msg_destroy (flux_msg_t *msg)
         if (msg_has_route (msg))
             msg_route_clear (msg);
         free (msg->topic);
-        free (msg->payload);
+        msg_payload_free (msg->payload);
         json_decref (msg->json);
         aux_destroy (&msg->aux);
         free (msg->lasterr);
@@ -836,6 +836,94 @@ char *flux_msg_route_string (const flux_msg_t *msg)
     return buf;
 }
 
+/* A payload buffer is preceded by a header holding its reference count.
+ * Messages may be handed off between threads (e.g. broker to module), so
+ * the count is manipulated atomically.  The union keeps payload data
+ * aligned as malloc() would.
+ */
+union payload_hdr {
+    int refcount;
+    long double align_ld;
+    void *align_ptr;
+};
+
+static inline union payload_hdr *payload_hdr (const void *payload)
+{
+    return (union payload_hdr *)payload - 1;
+}
+
+void *msg_payload_alloc (size_t size)
+{
+    union payload_hdr *hdr;
+
+    if (!(hdr = malloc (sizeof (*hdr) + size)))
+        return NULL;
+    hdr->refcount = 1;
+    return hdr + 1;
+}
+
+void msg_payload_free (void *payload)
+{
+    if (payload) {
+        union payload_hdr *hdr = payload_hdr (payload);
+        if (__atomic_sub_fetch (&hdr->refcount, 1, __ATOMIC_ACQ_REL) == 0)
+            free (hdr);
+    }
+}
+
+static void *payload_incref (void *payload)
+{
+    __atomic_add_fetch (&payload_hdr (payload)->refcount, 1, __ATOMIC_RELAXED);
+    return payload;
+}
+
+static bool payload_is_shared (const void *payload)
+{
+    int count = __atomic_load_n (&payload_hdr (payload)->refcount,
+                                 __ATOMIC_ACQUIRE);
+    return count > 1;
+}
+
+/* Resize an unshared payload buffer, or allocate one if payload is NULL.
+ */
+static void *payload_realloc (void *payload, size_t size)
+{
+    union payload_hdr *hdr;
+
+    if (!payload)
+        return msg_payload_alloc (size);
+    if (!(hdr = realloc (payload_hdr (payload), sizeof (*hdr) + size)))
+        return NULL;
+    return hdr + 1;
+}
+
+/* Give msg a private payload buffer of 'size' bytes that may be modified
+ * in place.  If the current buffer is shared with copies of this message,
+ * leave it to them and start over with a new one, preserving as much of
+ * the old content as fits.
+ */
+static int payload_unshare (flux_msg_t *msg, size_t size)
+{
+    void *ptr;
+
+    if (msg->payload && payload_is_shared (msg->payload)) {
+        if (!(ptr = msg_payload_alloc (size)))
+            goto nomem;
+        memcpy (ptr,
+                msg->payload,
+                size < msg->payload_size ? size : msg->payload_size);
+        msg_payload_free (msg->payload);
+    }
+    else if (!(ptr = payload_realloc (msg->payload, size)))
+        goto nomem;
+    msg->payload = ptr;
+    msg->payload_size = size;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
 static bool payload_overlap (flux_msg_t *msg, const void *b)
 {
     return ((char *)b >= (char *)msg->payload
@@ -860,21 +948,18 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, size_t size)
                 return -1;
             }
         }
-        if (size > msg->payload_size) {
-            void *ptr;
-            if (!(ptr = realloc (msg->payload, size))) {
-                errno = ENOMEM;
+        else if (payload_is_shared (msg->payload))
+            return 0; // setting a shared payload to itself
+        if (payload_is_shared (msg->payload) || size > msg->payload_size) {
+            if (payload_unshare (msg, size) < 0)
                 return -1;
-            }
-            msg->payload = ptr;
-            msg->payload_size = size;
         }
         memcpy (msg->payload, buf, size);
     /* Case #2: add payload.
      */
     } else if (!msg_has_payload (msg) && (buf != NULL && size > 0)) {
         assert (!msg->payload);
-        if (!(msg->payload = malloc (size)))
+        if (!(msg->payload = msg_payload_alloc (size)))
             return -1;
         msg->payload_size = size;
         memcpy (msg->payload, buf, size);
@@ -883,7 +968,7 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, size_t size)
      */
     } else if (msg_has_payload (msg) && (buf == NULL || size == 0)) {
         assert (msg->payload);
-        free (msg->payload);
+        msg_payload_free (msg->payload);
         msg->payload = NULL;
         msg->payload_size = 0;
         msg_clear_flag (msg, FLUX_MSGFLAG_PAYLOAD);
@@ -891,6 +976,23 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, size_t size)
     return 0;
 }
 
+int flux_msg_alloc_payload (flux_msg_t *msg, size_t size, void **buf)
+{
+    if (msg_validate (msg) < 0)
+        return -1;
+    if (size == 0 || !buf) {
+        errno = EINVAL;
+        return -1;
+    }
+    json_decref (msg->json);            /* invalidate cached json object */
+    msg->json = NULL;
+    if (payload_unshare (msg, size) < 0)
+        return -1;
+    msg_set_flag (msg, FLUX_MSGFLAG_PAYLOAD);
+    *buf = msg->payload;
+    return 0;
+}
+
 static inline void msg_lasterr_reset (flux_msg_t *msg)
 {
     if (msg_validate (msg) == 0) {
@@ -1157,9 +1259,7 @@ flux_msg_t *flux_msg_copy (const flux_msg_t *msg, bool payload)
     if (msg->payload) {
         if (payload) {
             cpy->payload_size = msg->payload_size;
-            if (!(cpy->payload = malloc (cpy->payload_size)))
-                goto error;
-            memcpy (cpy->payload, msg->payload, msg->payload_size);
+            cpy->payload = payload_incref (msg->payload);
         }
         else
             msg_clear_flag (cpy, FLUX_MSGFLAG_PAYLOAD);
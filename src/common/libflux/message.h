@@ -172,6 +172,13 @@ int flux_msg_get_payload (const flux_msg_t *msg,
 int flux_msg_set_payload (flux_msg_t *msg, const void *buf, size_t size);
 bool flux_msg_has_payload (const flux_msg_t *msg);
 
+/* Replace any payload with 'size' bytes of uninitialized, msg-owned
+ * storage, and return a pointer to it in 'buf' for the caller to fill in.
+ * This avoids a copy when the payload is produced in place, for example
+ * by decompression.  'size' must be nonzero.
+ */
+int flux_msg_alloc_payload (flux_msg_t *msg, size_t size, void **buf);
+
 /* Test/set/clear message flags
  */
 bool flux_msg_has_flag (const flux_msg_t *msg, int flag);
@@ -27,6 +27,7 @@ struct flux_msg {
     char *topic;
 
     // optional payload frame, if FLUX_MSGFLAG_PAYLOAD
+    // refcounted buffer from msg_payload_alloc(), possibly shared by copies
     void *payload;
     size_t payload_size;
 
@@ -42,6 +43,13 @@ struct flux_msg {
 
 flux_msg_t *msg_create (void);
 
+/* Payload buffers are reference counted so flux_msg_copy() can share
+ * them between messages.  A shared buffer must not be modified in place.
+ * msg_payload_free() drops one reference.
+ */
+void *msg_payload_alloc (size_t size);
+void msg_payload_free (void *payload);
+
 int msg_frames (const flux_msg_t *msg);
 
 #define msgtype_is_valid(tp) \
@@ -24,12 +24,38 @@ struct handler_stack {
     zlistx_t *stack;         // stack of message handlers if >1
 };
 
+/* Prefix trie of event handlers whose topic glob is a literal prefix
+ * followed by a single trailing '*', e.g. "job-state.*", or that match
+ * any topic.  Dispatch walks the event topic once, collecting handlers
+ * from each node on the path.
+ */
+struct topic_trie {
+    char c;
+    struct topic_trie *child;   // first child
+    struct topic_trie *sibling; // next sibling
+    zlistx_t *handlers;         // handlers whose prefix ends here
+};
+
+/* Event handlers matched for the message being dispatched.  Frames are
+ * chained on the dispatch so that flux_msg_handler_destroy() called from
+ * a handler can drop a handler that has not been called yet.
+ */
+struct dispatch_frame {
+    flux_msg_handler_t **mh;
+    int count;
+    struct dispatch_frame *prev;
+};
+
 struct dispatch {
     flux_t *h;
     zlist_t *handlers;
     zlist_t *handlers_new;
     zhashx_t *handlers_rpc; // matchtag => response handler
     zhashx_t *handlers_method; // topic => request handler (non-glob only)
+    zhashx_t *handlers_event; // topic => list of event handlers (non-glob)
+    struct topic_trie *handlers_event_prefix; // prefix => event handlers
+    struct dispatch_frame *frames;
+    uint64_t seq;
     flux_watcher_t *w;
     int running_count;
     int usecount;
@@ -44,6 +70,7 @@ struct flux_msg_handler {
     uint32_t rolemask;
     flux_msg_handler_f fn;
     void *arg;
+    uint64_t seq;           // creation order, for ordering event handlers
     uint8_t running:1;
 };
 
@@ -179,6 +206,168 @@ static bool isa_multmatch (const char *s)
     return false;
 }
 
+/* Return the length of the literal prefix if event topic glob 's' matches
+ * every topic with that prefix, i.e. 's' is NULL, "", "*", or a string
+ * with a single trailing '*' and no other glob or escape characters.
+ * Otherwise return -1.
+ */
+static int prefix_glob_len (const char *s)
+{
+    size_t len;
+
+    if (!s || (len = strlen (s)) == 0)
+        return 0;
+    if (s[len - 1] != '*' || strcspn (s, "*?[\\") != len - 1)
+        return -1;
+    return len - 1;
+}
+
+enum {
+    EVENT_INDEX_NONE,
+    EVENT_INDEX_EXACT,
+    EVENT_INDEX_PREFIX,
+};
+
+/* Event-only handlers with a literal topic or a prefix glob are indexed.
+ * Handlers for other message types, and true globs, are kept on the
+ * handlers list and matched linearly.
+ */
+static int event_index_type (flux_msg_handler_t *mh)
+{
+    if (mh->match.typemask != FLUX_MSGTYPE_EVENT
+        || mh->match.matchtag != FLUX_MATCHTAG_NONE)
+        return EVENT_INDEX_NONE;
+    if (!isa_multmatch (mh->match.topic_glob))
+        return EVENT_INDEX_EXACT;
+    if (prefix_glob_len (mh->match.topic_glob) >= 0)
+        return EVENT_INDEX_PREFIX;
+    return EVENT_INDEX_NONE;
+}
+
+static zlistx_t *handler_list_add (zlistx_t **lp, flux_msg_handler_t *mh)
+{
+    if (!*lp && !(*lp = zlistx_new ()))
+        goto nomem;
+    if (!zlistx_add_end (*lp, mh))
+        goto nomem;
+    return *lp;
+nomem:
+    errno = ENOMEM;
+    return NULL;
+}
+
+static void handler_list_remove (zlistx_t *l, flux_msg_handler_t *mh)
+{
+    void *handle;
+
+    if (l && (handle = zlistx_find (l, mh)))
+        zlistx_delete (l, handle);
+}
+
+static void topic_trie_destroy (struct topic_trie *t)
+{
+    while (t) {
+        struct topic_trie *next = t->sibling;
+        topic_trie_destroy (t->child);
+        zlistx_destroy (&t->handlers);
+        free (t);
+        t = next;
+    }
+}
+
+static struct topic_trie *topic_trie_child (struct topic_trie *t,
+                                            char c,
+                                            bool create)
+{
+    struct topic_trie *child;
+
+    for (child = t->child; child != NULL; child = child->sibling) {
+        if (child->c == c)
+            return child;
+    }
+    if (!create)
+        return NULL;
+    if (!(child = calloc (1, sizeof (*child))))
+        return NULL;
+    child->c = c;
+    child->sibling = t->child;
+    t->child = child;
+    return child;
+}
+
+static int topic_trie_add (struct topic_trie *t, flux_msg_handler_t *mh)
+{
+    const char *s = mh->match.topic_glob;
+    int len = prefix_glob_len (s);
+
+    for (int i = 0; i < len; i++) {
+        if (!(t = topic_trie_child (t, s[i], true)))
+            return -1;
+    }
+    if (!handler_list_add (&t->handlers, mh))
+        return -1;
+    return 0;
+}
+
+/* Remove 'mh' from the node for 'prefix' of length 'len', then prune
+ * nodes left without handlers or children on the way back up.
+ * Return true if node 't' is now empty and may be freed by the caller.
+ */
+static bool topic_trie_remove (struct topic_trie *t,
+                               const char *prefix,
+                               int len,
+                               flux_msg_handler_t *mh)
+{
+    if (len == 0)
+        handler_list_remove (t->handlers, mh);
+    else {
+        struct topic_trie **cp;
+
+        for (cp = &t->child; *cp != NULL; cp = &(*cp)->sibling) {
+            if ((*cp)->c == prefix[0])
+                break;
+        }
+        if (*cp && topic_trie_remove (*cp, prefix + 1, len - 1, mh)) {
+            struct topic_trie *empty = *cp;
+            *cp = empty->sibling;
+            zlistx_destroy (&empty->handlers);
+            free (empty);
+        }
+    }
+    return (!t->child && (!t->handlers || zlistx_size (t->handlers) == 0));
+}
+
+static int event_index_add (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    if (event_index_type (mh) == EVENT_INDEX_EXACT) {
+        zlistx_t *l = zhashx_lookup (d->handlers_event, mh->match.topic_glob);
+        if (!handler_list_add (&l, mh))
+            return -1;
+        (void)zhashx_insert (d->handlers_event, mh->match.topic_glob, l);
+        return 0;
+    }
+    return topic_trie_add (d->handlers_event_prefix, mh);
+}
+
+static void event_index_remove (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    if (event_index_type (mh) == EVENT_INDEX_EXACT) {
+        const char *topic = mh->match.topic_glob;
+        zlistx_t *l = zhashx_lookup (d->handlers_event, topic);
+
+        handler_list_remove (l, mh);
+        if (l && zlistx_size (l) == 0)
+            zhashx_delete (d->handlers_event, topic);
+    }
+    else {
+        const char *s = mh->match.topic_glob;
+        (void)topic_trie_remove (d->handlers_event_prefix,
+                                 s,
+                                 prefix_glob_len (s),
+                                 mh);
+    }
+}
+
 static void dispatch_requeue (struct dispatch *d)
 {
     if (d->unmatched) {
@@ -210,6 +399,8 @@ static void dispatch_usecount_decr (struct dispatch *d)
         flux_watcher_destroy (d->w);
         zhashx_destroy (&d->handlers_rpc);
         zhashx_destroy (&d->handlers_method);
+        zhashx_destroy (&d->handlers_event);
+        topic_trie_destroy (d->handlers_event_prefix);
         free (d);
         errno = saved_errno;
     }
@@ -265,6 +456,13 @@ static struct dispatch *dispatch_get (flux_t *h)
 
         if (!(d->handlers_method = method_hash_create ()))
             goto nomem;
+        if (!(d->handlers_event = zhashx_new ()))
+            goto nomem;
+        zhashx_set_destructor (d->handlers_event,
+                               (zhashx_destructor_fn *)zlistx_destroy);
+        d->handlers_event_prefix = calloc (1, sizeof (struct topic_trie));
+        if (!d->handlers_event_prefix)
+            goto nomem;
         if (flux_aux_set (h, "flux::dispatch", d, dispatch_destroy) < 0)
             goto error;
     }
@@ -333,12 +531,129 @@ static void call_handler (flux_msg_handler_t *mh, const flux_msg_t *msg)
     mh->fn (mh->d->h, mh, msg, mh->arg);
 }
 
+/* Collect event handlers for 'topic' from list 'l' into 'mh', or if 'mh'
+ * is NULL, just count them.  Return the number of handlers.
+ */
+static int collect_list (zlistx_t *l, flux_msg_handler_t **mh)
+{
+    int count = 0;
+
+    if (l) {
+        flux_msg_handler_t *item = zlistx_first (l);
+        while (item) {
+            if (mh)
+                mh[count] = item;
+            count++;
+            item = zlistx_next (l);
+        }
+    }
+    return count;
+}
+
+/* Collect (or count) handlers on the trie path spelled by 'topic'.
+ */
+static int collect_trie (struct topic_trie *t,
+                         const char *topic,
+                         flux_msg_handler_t **mh)
+{
+    int count = 0;
+
+    while (t) {
+        count += collect_list (t->handlers, mh ? mh + count : NULL);
+        if (*topic == '\0')
+            break;
+        t = topic_trie_child (t, *topic++, false);
+    }
+    return count;
+}
+
+/* Collect (or count) handlers on the handlers list that match 'msg'.
+ */
+static int collect_handlers (struct dispatch *d,
+                             const flux_msg_t *msg,
+                             flux_msg_handler_t **mh)
+{
+    flux_msg_handler_t *item;
+    int count = 0;
+
+    FOREACH_ZLIST (d->handlers, item) {
+        if (item->running && flux_msg_cmp (msg, item->match)) {
+            if (mh)
+                mh[count] = item;
+            count++;
+        }
+    }
+    return count;
+}
+
+static int seq_cmp (const void *a, const void *b)
+{
+    const flux_msg_handler_t *mh1 = *(const flux_msg_handler_t **)a;
+    const flux_msg_handler_t *mh2 = *(const flux_msg_handler_t **)b;
+
+    if (mh1->seq < mh2->seq)
+        return 1;
+    if (mh1->seq > mh2->seq)
+        return -1;
+    return 0;
+}
+
+/* Call all handlers matching event 'msg': indexed handlers for its exact
+ * topic and for each prefix of it, plus matches on the handlers list.
+ * Handlers are called most recently registered first, as if all of them
+ * were on the handlers list.
+ */
+static void dispatch_event (struct dispatch *d, const flux_msg_t *msg)
+{
+    flux_msg_handler_t *buf[32];
+    struct dispatch_frame frame = { .mh = buf, .prev = d->frames };
+    zlistx_t *exact = NULL;
+    const char *topic;
+    int count = 0;
+
+    /* An event without a topic still matches the handlers at the trie
+     * root, which match any topic.  Walk an empty topic to collect them.
+     */
+    if (flux_msg_get_topic (msg, &topic) < 0)
+        topic = NULL;
+    if (topic)
+        exact = zhashx_lookup (d->handlers_event, topic);
+    count += collect_list (exact, NULL);
+    count += collect_trie (d->handlers_event_prefix, topic ? topic : "", NULL);
+    count += collect_handlers (d, msg, NULL);
+    if (count == 0)
+        return;
+    if (count > (int)(sizeof (buf) / sizeof (buf[0]))
+        && !(frame.mh = malloc (count * sizeof (frame.mh[0])))) {
+        flux_log_error (d->h, "%s: out of memory", __FUNCTION__);
+        return;
+    }
+    frame.count = collect_list (exact, frame.mh);
+    frame.count += collect_trie (d->handlers_event_prefix,
+                                 topic ? topic : "",
+                                 frame.mh + frame.count);
+    frame.count += collect_handlers (d, msg, frame.mh + frame.count);
+    if (frame.count > 1)
+        qsort (frame.mh, frame.count, sizeof (frame.mh[0]), seq_cmp);
+
+    d->frames = &frame;
+    for (int i = 0; i < frame.count; i++) {
+        flux_msg_handler_t *mh = frame.mh[i];
+        if (mh && mh->running)
+            call_handler (mh, msg);
+    }
+    d->frames = frame.prev;
+    if (frame.mh != buf)
+        free (frame.mh);
+}
+
 /* Messages are matched in the following order:
  * 1) RPC responses - lookup in handlers_rpc hash by matchtag.
  * 2) RPC requests - lookup in handlers_method hash by topic string
  * 3) Requests and responses not matched above - sent to first match in
  *    list of handlers, where most recently registered handlers match first.
- * 4) Events - sent to all matches in list of handlers
+ * 4) Events - sent to all matches in handlers_event hash by topic string,
+ *    handlers_event_prefix trie, and list of handlers.
  */
 static bool dispatch_message (struct dispatch *d,
                               const flux_msg_t *msg,
@@ -370,6 +685,11 @@ static bool dispatch_message (struct dispatch *d,
             match = true;
         }
     }
+    /* event */
+    else if (type == FLUX_MSGTYPE_EVENT) {
+        dispatch_event (d, msg);
+        return false;
+    }
     /* other */
     if (!match) {
         FOREACH_ZLIST (d->handlers, mh) {
@@ -570,6 +890,7 @@ void flux_msg_handler_destroy (flux_msg_handler_t *mh)
 {
     if (mh) {
         int saved_errno = errno;
+        struct dispatch_frame *frame;
         assert (mh->magic == HANDLER_MAGIC);
         if (mh->match.typemask == FLUX_MSGTYPE_RESPONSE
             && mh->match.matchtag != FLUX_MATCHTAG_NONE) {
@@ -579,10 +900,20 @@ void flux_msg_handler_destroy (flux_msg_handler_t *mh)
                  && !isa_multmatch (mh->match.topic_glob)) {
             method_hash_remove (mh->d->handlers_method, mh);
         }
+        else if (event_index_type (mh) != EVENT_INDEX_NONE)
+            event_index_remove (mh->d, mh);
         else {
             zlist_remove (mh->d->handlers_new, mh);
             zlist_remove (mh->d->handlers, mh);
         }
+        /* Don't call this handler if an event being dispatched matched it.
+         */
+        for (frame = mh->d->frames; frame != NULL; frame = frame->prev) {
+            for (int i = 0; i < frame->count; i++) {
+                if (frame->mh[i] == mh)
+                    frame->mh[i] = NULL;
+            }
+        }
         flux_msg_handler_stop (mh);
         dispatch_usecount_decr (mh->d);
         free_msg_handler (mh);
@@ -613,6 +944,7 @@ flux_msg_handler_t *flux_msg_handler_create (flux_t *h,
     mh->fn = cb;
     mh->arg = arg;
     mh->d = d;
+    mh->seq = ++d->seq;
     /* Response (valid matchtag):
      * Fail if entry in the handlers_rpc hash exists, since that probably
      * indicates a matchtag reuse problem!
@@ -633,7 +965,14 @@ flux_msg_handler_t *flux_msg_handler_create (flux_t *h,
         if (method_hash_add (d->handlers_method, mh) < 0)
             goto error;
     }
-    /* Request (glob), response (FLUX_MATCHTAG_NONE), events:
+    /* Event (non-glob or prefix glob):
+     * Add entry to the handlers_event hash or handlers_event_prefix trie.
+     */
+    else if (event_index_type (mh) != EVENT_INDEX_NONE) {
+        if (event_index_add (d, mh) < 0)
+            goto error;
+    }
+    /* Request (glob), response (FLUX_MATCHTAG_NONE), events (glob):
      * Message handler is pushed to the front of the handlers list,
      * and matches before older ones for requests and responses.
      * (Requests and responses in hashes above match first though).
@@ -15,6 +15,7 @@
 #include <flux/core.h>
 
 #include "src/common/libutil/xzmalloc.h"
+#include "ccan/str/str.h"
 #include "src/common/libtap/tap.h"
 
 int cb2_called;
@@ -80,6 +81,112 @@ void test_simple_msg_handler (flux_t *h)
     diag ("destroyed message and message handler");
 }
 
+/* Event handlers are indexed by exact topic or literal prefix, but must
+ * still be called newest first, as if all were on one list, and must not
+ * be called if destroyed by an earlier handler for the same event.
+ */
+char event_order[64];
+flux_msg_handler_t *event_victim;
+void order_cb (flux_t *h,
+               flux_msg_handler_t *mh,
+               const flux_msg_t *msg,
+               void *arg)
+{
+    const char *name = arg;
+    strcat (event_order, name);
+    if (streq (name, "K") && event_victim) {
+        flux_msg_handler_destroy (event_victim);
+        event_victim = NULL;
+    }
+}
+
+static void send_event (flux_t *h, const char *topic)
+{
+    flux_msg_t *msg;
+
+    event_order[0] = '\0';
+    if (topic)
+        msg = flux_event_encode (topic, NULL);
+    else
+        msg = flux_msg_create (FLUX_MSGTYPE_EVENT);
+    if (!msg || flux_send (h, msg, 0) < 0)
+        BAIL_OUT ("could not send %s event", topic ? topic : "topicless");
+    flux_msg_destroy (msg);
+    if (flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) < 0)
+        BAIL_OUT ("flux_reactor_run failed");
+}
+
+void test_event_order (flux_t *h)
+{
+    struct {
+        const char *topic;
+        const char *name;
+    } tab[] = {
+        { "a.b.c", "A" },   // exact
+        { "a.*", "B" },     // prefix
+        { NULL, "C" },      // any
+        { "a.?.c", "D" },   // glob
+        { "a.b.c", "E" },   // exact, same topic
+        { "a.b.*", "F" },   // prefix, not started
+        { "*", "G" },       // any
+        { "a.b.c*", "H" },  // prefix, equal to topic
+        { "b.*", "I" },     // prefix, no match
+    };
+    flux_msg_handler_t *mh[9];
+    flux_msg_handler_t *k;
+    struct flux_match match = FLUX_MATCH_EVENT;
+
+    for (int i = 0; i < 9; i++) {
+        match.topic_glob = (char *)tab[i].topic;
+        if (!(mh[i] = flux_msg_handler_create (h,
+                                               match,
+                                               order_cb,
+                                               (char *)tab[i].name)))
+            BAIL_OUT ("flux_msg_handler_create failed");
+        if (!streq (tab[i].name, "F"))
+            flux_msg_handler_start (mh[i]);
+    }
+    send_event (h, "a.b.c");
+    ok (streq (event_order, "HGEDCBA"),
+        "event handlers were called newest first (%s)", event_order);
+    send_event (h, "a.x");
+    ok (streq (event_order, "GCB"),
+        "prefix and match-any handlers were called for another topic (%s)",
+        event_order);
+    send_event (h, "a");
+    ok (streq (event_order, "GC"),
+        "prefix handler was not called for topic shorter than prefix (%s)",
+        event_order);
+    send_event (h, NULL);
+    ok (streq (event_order, "GC"),
+        "only match-any handlers were called for event without topic (%s)",
+        event_order);
+
+    flux_msg_handler_start (mh[5]);
+    flux_msg_handler_stop (mh[6]);
+    send_event (h, "a.b.c");
+    ok (streq (event_order, "HFEDCBA"),
+        "started and stopped handlers were honored (%s)", event_order);
+
+    match.topic_glob = "a.b.c";
+    if (!(k = flux_msg_handler_create (h, match, order_cb, "K")))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (k);
+    event_victim = mh[4];
+    send_event (h, "a.b.c");
+    ok (streq (event_order, "KHFDCBA"),
+        "handler destroyed by earlier handler for event was not called (%s)",
+        event_order);
+    mh[4] = NULL;
+
+    flux_msg_handler_destroy (k);
+    for (int i = 0; i < 9; i++)
+        flux_msg_handler_destroy (mh[i]);
+    send_event (h, "a.b.c");
+    ok (streq (event_order, ""),
+        "no handlers were called after they were destroyed");
+}
+
 /* Check fastpath response matching
  */
 void test_fastpath (flux_t *h)
@@ -535,6 +642,7 @@ int main (int argc, char *argv[])
     test_request_catchall (h);
     test_response_catchall (h);
     test_response_with_routes (h);
+    test_event_order (h);
 
     flux_close (h);
     done_testing();
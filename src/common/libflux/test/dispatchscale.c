@@ -0,0 +1,216 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* dispatchscale.c - dispatch a batch of events to many event handlers */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <flux/core.h>
+#include <flux/optparse.h>
+
+#include "src/common/libutil/monotime.h"
+
+#include "tap.h"
+
+static int event_count;
+static int call_count;
+
+void event_cb (flux_t *h,
+               flux_msg_handler_t *mh,
+               const flux_msg_t *msg,
+               void *arg)
+{
+    int *calls = arg;
+
+    (*calls)++;
+    call_count++;
+}
+
+/* Sentinel event handler stops the reactor once all events are in.
+ */
+void done_cb (flux_t *h,
+              flux_msg_handler_t *mh,
+              const flux_msg_t *msg,
+              void *arg)
+{
+    flux_reactor_stop (flux_get_reactor (h));
+}
+
+static flux_msg_handler_t *handler_create (flux_t *h,
+                                           const char *fmt,
+                                           int i,
+                                           flux_msg_handler_f cb,
+                                           void *arg)
+{
+    struct flux_match match = FLUX_MATCH_EVENT;
+    flux_msg_handler_t *mh;
+    char topic[64];
+
+    snprintf (topic, sizeof (topic), fmt, i);
+    match.topic_glob = topic;
+    if (!(mh = flux_msg_handler_create (h, match, cb, arg)))
+        BAIL_OUT ("flux_msg_handler_create %s failed", topic);
+    flux_msg_handler_start (mh);
+    return mh;
+}
+
+static int send_event (flux_t *h, const char *fmt, int i)
+{
+    flux_msg_t *msg;
+    char topic[64];
+    int rc;
+
+    snprintf (topic, sizeof (topic), fmt, i);
+    if (!(msg = flux_event_encode (topic, NULL)))
+        return -1;
+    rc = flux_send (h, msg, 0);
+    flux_msg_destroy (msg);
+    return rc;
+}
+
+static struct optparse_option opts[] = {
+    { .name = "count", .key = 'c', .has_arg = 1, .arginfo = "N",
+      .usage = "Set event count per iteration (default 10000)",
+    },
+    { .name = "iter", .key = 'I', .has_arg = 1, .arginfo = "N",
+      .usage = "Set number of iterations (default 2)",
+    },
+    { .name = "handlers", .key = 'H', .has_arg = 1, .arginfo = "N",
+      .usage = "Set number of exact topic handlers (default 1000)",
+    },
+    { .name = "prefixes", .key = 'P', .has_arg = 1, .arginfo = "N",
+      .usage = "Set number of prefix glob handlers (default 100)",
+    },
+    { .name = "globs", .key = 'g', .has_arg = 1, .arginfo = "N",
+      .usage = "Set number of other glob handlers (default 10)",
+    },
+    OPTPARSE_TABLE_END
+};
+
+int main (int argc, char *argv[])
+{
+    optparse_t *p;
+    flux_t *h;
+    int test_size;
+    int test_iterations;
+    int nhandlers;
+    int nprefixes;
+    int nglobs;
+    int nmh;
+    flux_msg_handler_t **mh;
+    int *calls;
+
+    plan (NO_PLAN);
+
+    if (!(p = optparse_create ("dispatchscale")))
+        BAIL_OUT ("optparse_create");
+    if (optparse_add_option_table (p, opts) != OPTPARSE_SUCCESS)
+        BAIL_OUT ("optparse_add_option_table() failed");
+    if (optparse_parse_args (p, argc, argv) < argc)
+        BAIL_OUT ("Type dispatchscale -h for options.");
+    test_size = optparse_get_int (p, "count", 10000);
+    test_iterations = optparse_get_int (p, "iter", 2);
+    nhandlers = optparse_get_int (p, "handlers", 1000);
+    nprefixes = optparse_get_int (p, "prefixes", 100);
+    nglobs = optparse_get_int (p, "globs", 10);
+    if (nhandlers < 1 || nprefixes > nhandlers || nglobs > nhandlers)
+        BAIL_OUT ("need handlers >= 1, prefixes and globs <= handlers");
+
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("can't continue without loop handle");
+
+    /* Handler i matches event i exactly.  Prefix handler i and glob
+     * handler i also match event i, if i is in range.
+     */
+    nmh = nhandlers + nprefixes + nglobs + 1;
+    if (!(mh = calloc (nmh, sizeof (mh[0])))
+        || !(calls = calloc (nhandlers, sizeof (calls[0]))))
+        BAIL_OUT ("out of memory");
+    for (int i = 0; i < nhandlers; i++)
+        mh[i] = handler_create (h, "bench.%d.event", i, event_cb, &calls[i]);
+    for (int i = 0; i < nprefixes; i++)
+        mh[nhandlers + i] = handler_create (h,
+                                           "bench.%d.*",
+                                           i,
+                                           event_cb,
+                                           &calls[i]);
+    for (int i = 0; i < nglobs; i++)
+        mh[nhandlers + nprefixes + i] = handler_create (h,
+                                                        "bench.%d.ev?nt",
+                                                        i,
+                                                        event_cb,
+                                                        &calls[i]);
+    mh[nmh - 1] = handler_create (h, "bench.done", 0, done_cb, NULL);
+    diag ("registered %d exact, %d prefix, %d glob event handlers",
+          nhandlers,
+          nprefixes,
+          nglobs);
+
+    for (int iter = 1; iter <= test_iterations; iter++) {
+        int errors = 0;
+        int expected = 0;
+        int mismatch = 0;
+        struct timespec t0;
+        double t;
+        int rc;
+
+        diag ("Iteration %d of %d", iter, test_iterations);
+
+        memset (calls, 0, nhandlers * sizeof (calls[0]));
+        call_count = 0;
+        event_count = 0;
+        for (int i = 0; i < test_size; i++) {
+            int n = i % nhandlers;
+            if (send_event (h, "bench.%d.event", n) < 0)
+                errors++;
+            else
+                event_count++;
+        }
+        if (send_event (h, "bench.done", 0) < 0)
+            errors++;
+        ok (errors == 0,
+            "sent batch of events with no errors");
+
+        monotime (&t0);
+        rc = flux_reactor_run (flux_get_reactor (h), 0);
+        t = monotime_since (t0) / 1000;
+        diag ("dispatched %d events to %d handlers in %.3fs (%.1f Kmsg/s)",
+              event_count,
+              call_count,
+              t,
+              1E-3 * event_count / t);
+        ok (rc >= 0,
+            "processed events with no errors");
+
+        for (int n = 0; n < nhandlers; n++) {
+            int events = test_size / nhandlers
+                         + (n < test_size % nhandlers ? 1 : 0);
+            int want = events * (1 + (n < nprefixes) + (n < nglobs));
+            if (calls[n] != want)
+                mismatch++;
+            expected += want;
+        }
+        ok (mismatch == 0 && call_count == expected,
+            "each handler was called once per matching event");
+    }
+
+    for (int i = 0; i < nmh; i++)
+        flux_msg_handler_destroy (mh[i]);
+    free (mh);
+    free (calls);
+    flux_close (h);
+    optparse_destroy (p);
+
+    done_testing();
+    return (0);
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -714,6 +714,54 @@ void check_payload (void)
     flux_msg_destroy (msg);
 }
 
+/* flux_msg_alloc_payload
+ */
+void check_payload_alloc (void)
+{
+    flux_msg_t *msg;
+    const void *buf;
+    void *p;
+    size_t len;
+    json_t *o;
+    int i;
+
+    errno = 0;
+    ok (flux_msg_alloc_payload (NULL, 1, &p) < 0 && errno == EINVAL,
+        "flux_msg_alloc_payload msg=NULL fails with EINVAL");
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_RESPONSE)))
+        BAIL_OUT ("flux_msg_create failed");
+    errno = 0;
+    ok (flux_msg_alloc_payload (msg, 0, &p) < 0 && errno == EINVAL,
+        "flux_msg_alloc_payload size=0 fails with EINVAL");
+    errno = 0;
+    ok (flux_msg_alloc_payload (msg, 1, NULL) < 0 && errno == EINVAL,
+        "flux_msg_alloc_payload buf=NULL fails with EINVAL");
+
+    p = NULL;
+    ok (flux_msg_alloc_payload (msg, 4, &p) == 0 && p != NULL,
+        "flux_msg_alloc_payload works on message without payload");
+    ok (flux_msg_has_payload (msg),
+        "message now has payload");
+    memcpy (p, "abc", 4);
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0
+        && buf == p
+        && len == 4
+        && streq (buf, "abc"),
+        "flux_msg_get_payload returns the allocated buffer");
+
+    ok (flux_msg_pack (msg, "{s:i}", "a", 42) == 0
+        && flux_msg_unpack (msg, "o", &o) == 0,
+        "set and decode a json payload");
+    ok (flux_msg_alloc_payload (msg, 8, &p) == 0,
+        "flux_msg_alloc_payload works on message with payload");
+    memcpy (p, "{\"a\":7}", 8);
+    i = 0;
+    ok (flux_msg_unpack (msg, "{s:i}", "a", &i) == 0 && i == 7,
+        "cached json object was invalidated");
+
+    flux_msg_destroy (msg);
+}
+
 /* flux_msg_set_type, flux_msg_get_type
  * flux_msg_set_nodeid, flux_msg_get_nodeid
  * flux_msg_set_errnum, flux_msg_get_errnum
@@ -1064,6 +1112,81 @@ void check_copy (void)
     flux_msg_destroy (msg);
 }
 
+/* Copies share the payload buffer until one of them modifies it.
+ */
+void check_copy_shared (void)
+{
+    flux_msg_t *msg, *cpy, *cpy2;
+    const void *buf, *cpybuf, *cpy2buf;
+    size_t len;
+    void *p;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_topic (msg, "foo") < 0
+        || flux_msg_set_string (msg, "hello") < 0)
+        BAIL_OUT ("could not create test message");
+    if (!(cpy = flux_msg_copy (msg, true))
+        || !(cpy2 = flux_msg_copy (msg, true)))
+        BAIL_OUT ("flux_msg_copy failed");
+    ok (flux_msg_get_payload (msg, &buf, NULL) == 0
+        && flux_msg_get_payload (cpy, &cpybuf, NULL) == 0
+        && flux_msg_get_payload (cpy2, &cpy2buf, NULL) == 0
+        && buf == cpybuf
+        && buf == cpy2buf,
+        "copies share the original payload buffer");
+
+    ok (flux_msg_set_string (cpy, "world") == 0,
+        "flux_msg_set_string works on copy");
+    ok (flux_msg_get_payload (cpy, &cpybuf, &len) == 0
+        && cpybuf != buf
+        && len == 6
+        && streq (cpybuf, "world"),
+        "copy now has its own payload buffer");
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0
+        && len == 6
+        && streq (buf, "hello")
+        && flux_msg_get_payload (cpy2, &cpy2buf, NULL) == 0
+        && cpy2buf == buf,
+        "original payload is unchanged and still shared with other copy");
+
+    ok (flux_msg_set_payload (msg, buf, len) == 0
+        && flux_msg_get_payload (msg, &buf, NULL) == 0
+        && buf == cpy2buf,
+        "setting shared payload to itself does not unshare it");
+
+    ok (flux_msg_alloc_payload (cpy2, 3, &p) == 0 && p != cpy2buf,
+        "flux_msg_alloc_payload on shared payload returns a new buffer");
+    ok (memcmp (p, "hel", 3) == 0,
+        "new buffer retains the leading payload content");
+    memcpy (p, "ab", 3);
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0
+        && len == 6
+        && streq (buf, "hello"),
+        "original payload is unchanged");
+
+    flux_msg_destroy (msg);
+    ok (flux_msg_get_payload (cpy2, &cpy2buf, &len) == 0
+        && len == 3
+        && streq (cpy2buf, "ab"),
+        "copy payload is valid after original is destroyed");
+    flux_msg_destroy (cpy2);
+    ok (flux_msg_set_payload (cpy, NULL, 0) == 0
+        && !flux_msg_has_payload (cpy),
+        "payload can be removed from copy");
+    flux_msg_destroy (cpy);
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_string (msg, "hello") < 0
+        || !(cpy = flux_msg_copy (msg, true)))
+        BAIL_OUT ("could not create test message copy");
+    flux_msg_destroy (msg);
+    ok (flux_msg_set_string (cpy, "hi") == 0
+        && flux_msg_get_payload (cpy, &cpybuf, NULL) == 0
+        && streq (cpybuf, "hi"),
+        "payload of sole remaining copy can be modified");
+    flux_msg_destroy (cpy);
+}
+
 void check_print (void)
 {
     flux_msg_t *msg;
@@ -1399,12 +1522,14 @@ int main (int argc, char *argv[])
     check_routes ();
     check_topic ();
     check_payload ();
+    check_payload_alloc ();
     check_payload_json ();
     check_payload_json_formatted ();
     check_matchtag ();
     check_security ();
     check_aux ();
     check_copy ();
+    check_copy_shared ();
     check_flags ();
 
     check_cmp ();
@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <assert.h>
 #include <errno.h>
 #include <ctype.h>
@@ -44,6 +45,9 @@
 /* max size of internal hostrange buffer */
 #define MAXHOSTRANGELEN 1024
 
+/* min number of ranges before hostlist_find() uses a prefix index */
+#define HOSTLIST_INDEX_MIN 16
+
 /* Helper structure for hostlist iteration
  */
 struct current {
@@ -61,6 +65,23 @@ struct hostlist {
     struct hostrange **hr;  /* pointer to hostrange array */
 
     struct current current; /* iterator cursor */
+
+    /* prefix index for hostlist_find(), built on demand */
+    struct index_entry *index; /* ranges sorted by prefix stem, then position */
+    int *offsets;           /* position of the first host of each range */
+    int index_size;         /* allocated size of index and offsets arrays */
+    int index_count;        /* number of ranges in index */
+    int lookups;            /* finds since the index was last invalidated */
+};
+
+/* Index entry for a hostrange.  The key is the hostrange prefix with any
+ * trailing digits removed, so that e.g. host "foo01" and the range
+ * "foo0[1-9]" share a key.  The key points into the hostrange prefix.
+ */
+struct index_entry {
+    const char *key;
+    int keylen;
+    int index;
 };
 
 /* _range struct helper for parsing hostlist strings
@@ -133,6 +154,142 @@ fail:
     return NULL;
 }
 
+/* Return the length of 's' without any trailing digits.
+ */
+static int stem_len (const char *s, int len)
+{
+    while (len > 0 && isdigit ((unsigned char) s[len - 1]))
+        len--;
+    return len;
+}
+
+static int key_cmp (const char *k1, int len1, const char *k2, int len2)
+{
+    int rc = memcmp (k1, k2, MIN (len1, len2));
+    if (rc == 0)
+        rc = len1 - len2;
+    return rc;
+}
+
+static int index_entry_cmp (const void *a, const void *b)
+{
+    const struct index_entry *e1 = a;
+    const struct index_entry *e2 = b;
+    int rc = key_cmp (e1->key, e1->keylen, e2->key, e2->keylen);
+    if (rc == 0)
+        rc = e1->index - e2->index;
+    return rc;
+}
+
+static void index_entry_init (struct index_entry *e,
+                              struct hostlist *hl,
+                              int i)
+{
+    struct hostrange *hr = hl->hr[i];
+    e->key = hr->prefix;
+    e->keylen = stem_len (hr->prefix, hr->len_prefix);
+    e->index = i;
+}
+
+/* Return the position of the first index entry with key >= 'key',
+ * or with key > 'key' if 'upper' is true.
+ */
+static int index_search (struct hostlist *hl,
+                         const char *key,
+                         int keylen,
+                         bool upper)
+{
+    int lo = 0;
+    int hi = hl->index_count;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        struct index_entry *e = &hl->index[mid];
+        int rc = key_cmp (e->key, e->keylen, key, keylen);
+        if (rc < 0 || (upper && rc == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Drop the prefix index.  Must be called whenever ranges are inserted,
+ * removed, reordered, or have their lo value changed.
+ */
+static void hostlist_index_invalidate (struct hostlist *hl)
+{
+    free (hl->index);
+    free (hl->offsets);
+    hl->index = NULL;
+    hl->offsets = NULL;
+    hl->index_size = 0;
+    hl->index_count = 0;
+    hl->lookups = 0;
+}
+
+static int hostlist_index_reserve (struct hostlist *hl, int size)
+{
+    struct index_entry *index;
+    int *offsets;
+
+    if (size <= hl->index_size)
+        return 0;
+    size = MAX (size, hl->index_size * 2);
+    if (!(index = realloc (hl->index, size * sizeof (*index))))
+        return -1;
+    hl->index = index;
+    if (!(offsets = realloc (hl->offsets, size * sizeof (*offsets))))
+        return -1;
+    hl->offsets = offsets;
+    hl->index_size = size;
+    return 0;
+}
+
+static int hostlist_index_build (struct hostlist *hl)
+{
+    int offset = 0;
+
+    if (hostlist_index_reserve (hl, hl->nranges) < 0) {
+        hostlist_index_invalidate (hl);
+        return -1;
+    }
+    for (int i = 0; i < hl->nranges; i++) {
+        index_entry_init (&hl->index[i], hl, i);
+        hl->offsets[i] = offset;
+        offset += hostrange_count (hl->hr[i]);
+    }
+    qsort (hl->index, hl->nranges, sizeof (hl->index[0]), index_entry_cmp);
+    hl->index_count = hl->nranges;
+    return 0;
+}
+
+/* Add the last range in hl, whose first host is at position 'offset',
+ * to the prefix index if there is one.  Appending is the common way
+ * to grow a hostlist, so the index is updated here instead of being
+ * invalidated.
+ */
+static void hostlist_index_append (struct hostlist *hl, int offset)
+{
+    struct index_entry e;
+    int pos;
+
+    if (!hl->index)
+        return;
+    if (hostlist_index_reserve (hl, hl->nranges) < 0) {
+        hostlist_index_invalidate (hl);
+        return;
+    }
+    index_entry_init (&e, hl, hl->nranges - 1);
+    pos = index_search (hl, e.key, e.keylen, true);
+    memmove (&hl->index[pos + 1],
+             &hl->index[pos],
+             (hl->index_count - pos) * sizeof (e));
+    hl->index[pos] = e;
+    hl->offsets[e.index] = offset;
+    hl->index_count++;
+}
+
 
 /* Resize the internal array used to store the list of hostrange objects.
  *
@@ -193,6 +350,7 @@ static int hostlist_append_range (struct hostlist *hl, struct hostrange * hr)
     } else {
         if (!(hl->hr[hl->nranges++] = hostrange_copy (hr)))
             goto error;
+        hostlist_index_append (hl, hl->nhosts);
     }
 
     retval = hostrange_count (hr);
@@ -240,6 +398,8 @@ static int hostlist_insert_range (struct hostlist *hl,
     if (hl->size == hl->nranges && !hostlist_expand (hl))
         return 0;
 
+    hostlist_index_invalidate (hl);
+
     /* copy new hostrange into slot "n" in array */
     tmp = hl->hr[n];
     hl->hr[n] = hostrange_copy (hr);
@@ -310,6 +470,8 @@ static void hostlist_delete_range (struct hostlist *hl, int n)
     assert (hl != NULL);
     assert (n < hl->nranges && n >= 0);
 
+    hostlist_index_invalidate (hl);
+
     old = hl->hr[n];
     for (i = n; i < hl->nranges - 1; i++)
         hl->hr[i] = hl->hr[i + 1];
@@ -599,6 +761,8 @@ void hostlist_destroy (struct hostlist *hl)
             hostrange_destroy (hl->hr[i]);
         free (hl->hr);
         free (hl->current.host);
+        free (hl->index);
+        free (hl->offsets);
         free (hl);
         errno = saved_errno;
     }
@@ -687,11 +851,48 @@ int hostlist_count (struct hostlist *hl)
     return hl ? hl->nhosts : 0;
 }
 
+/* Find 'hn' using the prefix index.  Candidate ranges sharing the key
+ * of 'hn' are sorted by position, so the first match is the same one a
+ * linear search would find.
+ */
+static int hostlist_index_find (struct hostlist *hl,
+                                struct stack_hostname *hn,
+                                struct current *cur)
+{
+    int keylen = stem_len (hn->hostname, hn->len);
+    int pos = index_search (hl, hn->hostname, keylen, false);
+
+    while (pos < hl->index_count) {
+        struct index_entry *e = &hl->index[pos++];
+        int offset;
+
+        if (key_cmp (e->key, e->keylen, hn->hostname, keylen) != 0)
+            break;
+        if ((offset = hostrange_hn_within (hl->hr[e->index], hn)) >= 0) {
+            set_current (cur, e->index, offset);
+            return hl->offsets[e->index] + offset;
+        }
+    }
+    errno = ENOENT;
+    return -1;
+}
+
 static int hostlist_find_host (struct hostlist *hl,
                                struct stack_hostname *hn,
                                struct current *cur)
 {
     int i, count, ret = -1;
+
+    /*  Build the prefix index on the second lookup since the last
+     *   modification, so that a list which is searched once between
+     *   modifications (e.g. by hostlist_delete()) doesn't pay for it.
+     */
+    if (hl->nranges >= HOSTLIST_INDEX_MIN) {
+        if (!hl->index && ++hl->lookups > 1)
+            (void) hostlist_index_build (hl);
+        if (hl->index)
+            return hostlist_index_find (hl, hn, cur);
+    }
     for (i = 0, count = 0; i < hl->nranges; i++) {
         int offset = hostrange_hn_within (hl->hr[i], hn);
         if (offset >= 0) {
@@ -760,6 +961,8 @@ static int hostlist_remove_at (struct hostlist *hl, struct current *cur)
     if (cur->index > hl->nhosts - 1)
         return 0;
 
+    hostlist_index_invalidate (hl);
+
     hr = hl->hr[cur->index];
 
     /*  If we're removing the current host, invalidate cursor hostname
@@ -958,6 +1161,7 @@ void hostlist_sort (struct hostlist *hl)
         return;
     if (hl->nranges <= 1)
         return;
+    hostlist_index_invalidate (hl);
     qsort (hl->hr, hl->nranges, sizeof (struct hostrange *), _cmp);
     hostlist_coalesce (hl);
 }
@@ -989,6 +1193,7 @@ void hostlist_uniq (struct hostlist *hl)
     if (hl->nranges <= 1)
         return;
 
+    hostlist_index_invalidate (hl);
     qsort (hl->hr, hl->nranges, sizeof (struct hostrange *), &_cmp);
 
     while (i < hl->nranges) {
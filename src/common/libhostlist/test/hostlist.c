@@ -12,6 +12,9 @@
 #include "config.h"
 #endif
 
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 
@@ -371,6 +374,109 @@ void test_find_hostname ()
     }
 }
 
+/*  Return the position of the first occurrence of each host in 'hl' by
+ *   brute force, and check that hostlist_find() agrees.
+ */
+static bool check_find_all (struct hostlist *hl)
+{
+    struct hostlist *copy;
+    int count = hostlist_count (hl);
+    bool result = true;
+
+    if (!(copy = hostlist_copy (hl)))
+        BAIL_OUT ("hostlist_copy failed");
+    for (int i = 0; i < count; i++) {
+        char *host = strdup (hostlist_nth (copy, i));
+        int expected = i;
+        int rc;
+
+        if (!host)
+            BAIL_OUT ("strdup failed");
+        for (int j = 0; j < i; j++) {
+            if (strcmp (hostlist_nth (copy, j), host) == 0) {
+                expected = j;
+                break;
+            }
+        }
+        rc = hostlist_find (hl, host);
+        if (rc != expected || strcmp (hostlist_current (hl), host) != 0) {
+            diag ("hostlist_find (%s) returned %d, expected %d",
+                  host,
+                  rc,
+                  expected);
+            result = false;
+        }
+        free (host);
+    }
+    hostlist_destroy (copy);
+    return result;
+}
+
+void test_find_index ()
+{
+    struct hostlist *hl;
+    struct find_test *t = find_tests;
+    const char *hosts[] = {
+        "foo[1-3]", "bar7", "foo5", "f00[7-8]", "foo[01-03]", "foo2",
+        "baz", "bar[1-4]-eth0", "foo001", "bar", "fooi", "[0-5]",
+        "i[00-05]", "bar7", "z[10-12]", "foo10", "foo[8-9]", "corn-p2",
+        NULL,
+    };
+
+    /*  Pad each find test with enough ranges that the index is used.
+     */
+    while (t && t->input) {
+        int rc1, rc2;
+
+        if (!(hl = hostlist_create ()))
+            BAIL_OUT ("hostlist_create failed");
+        for (int i = 0; i < 32; i++) {
+            char pad[32];
+            snprintf (pad, sizeof (pad), "pad%dx", i);
+            if (hostlist_append (hl, pad) < 0)
+                BAIL_OUT ("hostlist_append failed");
+        }
+        if (hostlist_append (hl, t->input) < 0)
+            BAIL_OUT ("hostlist_append (%s) failed", t->input);
+        rc1 = hostlist_find (hl, t->arg);
+        rc2 = hostlist_find (hl, t->arg);
+        ok (rc1 == rc2 && rc2 == (t->rc < 0 ? -1 : t->rc + 32),
+            "indexed hostlist_find ('pad[0-31]x,%s', '%s') returned %d",
+            t->input, t->arg, rc2);
+        hostlist_destroy (hl);
+        t++;
+    }
+
+    if (!(hl = hostlist_create ()))
+        BAIL_OUT ("hostlist_create failed");
+    for (int i = 0; hosts[i] != NULL; i++) {
+        if (hostlist_append (hl, hosts[i]) < 0)
+            BAIL_OUT ("hostlist_append (%s) failed", hosts[i]);
+    }
+    ok (check_find_all (hl),
+        "hostlist_find returns first match for every host");
+    for (int i = 0; hosts[i] != NULL; i++) {
+        if (hostlist_append (hl, hosts[i]) < 0)
+            BAIL_OUT ("hostlist_append (%s) failed", hosts[i]);
+        if (hostlist_append (hl, "new[1-2]") < 0)
+            BAIL_OUT ("hostlist_append (new[1-2]) failed");
+    }
+    ok (check_find_all (hl),
+        "hostlist_find works after appending to an indexed hostlist");
+    ok (hostlist_delete (hl, "foo[1-3],bar7,i01,i01") > 0,
+        "hostlist_delete works on indexed hostlist");
+    ok (hostlist_find (hl, "i01") < 0 && errno == ENOENT,
+        "hostlist_find does not find deleted host");
+    ok (check_find_all (hl),
+        "hostlist_find works after hostlist_delete");
+    hostlist_sort (hl);
+    ok (check_find_all (hl),
+        "hostlist_find works after hostlist_sort");
+    hostlist_uniq (hl);
+    ok (check_find_all (hl),
+        "hostlist_find works after hostlist_uniq");
+    hostlist_destroy (hl);
+}
 
 struct delete_test {
     char *input;
@@ -646,6 +752,7 @@ int main (int argc, char *argv[])
     test_nth ();
     test_find ();
     test_find_hostname ();
+    test_find_index ();
     test_delete ();
     test_sortuniq ();
     test_iteration ();
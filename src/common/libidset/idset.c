@@ -229,6 +229,86 @@ static void idset_del_nocheck (struct idset *idset, unsigned int id)
     vebdel (idset->T, id);
 }
 
+/* Bulk operations copy sets to flat bitmaps, combine them a word at a
+ * time, and rebuild the tree with vebfrombits(), in time proportional to
+ * the universe size.  Element-wise operations cost O(log m) per id.
+ * Bulk operations are used when the number of ids processed element-wise
+ * would be at least (universe size / IDSET_BULK_RATIO).
+ */
+#define IDSET_WORD_BITS (sizeof (unsigned int) * 8)
+#define IDSET_BULK_RATIO 64
+
+static bool bulk_preferred (size_t count, size_t size)
+{
+    return count >= size / IDSET_BULK_RATIO;
+}
+
+/* Return the number of ids processed by an element-wise operation that
+ * iterates over 'idset'.  If counting is lazy, assume the worst.
+ */
+static size_t iter_count (const struct idset *idset)
+{
+    if ((idset->flags & IDSET_FLAG_COUNT_LAZY))
+        return idset->T.M;
+    return idset->count;
+}
+
+static size_t bits_words (size_t size)
+{
+    return (size + IDSET_WORD_BITS - 1) / IDSET_WORD_BITS;
+}
+
+/* Return a bitmap of at least 'size' bits containing the ids in idset.
+ */
+static unsigned int *bits_create (const struct idset *idset, size_t size)
+{
+    unsigned int *bits;
+
+    if (!(bits = calloc (bits_words (MAX (size, idset->T.M)),
+                         sizeof (*bits))))
+        return NULL;
+    vebtobits (idset->T, bits);
+    return bits;
+}
+
+/* Set or clear ids [lo,hi] in bitmap.
+ */
+static void bits_range (unsigned int *bits,
+                        unsigned int lo,
+                        unsigned int hi,
+                        bool set)
+{
+    size_t first = lo / IDSET_WORD_BITS;
+    size_t last = hi / IDSET_WORD_BITS;
+
+    for (size_t i = first; i <= last; i++) {
+        unsigned int mask = ~0u;
+        if (i == first)
+            mask &= ~0u << (lo % IDSET_WORD_BITS);
+        if (i == last && (hi % IDSET_WORD_BITS) < IDSET_WORD_BITS - 1)
+            mask &= ~(~0u << (hi % IDSET_WORD_BITS + 1));
+        if (set)
+            bits[i] |= mask;
+        else
+            bits[i] &= ~mask;
+    }
+}
+
+/* Replace the contents of idset with 'bits', which are destroyed.
+ */
+static void bits_load (struct idset *idset, unsigned int *bits)
+{
+    size_t words = bits_words (idset->T.M);
+    size_t count = 0;
+
+    if (idset->T.M % IDSET_WORD_BITS)
+        bits[words - 1] &= ~(~0u << (idset->T.M % IDSET_WORD_BITS));
+    for (size_t i = 0; i < words; i++)
+        count += __builtin_popcount (bits[i]);
+    idset->count = count;
+    vebfrombits (idset->T, bits);
+}
+
 int idset_set (struct idset *idset, unsigned int id)
 {
     if (!idset || !valid_id (id)) {
@@ -276,6 +356,18 @@ int idset_range_set (struct idset *idset, unsigned int lo, unsigned int hi)
         if (idset_grow (idset, hi + 1) < 0)
             return -1;
     }
+    if (bulk_preferred (hi - lo + 1, idset->T.M)) {
+        unsigned int *bits;
+
+        if (lo >= idset->T.M)
+            return 0;
+        if (!(bits = bits_create (idset, idset->T.M)))
+            return -1;
+        bits_range (bits, lo, MIN (hi, idset->T.M - 1), true);
+        bits_load (idset, bits);
+        free (bits);
+        return 0;
+    }
     for (id = lo; id <= hi; id++) {
         if (id >= oldsize) {
             if ((idset->flags & IDSET_FLAG_INITFULL))
@@ -325,6 +417,18 @@ int idset_range_clear (struct idset *idset, unsigned int lo, unsigned int hi)
         if (idset_grow (idset, hi + 1) < 0)
             return -1;
     }
+    if (bulk_preferred (hi - lo + 1, idset->T.M)) {
+        unsigned int *bits;
+
+        if (lo >= idset->T.M)
+            return 0;
+        if (!(bits = bits_create (idset, idset->T.M)))
+            return -1;
+        bits_range (bits, lo, MIN (hi, idset->T.M - 1), false);
+        bits_load (idset, bits);
+        free (bits);
+        return 0;
+    }
     for (id = lo; id <= hi; id++) {
         if (id >= oldsize) {
             if (!(idset->flags & IDSET_FLAG_INITFULL))
@@ -421,6 +525,27 @@ bool idset_empty (const struct idset *idset)
     return false;
 }
 
+/* Compare the sets' bitmaps, treating ids beyond a set's universe as
+ * unset.  On allocation failure, fall back to element-wise comparison.
+ */
+static int bits_equal (const struct idset *a, const struct idset *b)
+{
+    size_t size = MAX (a->T.M, b->T.M);
+    unsigned int *abits;
+    unsigned int *bbits = NULL;
+    int rc = -1;
+
+    if (!(abits = bits_create (a, size)) || !(bbits = bits_create (b, size)))
+        goto out;
+    rc = memcmp (abits,
+                 bbits,
+                 bits_words (size) * sizeof (*abits)) == 0 ? 1 : 0;
+out:
+    free (abits);
+    free (bbits);
+    return rc;
+}
+
 bool idset_equal (const struct idset *idset1,
                   const struct idset *idset2)
 {
@@ -440,6 +565,13 @@ bool idset_equal (const struct idset *idset1,
         count_checked = true;
     }
 
+    if (bulk_preferred (iter_count (idset1),
+                        MAX (idset1->T.M, idset2->T.M))) {
+        int rc = bits_equal (idset1, idset2);
+        if (rc >= 0)
+            return rc ? true : false;
+    }
+
     id = vebsucc (idset1->T, 0);
     while (id < idset1->T.M) {
         if (vebsucc (idset2->T, id) != id)
@@ -479,6 +611,28 @@ bool idset_has_intersection (const struct idset *a, const struct idset *b)
             b = tmp;
         }
 
+        if (bulk_preferred (iter_count (b), MIN (a->T.M, b->T.M))) {
+            size_t words = bits_words (MIN (a->T.M, b->T.M));
+            unsigned int *abits;
+            unsigned int *bbits = NULL;
+
+            if ((abits = bits_create (a, 0))
+                && (bbits = bits_create (b, 0))) {
+                bool result = false;
+                for (size_t i = 0; i < words; i++) {
+                    if ((abits[i] & bbits[i])) {
+                        result = true;
+                        break;
+                    }
+                }
+                free (abits);
+                free (bbits);
+                return result;
+            }
+            free (abits);
+            free (bbits);
+        }
+
         id = idset_first (b);
         while (id != IDSET_INVALID_ID) {
             if (idset_test (a, id))
@@ -489,12 +643,47 @@ bool idset_has_intersection (const struct idset *a, const struct idset *b)
     return false;
 }
 
+/* a += b a word at a time.
+ */
+static int add_bulk (struct idset *a, const struct idset *b)
+{
+    unsigned int last = idset_last (b);
+    unsigned int *abits;
+    unsigned int *bbits = NULL;
+    size_t words;
+
+    if (last == IDSET_INVALID_ID)
+        return 0;
+    // see IDSET_FLAG_INITFULL note in idset_set()
+    if (last >= a->T.M && !(a->flags & IDSET_FLAG_INITFULL)) {
+        if (idset_grow (a, last + 1) < 0)
+            return -1;
+    }
+    if (!(abits = bits_create (a, 0)) || !(bbits = bits_create (b, a->T.M)))
+        goto error;
+    words = bits_words (a->T.M);
+    for (size_t i = 0; i < words; i++)
+        abits[i] |= bbits[i];
+    bits_load (a, abits);
+    free (abits);
+    free (bbits);
+    return 0;
+error:
+    free (abits);
+    free (bbits);
+    return -1;
+}
+
 int idset_add (struct idset *a, const struct idset *b)
 {
     if (!a) {
         errno = EINVAL;
         return -1;
     }
+    if (b == a)
+        return 0;
+    if (b && bulk_preferred (iter_count (b), a->T.M))
+        return add_bulk (a, b);
     if (b) {
         unsigned int id;
         id = idset_first (b);
@@ -524,12 +713,45 @@ struct idset *idset_union (const struct idset *a, const struct idset *b)
     return result;
 }
 
+/* a -= b a word at a time.
+ */
+static int subtract_bulk (struct idset *a, const struct idset *b)
+{
+    unsigned int last = idset_last (b);
+    unsigned int *abits;
+    unsigned int *bbits = NULL;
+    size_t words;
+
+    if (last == IDSET_INVALID_ID)
+        return 0;
+    // see IDSET_FLAG_INITFULL note in idset_clear()
+    if (last >= a->T.M && (a->flags & IDSET_FLAG_INITFULL)) {
+        if (idset_grow (a, last + 1) < 0)
+            return -1;
+    }
+    if (!(abits = bits_create (a, 0)) || !(bbits = bits_create (b, a->T.M)))
+        goto error;
+    words = bits_words (a->T.M);
+    for (size_t i = 0; i < words; i++)
+        abits[i] &= ~bbits[i];
+    bits_load (a, abits);
+    free (abits);
+    free (bbits);
+    return 0;
+error:
+    free (abits);
+    free (bbits);
+    return -1;
+}
+
 int idset_subtract (struct idset *a, const struct idset *b)
 {
     if (!a) {
         errno = EINVAL;
         return -1;
     }
+    if (b && bulk_preferred (iter_count (b), a->T.M))
+        return subtract_bulk (a, b);
     if (b) {
         unsigned int id;
 
@@ -582,6 +804,23 @@ struct idset *idset_intersect (const struct idset *a, const struct idset *b)
 
     if (!(result = idset_copy (a)))
         return NULL;
+    if (bulk_preferred (iter_count (a), a->T.M)) {
+        unsigned int *rbits;
+        unsigned int *bbits = NULL;
+
+        if (!(rbits = bits_create (result, 0))
+            || !(bbits = bits_create (b, result->T.M))) {
+            free (rbits);
+            idset_destroy (result);
+            return NULL;
+        }
+        for (size_t i = 0; i < bits_words (result->T.M); i++)
+            rbits[i] &= bbits[i];
+        bits_load (result, rbits);
+        free (rbits);
+        free (bbits);
+        return result;
+    }
     id = idset_first (a);
     while (id != IDSET_INVALID_ID) {
         if (!idset_test (b, id) && idset_clear (result, id) < 0) {
@@ -1316,6 +1316,204 @@ void test_issue7494 (void)
     idset_destroy (idset);
 }
 
+/* Fill 'idset' with ids from [0,size) with probability 1/'every'.
+ */
+static void random_fill (struct idset *idset, unsigned int size, int every)
+{
+    for (unsigned int id = 0; id < size; id++) {
+        if (rand () % every == 0 && idset_set (idset, id) < 0)
+            BAIL_OUT ("idset_set failed");
+    }
+}
+
+/* Check that idset contains exactly the ids in [0,size) for which
+ * expect (a, b, id) is true, and that its count is correct.
+ */
+static bool check_op (struct idset *idset,
+                      const struct idset *a,
+                      const struct idset *b,
+                      unsigned int size,
+                      bool (*expect)(const struct idset *a,
+                                     const struct idset *b,
+                                     unsigned int id))
+{
+    size_t count = 0;
+
+    for (unsigned int id = 0; id < size; id++) {
+        bool e = expect (a, b, id);
+        if (idset_test (idset, id) != e) {
+            diag ("id %u: expected %s", id, e ? "set" : "unset");
+            return false;
+        }
+        if (e)
+            count++;
+    }
+    if (idset_count (idset) != count) {
+        diag ("count %zu != expected %zu", idset_count (idset), count);
+        return false;
+    }
+    return true;
+}
+
+static bool expect_union (const struct idset *a,
+                          const struct idset *b,
+                          unsigned int id)
+{
+    return idset_test (a, id) || idset_test (b, id);
+}
+
+static bool expect_difference (const struct idset *a,
+                               const struct idset *b,
+                               unsigned int id)
+{
+    return idset_test (a, id) && !idset_test (b, id);
+}
+
+static bool expect_intersect (const struct idset *a,
+                              const struct idset *b,
+                              unsigned int id)
+{
+    return idset_test (a, id) && idset_test (b, id);
+}
+
+static bool is_subset (const struct idset *a, const struct idset *b)
+{
+    unsigned int id = idset_first (a);
+    while (id != IDSET_INVALID_ID) {
+        if (!idset_test (b, id))
+            return false;
+        id = idset_next (a, id);
+    }
+    return true;
+}
+
+/* Exercise set operations on dense sets, where bulk (word at a time)
+ * operations are used, against a per-id reference.
+ */
+void test_bulk_ops (int flags)
+{
+    unsigned int sizes[] = { 1, 31, 32, 33, 100, 1024, 4099, 65536 };
+
+    for (int i = 0; i < ARRAY_SIZE (sizes); i++) {
+        unsigned int size = sizes[i];
+        unsigned int bsize = size + size / 2 + 1;
+        struct idset *a;
+        struct idset *b;
+        struct idset *c;
+
+        if (!(a = idset_create (size, flags | IDSET_FLAG_AUTOGROW)))
+            BAIL_OUT ("idset_create failed");
+        if (!(b = idset_create (bsize, flags)))
+            BAIL_OUT ("idset_create failed");
+        random_fill (a, size, 2);
+        random_fill (b, bsize, 3);
+
+        c = idset_union (a, b);
+        ok (c != NULL && check_op (c, a, b, bsize, expect_union),
+            "size=%u flags=0x%x: idset_union works", size, flags);
+        ok (idset_equal (c, c) && idset_equal (a, c) == is_subset (b, a),
+            "size=%u flags=0x%x: idset_equal works", size, flags);
+        idset_destroy (c);
+
+        c = idset_difference (a, b);
+        ok (c != NULL && check_op (c, a, b, bsize, expect_difference),
+            "size=%u flags=0x%x: idset_difference works", size, flags);
+        ok (idset_has_intersection (c, b) == false,
+            "size=%u flags=0x%x: idset_has_intersection a-b, b is false",
+            size, flags);
+        idset_destroy (c);
+
+        c = idset_intersect (a, b);
+        ok (c != NULL && check_op (c, a, b, bsize, expect_intersect),
+            "size=%u flags=0x%x: idset_intersect works", size, flags);
+        ok (idset_has_intersection (a, b) == !idset_empty (c),
+            "size=%u flags=0x%x: idset_has_intersection works", size, flags);
+        idset_destroy (c);
+
+        c = idset_copy (a);
+        ok (c != NULL
+            && idset_equal (a, c)
+            && idset_subtract (c, c) == 0
+            && idset_empty (c)
+            && idset_count (c) == 0,
+            "size=%u flags=0x%x: idset_subtract (a, a) clears a",
+            size, flags);
+        idset_destroy (c);
+
+        idset_destroy (a);
+        idset_destroy (b);
+    }
+}
+
+void test_bulk_initfull (void)
+{
+    struct idset *a;
+    struct idset *b;
+    char *s = NULL;
+
+    if (!(a = idset_create (64, IDSET_FLAG_INITFULL))
+        || !(b = idset_decode ("32-127")))
+        BAIL_OUT ("could not create test idsets");
+    errno = 0;
+    ok (idset_subtract (a, b) < 0 && errno == EINVAL,
+        "INITFULL idset_subtract fails with EINVAL if set cannot grow");
+    ok (idset_range_clear (a, 0, 63) == 0
+        && idset_add (a, b) == 0
+        && idset_count (a) == 32
+        && idset_universe_size (a) == 64,
+        "INITFULL idset_add ignores ids beyond universe");
+    idset_destroy (a);
+
+    if (!(a = idset_create (64, IDSET_FLAG_INITFULL | IDSET_FLAG_AUTOGROW)))
+        BAIL_OUT ("could not create test idset");
+    ok (idset_subtract (a, b) == 0
+        && (s = idset_encode (a, IDSET_FLAG_RANGE))
+        && streq (s, "0-31")
+        && idset_universe_size (a) == 128,
+        "INITFULL|AUTOGROW idset_subtract grows set");
+    free (s);
+    idset_destroy (a);
+
+    if (!(a = idset_create (64, 0)))
+        BAIL_OUT ("could not create test idset");
+    errno = 0;
+    ok (idset_add (a, b) < 0 && errno == EINVAL,
+        "idset_add fails with EINVAL if set cannot grow");
+    idset_destroy (a);
+    idset_destroy (b);
+}
+
+void test_bulk_range (void)
+{
+    struct idset *idset;
+    char *s = NULL;
+
+    if (!(idset = idset_create (1024, IDSET_FLAG_AUTOGROW)))
+        BAIL_OUT ("could not create test idset");
+    ok (idset_range_set (idset, 3, 1000) == 0
+        && idset_range_clear (idset, 33, 63) == 0
+        && idset_range_clear (idset, 500, 2000) == 0
+        && idset_count (idset) == 466
+        && (s = idset_encode (idset, IDSET_FLAG_RANGE))
+        && streq (s, "3-32,64-499"),
+        "idset_range_set/clear of large ranges works");
+    free (s);
+    ok (idset_range_set (idset, 4000, 5000) == 0
+        && idset_universe_size (idset) == 8192
+        && idset_count (idset) == 1467,
+        "idset_range_set of large range grows set");
+    idset_destroy (idset);
+
+    if (!(idset = idset_create (100, IDSET_FLAG_INITFULL)))
+        BAIL_OUT ("could not create test idset");
+    ok (idset_range_clear (idset, 0, 98) == 0
+        && idset_range_set (idset, 50, 200) == 0
+        && idset_count (idset) == 50
+        && idset_universe_size (idset) == 100,
+        "INITFULL idset_range_set of large range ignores ids beyond universe");
+    idset_destroy (idset);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -1350,6 +1548,10 @@ int main (int argc, char *argv[])
     test_decode_info ();
     test_decode_addsub ();
     test_issue7494 ();
+    test_bulk_ops (0);
+    test_bulk_ops (IDSET_FLAG_COUNT_LAZY);
+    test_bulk_initfull ();
+    test_bulk_range ();
 
     done_testing ();
 }
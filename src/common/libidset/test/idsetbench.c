@@ -0,0 +1,243 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* idsetbench.c - compare bulk idset operations with element-wise ones
+ *
+ * Usage: test_idsetbench [SIZE [DENSITY [ITERATIONS]]]
+ *
+ * Two random sets with SIZE universe and DENSITY percent of ids set are
+ * combined with the library operations, which use word at a time bulk
+ * operations on dense sets, and with element-wise reference versions
+ * built on idset_first()/idset_next() and idset_set()/idset_clear(),
+ * as the library did before bulk operations were added.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/libidset/idset.h"
+#include "src/common/libutil/monotime.h"
+
+static int ref_add (struct idset *a, const struct idset *b)
+{
+    unsigned int id = idset_first (b);
+    while (id != IDSET_INVALID_ID) {
+        if (idset_set (a, id) < 0)
+            return -1;
+        id = idset_next (b, id);
+    }
+    return 0;
+}
+
+static int ref_subtract (struct idset *a, const struct idset *b)
+{
+    unsigned int id = idset_first (b);
+    while (id != IDSET_INVALID_ID) {
+        if (idset_clear (a, id) < 0)
+            return -1;
+        id = idset_next (b, id);
+    }
+    return 0;
+}
+
+static struct idset *ref_intersect (const struct idset *a,
+                                    const struct idset *b)
+{
+    struct idset *result;
+    unsigned int id;
+
+    if (!(result = idset_copy (a)))
+        return NULL;
+    id = idset_first (a);
+    while (id != IDSET_INVALID_ID) {
+        if (!idset_test (b, id) && idset_clear (result, id) < 0) {
+            idset_destroy (result);
+            return NULL;
+        }
+        id = idset_next (a, id);
+    }
+    return result;
+}
+
+static bool ref_equal (const struct idset *a, const struct idset *b)
+{
+    unsigned int id;
+
+    if (idset_count (a) != idset_count (b))
+        return false;
+    id = idset_first (a);
+    while (id != IDSET_INVALID_ID) {
+        if (!idset_test (b, id))
+            return false;
+        id = idset_next (a, id);
+    }
+    return true;
+}
+
+static int ref_range_set (struct idset *a, unsigned int lo, unsigned int hi)
+{
+    for (unsigned int id = lo; id <= hi; id++) {
+        if (idset_set (a, id) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static struct idset *random_set (unsigned int size, int density)
+{
+    struct idset *idset;
+
+    if (!(idset = idset_create (size, 0))) {
+        perror ("idset_create");
+        exit (1);
+    }
+    for (unsigned int id = 0; id < size; id++) {
+        if (rand () % 100 < density)
+            idset_set (idset, id);
+    }
+    return idset;
+}
+
+static struct idset *copy (const struct idset *idset)
+{
+    struct idset *cpy;
+
+    if (!(cpy = idset_copy (idset))) {
+        perror ("idset_copy");
+        exit (1);
+    }
+    return cpy;
+}
+
+static void report (const char *name, double bulk, double ref, bool same)
+{
+    printf ("%-12s %10.3f %10.3f %8.1fx %s\n",
+            name,
+            bulk,
+            ref,
+            bulk > 0 ? ref / bulk : 0.,
+            same ? "" : "MISMATCH");
+}
+
+int main (int argc, char *argv[])
+{
+    unsigned int size = argc > 1 ? strtoul (argv[1], NULL, 10) : 16384;
+    int density = argc > 2 ? atoi (argv[2]) : 50;
+    int iterations = argc > 3 ? atoi (argv[3]) : 100;
+    struct idset *a = random_set (size, density);
+    struct idset *b = random_set (size, density);
+    struct idset *x;
+    struct idset *y;
+    struct timespec t0;
+    double bulk;
+    double ref;
+    bool same;
+
+    printf ("size=%u density=%d%% iterations=%d\n", size, density, iterations);
+    printf ("%-12s %10s %10s %9s\n",
+            "operation",
+            "bulk(ms)",
+            "ref(ms)",
+            "speedup");
+
+    bulk = ref = 0.;
+    same = true;
+    for (int i = 0; i < iterations; i++) {
+        x = copy (a);
+        y = copy (a);
+        monotime (&t0);
+        idset_add (x, b);
+        bulk += monotime_since (t0);
+        monotime (&t0);
+        ref_add (y, b);
+        ref += monotime_since (t0);
+        same = same && ref_equal (x, y);
+        idset_destroy (x);
+        idset_destroy (y);
+    }
+    report ("add", bulk, ref, same);
+
+    bulk = ref = 0.;
+    same = true;
+    for (int i = 0; i < iterations; i++) {
+        x = copy (a);
+        y = copy (a);
+        monotime (&t0);
+        idset_subtract (x, b);
+        bulk += monotime_since (t0);
+        monotime (&t0);
+        ref_subtract (y, b);
+        ref += monotime_since (t0);
+        same = same && ref_equal (x, y);
+        idset_destroy (x);
+        idset_destroy (y);
+    }
+    report ("subtract", bulk, ref, same);
+
+    bulk = ref = 0.;
+    same = true;
+    for (int i = 0; i < iterations; i++) {
+        monotime (&t0);
+        x = idset_intersect (a, b);
+        bulk += monotime_since (t0);
+        monotime (&t0);
+        y = ref_intersect (a, b);
+        ref += monotime_since (t0);
+        same = same && ref_equal (x, y);
+        idset_destroy (x);
+        idset_destroy (y);
+    }
+    report ("intersect", bulk, ref, same);
+
+    bulk = ref = 0.;
+    same = true;
+    x = copy (a);
+    for (int i = 0; i < iterations; i++) {
+        bool r1, r2;
+        monotime (&t0);
+        r1 = idset_equal (a, x);
+        bulk += monotime_since (t0);
+        monotime (&t0);
+        r2 = ref_equal (a, x);
+        ref += monotime_since (t0);
+        same = same && r1 == r2;
+    }
+    idset_destroy (x);
+    report ("equal", bulk, ref, same);
+
+    bulk = ref = 0.;
+    same = true;
+    for (int i = 0; i < iterations; i++) {
+        x = copy (a);
+        y = copy (a);
+        monotime (&t0);
+        idset_range_set (x, size / 4, size - size / 4);
+        bulk += monotime_since (t0);
+        monotime (&t0);
+        ref_range_set (y, size / 4, size - size / 4);
+        ref += monotime_since (t0);
+        same = same && ref_equal (x, y);
+        idset_destroy (x);
+        idset_destroy (y);
+    }
+    report ("range_set", bulk, ref, same);
+
+    idset_destroy (a);
+    idset_destroy (b);
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -505,6 +505,52 @@ void issue_2336 (void)
     free (T.D);
 }
 
+/* Build a set with vebput() and check that vebtobits() recovers it and
+ * vebfrombits() builds a byte-identical tree.
+ */
+static int bits_roundtrip (uint M, uint count)
+{
+    uint words = (M + 31) / 32;
+    uint *expected = calloc (words, sizeof (uint));
+    uint *bits = calloc (words, sizeof (uint));
+    Veb T = vebnew (M, 0);
+    Veb T2 = vebnew (M, 1);
+    int errors = 0;
+
+    if (!expected || !bits || !T.D || !T2.D)
+        BAIL_OUT ("out of memory");
+    for (uint i = 0; i < count; i++) {
+        uint x = rand () % M;
+        vebput (T, x);
+        expected[x / 32] |= 1u << (x % 32);
+    }
+    vebtobits (T, bits);
+    if (memcmp (bits, expected, words * sizeof (uint)) != 0)
+        errors++;
+    vebfrombits (T2, bits);
+    if (memcmp (T.D, T2.D, vebsize (M)) != 0)
+        errors++;
+    free (expected);
+    free (bits);
+    free (T.D);
+    free (T2.D);
+    return errors;
+}
+
+void test_bits (void)
+{
+    uint sizes[] = { 1, 7, 32, 33, 100, 1024, 1025, 4099, 65536, 100003 };
+    uint counts[] = { 0, 1, 2, 10, 1000, 100000 };
+
+    for (int i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++) {
+        int errors = 0;
+        for (int j = 0; j < sizeof (counts) / sizeof (counts[0]); j++)
+            errors += bits_roundtrip (sizes[i], counts[j]);
+        ok (errors == 0,
+            "vebtobits/vebfrombits round trip works for M=%u", sizes[i]);
+    }
+}
+
 int main(int argc, char** argv)
 {
     plan (NO_PLAN);
@@ -536,6 +582,7 @@ int main(int argc, char** argv)
     test_empty_init ();
     test_full_init ();
     issue_2336 ();
+    test_bits ();
 
     done_testing();
 }
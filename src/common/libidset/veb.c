@@ -375,3 +375,119 @@ vebpred(Veb T, uint x)
 	B = branch(T,i);
 	return i*ipow(T.k/2)+high(B);
 }
+
+/* Return the value of bits [x,x+n) of bitmap B, where n <= WORD and
+ * the bits do not span a word boundary.
+ */
+static uint
+getbits(const uint B[], uint x, uint n)
+{
+	return (B[x/WORD]>>(x%WORD))&ones(n);
+}
+
+/* Return the first set bit of bitmap B in [x,y), or y if there is none.
+ */
+static uint
+firstbit(const uint B[], uint x, uint y)
+{
+	while (x < y) {
+		uint w = B[x/WORD]&zeros(x%WORD);
+		if (w) {
+			x = x-x%WORD+ctz(w);
+			return x < y ? x : y;
+		}
+		x += WORD-x%WORD;
+	}
+	return y;
+}
+
+/* Return the last set bit of bitmap B in [x,y), or y if there is none.
+ */
+static uint
+lastbit(const uint B[], uint x, uint y)
+{
+	uint z = y;
+	while (z > x) {
+		uint i = (z-1)/WORD;
+		uint n = z-i*WORD;
+		uint w = B[i]&ones(n);
+		if (w) {
+			z = i*WORD+fls(w)-1;
+			return z >= x ? z : y;
+		}
+		z = i*WORD;
+	}
+	return y;
+}
+
+static void
+tobits(Veb T, uint B[], uint base)
+{
+	if (T.M <= WORD) {
+		uint x = decode(T.D,bytes(T.M));
+		if (x)
+			B[base/WORD] |= x<<(base%WORD);
+		return;
+	}
+	if (empty(T))
+		return;
+	uint lo = base+low(T);
+	uint hi = base+high(T);
+	B[lo/WORD] |= 1u<<(lo%WORD);
+	B[hi/WORD] |= 1u<<(hi%WORD);
+	Veb A = aux(T);
+	uint n = ipow(T.k/2);
+	uint i = vebsucc(A,0);
+	while (i < A.M) {
+		tobits(branch(T,i),B,base+i*n);
+		i = vebsucc(A,i+1);
+	}
+}
+
+void
+vebtobits(Veb T, uint B[])
+{
+	tobits(T,B,0);
+}
+
+/* Build T from bits [base,base+T.M) of B.  Members of T other than its
+ * low and high values are stored in the branches, so the low and high
+ * bits are cleared from B before the branches are built.
+ */
+static void
+frombits(Veb T, uint B[], uint base)
+{
+	if (T.M <= WORD) {
+		encode(T.D,bytes(T.M),getbits(B,base,T.M));
+		return;
+	}
+	uint end = base+T.M;
+	uint lo = firstbit(B,base,end);
+	if (lo == end) {
+		mkempty(T);
+		return;
+	}
+	uint hi = lastbit(B,base,end);
+	setlow(T,lo-base);
+	sethigh(T,hi-base);
+	B[lo/WORD] &= ~(1u<<(lo%WORD));
+	B[hi/WORD] &= ~(1u<<(hi%WORD));
+	Veb A = aux(T);
+	uint k = T.k/2;
+	uint m = highbits(T.M-1,k)+1;
+	uint n = ipow(k);
+	uint i;
+	mkempty(A);
+	for (i = 0; i < m; ++i) {
+		Veb C = branch(T,i);
+		frombits(C,B,base+i*n);
+		if (!empty(C))
+			vebput(A,i);
+	}
+}
+
+void
+vebfrombits(Veb T, uint B[])
+{
+	frombits(T,B,0);
+}
@@ -40,4 +40,15 @@ void vebput(Veb, uint);
 uint vebsucc(Veb, uint);
 uint vebpred(Veb, uint);
 
+/* Bulk conversion to and from a flat bitmap of WORD-bit uint words,
+ * where id x is bit x%WORD of word x/WORD.  vebtobits() ORs the members
+ * of T into bits, which must hold at least T.M bits.  vebfrombits()
+ * replaces the contents of T with bits [0,T.M) of bits, clearing bits
+ * as it goes, so the bitmap must be considered garbage afterwards.
+ * Both run in time proportional to the size of T rather than the number
+ * of members.
+ */
+void vebtobits(Veb, uint *);
+void vebfrombits(Veb, uint *);
+
 #endif /* _UTIL_LIBVEB_H */
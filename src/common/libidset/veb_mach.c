@@ -1,6 +1,6 @@
 
 #define WORD \
-	sizeof(uint)*8
+	(sizeof(uint)*8)
 
 static uint
 clz(uint x)
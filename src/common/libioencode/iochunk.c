@@ -0,0 +1,170 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+
+#include <jansson.h>
+
+#include "ccan/str/str.h"
+
+#include "ioencode.h"
+#include "iochunk.h"
+
+static void put_u32 (uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static uint32_t get_u32 (const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24)
+         | ((uint32_t)p[1] << 16)
+         | ((uint32_t)p[2] << 8)
+         | (uint32_t)p[3];
+}
+
+static void put_u64 (uint8_t *p, uint64_t v)
+{
+    put_u32 (p, v >> 32);
+    put_u32 (p + 4, v & 0xffffffff);
+}
+
+static uint64_t get_u64 (const uint8_t *p)
+{
+    return ((uint64_t)get_u32 (p) << 32) | get_u32 (p + 4);
+}
+
+ssize_t iochunk_record_size (const char *rank, int len)
+{
+    size_t rank_len;
+
+    if (!rank
+        || (rank_len = strlen (rank)) == 0
+        || rank_len > IOCHUNK_RANK_MAX
+        || len < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return IOCHUNK_HEADER_SIZE + rank_len + len;
+}
+
+ssize_t iochunk_encode (void *buf,
+                        size_t size,
+                        double timestamp,
+                        const char *stream,
+                        const char *rank,
+                        const char *data,
+                        int len,
+                        bool eof)
+{
+    uint8_t *p = buf;
+    ssize_t total;
+    size_t rank_len;
+    uint8_t flags = 0;
+
+    if (!buf
+        || !stream
+        || (!streq (stream, "stdout") && !streq (stream, "stderr"))
+        || (!data && len != 0)
+        || (len == 0 && !eof)
+        || timestamp < 0.
+        || (total = iochunk_record_size (rank, len)) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (total > size) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    if (timestamp == 0.) {
+        struct timespec ts;
+        if (clock_gettime (CLOCK_REALTIME, &ts) < 0)
+            return -1;
+        timestamp = ts.tv_sec + 1E-9 * ts.tv_nsec;
+    }
+    if (streq (stream, "stderr"))
+        flags |= IOCHUNK_FLAG_STDERR;
+    if (eof)
+        flags |= IOCHUNK_FLAG_EOF;
+    rank_len = strlen (rank);
+
+    p[0] = flags;
+    p[1] = rank_len;
+    put_u32 (p + 2, len);
+    put_u64 (p + 6, (uint64_t)(timestamp * 1E6));
+    memcpy (p + IOCHUNK_HEADER_SIZE, rank, rank_len);
+    if (len > 0)
+        memcpy (p + IOCHUNK_HEADER_SIZE + rank_len, data, len);
+    return total;
+}
+
+ssize_t iochunk_decode (const void *buf,
+                        size_t size,
+                        struct iochunk_record *rec)
+{
+    const uint8_t *p = buf;
+    size_t rank_len;
+    uint32_t len;
+
+    if (!buf || !rec) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (size < IOCHUNK_HEADER_SIZE)
+        goto eproto;
+    rank_len = p[1];
+    len = get_u32 (p + 2);
+    if (rank_len == 0
+        || len > INT32_MAX
+        || size - IOCHUNK_HEADER_SIZE < rank_len
+        || size - IOCHUNK_HEADER_SIZE - rank_len < len
+        || (p[0] & ~(IOCHUNK_FLAG_STDERR | IOCHUNK_FLAG_EOF)))
+        goto eproto;
+    rec->stream = (p[0] & IOCHUNK_FLAG_STDERR) ? "stderr" : "stdout";
+    rec->eof = (p[0] & IOCHUNK_FLAG_EOF) ? true : false;
+    rec->timestamp = 1E-6 * get_u64 (p + 6);
+    memcpy (rec->rank, p + IOCHUNK_HEADER_SIZE, rank_len);
+    rec->rank[rank_len] = '\0';
+    rec->data = (const char *)p + IOCHUNK_HEADER_SIZE + rank_len;
+    rec->len = len;
+    if (len == 0 && !rec->eof)
+        goto eproto;
+    return IOCHUNK_HEADER_SIZE + rank_len + len;
+eproto:
+    errno = EPROTO;
+    return -1;
+}
+
+json_t *iochunk_ioencode (const struct iochunk_record *rec)
+{
+    if (!rec) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return ioencode (rec->stream,
+                     rec->rank,
+                     rec->len > 0 ? rec->data : NULL,
+                     rec->len,
+                     rec->eof);
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
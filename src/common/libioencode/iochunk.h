@@ -0,0 +1,82 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _IOCHUNK_H
+#define _IOCHUNK_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <jansson.h>
+
+/* Compact binary encoding of RFC 24 data events.
+ *
+ * A chunk is a sequence of self-delimiting records, so chunks may be
+ * concatenated (e.g. by KVS append) and decoded as one.  Each record is
+ * a fixed size header followed by the rank string and raw data.  Header
+ * integers are in network byte order:
+ *
+ *   uint8  flags       IOCHUNK_FLAG_STDERR, IOCHUNK_FLAG_EOF
+ *   uint8  rank_len    length of rank string (no NUL)
+ *   uint32 data_len    length of data
+ *   uint64 timestamp   microseconds since the epoch
+ */
+enum {
+    IOCHUNK_FLAG_STDERR = 1,
+    IOCHUNK_FLAG_EOF = 2,
+};
+
+#define IOCHUNK_HEADER_SIZE 14
+#define IOCHUNK_RANK_MAX 255
+
+struct iochunk_record {
+    double timestamp;
+    const char *stream;             // "stdout" or "stderr"
+    char rank[IOCHUNK_RANK_MAX + 1];
+    const char *data;               // points into the decoded buffer
+    int len;
+    bool eof;
+};
+
+/* Return the size of the record that would encode 'rank' and 'len'
+ * bytes of data, or -1 with errno set on invalid arguments.
+ */
+ssize_t iochunk_record_size (const char *rank, int len);
+
+/* Encode a record into 'buf' of 'size' bytes.
+ * - stream must be "stdout" or "stderr"
+ * - to set only EOF, set data to NULL and len to 0
+ * - if timestamp is 0., the current time is used
+ * - returns the number of bytes written, or -1 with errno set
+ *   (EOVERFLOW if 'buf' is too small)
+ */
+ssize_t iochunk_encode (void *buf,
+                        size_t size,
+                        double timestamp,
+                        const char *stream,
+                        const char *rank,
+                        const char *data,
+                        int len,
+                        bool eof);
+
+/* Decode the record at the start of 'buf'.
+ * - rec->data points into 'buf' and is valid as long as 'buf' is
+ * - returns the number of bytes consumed, or -1 with errno set
+ *   (EPROTO if the record is truncated or malformed)
+ */
+ssize_t iochunk_decode (const void *buf,
+                        size_t size,
+                        struct iochunk_record *rec);
+
+/* Convert a decoded record to an RFC 24 data event context.
+ * The returned object should be json_decref()'d after use.
+ */
+json_t *iochunk_ioencode (const struct iochunk_record *rec);
+
+#endif /* !_IOCHUNK_H */
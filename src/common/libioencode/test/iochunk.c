@@ -0,0 +1,151 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <jansson.h>
+#include <errno.h>
+
+#include "ccan/str/str.h"
+#include "src/common/libtap/tap.h"
+#include "src/common/libioencode/ioencode.h"
+#include "src/common/libioencode/iochunk.h"
+
+void basic_corner_case (void)
+{
+    char buf[64];
+    struct iochunk_record rec;
+
+    errno = 0;
+    ok (iochunk_record_size (NULL, 0) < 0 && errno == EINVAL,
+        "iochunk_record_size rank=NULL fails with EINVAL");
+    errno = 0;
+    ok (iochunk_record_size ("", 0) < 0 && errno == EINVAL,
+        "iochunk_record_size rank=\"\" fails with EINVAL");
+    errno = 0;
+    ok (iochunk_encode (buf, sizeof (buf), 0., "stdin", "0", "x", 1, false) < 0
+        && errno == EINVAL,
+        "iochunk_encode stream=stdin fails with EINVAL");
+    errno = 0;
+    ok (iochunk_encode (buf, sizeof (buf), 0., "stdout", "0", NULL, 0, false)
+        < 0 && errno == EINVAL,
+        "iochunk_encode with no data and no EOF fails with EINVAL");
+    errno = 0;
+    ok (iochunk_encode (buf, 4, 0., "stdout", "0", "x", 1, false) < 0
+        && errno == EOVERFLOW,
+        "iochunk_encode into short buffer fails with EOVERFLOW");
+    errno = 0;
+    ok (iochunk_decode (NULL, 0, &rec) < 0 && errno == EINVAL,
+        "iochunk_decode buf=NULL fails with EINVAL");
+    errno = 0;
+    ok (iochunk_decode (buf, 4, &rec) < 0 && errno == EPROTO,
+        "iochunk_decode of short buffer fails with EPROTO");
+    errno = 0;
+    ok (iochunk_ioencode (NULL) == NULL && errno == EINVAL,
+        "iochunk_ioencode rec=NULL fails with EINVAL");
+}
+
+void basic (void)
+{
+    char buf[256];
+    struct iochunk_record rec;
+    ssize_t n, m, total;
+    const char *p;
+    json_t *o;
+    const char *stream;
+    const char *rank;
+    char *data;
+    int len;
+    bool eof;
+
+    n = iochunk_encode (buf, sizeof (buf), 1.5, "stdout", "3", "foo\n", 4,
+                        false);
+    ok (n == iochunk_record_size ("3", 4),
+        "iochunk_encode stdout data works");
+    m = iochunk_encode (buf + n, sizeof (buf) - n, 2.25, "stderr", "[0-7]",
+                        NULL, 0, true);
+    ok (m == iochunk_record_size ("[0-7]", 0),
+        "iochunk_encode stderr EOF works");
+    total = n + m;
+
+    ok (iochunk_decode (buf, total, &rec) == n,
+        "iochunk_decode of first record works");
+    ok (streq (rec.stream, "stdout")
+        && streq (rec.rank, "3")
+        && rec.len == 4
+        && !memcmp (rec.data, "foo\n", 4)
+        && rec.eof == false
+        && rec.timestamp == 1.5,
+        "first record decoded correctly");
+
+    ok ((o = iochunk_ioencode (&rec)) != NULL,
+        "iochunk_ioencode works");
+    ok (iodecode (o, &stream, &rank, &data, &len, &eof) == 0
+        && streq (stream, "stdout")
+        && streq (rank, "3")
+        && len == 4
+        && !memcmp (data, "foo\n", 4)
+        && eof == false,
+        "RFC 24 data event matches record");
+    free (data);
+    json_decref (o);
+
+    p = buf + n;
+    ok (iochunk_decode (p, total - n, &rec) == m,
+        "iochunk_decode of second record works");
+    ok (streq (rec.stream, "stderr")
+        && streq (rec.rank, "[0-7]")
+        && rec.len == 0
+        && rec.eof == true
+        && rec.timestamp == 2.25,
+        "second record decoded correctly");
+
+    errno = 0;
+    ok (iochunk_decode (buf, n - 1, &rec) < 0 && errno == EPROTO,
+        "iochunk_decode of truncated record fails with EPROTO");
+}
+
+void binary_data (void)
+{
+    const char data[] = "\xed\xbf\xbf\x00\x01\x02";
+    char buf[64];
+    struct iochunk_record rec;
+    ssize_t n;
+
+    n = iochunk_encode (buf, sizeof (buf), 0., "stdout", "0", data,
+                        sizeof (data), false);
+    ok (n > 0,
+        "iochunk_encode of binary data works");
+    ok (iochunk_decode (buf, n, &rec) == n
+        && rec.len == sizeof (data)
+        && !memcmp (rec.data, data, sizeof (data))
+        && rec.timestamp > 0.,
+        "binary data and current timestamp round trip");
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    basic_corner_case ();
+    basic ();
+    binary_data ();
+
+    done_testing ();
+
+    return 0;
+}
+
+/*
+ * vi: ts=4 sw=4 expandtab
+ */
@@ -81,6 +81,82 @@ static void rank_hash_purge (struct rlist *rl)
     zhashx_purge (rl->rank_index);
 }
 
+static void host_list_destructor (void **item)
+{
+    if (item) {
+        zlistx_destroy ((zlistx_t **) item);
+        *item = NULL;
+    }
+}
+
+static zhashx_t *host_hash_create (void)
+{
+    zhashx_t *hash;
+
+    if (!(hash = zhashx_new ())) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    zhashx_set_destructor (hash, host_list_destructor);
+    return hash;
+}
+
+/*  Return the list of rnodes with hostname 'host', in the order they
+ *   were added, or NULL if there are none.
+ */
+static zlistx_t *host_hash_lookup (const struct rlist *rl, const char *host)
+{
+    return zhashx_lookup (rl->host_index, host);
+}
+
+static int host_hash_insert (struct rlist *rl, struct rnode *n)
+{
+    zlistx_t *l;
+
+    if (!n->hostname)
+        return 0;
+    if (!(l = host_hash_lookup (rl, n->hostname))) {
+        if (!(l = zlistx_new ())) {
+            errno = ENOMEM;
+            return -1;
+        }
+        zhashx_insert (rl->host_index, n->hostname, l);
+    }
+    if (!zlistx_add_end (l, n)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+static void host_hash_delete (struct rlist *rl, struct rnode *n)
+{
+    zlistx_t *l;
+    void *handle;
+
+    if (n->hostname
+        && (l = host_hash_lookup (rl, n->hostname))
+        && (handle = zlistx_find (l, n))) {
+        zlistx_delete (l, handle);
+        if (zlistx_size (l) == 0)
+            zhashx_delete (rl->host_index, n->hostname);
+    }
+}
+
+static int host_hash_rebuild (struct rlist *rl)
+{
+    struct rnode *n;
+
+    zhashx_purge (rl->host_index);
+    n = zlistx_first (rl->nodes);
+    while (n) {
+        if (host_hash_insert (rl, n) < 0)
+            return -1;
+        n = zlistx_next (rl->nodes);
+    }
+    return 0;
+}
+
 static int
 sprintfcat (char **s, size_t *sz, size_t *lenp, const char *fmt, ...)
 {
@@ -113,6 +189,7 @@ void rlist_destroy (struct rlist *rl)
         zlistx_destroy (&rl->nodes);
         zhashx_destroy (&rl->noremap);
         zhashx_destroy (&rl->rank_index);
+        zhashx_destroy (&rl->host_index);
         json_decref (rl->scheduling);
         free (rl);
         errno = saved_errno;
@@ -143,6 +220,7 @@ struct rlist *rlist_create (void)
     zlistx_set_destructor (rl->nodes, rn_free_fn);
 
     if (!(rl->rank_index = rank_hash_create ())
+        || !(rl->host_index = host_hash_create ())
         || !(rl->noremap = zhashx_new ()))
         goto err;
     zhashx_set_destructor (rl->noremap, valfree);
@@ -190,7 +268,7 @@ static int rlist_add_rnode_new (struct rlist *rl, struct rnode *n)
     void *handle;
     if (!(handle = zlistx_add_end (rl->nodes, n)))
         return -1;
-    if (rank_hash_insert (rl, n) < 0)
+    if (rank_hash_insert (rl, n) < 0 || host_hash_insert (rl, n) < 0)
         return -1;
     rlist_update_totals (rl, n);
     return 0;
@@ -365,6 +443,7 @@ static int rlist_remove_rank (struct rlist *rl, int rank)
         return -1;
     }
     rank_hash_delete (rl, rank);
+    host_hash_delete (rl, n);
     zlistx_delete (rl->nodes, handle);
     return 0;
 }
@@ -408,14 +487,12 @@ int rlist_remap (struct rlist *rl)
 
 struct rnode * rlist_find_host (const struct rlist *rl, const char *host)
 {
-    struct rnode *n = zlistx_first (rl->nodes);
-    while (n) {
-        if (n->hostname && streq (n->hostname, host))
-            return n;
-        n = zlistx_next (rl->nodes);
+    zlistx_t *l = host_hash_lookup (rl, host);
+    if (!l) {
+        errno = ENOENT;
+        return NULL;
     }
-    errno = ENOENT;
-    return NULL;
+    return zlistx_first (l);
 }
 
 static int rlist_rerank_hostlist (struct rlist *rl,
@@ -495,6 +572,7 @@ static struct rnode *rlist_detach_rank (struct rlist *rl, uint32_t rank)
     if (n) {
         zlistx_detach (rl->nodes, zlistx_find (rl->nodes, n));
         rank_hash_delete (rl, rank);
+        host_hash_delete (rl, n);
     }
     return n;
 }
@@ -998,6 +1076,7 @@ err:
 static int rlist_assign_hostlist (struct rlist *rl, struct hostlist *hl)
 {
     struct rnode *n;
+    int rc = 0;
 
     if (!hl || hostlist_count (hl) != zlistx_size (rl->nodes))
         return -1;
@@ -1011,12 +1090,16 @@ static int rlist_assign_hostlist (struct rlist *rl, struct hostlist *hl)
     (void) hostlist_first (hl);
     while (n) {
         free (n->hostname);
-        if (!(n->hostname = strdup (hostlist_current (hl))))
-            return -1;
+        if (!(n->hostname = strdup (hostlist_current (hl)))) {
+            rc = -1;
+            break;
+        }
         (void) hostlist_next (hl);
         n = zlistx_next (rl->nodes);
     }
-    return 0;
+    if (host_hash_rebuild (rl) < 0)
+        rc = -1;
+    return rc;
 }
 
 int rlist_assign_hosts (struct rlist *rl, const char *hosts)
@@ -1508,14 +1591,13 @@ static int rlist_idset_set_by_host (const struct rlist *rl,
                                     const char *host)
 {
     int count = 0;
-    struct rnode *n = zlistx_first (rl->nodes);
+    zlistx_t *l = host_hash_lookup (rl, host);
+    struct rnode *n = l ? zlistx_first (l) : NULL;
     while (n) {
-        if (n->hostname && streq (n->hostname, host)) {
-            if (idset_set (ids, n->rank) < 0)
-                return -1;
-            count++;
-        }
-        n = zlistx_next (rl->nodes);
+        if (idset_set (ids, n->rank) < 0)
+            return -1;
+        count++;
+        n = zlistx_next (l);
     }
     return count;
 }
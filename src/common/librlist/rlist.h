@@ -34,6 +34,9 @@ struct rlist {
 
     zhashx_t *rank_index;
 
+    /*  hash of hostname -> list of rnodes with that hostname */
+    zhashx_t *host_index;
+
     /*  hash of resources to ignore on remap */
     zhashx_t *noremap;
 
@@ -0,0 +1,874 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* rv1pool.c - native allocator for the Python Rv1Pool scheduler layer
+ *
+ * This implements the same candidate filtering, worst-fit ordering,
+ * selection and feasibility checks as Rv1Pool.alloc() and
+ * Rv1Pool._check_feasibility() in src/bindings/python/flux/resource,
+ * including the text of the feasibility error messages.  Keep them in sync.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <flux/idset.h>
+#include <jansson.h>
+
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
+#include "rnode.h"
+#include "rlist.h"
+#include "rv1pool.h"
+
+/* Immutable topology shared by a pool and its copies.
+ */
+struct topology {
+    int refcount;
+    struct rlist *rl;
+};
+
+struct pool_node {
+    uint32_t rank;
+    const struct idset *cores;  /* all cores (owned by topology) */
+    const struct idset *gpus;   /* all gpus or NULL (owned by topology) */
+    int ncores;
+    int ngpus;
+
+    bool up;
+    struct idset *free_cores;
+    struct idset *free_gpus;    /* NULL if node has no gpus */
+    int nfree_cores;
+    int nfree_gpus;
+};
+
+struct rv1pool {
+    struct topology *topo;
+    struct pool_node *nodes;    /* sorted by rank */
+    int count;
+};
+
+/* A node chosen by rv1pool_alloc() along with how much to take from it.
+ */
+struct selection {
+    struct pool_node *node;
+    int ncores;
+    int ngpus;
+};
+
+static void topology_decref (struct topology *topo)
+{
+    if (topo && --topo->refcount == 0) {
+        int saved_errno = errno;
+        rlist_destroy (topo->rl);
+        free (topo);
+        errno = saved_errno;
+    }
+}
+
+static void pool_node_clear (struct pool_node *node)
+{
+    idset_destroy (node->free_cores);
+    idset_destroy (node->free_gpus);
+    node->free_cores = NULL;
+    node->free_gpus = NULL;
+}
+
+void rv1pool_destroy (struct rv1pool *pool)
+{
+    if (pool) {
+        int saved_errno = errno;
+        for (int i = 0; i < pool->count; i++)
+            pool_node_clear (&pool->nodes[i]);
+        free (pool->nodes);
+        topology_decref (pool->topo);
+        free (pool);
+        errno = saved_errno;
+    }
+}
+
+static int pool_node_cmp (const void *a, const void *b)
+{
+    const struct pool_node *x = a;
+    const struct pool_node *y = b;
+
+    if (x->rank < y->rank)
+        return -1;
+    return x->rank > y->rank ? 1 : 0;
+}
+
+static int pool_node_init (struct pool_node *node, const struct rnode *n)
+{
+    struct rnode_child *gpu = zhashx_lookup (n->children, "gpu");
+
+    node->rank = n->rank;
+    node->cores = n->cores->ids;
+    node->ncores = idset_count (node->cores);
+    if (gpu && idset_count (gpu->ids) > 0) {
+        node->gpus = gpu->ids;
+        node->ngpus = idset_count (gpu->ids);
+    }
+    node->up = true;
+    if (!(node->free_cores = idset_copy (node->cores))
+        || (node->gpus && !(node->free_gpus = idset_copy (node->gpus))))
+        return -1;
+    node->nfree_cores = node->ncores;
+    node->nfree_gpus = node->ngpus;
+    return 0;
+}
+
+struct rv1pool *rv1pool_create (const char *R, flux_error_t *errp)
+{
+    struct rv1pool *pool;
+    struct rnode *n;
+
+    if (!R) {
+        errno = EINVAL;
+        errprintf (errp, "Invalid argument");
+        return NULL;
+    }
+    if (!(pool = calloc (1, sizeof (*pool)))
+        || !(pool->topo = calloc (1, sizeof (*pool->topo))))
+        goto nomem;
+    pool->topo->refcount = 1;
+    if (!(pool->topo->rl = rlist_from_R (R))) {
+        errprintf (errp, "unable to parse R");
+        errno = EINVAL;
+        goto error;
+    }
+    if (rlist_nnodes (pool->topo->rl) > 0
+        && !(pool->nodes = calloc (rlist_nnodes (pool->topo->rl),
+                                   sizeof (pool->nodes[0]))))
+        goto nomem;
+    n = zlistx_first (pool->topo->rl->nodes);
+    while (n) {
+        if (pool_node_init (&pool->nodes[pool->count++], n) < 0)
+            goto nomem;
+        n = zlistx_next (pool->topo->rl->nodes);
+    }
+    qsort (pool->nodes, pool->count, sizeof (pool->nodes[0]), pool_node_cmp);
+    return pool;
+nomem:
+    errprintf (errp, "Out of memory");
+    errno = ENOMEM;
+error:
+    rv1pool_destroy (pool);
+    return NULL;
+}
+
+struct rv1pool *rv1pool_copy (const struct rv1pool *pool)
+{
+    struct rv1pool *cpy;
+
+    if (!pool) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(cpy = calloc (1, sizeof (*cpy))))
+        return NULL;
+    cpy->topo = pool->topo;
+    cpy->topo->refcount++;
+    if (pool->count > 0) {
+        if (!(cpy->nodes = malloc (pool->count * sizeof (cpy->nodes[0]))))
+            goto error;
+        for (int i = 0; i < pool->count; i++) {
+            struct pool_node *node = &cpy->nodes[cpy->count++];
+
+            *node = pool->nodes[i];
+            node->free_cores = idset_copy (pool->nodes[i].free_cores);
+            node->free_gpus = NULL;
+            if (!node->free_cores
+                || (pool->nodes[i].free_gpus
+                    && !(node->free_gpus =
+                         idset_copy (pool->nodes[i].free_gpus))))
+                goto error;
+        }
+    }
+    return cpy;
+error:
+    rv1pool_destroy (cpy);
+    return NULL;
+}
+
+int rv1pool_nnodes (const struct rv1pool *pool)
+{
+    return pool ? pool->count : 0;
+}
+
+static struct pool_node *pool_lookup (const struct rv1pool *pool,
+                                      uint32_t rank)
+{
+    struct pool_node key = { .rank = rank };
+
+    if (pool->count == 0)
+        return NULL;
+    return bsearch (&key,
+                    pool->nodes,
+                    pool->count,
+                    sizeof (pool->nodes[0]),
+                    pool_node_cmp);
+}
+
+static int pool_mark (struct rv1pool *pool, const char *ids, bool up)
+{
+    struct idset *idset;
+    unsigned int id;
+
+    if (!pool || !ids) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (streq (ids, "all")) {
+        for (int i = 0; i < pool->count; i++)
+            pool->nodes[i].up = up;
+        return 0;
+    }
+    if (!(idset = idset_decode (ids)))
+        return -1;
+    id = idset_first (idset);
+    while (id != IDSET_INVALID_ID) {
+        struct pool_node *node;
+        if ((node = pool_lookup (pool, id)))
+            node->up = up;
+        id = idset_next (idset, id);
+    }
+    idset_destroy (idset);
+    return 0;
+}
+
+int rv1pool_mark_up (struct rv1pool *pool, const char *ids)
+{
+    return pool_mark (pool, ids, true);
+}
+
+int rv1pool_mark_down (struct rv1pool *pool, const char *ids)
+{
+    return pool_mark (pool, ids, false);
+}
+
+int rv1pool_remove_ranks (struct rv1pool *pool, const char *ids)
+{
+    struct idset *idset;
+    int count = 0;
+
+    if (!pool || !ids) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(idset = idset_decode (ids)))
+        return -1;
+    for (int i = 0; i < pool->count; i++) {
+        if (idset_test (idset, pool->nodes[i].rank))
+            pool_node_clear (&pool->nodes[i]);
+        else
+            pool->nodes[count++] = pool->nodes[i];
+    }
+    pool->count = count;
+    idset_destroy (idset);
+    return 0;
+}
+
+/* Remove 'ids' from the free set 'avail', or return the members of 'ids'
+ * that are also in 'all' to it.  Return the new free count, or -1 on error.
+ */
+static int free_set_update (struct idset *avail,
+                            const struct idset *all,
+                            const struct idset *ids,
+                            bool alloc)
+{
+    struct idset *valid;
+
+    if (alloc) {
+        if (idset_subtract (avail, ids) < 0)
+            return -1;
+    }
+    else {
+        if (!(valid = idset_intersect (ids, all)))
+            return -1;
+        if (idset_add (avail, valid) < 0) {
+            ERRNO_SAFE_WRAP (idset_destroy, valid);
+            return -1;
+        }
+        idset_destroy (valid);
+    }
+    return idset_count (avail);
+}
+
+/* Apply one R_lite entry to the free sets.  Only the rank, core and gpu
+ * idsets are needed here, so decode them directly rather than building an
+ * rlist, which is much more expensive for the small R objects of a single
+ * allocation.
+ */
+static int pool_update_entry (struct rv1pool *pool, json_t *entry, bool alloc)
+{
+    const char *ranks_s;
+    const char *cores_s = NULL;
+    const char *gpus_s = NULL;
+    struct idset *ranks = NULL;
+    struct idset *cores = NULL;
+    struct idset *gpus = NULL;
+    unsigned int rank;
+    int rc = -1;
+
+    if (json_unpack (entry,
+                     "{s:s s:{s?s s?s}}",
+                     "rank", &ranks_s,
+                     "children",
+                       "core", &cores_s,
+                       "gpu", &gpus_s) < 0
+        || !(ranks = idset_decode (ranks_s))
+        || (cores_s && !(cores = idset_decode (cores_s)))
+        || (gpus_s && !(gpus = idset_decode (gpus_s)))) {
+        errno = EINVAL;
+        goto out;
+    }
+    rank = idset_first (ranks);
+    while (rank != IDSET_INVALID_ID) {
+        struct pool_node *node;
+
+        if ((node = pool_lookup (pool, rank))) {
+            int count;
+
+            if (cores) {
+                if ((count = free_set_update (node->free_cores,
+                                              node->cores,
+                                              cores,
+                                              alloc)) < 0)
+                    goto out;
+                node->nfree_cores = count;
+            }
+            if (node->free_gpus && gpus) {
+                if ((count = free_set_update (node->free_gpus,
+                                              node->gpus,
+                                              gpus,
+                                              alloc)) < 0)
+                    goto out;
+                node->nfree_gpus = count;
+            }
+        }
+        rank = idset_next (ranks, rank);
+    }
+    rc = 0;
+out:
+    ERRNO_SAFE_WRAP (idset_destroy, ranks);
+    ERRNO_SAFE_WRAP (idset_destroy, cores);
+    ERRNO_SAFE_WRAP (idset_destroy, gpus);
+    return rc;
+}
+
+static int pool_update (struct rv1pool *pool, const char *R, bool alloc)
+{
+    json_t *o = NULL;
+    json_t *R_lite;
+    json_t *entry;
+    size_t index;
+    int version;
+    int rc = -1;
+
+    if (!pool || !R) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(o = json_loads (R, 0, NULL))
+        || json_unpack (o,
+                        "{s:i s:{s:o}}",
+                        "version", &version,
+                        "execution",
+                          "R_lite", &R_lite) < 0
+        || version != 1
+        || !json_is_array (R_lite)) {
+        errno = EINVAL;
+        goto out;
+    }
+    json_array_foreach (R_lite, index, entry) {
+        if (pool_update_entry (pool, entry, alloc) < 0)
+            goto out;
+    }
+    rc = 0;
+out:
+    ERRNO_SAFE_WRAP (json_decref, o);
+    return rc;
+}
+
+int rv1pool_set_allocated (struct rv1pool *pool, const char *R)
+{
+    return pool_update (pool, R, true);
+}
+
+int rv1pool_clear_allocated (struct rv1pool *pool, const char *R)
+{
+    return pool_update (pool, R, false);
+}
+
+static int request_check (const struct rv1pool_request *req,
+                          flux_error_t *errp)
+{
+    if (!req
+        || req->nnodes < 0
+        || req->nslots < 0
+        || req->gpu_per_slot < 0
+        || (req->nnodes == 0 && req->slot_size <= 0)) {
+        errno = EINVAL;
+        return errprintf (errp, "invalid resource request");
+    }
+    return 0;
+}
+
+/* Worst-fit: descending free cores, then free GPUs.  Ties are broken by
+ * rank so that the order is stable.
+ */
+static int candidate_cmp (const void *a, const void *b)
+{
+    const struct pool_node *x = *(const struct pool_node **)a;
+    const struct pool_node *y = *(const struct pool_node **)b;
+
+    if (x->nfree_cores != y->nfree_cores)
+        return y->nfree_cores - x->nfree_cores;
+    if (x->nfree_gpus != y->nfree_gpus)
+        return y->nfree_gpus - x->nfree_gpus;
+    return x->rank < y->rank ? -1 : 1;
+}
+
+static int candidates_get (struct rv1pool *pool,
+                           const struct rv1pool_request *req,
+                           const struct idset *ranks,
+                           struct pool_node **candidates)
+{
+    int count = 0;
+
+    for (int i = 0; i < pool->count; i++) {
+        struct pool_node *node = &pool->nodes[i];
+        int needed_cores = req->exclusive ? node->ncores : req->slot_size;
+
+        if (!node->up
+            || node->nfree_cores < needed_cores
+            || (req->gpu_per_slot > 0
+                && node->nfree_gpus < req->gpu_per_slot)
+            || (ranks && !idset_test (ranks, node->rank)))
+            continue;
+        candidates[count++] = node;
+    }
+    qsort (candidates, count, sizeof (candidates[0]), candidate_cmp);
+    return count;
+}
+
+static int select_nodes (const struct rv1pool_request *req,
+                         struct pool_node **candidates,
+                         int ncandidates,
+                         struct selection *selected,
+                         int *nslotsp)
+{
+    int slots_per_node = req->nslots / req->nnodes;
+    int need_cores = slots_per_node * req->slot_size;
+    int need_gpus = slots_per_node * req->gpu_per_slot;
+    int count = 0;
+
+    for (int i = 0; i < ncandidates; i++) {
+        struct pool_node *node = candidates[i];
+
+        if (req->nnodes_max >= 0 && count >= req->nnodes_max)
+            break;
+        if (req->exclusive) {
+            if (node->nfree_cores < node->ncores)
+                continue;
+            selected[count].ncores = node->nfree_cores;
+            selected[count].ngpus = node->nfree_gpus;
+        }
+        else {
+            if (node->nfree_cores < need_cores
+                || node->nfree_gpus < need_gpus)
+                continue;
+            selected[count].ncores = need_cores;
+            selected[count].ngpus = need_gpus;
+        }
+        selected[count++].node = node;
+    }
+    if (count < req->nnodes)
+        return -1;
+    *nslotsp = slots_per_node * count;
+    return count;
+}
+
+static int select_slots (const struct rv1pool_request *req,
+                         struct pool_node **candidates,
+                         int ncandidates,
+                         struct selection *selected,
+                         int *nslotsp)
+{
+    int allocated_slots = 0;
+    int count = 0;
+
+    for (int i = 0; i < ncandidates; i++) {
+        struct pool_node *node = candidates[i];
+        int free_slots = node->nfree_cores / req->slot_size;
+        int take;
+
+        if (req->nslots_max >= 0 && allocated_slots >= req->nslots_max)
+            break;
+        if (req->gpu_per_slot > 0) {
+            int free_gpu_slots = node->nfree_gpus / req->gpu_per_slot;
+            if (free_gpu_slots < free_slots)
+                free_slots = free_gpu_slots;
+        }
+        take = free_slots;
+        if (req->nslots_max >= 0 && req->nslots_max - allocated_slots < take)
+            take = req->nslots_max - allocated_slots;
+        if (take > 0) {
+            selected[count].node = node;
+            selected[count].ncores = take * req->slot_size;
+            selected[count].ngpus = take * req->gpu_per_slot;
+            count++;
+            allocated_slots += take;
+        }
+    }
+    if (allocated_slots < req->nslots)
+        return -1;
+    *nslotsp = allocated_slots;
+    return count;
+}
+
+/* Take the 'count' lowest ids from 'avail' and return them as a JSON array.
+ */
+static json_t *take_ids (struct idset *avail, int count)
+{
+    json_t *ids;
+    unsigned int id;
+
+    if (!(ids = json_array ()))
+        return NULL;
+    id = idset_first (avail);
+    while (count-- > 0 && id != IDSET_INVALID_ID) {
+        json_t *o;
+        if (!(o = json_integer (id)) || json_array_append_new (ids, o) < 0) {
+            json_decref (ids);
+            return NULL;
+        }
+        id = idset_next (avail, id);
+    }
+    return ids;
+}
+
+static int clear_ids (struct idset *avail, json_t *ids)
+{
+    size_t index;
+    json_t *o;
+
+    json_array_foreach (ids, index, o) {
+        if (idset_clear (avail, json_integer_value (o)) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static json_t *selection_apply (struct selection *sel)
+{
+    struct pool_node *node = sel->node;
+    json_t *cores = NULL;
+    json_t *gpus = NULL;
+    json_t *entry;
+
+    if (!(cores = take_ids (node->free_cores, sel->ncores))
+        || (node->free_gpus
+            ? !(gpus = take_ids (node->free_gpus, sel->ngpus))
+            : !(gpus = json_array ()))
+        || !(entry = json_pack ("[IOO]",
+                                (json_int_t)node->rank,
+                                cores,
+                                gpus)))
+        goto error;
+    if (clear_ids (node->free_cores, cores) < 0
+        || (node->free_gpus && clear_ids (node->free_gpus, gpus) < 0)) {
+        json_decref (entry);
+        goto error;
+    }
+    node->nfree_cores = idset_count (node->free_cores);
+    if (node->free_gpus)
+        node->nfree_gpus = idset_count (node->free_gpus);
+    json_decref (cores);
+    json_decref (gpus);
+    return entry;
+error:
+    json_decref (cores);
+    json_decref (gpus);
+    return NULL;
+}
+
+char *rv1pool_alloc (struct rv1pool *pool,
+                     const struct rv1pool_request *req,
+                     const struct idset *ranks,
+                     flux_error_t *errp)
+{
+    struct pool_node **candidates = NULL;
+    struct selection *selected = NULL;
+    int ncandidates;
+    int nselected;
+    int nslots = 0;
+    json_t *result = NULL;
+    json_t *entries;
+    char *s = NULL;
+
+    if (!pool) {
+        errno = EINVAL;
+        errprintf (errp, "Invalid argument");
+        return NULL;
+    }
+    if (request_check (req, errp) < 0)
+        return NULL;
+    if (pool->count > 0
+        && (!(candidates = calloc (pool->count, sizeof (candidates[0])))
+            || !(selected = calloc (pool->count, sizeof (selected[0])))))
+        goto nomem;
+    ncandidates = candidates_get (pool, req, ranks, candidates);
+    if (req->nnodes > 0)
+        nselected = select_nodes (req,
+                                  candidates,
+                                  ncandidates,
+                                  selected,
+                                  &nslots);
+    else
+        nselected = select_slots (req,
+                                  candidates,
+                                  ncandidates,
+                                  selected,
+                                  &nslots);
+    if (nselected < 0) {
+        errprintf (errp, "insufficient resources");
+        errno = ENOSPC;
+        goto out;
+    }
+    if (!(result = json_pack ("{s:i s:[]}", "nslots", nslots, "ranks")))
+        goto nomem;
+    entries = json_object_get (result, "ranks");
+    for (int i = 0; i < nselected; i++) {
+        json_t *entry;
+        if (!(entry = selection_apply (&selected[i]))
+            || json_array_append_new (entries, entry) < 0)
+            goto nomem;
+    }
+    if (!(s = json_dumps (result, JSON_COMPACT)))
+        goto nomem;
+out:
+    json_decref (result);
+    free (candidates);
+    free (selected);
+    return s;
+nomem:
+    errprintf (errp, "Out of memory");
+    errno = ENOMEM;
+    goto out;
+}
+
+int rv1pool_check_feasibility (const struct rv1pool *pool,
+                               const struct rv1pool_request *req,
+                               const struct idset *ranks,
+                               flux_error_t *errp)
+{
+    int eligible = 0;
+
+    if (!pool) {
+        errno = EINVAL;
+        return errprintf (errp, "Invalid argument");
+    }
+    if (request_check (req, errp) < 0)
+        return -1;
+
+    if (req->exclusive) {
+        int need_nodes = req->nnodes > 1 ? req->nnodes : 1;
+
+        for (int i = 0; i < pool->count; i++) {
+            const struct pool_node *node = &pool->nodes[i];
+            if ((!ranks || idset_test (ranks, node->rank))
+                && node->ncores >= req->slot_size
+                && (req->gpu_per_slot == 0
+                    || node->ngpus >= req->gpu_per_slot))
+                eligible++;
+        }
+        if (eligible < need_nodes) {
+            errno = EOVERFLOW;
+            return errprintf (errp,
+                              "unsatisfiable request: need %d exclusive "
+                              "node(s), only %d eligible",
+                              need_nodes,
+                              eligible);
+        }
+        return 0;
+    }
+
+    if (req->nnodes > 0) {
+        int slots_per_node = req->nslots / req->nnodes;
+        int cores_per_node = slots_per_node * req->slot_size;
+        int gpus_per_node = slots_per_node * req->gpu_per_slot;
+        char gpus[64] = "";
+
+        for (int i = 0; i < pool->count; i++) {
+            const struct pool_node *node = &pool->nodes[i];
+            if ((!ranks || idset_test (ranks, node->rank))
+                && node->ncores >= cores_per_node
+                && node->ngpus >= gpus_per_node)
+                eligible++;
+        }
+        if (eligible < req->nnodes) {
+            if (gpus_per_node > 0)
+                snprintf (gpus, sizeof (gpus), " and %d GPUs", gpus_per_node);
+            errno = EOVERFLOW;
+            return errprintf (errp,
+                              "unsatisfiable request: need %d node(s) with "
+                              "%d cores%s each, only %d eligible",
+                              req->nnodes,
+                              cores_per_node,
+                              gpus,
+                              eligible);
+        }
+        return 0;
+    }
+
+    /* A slot must fit within a single rank, so check per-rank slot
+     * capacity rather than total cores across all ranks.
+     */
+    long total_slots = 0;
+    long total_cores = 0;
+    long total_gpu_slots = 0;
+    long total_gpus = 0;
+
+    for (int i = 0; i < pool->count; i++) {
+        const struct pool_node *node = &pool->nodes[i];
+        int slots = node->ncores / req->slot_size;
+
+        if (ranks && !idset_test (ranks, node->rank))
+            continue;
+        total_slots += slots;
+        total_cores += node->ncores;
+        total_gpus += node->ngpus;
+        if (req->gpu_per_slot > 0) {
+            int gpu_slots = node->ngpus / req->gpu_per_slot;
+            total_gpu_slots += gpu_slots < slots ? gpu_slots : slots;
+        }
+    }
+    if (total_slots < req->nslots) {
+        errno = EOVERFLOW;
+        return errprintf (errp,
+                          "unsatisfiable request: need %d slot(s) of "
+                          "%d core(s), only %ld such slot(s) available "
+                          "(total cores: %ld)",
+                          req->nslots,
+                          req->slot_size,
+                          total_slots,
+                          total_cores);
+    }
+    if (req->gpu_per_slot > 0 && total_gpu_slots < req->nslots) {
+        errno = EOVERFLOW;
+        return errprintf (errp,
+                          "unsatisfiable request: need %d slot(s) with "
+                          "%d GPU(s) each, only %ld available "
+                          "(total GPUs: %ld)",
+                          req->nslots,
+                          req->gpu_per_slot,
+                          total_gpu_slots,
+                          total_gpus);
+    }
+    return 0;
+}
+
+/* Append the members of 'all' that are not in 'avail' to JSON array 'ids'.
+ */
+static int append_allocated (json_t *ids,
+                             const struct idset *all,
+                             const struct idset *avail)
+{
+    unsigned int id;
+
+    if (!all)
+        return 0;
+    id = idset_first (all);
+    while (id != IDSET_INVALID_ID) {
+        if (!idset_test (avail, id)) {
+            json_t *o;
+            if (!(o = json_integer (id))
+                || json_array_append_new (ids, o) < 0)
+                return -1;
+        }
+        id = idset_next (all, id);
+    }
+    return 0;
+}
+
+char *rv1pool_allocated (const struct rv1pool *pool)
+{
+    json_t *o;
+    char *s = NULL;
+
+    if (!pool) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(o = json_array ()))
+        goto nomem;
+    for (int i = 0; i < pool->count; i++) {
+        const struct pool_node *node = &pool->nodes[i];
+        json_t *entry;
+
+        if (node->nfree_cores == node->ncores
+            && node->nfree_gpus == node->ngpus)
+            continue;
+        if (!(entry = json_pack ("[I[][]]", (json_int_t)node->rank))
+            || json_array_append_new (o, entry) < 0)
+            goto nomem;
+        if (append_allocated (json_array_get (entry, 1),
+                              node->cores,
+                              node->free_cores) < 0
+            || append_allocated (json_array_get (entry, 2),
+                                 node->gpus,
+                                 node->free_gpus) < 0)
+            goto nomem;
+    }
+    if (!(s = json_dumps (o, JSON_COMPACT)))
+        goto nomem;
+    json_decref (o);
+    return s;
+nomem:
+    json_decref (o);
+    errno = ENOMEM;
+    return NULL;
+}
+
+char *rv1pool_down (const struct rv1pool *pool)
+{
+    struct idset *ids;
+    char *s;
+
+    if (!pool) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW)))
+        return NULL;
+    for (int i = 0; i < pool->count; i++) {
+        if (!pool->nodes[i].up && idset_set (ids, pool->nodes[i].rank) < 0) {
+            idset_destroy (ids);
+            return NULL;
+        }
+    }
+    s = idset_encode (ids, IDSET_FLAG_RANGE);
+    ERRNO_SAFE_WRAP (idset_destroy, ids);
+    return s;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
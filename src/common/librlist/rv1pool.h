@@ -0,0 +1,114 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef HAVE_RV1POOL_H
+#define HAVE_RV1POOL_H 1
+
+#include <stdbool.h>
+#include <flux/idset.h>
+
+#include "src/common/libflux/types.h" /* flux_error_t */
+
+/*  Native allocator state for the Python Rv1Pool scheduler layer.
+ *
+ *  An rv1pool tracks up/down state and free cores and GPUs per rank,
+ *  and implements the Rv1Pool worst-fit allocation and feasibility
+ *  policy.  Topology (rank, cores, gpus) is immutable and shared between
+ *  copies, so rv1pool_copy() only duplicates the per-rank free sets.
+ *
+ *  Ranks are kept in ascending rank order, which is the order used to
+ *  break ties between equally loaded candidates.
+ */
+struct rv1pool;
+
+struct rv1pool_request {
+    int nnodes;         /* minimum node count, 0 for slot-only requests */
+    int nnodes_max;     /* maximum node count, -1 for unbounded */
+    int nslots;         /* minimum total slot count */
+    int nslots_max;     /* maximum total slot count, -1 for unbounded */
+    int slot_size;      /* cores per slot */
+    int gpu_per_slot;   /* GPUs per slot */
+    bool exclusive;     /* whole node allocation */
+};
+
+/*  Create a pool from the R_lite of Rv1 JSON string 'R'.
+ *  All ranks are up and all resources are free.
+ *  Returns NULL with errno set and errp filled if non-NULL on failure.
+ */
+struct rv1pool *rv1pool_create (const char *R, flux_error_t *errp);
+
+/*  Return a copy of 'pool' including up/down and allocation state.
+ */
+struct rv1pool *rv1pool_copy (const struct rv1pool *pool);
+
+void rv1pool_destroy (struct rv1pool *pool);
+
+/*  Return the number of ranks in 'pool'.
+ */
+int rv1pool_nnodes (const struct rv1pool *pool);
+
+/*  Mark the ranks in idset string 'ids', or "all", up or down.
+ *  Ranks not in the pool are ignored.
+ */
+int rv1pool_mark_up (struct rv1pool *pool, const char *ids);
+int rv1pool_mark_down (struct rv1pool *pool, const char *ids);
+
+/*  Remove the ranks in idset string 'ids' from the pool.
+ *  Ranks not in the pool are ignored.
+ */
+int rv1pool_remove_ranks (struct rv1pool *pool, const char *ids);
+
+/*  Mark the resources in Rv1 JSON string 'R' allocated or free.
+ *  Ranks not in the pool are ignored, as are resources that are already
+ *  in the requested state.
+ */
+int rv1pool_set_allocated (struct rv1pool *pool, const char *R);
+int rv1pool_clear_allocated (struct rv1pool *pool, const char *R);
+
+/*  Allocate resources for 'req' from up ranks in 'ranks' (all ranks if
+ *  NULL), e.g. the ranks matching the job's constraints.
+ *
+ *  On success the resources are marked allocated and a JSON object string
+ *  is returned, which the caller must free():
+ *
+ *    {"nslots":i, "ranks":[[rank, [core, ...], [gpu, ...]], ...]}
+ *
+ *  On failure, NULL is returned with errno set:
+ *  ENOSPC - resources are currently insufficient.  Use
+ *           rv1pool_check_feasibility() to determine if the request
+ *           can ever be satisfied.
+ *  EINVAL - invalid request
+ */
+char *rv1pool_alloc (struct rv1pool *pool,
+                     const struct rv1pool_request *req,
+                     const struct idset *ranks,
+                     flux_error_t *errp);
+
+/*  Check whether 'req' could be satisfied by the total resources of the
+ *  ranks in 'ranks' (all ranks if NULL), ignoring up/down and allocation
+ *  state.  Returns 0 if so.  Otherwise -1 is returned with errno set to
+ *  EOVERFLOW and the reason in errp, or EINVAL for an invalid request.
+ */
+int rv1pool_check_feasibility (const struct rv1pool *pool,
+                               const struct rv1pool_request *req,
+                               const struct idset *ranks,
+                               flux_error_t *errp);
+
+/*  Return allocated resources as a JSON array string, which the caller
+ *  must free(), in the same form as the rv1pool_alloc() "ranks" array.
+ *  Ranks with no allocated resources are omitted.
+ */
+char *rv1pool_allocated (const struct rv1pool *pool);
+
+/*  Return the idset string of down ranks, which the caller must free().
+ */
+char *rv1pool_down (const struct rv1pool *pool);
+
+#endif /* !HAVE_RV1POOL_H */
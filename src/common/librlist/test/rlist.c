@@ -1191,6 +1191,59 @@ void test_hosts_to_ranks (void)
     }
 }
 
+static void check_hosts_to_ranks (struct rlist *rl,
+                                  const char *hosts,
+                                  const char *expected)
+{
+    flux_error_t err;
+    struct idset *ids = rlist_hosts_to_ranks (rl, hosts, &err);
+    char *s = NULL;
+
+    if (ids && !(s = idset_encode (ids, IDSET_FLAG_RANGE)))
+        BAIL_OUT ("idset_encode failed");
+    if (expected)
+        is (s, expected,
+            "rlist_hosts_to_ranks (rl, %s) = %s", hosts, s);
+    else
+        ok (ids == NULL,
+            "rlist_hosts_to_ranks (rl, %s) fails: %s", hosts, err.text);
+    free (s);
+    idset_destroy (ids);
+}
+
+void test_hosts_to_ranks_update (void)
+{
+    char *R;
+    struct rlist *rl;
+    struct idset *ranks;
+
+    if (!(R = R_create ("0-7", "0-1", NULL, "foo[0-7]", NULL)))
+        BAIL_OUT ("R_create");
+    if (!(rl = rlist_from_R (R)))
+        BAIL_OUT ("rlist_from_R");
+    if (!(ranks = idset_decode ("2-3")))
+        BAIL_OUT ("idset_decode");
+
+    ok (rlist_remove_ranks (rl, ranks) == 2,
+        "rlist_remove_ranks removed 2 ranks");
+    check_hosts_to_ranks (rl, "foo[0-1,4-7]", "0-1,4-7");
+    check_hosts_to_ranks (rl, "foo2", NULL);
+
+    ok (rlist_rerank (rl, "foo[7,6,5,4,1,0]", NULL) == 0,
+        "rlist_rerank works");
+    check_hosts_to_ranks (rl, "foo7", "0");
+    check_hosts_to_ranks (rl, "foo[0,4]", "3,5");
+
+    ok (rlist_assign_hosts (rl, "bar[0-5]") == 0,
+        "rlist_assign_hosts works");
+    check_hosts_to_ranks (rl, "bar[0-5]", "0-5");
+    check_hosts_to_ranks (rl, "foo0", NULL);
+
+    idset_destroy (ranks);
+    rlist_destroy (rl);
+    free (R);
+}
+
 struct property_test {
     const char *desc;
     const char *ranks;
@@ -1536,6 +1589,7 @@ int main (int ac, char *av[])
     test_assign_hosts ();
     test_rerank ();
     test_hosts_to_ranks ();
+    test_hosts_to_ranks_update ();
     test_properties ();
     test_rlist_config_inval ();
     test_issue_5868 ();
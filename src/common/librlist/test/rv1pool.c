@@ -0,0 +1,368 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* Test native Rv1Pool allocator */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
+#include "rv1pool.h"
+
+/* ranks 0-1: 4 cores, ranks 2-3: 4 cores and 2 gpus */
+static const char R_gpu[] = "\
+{\"version\":1,\"execution\":{\"R_lite\":[\
+{\"rank\":\"0-1\",\"children\":{\"core\":\"0-3\"}},\
+{\"rank\":\"2-3\",\"children\":{\"core\":\"0-3\",\"gpu\":\"0-1\"}}\
+]}}";
+
+/* ranks 0-3: 4 cores */
+static const char R_4x4[] = "\
+{\"version\":1,\"execution\":{\"R_lite\":[\
+{\"rank\":\"0-3\",\"children\":{\"core\":\"0-3\"}}\
+]}}";
+
+static struct rv1pool *pool_create (const char *R)
+{
+    struct rv1pool *pool;
+    flux_error_t error;
+
+    if (!(pool = rv1pool_create (R, &error)))
+        BAIL_OUT ("rv1pool_create failed: %s", error.text);
+    return pool;
+}
+
+static struct rv1pool_request slots (int nslots, int slot_size, int gpus)
+{
+    struct rv1pool_request req = {
+        .nnodes = 0,
+        .nnodes_max = 0,
+        .nslots = nslots,
+        .nslots_max = nslots,
+        .slot_size = slot_size,
+        .gpu_per_slot = gpus,
+        .exclusive = false,
+    };
+    return req;
+}
+
+static struct rv1pool_request nodes (int nnodes, int slot_size, bool excl)
+{
+    struct rv1pool_request req = {
+        .nnodes = nnodes,
+        .nnodes_max = nnodes,
+        .nslots = nnodes,
+        .nslots_max = nnodes,
+        .slot_size = slot_size,
+        .gpu_per_slot = 0,
+        .exclusive = excl,
+    };
+    return req;
+}
+
+/* Allocate 'req' and compare the result with 'expected'.
+ */
+static bool alloc_is (struct rv1pool *pool,
+                      struct rv1pool_request req,
+                      const struct idset *ranks,
+                      const char *expected)
+{
+    flux_error_t error;
+    char *s;
+    bool result;
+
+    if (!(s = rv1pool_alloc (pool, &req, ranks, &error))) {
+        diag ("rv1pool_alloc: %s", error.text);
+        return false;
+    }
+    result = streq (s, expected);
+    if (!result)
+        diag ("got %s, expected %s", s, expected);
+    free (s);
+    return result;
+}
+
+static bool allocated_is (struct rv1pool *pool, const char *expected)
+{
+    char *s;
+    bool result;
+
+    if (!(s = rv1pool_allocated (pool)))
+        return false;
+    result = streq (s, expected);
+    if (!result)
+        diag ("got %s, expected %s", s, expected);
+    free (s);
+    return result;
+}
+
+static void test_invalid (void)
+{
+    struct rv1pool_request req = slots (1, 0, 0);
+    struct rv1pool *pool;
+    flux_error_t error;
+
+    errno = 0;
+    ok (rv1pool_create (NULL, NULL) == NULL && errno == EINVAL,
+        "rv1pool_create R=NULL fails with EINVAL");
+    errno = 0;
+    ok (rv1pool_create ("{", &error) == NULL && errno == EINVAL,
+        "rv1pool_create with invalid R fails with EINVAL");
+    errno = 0;
+    ok (rv1pool_copy (NULL) == NULL && errno == EINVAL,
+        "rv1pool_copy pool=NULL fails with EINVAL");
+    errno = 0;
+    ok (rv1pool_mark_up (NULL, "all") < 0 && errno == EINVAL,
+        "rv1pool_mark_up pool=NULL fails with EINVAL");
+
+    pool = pool_create (R_4x4);
+    errno = 0;
+    ok (rv1pool_alloc (pool, &req, NULL, &error) == NULL && errno == EINVAL,
+        "rv1pool_alloc with slot_size=0 fails with EINVAL");
+    errno = 0;
+    ok (rv1pool_alloc (pool, NULL, NULL, &error) == NULL && errno == EINVAL,
+        "rv1pool_alloc req=NULL fails with EINVAL");
+    errno = 0;
+    ok (rv1pool_mark_down (pool, "foo") < 0 && errno == EINVAL,
+        "rv1pool_mark_down with invalid idset fails with EINVAL");
+    rv1pool_destroy (pool);
+}
+
+static void test_worst_fit (void)
+{
+    struct rv1pool *pool = pool_create (R_gpu);
+
+    ok (rv1pool_nnodes (pool) == 4,
+        "rv1pool_create works");
+    ok (alloc_is (pool, slots (1, 1, 0), NULL,
+                  "{\"nslots\":1,\"ranks\":[[2,[0],[]]]}"),
+        "first 1 core slot goes to the first node with most free gpus");
+    ok (alloc_is (pool, slots (1, 1, 0), NULL,
+                  "{\"nslots\":1,\"ranks\":[[3,[0],[]]]}"),
+        "second 1 core slot goes to the least loaded node");
+    ok (alloc_is (pool, slots (1, 1, 0), NULL,
+                  "{\"nslots\":1,\"ranks\":[[0,[0],[]]]}"),
+        "ties are broken by rank");
+    ok (alloc_is (pool, slots (2, 2, 1), NULL,
+                  "{\"nslots\":2,\"ranks\":[[2,[1,2],[0]],[3,[1,2],[0]]]}"),
+        "gpu slots are allocated from gpu nodes only");
+    ok (allocated_is (pool,
+                      "[[0,[0],[]],[2,[0,1,2],[0]],[3,[0,1,2],[0]]]"),
+        "rv1pool_allocated reports allocated resources");
+    rv1pool_destroy (pool);
+}
+
+static void test_slot_range (void)
+{
+    struct rv1pool *pool = pool_create (R_4x4);
+    struct rv1pool_request req = slots (2, 2, 0);
+
+    req.nslots_max = -1;
+    ok (alloc_is (pool, req, NULL,
+                  "{\"nslots\":8,\"ranks\":[[0,[0,1,2,3],[]],"
+                  "[1,[0,1,2,3],[]],[2,[0,1,2,3],[]],[3,[0,1,2,3],[]]]}"),
+        "unbounded slot range takes everything");
+    rv1pool_destroy (pool);
+
+    pool = pool_create (R_4x4);
+    req.nslots_max = 3;
+    ok (alloc_is (pool, req, NULL,
+                  "{\"nslots\":3,\"ranks\":[[0,[0,1,2,3],[]],[1,[0,1],[]]]}"),
+        "bounded slot range stops at nslots_max");
+    rv1pool_destroy (pool);
+}
+
+static void test_nodes (void)
+{
+    struct rv1pool *pool = pool_create (R_4x4);
+    struct rv1pool_request req;
+    struct idset *ranks;
+    flux_error_t error;
+
+    ok (alloc_is (pool, slots (1, 1, 0), NULL,
+                  "{\"nslots\":1,\"ranks\":[[0,[0],[]]]}"),
+        "allocated a core on rank 0");
+    ok (alloc_is (pool, nodes (2, 1, true), NULL,
+                  "{\"nslots\":2,\"ranks\":[[1,[0,1,2,3],[]],"
+                  "[2,[0,1,2,3],[]]]}"),
+        "exclusive node allocation skips partially allocated nodes");
+    req = nodes (2, 1, true);
+    errno = 0;
+    ok (rv1pool_alloc (pool, &req, NULL, &error) == NULL && errno == ENOSPC,
+        "exclusive allocation of 2 more nodes fails with ENOSPC");
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) == 0,
+        "but the request is feasible");
+
+    if (!(ranks = idset_decode ("0")))
+        BAIL_OUT ("idset_decode failed");
+    req = nodes (1, 2, false);
+    ok (alloc_is (pool, req, ranks,
+                  "{\"nslots\":1,\"ranks\":[[0,[1,2],[]]]}"),
+        "allocation is restricted to eligible ranks");
+    idset_destroy (ranks);
+
+    req = nodes (1, 1, false);
+    req.nnodes_max = -1;
+    ok (alloc_is (pool, req, NULL,
+                  "{\"nslots\":2,\"ranks\":[[3,[0],[]],[0,[3],[]]]}"),
+        "unbounded node range takes every eligible node");
+    rv1pool_destroy (pool);
+}
+
+static void test_feasibility (void)
+{
+    struct rv1pool *pool = pool_create (R_gpu);
+    struct rv1pool_request req;
+    struct idset *ranks;
+    flux_error_t error;
+
+    req = nodes (5, 1, true);
+    errno = 0;
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) < 0
+        && errno == EOVERFLOW
+        && streq (error.text,
+                  "unsatisfiable request: need 5 exclusive node(s), "
+                  "only 4 eligible"),
+        "too many exclusive nodes is infeasible");
+
+    req = nodes (1, 8, false);
+    errno = 0;
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) < 0
+        && errno == EOVERFLOW
+        && streq (error.text,
+                  "unsatisfiable request: need 1 node(s) with 8 cores "
+                  "each, only 0 eligible"),
+        "node with too many cores is infeasible");
+
+    req = nodes (3, 1, false);
+    req.gpu_per_slot = 1;
+    errno = 0;
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) < 0
+        && errno == EOVERFLOW
+        && streq (error.text,
+                  "unsatisfiable request: need 3 node(s) with 1 cores "
+                  "and 1 GPUs each, only 2 eligible"),
+        "too many gpu nodes is infeasible");
+
+    req = slots (9, 2, 0);
+    errno = 0;
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) < 0
+        && errno == EOVERFLOW
+        && streq (error.text,
+                  "unsatisfiable request: need 9 slot(s) of 2 core(s), "
+                  "only 8 such slot(s) available (total cores: 16)"),
+        "too many slots is infeasible");
+
+    req = slots (5, 1, 1);
+    errno = 0;
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) < 0
+        && errno == EOVERFLOW
+        && streq (error.text,
+                  "unsatisfiable request: need 5 slot(s) with 1 GPU(s) "
+                  "each, only 4 available (total GPUs: 4)"),
+        "too many gpu slots is infeasible");
+
+    if (!(ranks = idset_decode ("0-1")))
+        BAIL_OUT ("idset_decode failed");
+    req = slots (1, 1, 1);
+    errno = 0;
+    ok (rv1pool_check_feasibility (pool, &req, ranks, &error) < 0
+        && errno == EOVERFLOW,
+        "gpu slot restricted to non-gpu ranks is infeasible");
+    idset_destroy (ranks);
+
+    ok (rv1pool_mark_down (pool, "all") == 0,
+        "rv1pool_mark_down all works");
+    req = slots (16, 1, 0);
+    ok (rv1pool_check_feasibility (pool, &req, NULL, &error) == 0,
+        "feasibility ignores down ranks");
+    errno = 0;
+    ok (rv1pool_alloc (pool, &req, NULL, &error) == NULL && errno == ENOSPC,
+        "but allocation fails with ENOSPC");
+    rv1pool_destroy (pool);
+}
+
+static void test_state (void)
+{
+    struct rv1pool *pool = pool_create (R_4x4);
+    struct rv1pool *cpy;
+    char *s;
+
+    ok (rv1pool_mark_down (pool, "1-2,7") == 0,
+        "rv1pool_mark_down ignores unknown ranks");
+    ok ((s = rv1pool_down (pool)) && streq (s, "1-2"),
+        "rv1pool_down works");
+    free (s);
+    ok (alloc_is (pool, slots (2, 3, 0), NULL,
+                  "{\"nslots\":2,\"ranks\":[[0,[0,1,2],[]],[3,[0,1,2],[]]]}"),
+        "down ranks are not allocated");
+
+    ok ((cpy = rv1pool_copy (pool)) != NULL,
+        "rv1pool_copy works");
+    ok (rv1pool_mark_up (cpy, "all") == 0
+        && alloc_is (cpy, slots (2, 4, 0), NULL,
+                     "{\"nslots\":2,\"ranks\":[[1,[0,1,2,3],[]],"
+                     "[2,[0,1,2,3],[]]]}"),
+        "copy can be modified");
+    ok ((s = rv1pool_down (pool)) && streq (s, "1-2")
+        && allocated_is (pool, "[[0,[0,1,2],[]],[3,[0,1,2],[]]]"),
+        "original is unaffected");
+    free (s);
+    rv1pool_destroy (cpy);
+
+    ok (rv1pool_clear_allocated (pool,
+                                 "{\"version\":1,\"execution\":{\"R_lite\":"
+                                 "[{\"rank\":\"0,9\",\"children\":"
+                                 "{\"core\":\"0-7\"}}]}}") == 0
+        && allocated_is (pool, "[[3,[0,1,2],[]]]"),
+        "rv1pool_clear_allocated works");
+    ok (rv1pool_set_allocated (pool,
+                               "{\"version\":1,\"execution\":{\"R_lite\":"
+                               "[{\"rank\":\"1\",\"children\":"
+                               "{\"core\":\"3\"}}]}}") == 0
+        && allocated_is (pool, "[[1,[3],[]],[3,[0,1,2],[]]]"),
+        "rv1pool_set_allocated works");
+    errno = 0;
+    ok (rv1pool_set_allocated (pool, "{}") < 0 && errno == EINVAL,
+        "rv1pool_set_allocated with invalid R fails with EINVAL");
+
+    ok (rv1pool_remove_ranks (pool, "1,3") == 0
+        && rv1pool_nnodes (pool) == 2
+        && allocated_is (pool, "[]"),
+        "rv1pool_remove_ranks works");
+    ok ((s = rv1pool_down (pool)) && streq (s, "2"),
+        "removed ranks are no longer down");
+    free (s);
+    rv1pool_destroy (pool);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_invalid ();
+    test_worst_fit ();
+    test_slot_range ();
+    test_nodes ();
+    test_feasibility ();
+    test_state ();
+
+    done_testing ();
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
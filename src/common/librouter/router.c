@@ -30,6 +30,7 @@ struct router_entry {
     struct router *rtr;
     struct subhash *subscriptions;  // client's subscriber hash
     struct disconnect *dcon;
+    unsigned int event_seq;         // last event sent, to avoid duplicates
 };
 
 struct router {
@@ -37,6 +38,8 @@ struct router {
     zhashx_t *routes;               // uuid => 'struct router_entry'
     void *arg;
     struct subhash *subscriptions;  // router's subscriber hash
+    zhashx_t *subscribers;          // topic => list of 'struct router_entry'
+    unsigned int event_seq;
     struct servhash *services;
     flux_msg_handler_t **handlers;
     bool mute;
@@ -226,24 +229,82 @@ static int broker_unsubscribe (const char *topic, void *arg)
     return 0;
 }
 
+// zhashx_destructor_fn footprint
+static void subscriber_list_destructor (void **item)
+{
+    if (item) {
+        zlistx_destroy ((zlistx_t **)item);
+        *item = NULL;
+    }
+}
+
+/* Add 'entry' to the list of clients subscribed to 'topic'.
+ */
+static int subscriber_add (struct router *rtr,
+                           const char *topic,
+                           struct router_entry *entry)
+{
+    zlistx_t *l;
+
+    if (!(l = zhashx_lookup (rtr->subscribers, topic))) {
+        if (!(l = zlistx_new ()))
+            goto nomem;
+        (void)zhashx_insert (rtr->subscribers, topic, l);
+    }
+    if (!zlistx_add_end (l, entry))
+        goto nomem;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static void subscriber_remove (struct router *rtr,
+                               const char *topic,
+                               struct router_entry *entry)
+{
+    zlistx_t *l;
+    void *handle;
+
+    if ((l = zhashx_lookup (rtr->subscribers, topic))
+        && (handle = zlistx_find (l, entry))) {
+        zlistx_delete (l, handle);
+        if (zlistx_size (l) == 0)
+            zhashx_delete (rtr->subscribers, topic);
+    }
+}
+
 /* A client asks the router to subscribe.
+ * This is only called on the client's first subscription to 'topic'.
  * This might generate a broker_subscribe() or just usecount++.
  */
 static int router_subscribe (const char *topic, void *arg)
 {
-    struct router *rtr = arg;
+    struct router_entry *entry = arg;
+    struct router *rtr = entry->rtr;
 
-    return subhash_subscribe (rtr->subscriptions, topic);
+    if (subscriber_add (rtr, topic, entry) < 0)
+        return -1;
+    if (subhash_subscribe (rtr->subscriptions, topic) < 0) {
+        ERRNO_SAFE_WRAP (subscriber_remove, rtr, topic, entry);
+        return -1;
+    }
+    return 0;
 }
 
 /* A client asks the router to unsubscribe.
+ * This is only called on the client's last unsubscription from 'topic'.
  * This might generate a broker_unsubscribe() or just usecount--.
  */
 static int router_unsubscribe (const char *topic, void *arg)
 {
-    struct router *rtr = arg;
+    struct router_entry *entry = arg;
+    struct router *rtr = entry->rtr;
 
-    return subhash_unsubscribe (rtr->subscriptions, topic);
+    if (subhash_unsubscribe (rtr->subscriptions, topic) < 0)
+        return -1;
+    subscriber_remove (rtr, topic, entry);
+    return 0;
 }
 
 static void disconnect_cb (const flux_msg_t *msg, void *arg)
@@ -319,8 +380,8 @@ struct router_entry *router_entry_add (struct router *rtr,
     if (!(entry = router_entry_create (uuid, cb, arg)))
         return NULL;
 
-    subhash_set_subscribe (entry->subscriptions, router_subscribe, rtr);
-    subhash_set_unsubscribe (entry->subscriptions, router_unsubscribe, rtr);
+    subhash_set_subscribe (entry->subscriptions, router_subscribe, entry);
+    subhash_set_unsubscribe (entry->subscriptions, router_unsubscribe, entry);
 
     if (zhashx_insert (rtr->routes, uuid, entry) < 0) {
         router_entry_destroy (entry);
@@ -398,8 +459,47 @@ error:
     return;
 }
 
+struct event_dispatch {
+    struct router *rtr;
+    const flux_msg_t *msg;
+};
+
+static void router_entry_send_event (struct router_entry *entry,
+                                     const flux_msg_t *msg)
+{
+    struct router *rtr = entry->rtr;
+
+    if (entry->event_seq == rtr->event_seq)
+        return; // already sent via another matching subscription
+    entry->event_seq = rtr->event_seq;
+    if (entry->send (msg, entry->arg) < 0)
+        flux_log_error (rtr->h, "router: event > client=%.5s", entry->uuid);
+}
+
+/* subhash_prefix_foreach() callback:
+ * send event to clients subscribed to 'prefix' of its topic.
+ */
+static bool event_dispatch_prefix (const char *prefix, void *arg)
+{
+    struct event_dispatch *ev = arg;
+    struct router_entry *entry;
+    zlistx_t *l;
+
+    if ((l = zhashx_lookup (ev->rtr->subscribers, prefix))) {
+        entry = zlistx_first (l);
+        while (entry) {
+            router_entry_send_event (entry, ev->msg);
+            entry = zlistx_next (l);
+        }
+    }
+    return false;
+}
+
 /* Receive event from broker.
  * Distribute to all router entries with matching subscriptions.
+ * Subscriptions are prefixes of the topic, so look up the subscribers
+ * of each prefix rather than checking every client.  Fall back to the
+ * latter if the topic is too long.
  */
 static void event_cb (flux_t *h,
                       flux_msg_handler_t *mh,
@@ -409,18 +509,21 @@ static void event_cb (flux_t *h,
     struct router *rtr = arg;
     struct router_entry *entry;
     const char *topic;
+    struct event_dispatch ev = { .rtr = rtr, .msg = msg };
 
     if (flux_msg_get_topic (msg, &topic) < 0) {
         flux_log_error (h, "router: event > client");
         return;
     }
-
+    rtr->event_seq++;
+    if (strlen (topic) < SUBHASH_TOPIC_MAX) {
+        (void)subhash_prefix_foreach (topic, event_dispatch_prefix, &ev);
+        return;
+    }
     entry = zhashx_first (rtr->routes);
     while ((entry)) {
-        if (subhash_topic_match (entry->subscriptions, topic)) {
-            if (entry->send (msg, entry->arg) < 0)
-                flux_log_error (h, "router: event > client=%.5s", entry->uuid);
-        }
+        if (subhash_topic_match (entry->subscriptions, topic))
+            router_entry_send_event (entry, msg);
         entry = zhashx_next (rtr->routes);
     }
 }
@@ -450,6 +553,9 @@ struct router *router_create (flux_t *h)
 
     if (!(rtr->subscriptions = subhash_create ()))
         goto error;
+    if (!(rtr->subscribers = zhashx_new ()))
+        goto error;
+    zhashx_set_destructor (rtr->subscribers, subscriber_list_destructor);
     subhash_set_subscribe (rtr->subscriptions, broker_subscribe, rtr);
     subhash_set_unsubscribe (rtr->subscriptions, broker_unsubscribe, rtr);
 
@@ -469,9 +575,11 @@ void router_destroy (struct router *rtr)
 {
     if (rtr) {
         flux_msg_handler_delvec (rtr->handlers);
+        // entries unsubscribe from rtr->subscriptions as they are destroyed
+        ERRNO_SAFE_WRAP (zhashx_destroy, &rtr->routes);
         subhash_destroy (rtr->subscriptions);
+        ERRNO_SAFE_WRAP (zhashx_destroy, &rtr->subscribers);
         servhash_destroy (rtr->services);
-        ERRNO_SAFE_WRAP (zhashx_destroy, &rtr->routes);
         ERRNO_SAFE_WRAP (free, rtr);
     }
 }
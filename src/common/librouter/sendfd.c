@@ -39,6 +39,11 @@
  *   is assembled, then it is freed.  The static buffer is sized somewhat
  *   arbitrarily at 4K.
  *
+ * - iobuf_append/iobuf_flush and iobuf_read/iobuf_decode use the same
+ *   encoding, but batch multiple messages in the iobuf so that several
+ *   can be sent or received with one system call.  The buffer grows as
+ *   needed and is freed once it has been drained.
+ *
  * - sendfd/recvfd do not encrypt messages, therefore this transport
  *   is only appropriate for use on AF_LOCAL sockets or on file descriptors
  *   tunneled through a secure channel.
@@ -178,6 +183,151 @@ done:
     return msg;
 }
 
+static size_t iobuf_capacity (struct iobuf *io)
+{
+    if (!io->buf)
+        return 0;
+    return io->buf == io->buf_fixed ? sizeof (io->buf_fixed) : io->alloc;
+}
+
+/* Ensure that iobuf can hold 'size' bytes, preserving its content.
+ */
+static int iobuf_reserve (struct iobuf *io, size_t size)
+{
+    size_t alloc;
+    uint8_t *buf;
+
+    if (!io->buf)
+        io->buf = io->buf_fixed;
+    if (size <= iobuf_capacity (io))
+        return 0;
+    alloc = iobuf_capacity (io);
+    while (alloc < size)
+        alloc *= 2;
+    if (io->buf == io->buf_fixed) {
+        if (!(buf = malloc (alloc)))
+            return -1;
+        memcpy (buf, io->buf_fixed, io->size);
+    }
+    else if (!(buf = realloc (io->buf, alloc)))
+        return -1;
+    io->buf = buf;
+    io->alloc = alloc;
+    return 0;
+}
+
+int iobuf_append (struct iobuf *io, const flux_msg_t *msg)
+{
+    uint32_t hdr[2];
+    ssize_t s;
+
+    if (!io || !msg) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((s = flux_msg_encode_size (msg)) < 0
+        || iobuf_reserve (io, io->size + s + 8) < 0)
+        return -1;
+    if (flux_msg_encode (msg, io->buf + io->size + 8, s) < 0)
+        return -1;
+    // messages are packed, so the header may not be aligned
+    hdr[0] = IOBUF_MAGIC;
+    hdr[1] = htonl (s);
+    memcpy (io->buf + io->size, hdr, 8);
+    io->size += s + 8;
+    return 0;
+}
+
+size_t iobuf_pending (struct iobuf *io)
+{
+    return io ? io->size - io->done : 0;
+}
+
+int iobuf_flush (int fd, struct iobuf *io, int *calls)
+{
+    ssize_t n;
+
+    if (fd < 0 || !io) {
+        errno = EINVAL;
+        return -1;
+    }
+    while (io->done < io->size) {
+        n = write (fd, io->buf + io->done, io->size - io->done);
+        if (calls)
+            (*calls)++;
+        if (n < 0)
+            return -1;
+        io->done += n;
+    }
+    iobuf_clean (io);
+    return 0;
+}
+
+ssize_t iobuf_read (int fd, struct iobuf *io)
+{
+    ssize_t n;
+
+    if (fd < 0 || !io) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (io->done > 0) {
+        memmove (io->buf, io->buf + io->done, io->size - io->done);
+        io->size -= io->done;
+        io->done = 0;
+    }
+    /* Make room for all of a partially received message.
+     */
+    if (io->size >= 8) {
+        uint32_t len;
+        memcpy (&len, io->buf + 4, 4);
+        if (iobuf_reserve (io, ntohl (len) + 8) < 0)
+            return -1;
+    }
+    else if (iobuf_reserve (io, 8) < 0)
+        return -1;
+    n = read (fd, io->buf + io->size, iobuf_capacity (io) - io->size);
+    if (n < 0)
+        return -1;
+    if (n == 0) {
+        errno = ECONNRESET;
+        return -1;
+    }
+    io->size += n;
+    return n;
+}
+
+flux_msg_t *iobuf_decode (struct iobuf *io)
+{
+    uint32_t hdr[2];
+    size_t len;
+    flux_msg_t *msg;
+
+    if (!io) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (io->size - io->done < 8)
+        goto wouldblock;
+    memcpy (hdr, io->buf + io->done, 8);
+    if (hdr[0] != IOBUF_MAGIC) {
+        errno = EPROTO;
+        return NULL;
+    }
+    len = ntohl (hdr[1]);
+    if (io->size - io->done < len + 8)
+        goto wouldblock;
+    if (!(msg = flux_msg_decode (io->buf + io->done + 8, len)))
+        return NULL;
+    io->done += len + 8;
+    if (io->done == io->size)
+        iobuf_clean (io);
+    return msg;
+wouldblock:
+    errno = EWOULDBLOCK;
+    return NULL;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
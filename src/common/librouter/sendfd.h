@@ -17,6 +17,7 @@ struct iobuf {
     uint8_t *buf;
     size_t size;
     size_t done;
+    size_t alloc;       // allocated size of buf, if not buf_fixed
     uint8_t buf_fixed[4096];
 };
 
@@ -32,6 +33,27 @@ int sendfd (int fd, const flux_msg_t *msg, struct iobuf *iobuf);
  */
 flux_msg_t *recvfd (int fd, struct iobuf *iobuf);
 
+/* Buffered I/O of many messages per system call, for non-blocking fds.
+ * An iobuf used with these functions should not be used with sendfd()
+ * or recvfd().
+ *
+ * iobuf_append() encodes a message at the end of iobuf.
+ * iobuf_flush() writes buffered messages to fd, incrementing *calls for
+ * each write(2).  It fails with EAGAIN/EWOULDBLOCK if some data remains.
+ * iobuf_pending() returns the number of bytes not yet written.
+ *
+ * iobuf_read() makes one read(2) call to add as much data as will fit to
+ * iobuf.  It fails with ECONNRESET on EOF.
+ * iobuf_decode() returns the next complete message from iobuf, or fails
+ * with EWOULDBLOCK if more data must be read first.
+ */
+int iobuf_append (struct iobuf *iobuf, const flux_msg_t *msg);
+int iobuf_flush (int fd, struct iobuf *iobuf, int *calls);
+size_t iobuf_pending (struct iobuf *iobuf);
+
+ssize_t iobuf_read (int fd, struct iobuf *iobuf);
+flux_msg_t *iobuf_decode (struct iobuf *iobuf);
+
 /* Initialize iobuf members.
  */
 void iobuf_init (struct iobuf *iobuf);
@@ -36,6 +36,7 @@
 #include "config.h"
 #endif
 #include <stdlib.h>
+#include <string.h>
 #include <flux/core.h>
 
 #include "src/common/libutil/errno_safe.h"
@@ -95,11 +96,47 @@ error:
     return NULL;
 }
 
+/* Call 'cb' with each prefix of 'topic', longest first, until it returns
+ * true.  Return false without calling 'cb' if topic is too long.
+ */
+bool subhash_prefix_foreach (const char *topic,
+                             bool (*cb)(const char *prefix, void *arg),
+                             void *arg)
+{
+    char prefix[SUBHASH_TOPIC_MAX];
+    size_t len = strlen (topic);
+
+    if (len >= sizeof (prefix))
+        return false;
+    memcpy (prefix, topic, len + 1);
+    for (;;) {
+        if (cb (prefix, arg))
+            return true;
+        if (len == 0)
+            break;
+        prefix[--len] = '\0';
+    }
+    return false;
+}
+
+static bool subhash_lookup (const char *prefix, void *arg)
+{
+    struct subhash *sh = arg;
+    return zhashx_lookup (sh->subs, prefix) ? true : false;
+}
+
 bool subhash_topic_match (struct subhash *sh, const char *topic)
 {
     struct subhash_entry *entry;
 
     if (sh && topic) {
+        size_t len = strlen (topic);
+
+        /* With more subscriptions than there are prefixes of topic,
+         * look up each prefix instead of scanning the subscriptions.
+         */
+        if (zhashx_size (sh->subs) > len && len < SUBHASH_TOPIC_MAX)
+            return subhash_prefix_foreach (topic, subhash_lookup, sh);
         entry = zhashx_first (sh->subs);
         while (entry) {
             /* entry->topic="" matches all
@@ -22,6 +22,17 @@ void subhash_set_unsubscribe (struct subhash *sub, subscribe_f cb, void *arg);
 
 bool subhash_topic_match (struct subhash *sh, const char *topic);
 
+/* Call 'cb' with each prefix of 'topic' (including itself and ""),
+ * longest first, stopping when it returns true.  Returns false if 'cb'
+ * never returned true, or if topic has SUBHASH_TOPIC_MAX chars or more.
+ * Topic subscriptions are prefixes, so this visits every subscription
+ * topic that could match.
+ */
+#define SUBHASH_TOPIC_MAX 256
+bool subhash_prefix_foreach (const char *topic,
+                             bool (*cb)(const char *prefix, void *arg),
+                             void *arg);
+
 int subhash_subscribe (struct subhash *sh, const char *topic);
 int subhash_unsubscribe (struct subhash *sh, const char *topic);
 
@@ -257,6 +257,93 @@ void test_basic (flux_t *h)
     router_destroy (rtr);
 }
 
+struct event_counter {
+    flux_reactor_t *r;
+    int count;
+};
+
+/* Count events received by a router entry and stop the reactor.
+ * Ignore the responses to subscribe requests.
+ */
+int count_recv (const flux_msg_t *msg, void *arg)
+{
+    struct event_counter *ctr = arg;
+    int type;
+
+    if (flux_msg_get_type (msg, &type) == 0 && type == FLUX_MSGTYPE_EVENT) {
+        ctr->count++;
+        flux_reactor_stop (ctr->r);
+    }
+    return 0;
+}
+
+void entry_sendreq (struct router_entry *entry,
+                    const char *topic,
+                    const char *payload)
+{
+    flux_msg_t *request;
+
+    if (!(request = flux_request_encode (topic, payload)))
+        BAIL_OUT ("flux_request_encode failed");
+    router_entry_recv (entry, request);
+    flux_msg_destroy (request);
+}
+
+/* Publish rtest.event and return when some entry has received it.
+ */
+void event_pub (flux_reactor_t *r, struct router_entry *entry)
+{
+    entry_sendreq (entry, "rtest.pub", NULL);
+    if (flux_reactor_run (r, 0) < 0)
+        BAIL_OUT ("flux_reactor_run failed");
+}
+
+void test_event_multi (flux_t *h)
+{
+    flux_reactor_t *r;
+    struct router *rtr;
+    struct router_entry *a, *b, *c;
+    struct event_counter actr = { 0 }, bctr = { 0 }, cctr = { 0 };
+
+    if (!(r = flux_get_reactor (h)))
+        BAIL_OUT ("flux_get_reactor failed");
+    actr.r = bctr.r = cctr.r = r;
+    if (!(rtr = router_create (h))
+        || !(a = router_entry_add (rtr, "aaaa", count_recv, &actr))
+        || !(b = router_entry_add (rtr, "bbbb", count_recv, &bctr))
+        || !(c = router_entry_add (rtr, "cccc", count_recv, &cctr)))
+        BAIL_OUT ("error creating router with three entries");
+
+    entry_sendreq (a, "event.subscribe", "{\"topic\":\"rtest\"}");
+    entry_sendreq (a, "event.subscribe", "{\"topic\":\"rtest.event\"}");
+    entry_sendreq (b, "event.subscribe", "{\"topic\":\"other\"}");
+    entry_sendreq (c, "event.subscribe", "{\"topic\":\"\"}");
+
+    event_pub (r, b);
+    ok (actr.count == 1 && bctr.count == 0 && cctr.count == 1,
+        "multi: event sent once to each matching entry");
+
+    entry_sendreq (a, "event.unsubscribe", "{\"topic\":\"rtest\"}");
+    event_pub (r, b);
+    ok (actr.count == 2 && bctr.count == 0 && cctr.count == 2,
+        "multi: event sent after one of two subscriptions was dropped");
+
+    router_entry_delete (c);
+    event_pub (r, b);
+    ok (actr.count == 3 && bctr.count == 0 && cctr.count == 2,
+        "multi: deleted entry no longer receives events");
+
+    entry_sendreq (a, "event.unsubscribe", "{\"topic\":\"rtest.event\"}");
+    entry_sendreq (b, "event.subscribe", "{\"topic\":\"rtest.ev\"}");
+    event_pub (r, a);
+    ok (actr.count == 3 && bctr.count == 1,
+        "multi: event is sent to new subscriber only");
+
+    router_entry_delete (a);
+    router_entry_delete (b);
+    router_destroy (rtr);
+}
+
 void test_error (flux_t *h)
 {
     ok (router_renew (NULL) == 0,
@@ -275,6 +362,7 @@ int main (int argc, char *argv[])
         BAIL_OUT ("test_server_create failed");
 
     test_basic (h);
+    test_event_multi (h);
     test_error (h);
 
     diag ("stopping test server");
@@ -314,6 +314,140 @@ next:
     free (buf);
 }
 
+/* Send a batch of messages of mixed sizes with iobuf_append() and
+ * iobuf_flush() over a non-blocking pipe, reading them on the other end
+ * with iobuf_read() and iobuf_decode().
+ */
+void test_batch (int count)
+{
+    int pfd[2];
+    struct iobuf iow;
+    struct iobuf ior;
+    char *big;
+    int sent = 0;
+    int received = 0;
+    int errors = 0;
+    int writes = 0;
+    int reads = 0;
+    flux_msg_t *msg;
+
+    if (pipe2 (pfd, O_CLOEXEC | O_NONBLOCK) < 0)
+        BAIL_OUT ("pipe2 failed");
+    if (!(big = malloc (10000)))
+        BAIL_OUT ("out of memory");
+    memset (big, 'x', 9999);
+    big[9999] = '\0';
+    iobuf_init (&iow);
+    iobuf_init (&ior);
+
+    while (received < count) {
+        /* Append messages until some are pending, then flush.
+         * Every tenth message is larger than the fixed buffer.
+         */
+        while (sent < count && iobuf_pending (&iow) < 16384) {
+            if (!(msg = flux_request_encode ("foo.bar",
+                                             sent % 10 == 9 ? big : "small"))
+                || flux_msg_set_matchtag (msg, sent) < 0
+                || iobuf_append (&iow, msg) < 0)
+                BAIL_OUT ("failed to append message %d", sent);
+            flux_msg_destroy (msg);
+            sent++;
+        }
+        if (iobuf_flush (pfd[1], &iow, &writes) < 0
+            && errno != EAGAIN && errno != EWOULDBLOCK)
+            BAIL_OUT ("iobuf_flush failed: %s", strerror (errno));
+        reads++;
+        if (iobuf_read (pfd[0], &ior) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                BAIL_OUT ("iobuf_read failed: %s", strerror (errno));
+            continue;
+        }
+        while ((msg = iobuf_decode (&ior))) {
+            const char *payload;
+            uint32_t matchtag;
+
+            if (flux_request_decode (msg, NULL, &payload) < 0
+                || flux_msg_get_matchtag (msg, &matchtag) < 0
+                || matchtag != received
+                || !streq (payload, received % 10 == 9 ? big : "small"))
+                errors++;
+            flux_msg_destroy (msg);
+            received++;
+        }
+        if (errno != EWOULDBLOCK)
+            BAIL_OUT ("iobuf_decode failed: %s", strerror (errno));
+    }
+    ok (received == count && errors == 0,
+        "batch %d: received messages are intact", count);
+    diag ("batch %d: %d writes, %d reads", count, writes, reads);
+    ok (writes < count && reads < count,
+        "batch %d: fewer system calls than messages", count);
+    ok (iobuf_pending (&iow) == 0 && iow.buf == NULL && ior.buf == NULL,
+        "batch %d: drained iobufs were released", count);
+
+    iobuf_clean (&iow);
+    iobuf_clean (&ior);
+    close (pfd[1]);
+    close (pfd[0]);
+    free (big);
+}
+
+/* iobuf_decode() waits for a complete message and rejects bad ones.
+ */
+void test_decode (void)
+{
+    int pfd[2];
+    struct iobuf iow;
+    struct iobuf ior;
+    flux_msg_t *msg;
+    size_t len;
+
+    if (pipe2 (pfd, O_CLOEXEC | O_NONBLOCK) < 0)
+        BAIL_OUT ("pipe2 failed");
+    iobuf_init (&iow);
+    iobuf_init (&ior);
+    if (!(msg = flux_request_encode ("foo.bar", NULL))
+        || iobuf_append (&iow, msg) < 0)
+        BAIL_OUT ("failed to append message");
+    flux_msg_destroy (msg);
+    len = iobuf_pending (&iow);
+
+    /* write all but the last byte */
+    if (write (pfd[1], iow.buf, len - 1) != len - 1)
+        BAIL_OUT ("write failed");
+    ok (iobuf_read (pfd[0], &ior) == len - 1,
+        "iobuf_read read partial message");
+    errno = 0;
+    ok (iobuf_decode (&ior) == NULL && errno == EWOULDBLOCK,
+        "iobuf_decode of partial message fails with EWOULDBLOCK");
+    if (write (pfd[1], iow.buf + len - 1, 1) != 1)
+        BAIL_OUT ("write failed");
+    ok (iobuf_read (pfd[0], &ior) == 1,
+        "iobuf_read read the rest of the message");
+    ok ((msg = iobuf_decode (&ior)) != NULL,
+        "iobuf_decode returned the message");
+    flux_msg_destroy (msg);
+
+    /* corrupt the magic number */
+    iow.buf[0] = ~iow.buf[0];
+    if (write (pfd[1], iow.buf, len) != len)
+        BAIL_OUT ("write failed");
+    ok (iobuf_read (pfd[0], &ior) == len,
+        "iobuf_read read a bad message");
+    errno = 0;
+    ok (iobuf_decode (&ior) == NULL && errno == EPROTO,
+        "iobuf_decode of message with bad magic fails with EPROTO");
+
+    close (pfd[1]);
+    errno = 0;
+    ok (iobuf_read (pfd[0], &ior) < 0 && errno == ECONNRESET,
+        "iobuf_read fails with ECONNRESET on EOF");
+
+    iobuf_clean (&iow);
+    iobuf_clean (&ior);
+    close (pfd[0]);
+}
+
 void test_inval (void)
 {
     flux_msg_t *msg;
@@ -332,6 +466,19 @@ void test_inval (void)
     ok (sendfd (0, NULL, NULL) < 0 && errno == EINVAL,
         "senfd msg=NULL fails with EINVAL");
 
+    errno = 0;
+    ok (iobuf_append (NULL, msg) < 0 && errno == EINVAL,
+        "iobuf_append iobuf=NULL fails with EINVAL");
+    errno = 0;
+    ok (iobuf_flush (-1, NULL, NULL) < 0 && errno == EINVAL,
+        "iobuf_flush fd=-1 fails with EINVAL");
+    errno = 0;
+    ok (iobuf_read (-1, NULL) < 0 && errno == EINVAL,
+        "iobuf_read fd=-1 fails with EINVAL");
+    errno = 0;
+    ok (iobuf_decode (NULL) == NULL && errno == EINVAL,
+        "iobuf_decode iobuf=NULL fails with EINVAL");
+
     flux_msg_destroy (msg);
 }
 
@@ -346,6 +493,8 @@ int main (int argc, char *argv[])
     test_nonblock (4096, 256);
     test_nonblock (16384, 64);
     test_nonblock (1048586, 1);
+    test_batch (1000);
+    test_decode ();
     test_inval ();
 
     done_testing();
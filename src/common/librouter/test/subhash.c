@@ -14,6 +14,7 @@
 #include <flux/core.h>
 
 #include "src/common/libtap/tap.h"
+#include "ccan/str/str.h"
 #include "src/common/librouter/subhash.h"
 
 void test_topic_match (void)
@@ -58,6 +59,82 @@ void test_topic_match (void)
     subhash_destroy (sub);
 }
 
+/* With more subscriptions than topic prefixes, subhash_topic_match()
+ * looks up topic prefixes instead of scanning subscriptions.
+ */
+void test_topic_match_many (void)
+{
+    struct subhash *sub;
+    char topic[64];
+    char longtopic[SUBHASH_TOPIC_MAX + 16];
+
+    if (!(sub = subhash_create ()))
+        BAIL_OUT ("subhash_create failed");
+    for (int i = 0; i < 100; i++) {
+        snprintf (topic, sizeof (topic), "t%d.", i);
+        if (subhash_subscribe (sub, topic) < 0)
+            BAIL_OUT ("subhash_subscribe %s failed", topic);
+    }
+    ok (subhash_topic_match (sub, "t42.foo") == true,
+        "subhash_topic_match t42.foo returns true");
+    ok (subhash_topic_match (sub, "t42.") == true,
+        "subhash_topic_match t42. returns true");
+    ok (subhash_topic_match (sub, "t42") == false,
+        "subhash_topic_match t42 returns false");
+    ok (subhash_topic_match (sub, "t100.foo") == false,
+        "subhash_topic_match t100.foo returns false");
+    ok (subhash_topic_match (sub, "") == false,
+        "subhash_topic_match \"\" returns false");
+
+    memset (longtopic, 'x', sizeof (longtopic) - 1);
+    longtopic[sizeof (longtopic) - 1] = '\0';
+    memcpy (longtopic, "t7.", 3);
+    ok (subhash_topic_match (sub, longtopic) == true,
+        "subhash_topic_match works with a very long topic");
+    longtopic[1] = 'x';
+    ok (subhash_topic_match (sub, longtopic) == false,
+        "subhash_topic_match fails on a very long unmatched topic");
+
+    ok (subhash_subscribe (sub, "") == 0,
+        "subhash_subscribe \"\"");
+    ok (subhash_topic_match (sub, "bar") == true,
+        "subhash_topic_match bar returns true");
+
+    subhash_destroy (sub);
+}
+
+static bool collect_prefix (const char *prefix, void *arg)
+{
+    char *buf = arg;
+
+    strcat (buf, "[");
+    strcat (buf, prefix);
+    strcat (buf, "]");
+    return streq (prefix, "ab");
+}
+
+void test_prefix_foreach (void)
+{
+    char buf[64];
+    char longtopic[SUBHASH_TOPIC_MAX + 1];
+
+    buf[0] = '\0';
+    ok (subhash_prefix_foreach ("xyz", collect_prefix, buf) == false
+        && streq (buf, "[xyz][xy][x][]"),
+        "subhash_prefix_foreach visits all prefixes, longest first");
+    buf[0] = '\0';
+    ok (subhash_prefix_foreach ("abcd", collect_prefix, buf) == true
+        && streq (buf, "[abcd][abc][ab]"),
+        "subhash_prefix_foreach stops when callback returns true");
+
+    memset (longtopic, 'x', sizeof (longtopic) - 1);
+    longtopic[sizeof (longtopic) - 1] = '\0';
+    buf[0] = '\0';
+    ok (subhash_prefix_foreach (longtopic, collect_prefix, buf) == false
+        && streq (buf, ""),
+        "subhash_prefix_foreach skips topic of SUBHASH_TOPIC_MAX chars");
+}
+
 int counter_cb (const char *topic, void *arg)
 {
     int *count = arg;
@@ -199,6 +276,8 @@ int main (int argc, char *argv[])
     plan (NO_PLAN);
 
     test_topic_match ();
+    test_topic_match_many ();
+    test_prefix_foreach ();
     test_callbacks ();
     test_callbacks_rc ();
     test_errors ();
@@ -31,6 +31,11 @@
  * - usock_conn_send() adds a message to a queue, starts fd (write) watcher.
  * - Register a receive callback to receive complete messages from client.
  * - Register an error callback to be notified when I/O errors occur.
+ * - Each write watcher callback encodes queued messages into one buffer,
+ *   up to USOCK_WRITE_BUDGET bytes, and writes it with one write(2).
+ *   Each read watcher callback reads as much as fits in the input buffer
+ *   and passes all the complete messages it contains to the receive
+ *   callback.
  */
 
 #if HAVE_CONFIG_H
@@ -61,6 +66,8 @@
 
 #define LISTEN_BACKLOG 5
 
+#define USOCK_WRITE_BUDGET  65536
+
 #ifndef UUID_STR_LEN
 #define UUID_STR_LEN 37     // defined in later libuuid headers
 #endif
@@ -91,6 +98,10 @@ struct usock_conn {
 
     int txcount;
     int rxcount;
+    int readcount;          // read(2) calls
+    int writecount;         // write(2) calls
+    int read_batch_max;     // most messages received from one read(2)
+    int write_batch_max;    // most messages sent in one batch
 
     usock_conn_close_f close_cb;
     void *close_arg;
@@ -217,22 +228,31 @@ static void conn_read_cb (flux_reactor_t *r,
     }
     if ((revents & FLUX_POLLIN)) {
         flux_msg_t *msg;
+        int count = 0;
 
-        if (!(msg = recvfd (conn->in.fd, &conn->in.iobuf))) {
+        conn->readcount++;
+        if (iobuf_read (conn->in.fd, &conn->in.iobuf) < 0) {
             if (errno != EWOULDBLOCK && errno != EAGAIN)
                 goto error;
+            return;
         }
-        else {
+        while ((msg = iobuf_decode (&conn->in.iobuf))) {
             /* Update message credentials based on connected creds.
              */
-            if (auth_init_message (msg, &conn->cred) < 0)
+            if (auth_init_message (msg, &conn->cred) < 0) {
+                flux_msg_destroy (msg);
                 goto error;
-
+            }
             if (conn->recv_cb)
                 conn->recv_cb (conn, msg, conn->recv_arg);
             flux_msg_destroy (msg);
             conn->txcount++;
+            count++;
         }
+        if (errno != EWOULDBLOCK)
+            goto error;
+        if (conn->read_batch_max < count)
+            conn->read_batch_max = count;
     }
     return;
 error:
@@ -261,31 +281,42 @@ static void conn_write_cb (flux_reactor_t *r,
     }
 
     if ((revents & FLUX_POLLOUT)) {
-        const flux_msg_t *msg = zlist_head (conn->outqueue);
-        if (msg) {
-            if (sendfd (conn->out.fd, msg, &conn->out.iobuf) < 0) {
-                if (errno == EPIPE) {
-                    /* Remote peer has closed connection.
-                     * However, there may still be pending messages sent
-                     * by peer, so do not destroy connection here. Instead,
-                     * drop all pending messages in the output queue, and
-                     * let connection be closed after EOF/ECONNRESET from
-                     * *read* side of connection.
-                     */
-                    while (conn_outqueue_drop (conn))
-                        ;
-                    flux_watcher_stop (conn->out.w);
-                }
-                else if (errno != EWOULDBLOCK && errno != EAGAIN)
-                    goto error;
+        flux_msg_t *msg;
+        int count = 0;
+
+        while (iobuf_pending (&conn->out.iobuf) < USOCK_WRITE_BUDGET
+               && (msg = zlist_pop (conn->outqueue))) {
+            if (iobuf_append (&conn->out.iobuf, msg) < 0) {
+                flux_msg_decref (msg);
+                goto error;
             }
-            else {
-                (void) conn_outqueue_drop (conn);
-                if (zlist_size (conn->outqueue) == 0)
-                    flux_watcher_stop (conn->out.w);
-                conn->rxcount++;
+            flux_msg_decref (msg);
+            conn->rxcount++;
+            count++;
+        }
+        if (conn->write_batch_max < count)
+            conn->write_batch_max = count;
+        if (iobuf_flush (conn->out.fd,
+                         &conn->out.iobuf,
+                         &conn->writecount) < 0) {
+            if (errno == EPIPE) {
+                /* Remote peer has closed connection.
+                 * However, there may still be pending messages sent
+                 * by peer, so do not destroy connection here. Instead,
+                 * drop all pending messages in the output queue, and
+                 * let connection be closed after EOF/ECONNRESET from
+                 * *read* side of connection.
+                 */
+                while (conn_outqueue_drop (conn))
+                    ;
+                iobuf_clean (&conn->out.iobuf);
+                flux_watcher_stop (conn->out.w);
             }
+            else if (errno != EWOULDBLOCK && errno != EAGAIN)
+                goto error;
         }
+        else if (zlist_size (conn->outqueue) == 0)
+            flux_watcher_stop (conn->out.w);
     }
     return;
 error:
@@ -828,13 +859,17 @@ void usock_client_destroy (struct usock_client *client)
 
 static json_t *usock_client_stats_get (struct usock_conn *conn)
 {
-    return json_pack ("{s:s s:i s:i s:i s:i s:i}",
+    return json_pack ("{s:s s:i s:i s:i s:i s:i s:i s:i s:i s:i}",
                       "uuid", conn->uuid_str,
                       "userid", conn->cred.userid,
                       "pid", conn->pid,
                       "txcount", conn->txcount,
                       "rxcount", conn->rxcount,
-                      "rxbacklog", (int)zlist_size (conn->outqueue));
+                      "rxbacklog", (int)zlist_size (conn->outqueue),
+                      "readcount", conn->readcount,
+                      "writecount", conn->writecount,
+                      "read-batch-max", conn->read_batch_max,
+                      "write-batch-max", conn->write_batch_max);
 }
 
 json_t *usock_server_stats_get (struct usock_server *server)
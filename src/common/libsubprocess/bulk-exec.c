@@ -21,9 +21,13 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/aux.h"
+#include "src/common/libutil/errno_safe.h"
 #include "src/common/libjob/idf58.h"
+#include "src/common/libioencode/ioencode.h"
 #include "ccan/str/str.h"
 #include "bulk-exec.h"
+#include "subprocess_private.h"
+#include "command_private.h"
 
 struct exec_cmd {
     struct idset *ranks;
@@ -31,6 +35,17 @@ struct exec_cmd {
     int flags;
 };
 
+/*  A command launched with a single tree-exec request.  The per-rank
+ *   subprocess objects are proxies whose state is driven by the
+ *   aggregated responses.
+ */
+struct tree_launch {
+    struct bulk_exec *exec;
+    char key[128];
+    flux_future_t *f;
+    zhashx_t *procs;     /* rank => flux_subprocess_t (owned by processes) */
+};
+
 struct bulk_exec {
     flux_t *h;
 
@@ -48,6 +63,10 @@ struct bulk_exec {
     int exit_status;         /* Largest wait status of all complete procs */
 
     unsigned int active:1;
+    unsigned int tree:1;     /* launch via tree-exec instead of per-rank */
+    int tree_seq;
+    char *tree_barrier;      /* barrier service topic for tree launch */
+    uint32_t tree_userid;
 
     flux_watcher_t *prep;
     flux_watcher_t *check;
@@ -61,6 +80,7 @@ struct bulk_exec {
 
     zlist_t *commands;
     zlist_t *processes;
+    zlist_t *trees;
 
     struct bulk_exec_ops *handlers;
     void *arg;
@@ -145,6 +165,10 @@ int bulk_exec_write (struct bulk_exec *exec,
         errno = EINVAL;
         return -1;
     }
+    if (exec->tree) {
+        errno = ENOTSUP;
+        return -1;
+    }
 
     p = zlist_first (exec->processes);
     while (p) {
@@ -163,6 +187,10 @@ int bulk_exec_close (struct bulk_exec *exec, const char *stream)
         errno = EINVAL;
         return -1;
     }
+    if (exec->tree) {
+        errno = ENOTSUP;
+        return -1;
+    }
 
     p = zlist_first (exec->processes);
     while (p) {
@@ -286,6 +314,25 @@ static void exec_state_cb (flux_subprocess_t *p, flux_subprocess_state_t state)
     }
 }
 
+static void exec_output (struct bulk_exec *exec,
+                         flux_subprocess_t *p,
+                         const char *stream,
+                         const char *s,
+                         int len)
+{
+    if (exec->handlers->on_output)
+        (*exec->handlers->on_output) (exec, p, stream, s, len, exec->arg);
+    else {
+        flux_log (exec->h,
+                  LOG_INFO,
+                  "rank %d: %s: %.*s",
+                  flux_subprocess_rank (p),
+                  stream,
+                  len,
+                  s);
+    }
+}
+
 static void exec_output_cb (flux_subprocess_t *p, const char *stream)
 {
     struct bulk_exec *exec = flux_subprocess_aux_get (p, "job-exec::exec");
@@ -296,20 +343,8 @@ static void exec_output_cb (flux_subprocess_t *p, const char *stream)
         flux_log_error (exec->h, "flux_subprocess_read");
         return;
     }
-    if (len) {
-        int rank = flux_subprocess_rank (p);
-        if (exec->handlers->on_output)
-            (*exec->handlers->on_output) (exec, p, stream, s, len, exec->arg);
-        else {
-            flux_log (exec->h,
-                      LOG_INFO,
-                      "rank %d: %s: %.*s",
-                      rank,
-                      stream,
-                      len,
-                      s);
-        }
-    }
+    if (len)
+        exec_output (exec, p, stream, s, len);
 }
 
 static void exec_cmd_destroy (void *arg)
@@ -432,6 +467,277 @@ opt_error:
     return -1;
 }
 
+static void tree_launch_destroy (void *arg)
+{
+    struct tree_launch *t = arg;
+    if (t) {
+        int saved_errno = errno;
+        flux_future_destroy (t->f);
+        zhashx_destroy (&t->procs);
+        free (t);
+        errno = saved_errno;
+    }
+}
+
+static flux_subprocess_t *tree_proc_lookup (struct tree_launch *t,
+                                            unsigned int rank)
+{
+    char key[16];
+    snprintf (key, sizeof (key), "%u", rank);
+    return zhashx_lookup (t->procs, key);
+}
+
+static void tree_proc_started (struct tree_launch *t, unsigned int rank)
+{
+    flux_subprocess_t *p = tree_proc_lookup (t, rank);
+    if (p && p->state == FLUX_SUBPROCESS_INIT) {
+        p->state = p->state_reported = FLUX_SUBPROCESS_RUNNING;
+        exec_state_cb (p, FLUX_SUBPROCESS_RUNNING);
+    }
+}
+
+static void tree_proc_exited (struct tree_launch *t,
+                              unsigned int rank,
+                              int status)
+{
+    flux_subprocess_t *p = tree_proc_lookup (t, rank);
+    if (p && flux_subprocess_active (p)) {
+        p->status = status;
+        p->state = p->state_reported = FLUX_SUBPROCESS_EXITED;
+        p->completed = true;
+        exec_complete_cb (p);
+    }
+}
+
+static void tree_proc_failed (struct tree_launch *t,
+                              unsigned int rank,
+                              int errnum,
+                              const char *errstr)
+{
+    flux_subprocess_t *p = tree_proc_lookup (t, rank);
+    if (p && flux_subprocess_active (p)) {
+        p->failed_errno = errnum;
+        if (errstr)
+            snprintf (p->failed_error.text,
+                      sizeof (p->failed_error.text),
+                      "%s",
+                      errstr);
+        p->state = p->state_reported = FLUX_SUBPROCESS_FAILED;
+        exec_state_cb (p, FLUX_SUBPROCESS_FAILED);
+    }
+}
+
+static void tree_output (struct tree_launch *t, json_t *output)
+{
+    size_t index;
+    json_t *io;
+
+    json_array_foreach (output, index, io) {
+        const char *stream;
+        const char *rank;
+        char *data = NULL;
+        int len;
+        flux_subprocess_t *p;
+
+        if (iodecode (io, &stream, &rank, &data, &len, NULL) < 0) {
+            flux_log_error (t->exec->h, "tree-exec %s: iodecode", t->key);
+            continue;
+        }
+        if (len > 0 && (p = tree_proc_lookup (t, strtoul (rank, NULL, 10))))
+            exec_output (t->exec, p, stream, data, len);
+        free (data);
+    }
+}
+
+/*  The tree-exec request terminated.  Any process not yet accounted for
+ *   is considered failed, e.g. if the root broker's subtree was lost.
+ */
+static void tree_launch_finish (struct tree_launch *t,
+                                int errnum,
+                                const char *errstr)
+{
+    flux_subprocess_t *p;
+    zlistx_t *ranks;
+    uint32_t *rank;
+
+    if (errnum == ENODATA) {
+        errnum = EPROTO;
+        errstr = "tree-exec ended without reporting process exit";
+    }
+    /* Collect ranks first, since tree_proc_failed() does its own lookup
+     * in t->procs, which would disturb the iteration.
+     */
+    if (!(ranks = zlistx_new ())) {
+        flux_log_error (t->exec->h, "tree-exec %s: zlistx_new", t->key);
+        return;
+    }
+    p = zhashx_first (t->procs);
+    while (p) {
+        if (flux_subprocess_active (p))
+            zlistx_add_end (ranks, &p->rank);
+        p = zhashx_next (t->procs);
+    }
+    rank = zlistx_first (ranks);
+    while (rank) {
+        tree_proc_failed (t, *rank, errnum, errstr);
+        rank = zlistx_next (ranks);
+    }
+    zlistx_destroy (&ranks);
+}
+
+static void tree_launch_continuation (flux_future_t *f, void *arg)
+{
+    struct tree_launch *t = arg;
+    const char *started = NULL;
+    json_t *exited = NULL;
+    json_t *failed = NULL;
+    json_t *output = NULL;
+    const char *key;
+    json_t *val;
+    size_t index;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s?s s?o s?o s?o}",
+                             "started", &started,
+                             "exited", &exited,
+                             "failed", &failed,
+                             "output", &output) < 0) {
+        if (errno != ENODATA)
+            flux_log (t->exec->h,
+                      LOG_ERR,
+                      "tree-exec %s: %s",
+                      t->key,
+                      future_strerror (f, errno));
+        tree_launch_finish (t, errno, future_strerror (f, errno));
+        return;
+    }
+    if (started) {
+        struct idset *ids = idset_decode (started);
+        unsigned int rank = idset_first (ids);
+        while (rank != IDSET_INVALID_ID) {
+            tree_proc_started (t, rank);
+            rank = idset_next (ids, rank);
+        }
+        idset_destroy (ids);
+    }
+    if (output)
+        tree_output (t, output);
+    json_object_foreach (exited, key, val) {
+        int status = strtol (key, NULL, 10);
+        struct idset *ids = idset_decode (json_string_value (val));
+        unsigned int rank = idset_first (ids);
+        while (rank != IDSET_INVALID_ID) {
+            tree_proc_exited (t, rank, status);
+            rank = idset_next (ids, rank);
+        }
+        idset_destroy (ids);
+    }
+    json_array_foreach (failed, index, val) {
+        int rank;
+        int errnum;
+        const char *errstr;
+        if (json_unpack (val, "[i i s]", &rank, &errnum, &errstr) == 0)
+            tree_proc_failed (t, rank, errnum, errstr);
+    }
+    flux_future_reset (f);
+}
+
+/*  Launch 'cmd' on all of its ranks with one tree-exec request to the
+ *   TBON root, which forwards it down the tree.  Proxy subprocess objects
+ *   stand in for each rank so bulk-exec users see the usual per-rank API.
+ */
+static int exec_tree_start_cmd (struct bulk_exec *exec, struct exec_cmd *cmd)
+{
+    struct tree_launch *t;
+    unsigned int rank;
+    char topic[128];
+    char *ranks = NULL;
+    json_t *o = NULL;
+    json_t *barrier = NULL;
+
+    if (!(t = calloc (1, sizeof (*t))))
+        return -1;
+    t->exec = exec;
+    if (!(t->procs = zhashx_new ())
+        || zlist_append (exec->trees, t) < 0) {
+        tree_launch_destroy (t);
+        errno = ENOMEM;
+        return -1;
+    }
+    zlist_freefn (exec->trees, t, tree_launch_destroy, true);
+    snprintf (t->key,
+              sizeof (t->key),
+              "%s-%s-%d",
+              idf58 (exec->id),
+              exec->name,
+              exec->tree_seq++);
+
+    rank = idset_first (cmd->ranks);
+    while (rank != IDSET_INVALID_ID) {
+        flux_subprocess_t *p;
+        char key[16];
+
+        if (!(p = subprocess_proxy_create (exec->h, cmd->cmd, rank)))
+            return -1;
+        if (flux_subprocess_aux_set (p, "job-exec::exec", exec, NULL) < 0
+            || zlist_append (exec->processes, p) < 0) {
+            flux_subprocess_destroy (p);
+            return -1;
+        }
+        zlist_freefn (exec->processes, p,
+                     (zlist_free_fn *) flux_subprocess_destroy,
+                     true);
+        snprintf (key, sizeof (key), "%u", rank);
+        if (zhashx_insert (t->procs, key, p) < 0) {
+            errno = EEXIST;
+            return -1;
+        }
+        rank = idset_next (cmd->ranks, rank);
+    }
+
+    /*  Processes find their barrier via the tree-exec key.
+     */
+    if (exec->tree_barrier) {
+        if (flux_cmd_setenvf (cmd->cmd,
+                              1,
+                              "FLUX_EXEC_TREE_BARRIER",
+                              "%s",
+                              t->key) < 0
+            || !(barrier = json_pack ("{s:s s:I s:i}",
+                                      "topic", exec->tree_barrier,
+                                      "id", (json_int_t)exec->id,
+                                      "userid", (int)exec->tree_userid))) {
+            errno = ENOMEM;
+            goto error;
+        }
+    }
+    snprintf (topic, sizeof (topic), "%s.tree-exec", exec->service);
+    if (!(ranks = idset_encode (cmd->ranks, IDSET_FLAG_RANGE))
+        || !(o = cmd_tojson (cmd->cmd))
+        || !(t->f = flux_rpc_pack (exec->h,
+                                   topic,
+                                   0,
+                                   FLUX_RPC_STREAMING,
+                                   "{s:s s:s s:O s:i s:O?}",
+                                   "key", t->key,
+                                   "ranks", ranks,
+                                   "cmd", o,
+                                   "flags", cmd->flags,
+                                   "barrier", barrier))
+        || flux_future_then (t->f, -1., tree_launch_continuation, t) < 0)
+        goto error;
+    idset_range_clear (cmd->ranks, 0, INT_MAX);
+    free (ranks);
+    json_decref (o);
+    json_decref (barrier);
+    return 0;
+error:
+    ERRNO_SAFE_WRAP (free, ranks);
+    ERRNO_SAFE_WRAP (json_decref, o);
+    ERRNO_SAFE_WRAP (json_decref, barrier);
+    return -1;
+}
+
 void bulk_exec_stop (struct bulk_exec *exec)
 {
     flux_watcher_stop (exec->prep);
@@ -442,7 +748,17 @@ static int exec_start_cmds (struct bulk_exec *exec, int max)
 {
     while (zlist_size (exec->commands) && (max != 0)) {
         struct exec_cmd *cmd = zlist_first (exec->commands);
-        int rc = exec_start_cmd (exec, cmd, max);
+        int rc;
+
+        if (exec->tree) {
+            if (exec_tree_start_cmd (exec, cmd) < 0) {
+                flux_log_error (exec->h, "exec_tree_start_cmd failed");
+                return -1;
+            }
+            zlist_remove (exec->commands, cmd);
+            continue;
+        }
+        rc = exec_start_cmd (exec, cmd, max);
         if (rc < 0) {
             flux_log_error (exec->h, "exec_start_cmd failed");
             return -1;
@@ -492,6 +808,7 @@ void bulk_exec_destroy (struct bulk_exec *exec)
 {
     if (exec) {
         int saved_errno = errno;
+        zlist_destroy (&exec->trees);
         zlist_destroy (&exec->processes);
         zlist_destroy (&exec->commands);
         idset_destroy (exec->exit_batch);
@@ -500,6 +817,7 @@ void bulk_exec_destroy (struct bulk_exec *exec)
         flux_watcher_destroy (exec->idle);
         flux_watcher_destroy (exec->exit_batch_timer);
         aux_destroy (&exec->aux);
+        free (exec->tree_barrier);
         free (exec->name);
         free (exec->service);
         free (exec);
@@ -531,6 +849,7 @@ struct bulk_exec * bulk_exec_create (struct bulk_exec_ops *ops,
     exec->arg = arg;
     exec->processes = zlist_new ();
     exec->commands = zlist_new ();
+    exec->trees = zlist_new ();
     exec->exit_batch = idset_create (0, IDSET_FLAG_AUTOGROW);
     exec->max_start_per_loop = 1;
 
@@ -550,6 +869,34 @@ int bulk_exec_set_max_per_loop (struct bulk_exec *exec, int max)
     return 0;
 }
 
+int bulk_exec_set_tree_launch (struct bulk_exec *exec, bool enable)
+{
+    if (!exec || exec->active || !streq (exec->service, "rexec")) {
+        errno = EINVAL;
+        return -1;
+    }
+    exec->tree = enable ? 1 : 0;
+    return 0;
+}
+
+int bulk_exec_set_tree_barrier (struct bulk_exec *exec,
+                                const char *topic,
+                                uint32_t userid)
+{
+    char *cpy;
+
+    if (!exec || !exec->tree || !topic) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(cpy = strdup (topic)))
+        return -1;
+    free (exec->tree_barrier);
+    exec->tree_barrier = cpy;
+    exec->tree_userid = userid;
+    return 0;
+}
+
 int bulk_exec_push_cmd (struct bulk_exec *exec,
                        const struct idset *ranks,
                        flux_cmd_t *cmd,
@@ -667,6 +1014,61 @@ void bulk_exec_kill_log_error (flux_future_t *f, flux_jobid_t id)
     }
 }
 
+/*  Signal active proxy processes in 'ranks' with one tree-kill request per
+ *   tree launch.
+ */
+static int exec_tree_kill (struct bulk_exec *exec,
+                           flux_future_t *cf,
+                           const struct idset *ranks,
+                           int signum)
+{
+    struct tree_launch *t;
+    char topic[128];
+
+    snprintf (topic, sizeof (topic), "%s.tree-kill", exec->service);
+    t = zlist_first (exec->trees);
+    while (t) {
+        struct idset *ids;
+        flux_subprocess_t *p;
+        char *s = NULL;
+        flux_future_t *f = NULL;
+
+        if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW)))
+            return -1;
+        p = zhashx_first (t->procs);
+        while (p) {
+            if (flux_subprocess_active (p)
+                && (!ranks || idset_test (ranks, p->rank))
+                && idset_set (ids, p->rank) < 0)
+                goto error;
+            p = zhashx_next (t->procs);
+        }
+        if (!idset_empty (ids)) {
+            if (!(s = idset_encode (ids, IDSET_FLAG_RANGE))
+                || !(f = flux_rpc_pack (exec->h,
+                                        topic,
+                                        0,
+                                        0,
+                                        "{s:s s:s s:i}",
+                                        "key", t->key,
+                                        "ranks", s,
+                                        "signal", signum))
+                || flux_future_push (cf, t->key, f) < 0)
+                goto error;
+            free (s);
+        }
+        idset_destroy (ids);
+        t = zlist_next (exec->trees);
+        continue;
+error:
+        flux_future_destroy (f);
+        free (s);
+        idset_destroy (ids);
+        return -1;
+    }
+    return 0;
+}
+
 flux_future_t *bulk_exec_kill (struct bulk_exec *exec,
                                const struct idset *ranks,
                                int signum)
@@ -683,6 +1085,14 @@ flux_future_t *bulk_exec_kill (struct bulk_exec *exec,
         return NULL;
     flux_future_set_flux (cf, exec->h);
 
+    if (exec->tree) {
+        if (exec_tree_kill (exec, cf, ranks, signum) < 0) {
+            flux_future_destroy (cf);
+            return NULL;
+        }
+        goto done;
+    }
+
     p = zlist_first (exec->processes);
     while (p) {
         if ((!ranks || idset_test (ranks, flux_subprocess_rank (p)))) {
@@ -712,6 +1122,7 @@ flux_future_t *bulk_exec_kill (struct bulk_exec *exec,
         p = zlist_next (exec->processes);
     }
 
+done:
     /*  If no child futures were pushed into the wait_all future `cf`,
      *   then no signals were sent and we should immediately return ENOENT.
      */
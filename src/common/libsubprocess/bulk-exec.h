@@ -60,6 +60,24 @@ int bulk_exec_aux_set (struct bulk_exec *exec,
  */
 int bulk_exec_set_max_per_loop (struct bulk_exec *exec, int max);
 
+/*  Launch each command with a single request to the TBON root, which
+ *   forwards it down the overlay tree and aggregates process events on
+ *   the way back up.  Only supported for the "rexec" service, and must be
+ *   called before bulk_exec_start().  bulk_exec_write(3) and
+ *   bulk_exec_close(3) are not supported in this mode.
+ */
+int bulk_exec_set_tree_launch (struct bulk_exec *exec, bool enable);
+
+/*  In tree launch mode, let processes enter a barrier that is reduced at
+ *   each broker on the way up the tree.  The root sends {id, ranks} to
+ *   'topic' and the response is relayed back down.  Processes find the
+ *   barrier via FLUX_EXEC_TREE_BARRIER in their environment, and their
+ *   barrier requests are authorized against 'userid'.
+ */
+int bulk_exec_set_tree_barrier (struct bulk_exec *exec,
+                                const char *topic,
+                                uint32_t userid);
+
 void bulk_exec_destroy (struct bulk_exec *exec);
 
 int bulk_exec_push_cmd (struct bulk_exec *exec,
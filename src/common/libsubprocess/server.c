@@ -1239,12 +1239,9 @@ error:
     json_decref (procs);
 }
 
-static void server_disconnect_cb (flux_t *h,
-                                  flux_msg_handler_t *mh,
-                                  const flux_msg_t *msg,
-                                  void *arg)
+void subprocess_server_disconnect (subprocess_server_t *s,
+                                   const flux_msg_t *msg)
 {
-    subprocess_server_t *s = arg;
     const char *sender;
 
     if ((sender = flux_msg_route_first (msg))) {
@@ -1276,6 +1273,14 @@ static void server_disconnect_cb (flux_t *h,
     }
 }
 
+static void server_disconnect_cb (flux_t *h,
+                                  flux_msg_handler_t *mh,
+                                  const flux_msg_t *msg,
+                                  void *arg)
+{
+    subprocess_server_disconnect (arg, msg);
+}
+
 static void server_wait_cb (flux_t *h,
                             flux_msg_handler_t *mh,
                             const flux_msg_t *msg,
@@ -50,6 +50,13 @@ void subprocess_server_set_auth_cb (subprocess_server_t *s,
  */
 void subprocess_server_destroy (subprocess_server_t *s);
 
+/* Handle a 'service'.disconnect request.  The server registers its own
+ * handler for it, so this is only needed by a caller that overrides that
+ * handler to also act on the disconnect.
+ */
+void subprocess_server_disconnect (subprocess_server_t *s,
+                                   const flux_msg_t *msg);
+
 /* Send all subprocesses a signal and return a future that is fulfilled
  * when all subprocesses have exited.  New rexec.exec requests will fail.
  * This future is fulfilled immediately if there are no subprocesses, but if
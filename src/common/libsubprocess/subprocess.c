@@ -244,6 +244,32 @@ error:
     return NULL;
 }
 
+flux_subprocess_t *subprocess_proxy_create (flux_t *h,
+                                             const flux_cmd_t *cmd,
+                                             int rank)
+{
+    flux_subprocess_t *p;
+
+    if (!h || !cmd || rank < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(p = calloc (1, sizeof (*p))))
+        return NULL;
+    init_pair_fds (p->sync_fds);
+    if (!(p->cmd = flux_cmd_copy (cmd))) {
+        subprocess_free (p);
+        return NULL;
+    }
+    p->h = h;
+    p->reactor = flux_get_reactor (h);
+    p->rank = rank;
+    p->state = FLUX_SUBPROCESS_INIT;
+    p->state_reported = p->state;
+    p->refcount = 1;
+    return p;
+}
+
 /*
  * Accessors
  */
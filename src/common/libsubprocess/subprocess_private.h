@@ -140,6 +140,13 @@ struct subprocess_channel *channel_create (flux_subprocess_t *p,
 
 struct idset * subprocess_childfds (flux_subprocess_t *p);
 
+/* Create a remote subprocess object for 'cmd' on 'rank' that is not backed
+ * by an exec RPC.  The caller is responsible for updating its state.
+ */
+flux_subprocess_t *subprocess_proxy_create (flux_t *h,
+                                             const flux_cmd_t *cmd,
+                                             int rank);
+
 void subprocess_incref (flux_subprocess_t *p);
 void subprocess_decref (flux_subprocess_t *p);
 
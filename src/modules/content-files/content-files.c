@@ -47,6 +47,10 @@
  *
  * Once loaded this module can also be exercised directly using
  * flux-content(1) with the --bypass-cache option.
+ *
+ * By default, files contain the raw blob.  With codec=lz4 or codec=zstd,
+ * blobs large enough to benefit are stored compressed (see filedb.h).
+ * Files written with any codec can be read regardless of this setting.
  */
 
 #if HAVE_CONFIG_H
@@ -63,6 +67,7 @@
 #include "ccan/str/str.h"
 
 #include "src/common/libcontent/content-util.h"
+#include "src/common/libcontent/content-codec.h"
 
 #include "filedb.h"
 
@@ -72,6 +77,7 @@ struct content_files {
     flux_t *h;
     char *hashfun;
     int hash_size;
+    struct content_codec *codec;
 };
 
 static int file_count_cb (dirwalk_t *d, void *arg)
@@ -141,7 +147,12 @@ static void load_cb (flux_t *h,
                            blobref,
                            sizeof (blobref)) < 0)
         goto error;
-    if (filedb_get (ctx->dbpath, blobref, &data, &size, &errstr) < 0)
+    if (filedb_get (ctx->dbpath,
+                    blobref,
+                    ctx->codec,
+                    &data,
+                    &size,
+                    &errstr) < 0)
         goto error;
     if (flux_respond_raw (h, msg, data, size) < 0)
         flux_log_error (h, "error responding to load request");
@@ -185,7 +196,12 @@ void store_cb (flux_t *h,
                            blobref,
                            sizeof (blobref)) < 0)
         goto error;
-    if (filedb_put (ctx->dbpath, blobref, data, size, &errstr) < 0)
+    if (filedb_put (ctx->dbpath,
+                    blobref,
+                    data,
+                    size,
+                    ctx->codec,
+                    &errstr) < 0)
         goto error;
     if (flux_respond_raw (h, msg, hash, hash_size) < 0)
         flux_log_error (h, "error responding to store request");
@@ -236,7 +252,7 @@ error:
 /* Handle a content-backing.checkpoint-get request from the rank 0 kvs module.
  * The KVS stores its last root reference here for restart purposes.
  *
- * N.B. filedb_get() calls read_all() which ensures that the returned buffer
+ * N.B. filedb_get() ensures that the returned buffer
  * is padded with an extra NULL not included in the returned length,
  * so it is safe to use the result as a string argument in flux_respond_pack().
  */
@@ -254,6 +270,7 @@ void checkpoint_get_cb (flux_t *h,
 
     if (filedb_get (ctx->dbpath,
                     KVS_DEFAULT_CHECKPOINT,
+                    ctx->codec,
                     &data,
                     &size,
                     &errstr) < 0)
@@ -307,6 +324,7 @@ void checkpoint_put_cb (flux_t *h,
                     KVS_DEFAULT_CHECKPOINT,
                     value,
                     strlen (value),
+                    ctx->codec,
                     &errstr) < 0)
         goto error;
     if (flux_respond (h, msg, NULL) < 0)
@@ -328,6 +346,7 @@ static void content_files_destroy (struct content_files *ctx)
         flux_msg_handler_delvec (ctx->handlers);
         free (ctx->dbpath);
         free (ctx->hashfun);
+        content_codec_destroy (ctx->codec);
         free (ctx);
         errno = saved_errno;
     }
@@ -378,15 +397,22 @@ static const struct flux_msg_handler_spec htab[] = {
 
 /* Create module context and perform some initialization.
  */
-static struct content_files *content_files_create (flux_t *h, bool truncate)
+static struct content_files *content_files_create (flux_t *h,
+                                                   bool truncate,
+                                                   const char *codec)
 {
     struct content_files *ctx;
     const char *statedir;
     const char *s;
+    flux_error_t error;
 
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
     ctx->h = h;
+    if (!(ctx->codec = content_codec_create (codec, &error))) {
+        flux_log (h, LOG_ERR, "codec=%s: %s", codec, error.text);
+        goto error;
+    }
 
     /* Some tunables:
      * - the hash function, e.g. sha1, sha256
@@ -423,7 +449,8 @@ static int parse_args (flux_t *h,
                        int argc,
                        char **argv,
                        bool *testing,
-                       bool *truncate)
+                       bool *truncate,
+                       const char **codec)
 {
     int i;
     for (i = 0; i < argc; i++) {
@@ -431,6 +458,8 @@ static int parse_args (flux_t *h,
             *testing = true;
         else if (streq (argv[i], "truncate"))
             *truncate = true;
+        else if (strstarts (argv[i], "codec="))
+            *codec = argv[i] + 6;
         else {
             flux_log (h, LOG_ERR, "Unknown module option: %s", argv[i]);
             errno = EINVAL;
@@ -457,11 +486,12 @@ int mod_main (flux_t *h, int argc, char **argv)
     struct content_files *ctx;
     bool testing = false;
     bool truncate = false;
+    const char *codec = "none";
     int rc = -1;
 
-    if (parse_args (h, argc, argv, &testing, &truncate) < 0)
+    if (parse_args (h, argc, argv, &testing, &truncate, &codec) < 0)
         return -1;
-    if (!(ctx = content_files_create (h, truncate))) {
+    if (!(ctx = content_files_create (h, truncate, codec))) {
         flux_log_error (h, "content_files_create failed");
         return -1;
     }
@@ -19,6 +19,8 @@
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <arpa/inet.h>
 
 #include "src/common/libutil/read_all.h"
 #include "src/common/libutil/errno_safe.h"
@@ -39,13 +41,28 @@ static int filedb_input_check (const char *key, const char **errstr)
     return 0;
 }
 
+/* Build the path of 'key' as stored with 'codec'.
+ */
 static int filedb_path (const char *dbpath,
                         const char *key,
+                        int codec,
                         char *path,
                         size_t path_len,
                         const char **errstr)
 {
-    if (snprintf (path, path_len, "%s/%s", dbpath, key) >= path_len) {
+    int n;
+
+    if (codec == CONTENT_CODEC_NONE)
+        n = snprintf (path, path_len, "%s/%s", dbpath, key);
+    else {
+        n = snprintf (path,
+                      path_len,
+                      "%s/%s.%s",
+                      dbpath,
+                      key,
+                      content_codec_id_to_name (codec));
+    }
+    if (n >= path_len) {
         errno = EOVERFLOW;
         if (errstr)
             *errstr = "key name too long for internal buffer";
@@ -54,20 +71,12 @@ static int filedb_path (const char *dbpath,
     return 0;
 }
 
-int filedb_get (const char *dbpath,
-                const char *key,
-                void **datap,
-                size_t *sizep,
-                const char **errstr)
+static int filedb_read (const char *path, void **datap, size_t *sizep)
 {
-    char path[1024];
     int fd;
     void *data;
     ssize_t size;
 
-    if (filedb_input_check (key, errstr) < 0
-        || filedb_path (dbpath, key, path, sizeof (path), errstr) < 0)
-        return -1;
     if ((fd = open (path, O_RDONLY)) < 0)
         return -1;
     if ((size = read_all (fd, &data)) < 0) {
@@ -83,27 +92,157 @@ int filedb_get (const char *dbpath,
     return 0;
 }
 
+/* Uncompress a value read from a file written with 'id'.
+ * Like read_all(), pad the result with a NUL byte.
+ */
+static int filedb_uncompress (struct content_codec *codec,
+                              int id,
+                              const void *data,
+                              size_t size,
+                              void **datap,
+                              size_t *sizep,
+                              const char **errstr)
+{
+    uint32_t hdr;
+    size_t usize;
+    char *buf;
+
+    if (size < sizeof (hdr)) {
+        errno = EINVAL;
+        if (errstr)
+            *errstr = "compressed file is truncated";
+        return -1;
+    }
+    memcpy (&hdr, data, sizeof (hdr));
+    usize = ntohl (hdr);
+    if (!(buf = malloc (usize + 1)))
+        return -1;
+    if (content_codec_decompress (codec,
+                                  id,
+                                  (char *)data + sizeof (hdr),
+                                  size - sizeof (hdr),
+                                  buf,
+                                  usize) < 0) {
+        if (errstr && errno == EINVAL)
+            *errstr = "compressed file is corrupt";
+        ERRNO_SAFE_WRAP (free, buf);
+        return -1;
+    }
+    buf[usize] = '\0';
+    *datap = buf;
+    *sizep = usize;
+    return 0;
+}
+
+int filedb_get (const char *dbpath,
+                const char *key,
+                struct content_codec *codec,
+                void **datap,
+                size_t *sizep,
+                const char **errstr)
+{
+    char path[1024];
+    void *data;
+    size_t size;
+    int id;
+
+    if (filedb_input_check (key, errstr) < 0)
+        return -1;
+    for (id = CONTENT_CODEC_NONE; content_codec_id_to_name (id); id++) {
+        if (filedb_path (dbpath, key, id, path, sizeof (path), errstr) < 0)
+            return -1;
+        if (filedb_read (path, &data, &size) == 0)
+            break;
+        if (errno != ENOENT)
+            return -1;
+    }
+    if (!content_codec_id_to_name (id)) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (id != CONTENT_CODEC_NONE) {
+        void *udata;
+        size_t usize;
+
+        if (filedb_uncompress (codec,
+                               id,
+                               data,
+                               size,
+                               &udata,
+                               &usize,
+                               errstr) < 0) {
+            ERRNO_SAFE_WRAP (free, data);
+            return -1;
+        }
+        free (data);
+        data = udata;
+        size = usize;
+    }
+    *datap = data;
+    *sizep = size;
+    return 0;
+}
+
 int filedb_put (const char *dbpath,
                 const char *key,
                 const void *data,
                 size_t size,
+                struct content_codec *codec,
                 const char **errstr)
 {
     char path[1024];
     int fd;
+    int id = CONTENT_CODEC_NONE;
+    char *buf = NULL;
 
-    if (filedb_input_check (key, errstr) < 0
-        || filedb_path (dbpath, key, path, sizeof (path), errstr) < 0)
+    if (filedb_input_check (key, errstr) < 0)
         return -1;
+    if (codec
+        && content_codec_wanted (codec, size)
+        && size <= UINT32_MAX) {
+        size_t bound = content_codec_bound (codec, size);
+        uint32_t hdr = htonl (size);
+        ssize_t n;
+
+        if (!(buf = malloc (sizeof (hdr) + bound)))
+            return -1;
+        if ((n = content_codec_compress (codec,
+                                         data,
+                                         size,
+                                         buf + sizeof (hdr),
+                                         bound)) < 0) {
+            if (errstr)
+                *errstr = "compression failed";
+            goto error;
+        }
+        memcpy (buf, &hdr, sizeof (hdr));
+        data = buf;
+        size = sizeof (hdr) + n;
+        id = content_codec_id (codec);
+    }
+    if (filedb_path (dbpath, key, id, path, sizeof (path), errstr) < 0)
+        goto error;
     if ((fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0)
-        return -1;
+        goto error;
     if (write_all (fd, data, size) < 0) {
         ERRNO_SAFE_WRAP (close, fd);
-        return -1;
+        goto error;
     }
     if (close (fd) < 0)
-        return -1;
+        goto error;
+    /* Remove any copy stored with another codec, e.g. an old checkpoint,
+     * so filedb_get() can't find it first.
+     */
+    for (int other = 0; content_codec_id_to_name (other); other++) {
+        if (other != id
+            && filedb_path (dbpath, key, other, path, sizeof (path), NULL) == 0)
+            (void)unlink (path);
+    }
+    free (buf);
     return 0;
+error:
+    ERRNO_SAFE_WRAP (free, buf);
+    return -1;
 }
 
 int filedb_validate (const char *dbpath,
@@ -113,12 +252,17 @@ int filedb_validate (const char *dbpath,
     char path[1024];
     struct stat statbuf;
 
-    if (filedb_input_check (key, errstr) < 0
-        || filedb_path (dbpath, key, path, sizeof (path), errstr) < 0)
+    if (filedb_input_check (key, errstr) < 0)
         return -1;
-    if (stat (path, &statbuf) < 0)
-        return -1;
-    return 0;
+    for (int id = CONTENT_CODEC_NONE; content_codec_id_to_name (id); id++) {
+        if (filedb_path (dbpath, key, id, path, sizeof (path), errstr) < 0)
+            return -1;
+        if (stat (path, &statbuf) == 0)
+            return 0;
+        if (errno != ENOENT)
+            return -1;
+    }
+    return -1;
 }
 
 /*
@@ -11,22 +11,36 @@
 #ifndef _CONTENT_FILES_FILEDB_H
 #define _CONTENT_FILES_FILEDB_H
 
-/* Read file named 'key' from the dbpath directory.
+#include "src/common/libcontent/content-codec.h"
+
+/* A compressed value is stored in a file named 'key' plus a '.codec'
+ * suffix, e.g. "key.lz4", that contains the uncompressed size as a 32 bit
+ * big endian integer followed by the compressed data.  An uncompressed
+ * value is stored as is in a file named 'key'.
+ */
+
+/* Read file named 'key' from the dbpath directory, uncompressing it if
+ * necessary.  'codec' may be NULL unless the value was compressed with
+ * a dictionary.
  * On success, 'datap' and 'sizep' are assigned the contents and size
- * and 0 is returned (*datap must be freed).
+ * and 0 is returned (*datap must be freed).  The contents are followed
+ * by a NUL byte that is not included in the size.
  * On failure, -1 is returned with errno set.
  * Pass '*errstr' (pre-set to NULL) and if a human readable error message
  * is appropriate, it is assigned on error (do not free).
  */
 int filedb_get (const char *dbpath,
                 const char *key,
+                struct content_codec *codec,
                 void **datap,
                 size_t *sizep,
                 const char **errstr);
 
 
 /* Put file named 'key' with content 'data' and length 'size' to the
- * dbpath directory.  On success, 0 is returned.
+ * dbpath directory, compressed with 'codec' if it is non-NULL and the
+ * codec wants to compress a value of that size.  Any copy of 'key'
+ * stored with a different codec is removed.  On success, 0 is returned.
  * On failure, -1 is returned with errno set.
  * Pass '*errstr' (pre-set to NULL) and if a human readable error message
  * is appropriate, it is assigned on error (do not free).
@@ -35,9 +49,11 @@ int filedb_put (const char *dbpath,
                 const char *key,
                 const void *data,
                 size_t size,
+                struct content_codec *codec,
                 const char **errstr);
 
-/* Validate file named 'key' from the dbpath directory exists.
+/* Validate file named 'key' from the dbpath directory exists,
+ * compressed or not.
  * Return 0 if file exists.
  * On failure, -1 is returned with errno set.
  * Pass '*errstr' (pre-set to NULL) and if a human readable error message
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/stat.h>
 
 #include "src/common/libtap/tap.h"
 #include "src/modules/content-files/filedb.h"
@@ -34,21 +35,22 @@ void test_badargs (const char *dbpath)
 
     errno = 0;
     errstr = NULL;
-    ok (filedb_get (dbpath, "/", &data, &size, &errstr) < 0 && errno == EINVAL,
+    ok (filedb_get (dbpath, "/", NULL, &data, &size, &errstr) < 0
+        && errno == EINVAL,
         "filedb_get key=\"/\" failed with EINVAL");
     ok (errstr != NULL,
         "and error string was set");
 
     errno = 0;
     errstr = NULL;
-    ok (filedb_get (dbpath, longkey, &data, &size, &errstr) < 0
+    ok (filedb_get (dbpath, longkey, NULL, &data, &size, &errstr) < 0
         && errno == EOVERFLOW,
         "filedb_get key=<long> failed with EOVERFLOW");
     ok (errstr != NULL,
         "and error string was set");
 
     errno = 0;
-    ok (filedb_get (dbpath, "noexist", &data, &size, &errstr) < 0
+    ok (filedb_get (dbpath, "noexist", NULL, &data, &size, &errstr) < 0
         && errno == ENOENT,
         "filedb_get key=\"\" failed with ENOENT");
 
@@ -56,14 +58,14 @@ void test_badargs (const char *dbpath)
 
     errno = 0;
     errstr = NULL;
-    ok (filedb_put (dbpath, "", "", 1, &errstr) < 0 && errno == EINVAL,
+    ok (filedb_put (dbpath, "", "", 1, NULL, &errstr) < 0 && errno == EINVAL,
         "filedb_put key=\"\" failed with EINVAL");
     ok (errstr != NULL,
         "and error string was set");
 
     errno = 0;
     errstr = NULL;
-    ok (filedb_put (dbpath, longkey, "", 1, &errstr) < 0
+    ok (filedb_put (dbpath, longkey, "", 1, NULL, &errstr) < 0
         && errno == EOVERFLOW,
         "filedb_put key=<long> failed with EOVERFLOW");
     ok (errstr != NULL,
@@ -99,13 +101,13 @@ void test_simple (const char *dbpath)
 
     ok (filedb_validate (dbpath, "key1", &errstr) < 0,
         "filedb_validate fails on non-existent key");
-    ok (filedb_put (dbpath, "key1", val1, sizeof (val1), &errstr) == 0,
+    ok (filedb_put (dbpath, "key1", val1, sizeof (val1), NULL, &errstr) == 0,
         "filedb_put key1={abc} works");
     ok (filedb_validate (dbpath, "key1", &errstr) == 0,
         "filedb_validate success existent key");
     size = 0;
     data = NULL;
-    ok (filedb_get (dbpath, "key1", &data, &size, &errstr) == 0,
+    ok (filedb_get (dbpath, "key1", NULL, &data, &size, &errstr) == 0,
         "filedb_get key1 works");
     ok (data && size == sizeof (val1) && memcmp (data, val1, size) == 0,
         "and returned data matches");
@@ -113,15 +115,102 @@ void test_simple (const char *dbpath)
 
     /* overwrite key is allowed (e.g. for checkpoint support) */
 
-    ok (filedb_put (dbpath, "key1", val2, sizeof (val2), &errstr) == 0,
+    ok (filedb_put (dbpath, "key1", val2, sizeof (val2), NULL, &errstr) == 0,
         "filedb_put key1={zyxwvu} works (overwrite)");
-    ok (filedb_get (dbpath, "key1", &data, &size, &errstr) == 0,
+    ok (filedb_get (dbpath, "key1", NULL, &data, &size, &errstr) == 0,
         "filedb_get key1 works");
     ok (data && size == sizeof (val2) && memcmp (data, val2, size) == 0,
         "and returned the updated data");
     free (data);
 }
 
+static bool file_exists (const char *dbpath, const char *name)
+{
+    char path[1024];
+    struct stat sb;
+
+    snprintf (path, sizeof (path), "%s/%s", dbpath, name);
+    return stat (path, &sb) == 0;
+}
+
+void test_codec (const char *dbpath, const char *name)
+{
+    struct content_codec *codec;
+    char suffixed[64];
+    char val[4096];
+    const char *errstr;
+    void *data;
+    size_t size;
+
+    if (!(codec = content_codec_create (name, NULL)))
+        BAIL_OUT ("content_codec_create %s failed", name);
+    snprintf (suffixed, sizeof (suffixed), "key2.%s", name);
+    for (int i = 0; i < sizeof (val); i++)
+        val[i] = 'a' + i % 7;
+
+    ok (filedb_put (dbpath, "key2", val, sizeof (val), codec, &errstr) == 0,
+        "%s: filedb_put key2 works", name);
+    ok (file_exists (dbpath, suffixed) && !file_exists (dbpath, "key2"),
+        "%s: value was stored compressed", name);
+    ok (filedb_validate (dbpath, "key2", &errstr) == 0,
+        "%s: filedb_validate finds the compressed value", name);
+    data = NULL;
+    size = 0;
+    ok (filedb_get (dbpath, "key2", codec, &data, &size, &errstr) == 0
+        && size == sizeof (val)
+        && memcmp (data, val, size) == 0
+        && ((char *)data)[size] == '\0',
+        "%s: filedb_get returns the original, NUL padded value", name);
+    free (data);
+
+    ok (filedb_put (dbpath, "key2", "xyz", 3, codec, &errstr) == 0,
+        "%s: filedb_put key2 with a small value works", name);
+    ok (file_exists (dbpath, "key2") && !file_exists (dbpath, suffixed),
+        "%s: value was stored uncompressed and the old copy removed", name);
+    ok (filedb_get (dbpath, "key2", codec, &data, &size, &errstr) == 0
+        && size == 3
+        && memcmp (data, "xyz", 3) == 0,
+        "%s: filedb_get returns the updated value", name);
+    free (data);
+
+    ok (filedb_put (dbpath, "key3", val, sizeof (val), codec, &errstr) == 0
+        && filedb_get (dbpath, "key3", NULL, &data, &size, &errstr) == 0
+        && size == sizeof (val)
+        && memcmp (data, val, size) == 0,
+        "%s: compressed value can be read without the codec", name);
+    free (data);
+    snprintf (suffixed, sizeof (suffixed), "key3.%s", name);
+    ok (file_exists (dbpath, suffixed),
+        "%s: key3 was stored compressed", name);
+    ok (filedb_put (dbpath, "key3", val, sizeof (val), NULL, &errstr) == 0
+        && file_exists (dbpath, "key3")
+        && !file_exists (dbpath, suffixed),
+        "%s: rewriting without the codec replaces the compressed copy", name);
+
+    content_codec_destroy (codec);
+}
+
+void test_corrupt (const char *dbpath)
+{
+    char path[1024];
+    const char *errstr = NULL;
+    void *data;
+    size_t size;
+    FILE *f;
+
+    snprintf (path, sizeof (path), "%s/key4.lz4", dbpath);
+    if (!(f = fopen (path, "w")))
+        BAIL_OUT ("could not create %s", path);
+    fwrite ("\0\0\0\x10garbage", 1, 11, f);
+    fclose (f);
+    errno = 0;
+    ok (filedb_get (dbpath, "key4", NULL, &data, &size, &errstr) < 0
+        && errno == EINVAL,
+        "filedb_get of a corrupt compressed value fails with EINVAL");
+    ok (errstr != NULL,
+        "and error string was set");
+}
+
 int main (int argc, char *argv[])
 {
     char dir[1024];
@@ -139,6 +228,10 @@ int main (int argc, char *argv[])
 
     test_badargs (dir);
     test_simple (dir);
+    test_codec (dir, "lz4");
+    if (content_codec_available (CONTENT_CODEC_ZSTD))
+        test_codec (dir, "zstd");
+    test_corrupt (dir);
 
     if (unlink_recursive (dir) < 0)
         BAIL_OUT ("unlink_recursive failed");
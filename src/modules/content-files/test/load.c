@@ -22,7 +22,7 @@ int main (int argc, char **argv)
         fprintf (stderr, "Usage: test_load dbpath key >output\n");
         exit (1);
     }
-    if (filedb_get (argv[1], argv[2], &data, &size, &errstr) < 0)
+    if (filedb_get (argv[1], argv[2], NULL, &data, &size, &errstr) < 0)
         log_msg_exit ("filedb_get: %s", errstr ? errstr : strerror (errno));
 
     log_msg ("%zu bytes", size);
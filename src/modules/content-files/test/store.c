@@ -26,7 +26,7 @@ int main (int argc, char **argv)
     if (size < 0)
         log_err_exit ("error reading stdin");
 
-    if (filedb_put (argv[1], argv[2], data, size, &errstr) < 0)
+    if (filedb_put (argv[1], argv[2], data, size, NULL, &errstr) < 0)
         log_msg_exit ("filedb_put : %s", errstr ? errstr : "failed");
 
     free (data);
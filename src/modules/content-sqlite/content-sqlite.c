@@ -17,8 +17,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <sys/statvfs.h>
+#include <limits.h>
+#include <pthread.h>
 #include <sqlite3.h>
-#include <lz4.h>
 #include <flux/core.h>
 #include <jansson.h>
 #include <assert.h>
@@ -30,23 +31,30 @@
 #include "src/common/libutil/tstat.h"
 #include "src/common/libutil/monotime.h"
 #include "src/common/libkvs/kvs_checkpoint.h"
+#include "src/common/libkvs/treeobj.h"
 
 #include "src/common/libcontent/content-util.h"
+#include "src/common/libcontent/content-codec.h"
+#include "ccan/array_size/array_size.h"
 #include "ccan/str/str.h"
 
-const size_t lzo_buf_chunksize = 1024*1024;
-const size_t compression_threshold = 256; /* compress blobs >= this size */
+const size_t compress_buf_chunksize = 1024*1024;
 
+/* 'size' is the uncompressed size of 'object', or -1 if it is stored
+ * uncompressed.  'codec' identifies the compressor (see content-codec.h).
+ * Objects stored before the codec column was added are LZ4.
+ */
 const char *sql_create_table = "CREATE TABLE if not exists objects("
                                "  hash BLOB PRIMARY KEY,"
                                "  size INT,"
                                "  object BLOB,"
-                               "  epoch INT DEFAULT 0"
+                               "  epoch INT DEFAULT 0,"
+                               "  codec INT DEFAULT 1"
                                ");";
-const char *sql_load = "SELECT object,size FROM objects"
+const char *sql_load = "SELECT object,size,codec FROM objects"
                        "  WHERE hash = ?1 LIMIT 1";
-const char *sql_store = "INSERT INTO objects (hash,size,object,epoch) "
-                        "  values (?1, ?2, ?3, ?4) "
+const char *sql_store = "INSERT INTO objects (hash,size,object,epoch,codec) "
+                        "  values (?1, ?2, ?3, ?4, ?5) "
                         "ON CONFLICT(hash) DO UPDATE SET epoch = excluded.epoch";
 const char *sql_validate = "SELECT EXISTS("
                            "  SELECT 1 FROM objects WHERE hash = ?1)";
@@ -77,18 +85,96 @@ const char *sql_table_list = "SELECT tbl_name FROM sqlite_master where type = 't
 const char *sql_checkpt_get_all = "SELECT * FROM checkpt_v2 ORDER BY id DESC";
 
 const char *sql_alter_objects_add_epoch = "ALTER TABLE objects ADD COLUMN epoch INT DEFAULT 0";
+const char *sql_alter_objects_add_codec = "ALTER TABLE objects ADD COLUMN codec INT DEFAULT 1";
 const char *sql_get_max_checkpt_id = "SELECT MAX(id) FROM checkpt_v2";
 const char *sql_table_info = "PRAGMA table_info(objects)";
 const char *sql_mark_blob = "UPDATE objects SET epoch = MAX(epoch, ?1) WHERE hash = ?2";
 /* Select up to 'delete_cap' (?4) garbage rowids in a bounded rowid window
- * (?2 < rowid <= ?3), ascending, resuming from a cursor.  See sweep_cb.
+ * (?2 < rowid <= ?3), ascending, resuming from a cursor.  Objects in the
+ * reachability index are live whatever their epoch.  See sweep_cb.
  */
 const char *sql_sweep_select = "SELECT rowid FROM objects"
                                "  WHERE epoch < ?1 AND rowid > ?2 AND rowid <= ?3"
+                               "  AND NOT EXISTS (SELECT 1 FROM gc_nodes"
+                               "    WHERE gc_nodes.hash = objects.hash)"
                                "  ORDER BY rowid LIMIT ?4";
 const char *sql_sweep_delete = "DELETE FROM objects WHERE rowid = ?1";
 const char *sql_max_rowid = "SELECT MAX(rowid) FROM objects";
-const char *sql_count_sweep_candidates = "SELECT COUNT(*) FROM objects WHERE epoch < ?1";
+const char *sql_count_sweep_candidates = "SELECT COUNT(*) FROM objects"
+                                         "  WHERE epoch < ?1"
+                                         "  AND NOT EXISTS (SELECT 1 FROM gc_nodes"
+                                         "    WHERE gc_nodes.hash = objects.hash)";
+
+/* Reachability index for incremental garbage collection (see gc_index_cb).
+ * gc_nodes holds every object reachable from the roots pinned in gc_pins.
+ * 'refs' counts the indexed tree objects that refer to the object, plus one
+ * if it is pinned.  'walked' is set once a tree object's references have
+ * been added to gc_refs.  Hashes are bound as text, as in the objects table,
+ * so the two compare equal.
+ */
+const char *sql_create_table_gc_nodes = "CREATE TABLE if not exists gc_nodes("
+                                        "  hash BLOB PRIMARY KEY,"
+                                        "  refs INT NOT NULL,"
+                                        "  tree INT NOT NULL,"
+                                        "  walked INT NOT NULL"
+                                        ") WITHOUT ROWID;";
+const char *sql_create_index_gc_unref = "CREATE INDEX if not exists gc_unref"
+                                        "  ON gc_nodes(refs) WHERE refs = 0;";
+const char *sql_create_index_gc_unwalked = "CREATE INDEX if not exists"
+                                           "  gc_unwalked ON gc_nodes(tree)"
+                                           "  WHERE walked = 0;";
+const char *sql_create_table_gc_refs = "CREATE TABLE if not exists gc_refs("
+                                       "  parent BLOB,"
+                                       "  child BLOB,"
+                                       "  PRIMARY KEY (parent, child)"
+                                       ") WITHOUT ROWID;";
+const char *sql_create_table_gc_pins = "CREATE TABLE if not exists gc_pins("
+                                       "  hash BLOB PRIMARY KEY"
+                                       ") WITHOUT ROWID;";
+const char *sql_create_table_gc_newpins = "CREATE TEMP TABLE if not exists"
+                                          "  gc_newpins("
+                                          "  hash BLOB PRIMARY KEY"
+                                          ") WITHOUT ROWID;";
+const char *sql_gc_walked_get = "SELECT walked FROM gc_nodes WHERE hash = ?1";
+const char *sql_gc_unwalked_get = "SELECT hash FROM gc_nodes"
+                                  "  WHERE tree = 1 AND walked = 0 LIMIT ?1";
+const char *sql_gc_unwalked_any = "SELECT EXISTS(SELECT 1 FROM gc_nodes"
+                                  "  WHERE tree = 1 AND walked = 0)";
+const char *sql_gc_walked_set = "INSERT INTO gc_nodes (hash,refs,tree,walked)"
+                                "  values (?1, 0, 1, 1) "
+                                "ON CONFLICT(hash) DO UPDATE"
+                                "  SET tree = 1, walked = 1";
+const char *sql_gc_ref_add = "INSERT OR IGNORE INTO gc_refs (parent,child)"
+                             "  values (?1, ?2)";
+const char *sql_gc_node_ref = "INSERT INTO gc_nodes (hash,refs,tree,walked)"
+                              "  values (?1, 1, ?2, 0) "
+                              "ON CONFLICT(hash) DO UPDATE"
+                              "  SET refs = refs + 1,"
+                              "  tree = MAX(tree, excluded.tree)";
+const char *sql_gc_newpin_add = "INSERT OR IGNORE INTO temp.gc_newpins (hash)"
+                                "  values (?1)";
+const char *sql_gc_newpin_unwalked = "SELECT COUNT(*) FROM temp.gc_newpins"
+                                     "  WHERE NOT EXISTS (SELECT 1 FROM gc_nodes"
+                                     "    WHERE gc_nodes.hash = gc_newpins.hash"
+                                     "    AND walked = 1)";
+const char *sql_gc_pin_swap[] = {
+    "UPDATE gc_nodes SET refs = refs - 1 WHERE hash IN ("
+    "  SELECT hash FROM gc_pins"
+    "  WHERE hash NOT IN (SELECT hash FROM temp.gc_newpins))",
+    "UPDATE gc_nodes SET refs = refs + 1 WHERE hash IN ("
+    "  SELECT hash FROM temp.gc_newpins"
+    "  WHERE hash NOT IN (SELECT hash FROM gc_pins))",
+    "DELETE FROM gc_pins",
+    "INSERT INTO gc_pins SELECT hash FROM temp.gc_newpins",
+    "DELETE FROM temp.gc_newpins",
+};
+const char *sql_gc_unref_get = "SELECT hash FROM gc_nodes"
+                               "  WHERE refs = 0 LIMIT 1";
+const char *sql_gc_unref_children = "UPDATE gc_nodes SET refs = refs - 1"
+                                    "  WHERE hash IN (SELECT child FROM gc_refs"
+                                    "    WHERE parent = ?1)";
+const char *sql_gc_refs_del = "DELETE FROM gc_refs WHERE parent = ?1";
+const char *sql_gc_node_del = "DELETE FROM gc_nodes WHERE hash = ?1";
 
 #define MAX_CHECKPOINTS_DEFAULT 5
 
@@ -121,9 +207,121 @@ const char *sql_count_sweep_candidates = "SELECT COUNT(*) FROM objects WHERE epo
 #define SWEEP_DELETE_MAX 8192
 #define SWEEP_WINDOW_MAX (1<<19)   /* 512K rows scanned per call */
 
+/* Per-call bounds on reachability index maintenance, which also runs on the
+ * reactor thread.  A gc-index call stops walking tree objects once either
+ * bound is reached and returns the rest as pending.  Walking a tree object
+ * means loading and decoding it, then one upsert per reference; a
+ * gc-collect call removes up to GC_COLLECT_MAX unreferenced objects.
+ */
+#define GC_INDEX_TREES_MAX 1024
+#define GC_INDEX_REFS_MAX 16384
+#define GC_COLLECT_MAX 4096
+
+/* With shards=N, the objects table is split across N database files by
+ * hash prefix, each owned by a worker thread.  The reactor thread keeps the
+ * checkpoint table and forwards object requests to the owning shard over an
+ * interthread channel.  A worker drains up to SHARD_BATCH_MAX queued
+ * requests per wakeup and commits all the stores among them in a single
+ * transaction.
+ */
+#define SHARDS_MAX 64
+#define SHARD_BATCH_MAX 256
+
+/* The background sweep started by sweep-start does its work in small
+ * slices when the reactor is otherwise idle, so that load and store
+ * requests are not held up behind it.  Each slice deletes at most
+ * SWEEP_SLICE_DELETES blobs and scans at most SWEEP_SLICE_WINDOW rows
+ * (a few milliseconds by the estimates above SWEEP_DELETE_MAX), or frees
+ * at most SWEEP_SLICE_PAGES pages with incremental_vacuum.
+ */
+#define SWEEP_SLICE_DELETES 256
+#define SWEEP_SLICE_WINDOW 16384
+#define SWEEP_SLICE_PAGES 256
+
+/* Value returned by "PRAGMA auto_vacuum" for INCREMENTAL mode
+ * (0 = NONE, 1 = FULL, 2 = INCREMENTAL).
+ */
+#define SQLITE_AUTO_VACUUM_INCREMENTAL 2
+
+/* Compression dictionaries used by objects in this database.  They are
+ * never deleted, since any object may refer to one.
+ */
+const char *sql_create_table_dict = "CREATE TABLE if not exists dictionaries("
+                                    "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                    "  codec INT,"
+                                    "  dict BLOB"
+                                    ");";
+const char *sql_dict_get_all = "SELECT codec,dict FROM dictionaries"
+                               "  ORDER BY id";
+const char *sql_dict_put = "INSERT INTO dictionaries (codec,dict)"
+                           "  values (?1, ?2)";
+
+/* With codec=zstd, a database without a dictionary samples the small blobs
+ * stored to it.  Once DICT_TRAIN_SAMPLES or DICT_TRAIN_BYTES have been
+ * collected, a DICT_SIZE dictionary is trained from them and saved, and
+ * later blobs are compressed with it.  Training takes tens of milliseconds
+ * and happens once per database (or shard).
+ */
+#define DICT_SIZE (16*1024)
+#define DICT_SAMPLE_SIZE_MAX 4096
+#define DICT_TRAIN_SAMPLES 4096
+#define DICT_TRAIN_BYTES (1024*1024)
+
+const char *sql_create_table_meta = "CREATE TABLE if not exists meta("
+                                    "  key TEXT PRIMARY KEY,"
+                                    "  value INT"
+                                    ");";
+const char *sql_meta_get = "SELECT value FROM meta WHERE key = ?1";
+const char *sql_meta_put = "INSERT OR REPLACE INTO meta (key,value)"
+                           "  values (?1, ?2)";
+
 struct content_stats {
     tstat_t load;
     tstat_t store;
+    tstat_t batch;      // stores per group commit (shards only)
+    uint64_t load_bytes;        // blob bytes returned by load
+    uint64_t load_copy_bytes;   // load bytes memcpy'd after leaving sqlite
+};
+
+enum sweep_phase {
+    SWEEP_INACTIVE = 0,
+    SWEEP_SCAN,         // deleting blobs below epoch up to high_water
+    SWEEP_VACUUM,       // returning free pages to the filesystem
+    SWEEP_CHECKPOINT,   // truncating the WAL
+};
+
+struct sweeper {
+    flux_watcher_t *prep;
+    flux_watcher_t *check;
+    flux_watcher_t *idle;
+    flux_watcher_t *timer;      // running while the rate budget is spent
+    struct flux_msglist *requests;
+    enum sweep_phase phase;
+    int64_t epoch;
+    int64_t cursor;
+    int64_t high_water;
+    int64_t deleted;            // this run
+    int64_t vacuumed_pages;     // this run
+    double tokens;              // deletes allowed by sweep_rate
+    double t_tokens;            // when tokens was last updated
+    int64_t runs;
+    int64_t total_deleted;
+};
+
+struct shard_batch;
+
+struct shard {
+    struct content_sqlite *ctx;     // parent (reactor thread) context
+    struct content_sqlite *db;      // shard database, owned by worker
+    int index;
+    flux_t *h;                      // reactor thread end of channel
+    flux_t *h_worker;               // worker thread end of channel
+    flux_msg_handler_t **handlers;
+    flux_reactor_t *r;              // worker thread reactor
+    flux_watcher_t *w;
+    struct shard_batch *batch;
+    pthread_t thread;
+    bool started;
 };
 
 struct content_sqlite {
@@ -140,14 +338,28 @@ struct content_sqlite {
     flux_t *h;
     char *hashfun;
     int hash_size;
-    size_t lzo_bufsize;
-    void *lzo_buf;
+    size_t compress_bufsize;
+    void *compress_buf;
+    char *codec_name;
+    struct content_codec *codec;
+    void *dict_samples;         // small blobs saved for dictionary training
+    size_t *dict_sample_sizes;
+    int dict_sample_count;
+    size_t dict_sample_bytes;
+    int dict_sample_count_committed;
+    size_t dict_sample_bytes_committed;
     struct content_stats stats;
     char *journal_mode;
     char *synchronous;
     int max_checkpoints;
+    int sweep_rate;             // blobs deleted per second, 0=unlimited
+    int64_t auto_vacuum;
+    struct sweeper sweep;
     bool truncate;
     int64_t current_epoch;
+    int shard_count;
+    struct shard **shards;
+    bool is_shard;
 };
 
 static int set_config (char **conf, const char *val)
@@ -225,35 +437,205 @@ static void set_errno_from_sqlite_error (struct content_sqlite *ctx)
     }
 }
 
-static int grow_lzo_buf (struct content_sqlite *ctx, size_t size)
+static int grow_compress_buf (struct content_sqlite *ctx, size_t size)
 {
-    size_t newsize = ctx->lzo_bufsize;
+    size_t newsize = ctx->compress_bufsize;
     void *newbuf;
     while (newsize < size)
-        newsize += lzo_buf_chunksize;
-    if (!(newbuf = realloc (ctx->lzo_buf, newsize))) {
+        newsize += compress_buf_chunksize;
+    if (!(newbuf = realloc (ctx->compress_buf, newsize))) {
         errno = ENOMEM;
         return -1;
     }
-    ctx->lzo_bufsize = newsize;
-    ctx->lzo_buf = newbuf;
+    ctx->compress_bufsize = newsize;
+    ctx->compress_buf = newbuf;
+    return 0;
+}
+
+static void dict_samples_clear (struct content_sqlite *ctx)
+{
+    free (ctx->dict_samples);
+    free (ctx->dict_sample_sizes);
+    ctx->dict_samples = NULL;
+    ctx->dict_sample_sizes = NULL;
+    ctx->dict_sample_count = 0;
+    ctx->dict_sample_bytes = 0;
+    ctx->dict_sample_count_committed = 0;
+    ctx->dict_sample_bytes_committed = 0;
+}
+
+/* Samples taken inside a store transaction are pending until it commits.
+ * Keep them on commit, and drop them on rollback so blobs that never made
+ * it into the database don't skew the training set.
+ */
+static void dict_samples_commit (struct content_sqlite *ctx)
+{
+    ctx->dict_sample_count_committed = ctx->dict_sample_count;
+    ctx->dict_sample_bytes_committed = ctx->dict_sample_bytes;
+}
+
+static void dict_samples_rollback (struct content_sqlite *ctx)
+{
+    ctx->dict_sample_count = ctx->dict_sample_count_committed;
+    ctx->dict_sample_bytes = ctx->dict_sample_bytes_committed;
+}
+
+static bool dict_samples_full (struct content_sqlite *ctx)
+{
+    return ctx->dict_sample_count == DICT_TRAIN_SAMPLES
+        || ctx->dict_sample_bytes >= DICT_TRAIN_BYTES;
+}
+
+/* Save a copy of a newly stored blob for dictionary training, if the codec
+ * could use a dictionary and doesn't have one yet.
+ */
+static void dict_sample (struct content_sqlite *ctx,
+                         const void *data,
+                         int size)
+{
+    if (!content_codec_dict_supported (ctx->codec)
+        || content_codec_dict_id (ctx->codec) != 0
+        || size == 0
+        || size > DICT_SAMPLE_SIZE_MAX
+        || dict_samples_full (ctx))
+        return;
+    if (!ctx->dict_samples) {
+        size_t bufsize = DICT_TRAIN_BYTES + DICT_SAMPLE_SIZE_MAX;
+        if (!(ctx->dict_samples = malloc (bufsize))
+            || !(ctx->dict_sample_sizes = calloc (DICT_TRAIN_SAMPLES,
+                                                  sizeof (size_t)))) {
+            dict_samples_clear (ctx);
+            return;
+        }
+    }
+    memcpy ((char *)ctx->dict_samples + ctx->dict_sample_bytes, data, size);
+    ctx->dict_sample_sizes[ctx->dict_sample_count++] = size;
+    ctx->dict_sample_bytes += size;
+}
+
+/* Save a dictionary in the database, then start using it.  In that order,
+ * so no object can refer to a dictionary that wasn't saved.
+ */
+static int dict_put (struct content_sqlite *ctx,
+                     int codec,
+                     const void *dict,
+                     size_t size)
+{
+    sqlite3_stmt *stmt = NULL;
+    int64_t dict_id;
+
+    if (sqlite3_prepare_v2 (ctx->db, sql_dict_put, -1, &stmt, NULL) != SQLITE_OK
+        || sqlite3_bind_int (stmt, 1, codec) != SQLITE_OK
+        || sqlite3_bind_blob (stmt, 2, dict, size, SQLITE_STATIC) != SQLITE_OK
+        || sqlite3_step (stmt) != SQLITE_DONE) {
+        log_sqlite_error (ctx, "dict_put");
+        set_errno_from_sqlite_error (ctx);
+        if (stmt)
+            ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+        return -1;
+    }
+    sqlite3_finalize (stmt);
+    if ((dict_id = content_codec_dict_add (ctx->codec, codec, dict, size)) < 0)
+        return -1;
+    flux_log (ctx->h,
+              LOG_DEBUG,
+              "%s: using %zu byte %s dictionary %jd",
+              ctx->dbfile,
+              size,
+              content_codec_id_to_name (codec),
+              (intmax_t)dict_id);
+    return 0;
+}
+
+/* Train a dictionary once enough samples have been collected.  This is
+ * called outside of any transaction, so the dictionary is committed before
+ * any blob compressed with it.
+ */
+static void dict_train_if_ready (struct content_sqlite *ctx)
+{
+    void *dict;
+    size_t size;
+
+    if (!ctx->dict_samples || !dict_samples_full (ctx))
+        return;
+    if (content_codec_dict_train (ctx->codec,
+                                  ctx->dict_samples,
+                                  ctx->dict_sample_sizes,
+                                  ctx->dict_sample_count,
+                                  DICT_SIZE,
+                                  &dict,
+                                  &size) < 0) {
+        flux_log (ctx->h,
+                  LOG_DEBUG,
+                  "%s: dictionary training failed, will retry",
+                  ctx->dbfile);
+        dict_samples_clear (ctx);
+        return;
+    }
+    if (dict_put (ctx, content_codec_id (ctx->codec), dict, size) < 0)
+        flux_log_error (ctx->h, "%s: error saving dictionary", ctx->dbfile);
+    free (dict);
+    dict_samples_clear (ctx);
+}
+
+/* Load dictionaries saved in the database into the codec.
+ */
+static int dict_load_all (struct content_sqlite *ctx)
+{
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+
+    if (sqlite3_prepare_v2 (ctx->db,
+                            sql_dict_get_all,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "preparing dict_get_all stmt");
+        goto error;
+    }
+    while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
+        int codec = sqlite3_column_int (stmt, 0);
+        const void *dict = sqlite3_column_blob (stmt, 1);
+        int size = sqlite3_column_bytes (stmt, 1);
+
+        if (content_codec_dict_add (ctx->codec, codec, dict, size) < 0
+            && errno != EEXIST) {
+            flux_log_error (ctx->h,
+                            "%s: error loading %s dictionary",
+                            ctx->dbfile,
+                            content_codec_id_to_name (codec));
+            sqlite3_finalize (stmt);
+            return -1;
+        }
+    }
+    if (rc != SQLITE_DONE) {
+        log_sqlite_error (ctx, "reading dictionaries");
+        goto error;
+    }
+    sqlite3_finalize (stmt);
     return 0;
+error:
+    set_errno_from_sqlite_error (ctx);
+    if (stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    return -1;
 }
 
-/* Load blob from objects table, uncompressing if necessary.
+/* Load blob from objects table into the payload of 'rsp', uncompressing
+ * if necessary.  A compressed blob is uncompressed directly into the payload
+ * buffer, so it is not copied again on its way to the requestor.  An
+ * uncompressed blob is copied once, out of sqlite's page cache.
  * Returns 0 on success, -1 on error with errno set.
- * On successful return, must call sqlite3_reset (ctx->load_stmt),
- * which invalidates returned data.
  */
 static int content_sqlite_load (struct content_sqlite *ctx,
                                 const void *hash,
                                 int hash_size,
-                                const void **datap,
-                                int *sizep)
+                                flux_msg_t *rsp)
 {
     const void *data = NULL;
     int size = 0;
     int uncompressed_size;
+    int codec;
 
     if (sqlite3_bind_text (ctx->load_stmt,
                            1,
@@ -282,30 +664,33 @@ static int content_sqlite_load (struct content_sqlite *ctx,
         goto error;
     }
     uncompressed_size = sqlite3_column_int (ctx->load_stmt, 1);
+    codec = sqlite3_column_int (ctx->load_stmt, 2);
     if (uncompressed_size != -1) {
-        if (ctx->lzo_bufsize < uncompressed_size
-                                && grow_lzo_buf (ctx, uncompressed_size) < 0)
-            goto error;
-        int r = LZ4_decompress_safe (data,
-                                     ctx->lzo_buf,
-                                     size,
-                                     uncompressed_size);
-        if (r < 0) {
-            errno = EINVAL;
+        void *buf;
+
+        if (flux_msg_alloc_payload (rsp, uncompressed_size, &buf) < 0)
             goto error;
-        }
-        if (r != uncompressed_size) {
-            flux_log (ctx->h, LOG_ERR, "load: blob size mismatch");
-            errno = EINVAL;
+        if (content_codec_decompress (ctx->codec,
+                                      codec,
+                                      data,
+                                      size,
+                                      buf,
+                                      uncompressed_size) < 0) {
+            flux_log_error (ctx->h,
+                            "load: error decompressing %s blob",
+                            content_codec_id_to_name (codec) ?
+                            content_codec_id_to_name (codec) : "unknown");
             goto error;
         }
-        data = ctx->lzo_buf;
         size = uncompressed_size;
     }
-    *datap = data;
-    *sizep = size;
-    /* call sqlite3_reset() on ctx->load_stmt in caller, after it has
-     * used returned data pointer */
+    else {
+        if (flux_msg_set_payload (rsp, data, size) < 0)
+            goto error;
+        ctx->stats.load_copy_bytes += size;
+    }
+    ctx->stats.load_bytes += size;
+    (void)sqlite3_reset (ctx->load_stmt);
     return 0;
 error:
     ERRNO_SAFE_WRAP (sqlite3_reset, ctx->load_stmt);
@@ -322,8 +707,12 @@ static int content_sqlite_store (struct content_sqlite *ctx,
                                  void *hash,
                                  int hash_len)
 {
+    const void *blob = data;
+    int blob_size = size;
     int uncompressed_size = -1;
+    int codec = CONTENT_CODEC_NONE;
     int hash_size;
+    sqlite3_int64 last_rowid;
 
     if ((hash_size = blobref_hash_raw (ctx->hashfun,
                                        data,
@@ -332,19 +721,23 @@ static int content_sqlite_store (struct content_sqlite *ctx,
                                        hash_len)) < 0)
         return -1;
     assert (hash_size == ctx->hash_size);
-    if (size >= compression_threshold) {
-        int r;
-        int out_len = LZ4_compressBound(size);
-        if (ctx->lzo_bufsize < out_len && grow_lzo_buf (ctx, out_len) < 0)
+    if (content_codec_wanted (ctx->codec, size)) {
+        ssize_t r;
+        size_t out_len = content_codec_bound (ctx->codec, size);
+        if (ctx->compress_bufsize < out_len
+            && grow_compress_buf (ctx, out_len) < 0)
             return -1;
-        r = LZ4_compress_default (data, ctx->lzo_buf, size, out_len);
-        if (r == 0) {
-            errno = EINVAL;
+        r = content_codec_compress (ctx->codec,
+                                    data,
+                                    size,
+                                    ctx->compress_buf,
+                                    out_len);
+        if (r < 0)
             return -1;
-        }
         uncompressed_size = size;
         size = r;
-        data = ctx->lzo_buf;
+        data = ctx->compress_buf;
+        codec = content_codec_id (ctx->codec);
     }
     if (sqlite3_bind_text (ctx->store_stmt,
                            1,
@@ -378,14 +771,27 @@ static int content_sqlite_store (struct content_sqlite *ctx,
         set_errno_from_sqlite_error (ctx);
         goto error;
     }
+    if (sqlite3_bind_int (ctx->store_stmt, 5, codec) != SQLITE_OK) {
+        log_sqlite_error (ctx, "store: binding codec");
+        set_errno_from_sqlite_error (ctx);
+        goto error;
+    }
     /* N.B. ON CONFLICT clause updates epoch without rewriting object.
+     * That path doesn't change the last insert rowid, while a new row
+     * does, so use it to sample only blobs that were actually inserted.
+     * (sqlite3_changes() counts the upsert's update too.)
      */
+    last_rowid = sqlite3_last_insert_rowid (ctx->db);
     if (sqlite3_step (ctx->store_stmt) != SQLITE_DONE) {
         log_sqlite_error (ctx, "store: executing stmt");
         set_errno_from_sqlite_error (ctx);
         goto error;
     }
     sqlite3_reset (ctx->store_stmt);
+    if (sqlite3_last_insert_rowid (ctx->db) != last_rowid)
+        dict_sample (ctx, blob, blob_size);
+    if (sqlite3_get_autocommit (ctx->db))
+        dict_samples_commit (ctx);
     return hash_size;
 error:
     ERRNO_SAFE_WRAP (sqlite3_reset, ctx->store_stmt);
@@ -429,6 +835,54 @@ error:
     return -1;
 }
 
+/* Select the shard that owns 'hash' from its leading bytes.
+ */
+static struct shard *shard_lookup (struct content_sqlite *ctx,
+                                   const void *hash)
+{
+    const uint8_t *p = hash;
+
+    return ctx->shards[((p[0] << 8) | p[1]) % ctx->shard_count];
+}
+
+/* Pass a request through to the worker thread that owns 'hash'.
+ * The worker responds directly to the original message, and the response
+ * is passed back to the broker by shard_response_cb().
+ */
+static void shard_forward (struct content_sqlite *ctx,
+                           const flux_msg_t *msg,
+                           const void *hash)
+{
+    struct shard *shard = shard_lookup (ctx, hash);
+
+    if (flux_send (shard->h, msg, 0) < 0) {
+        flux_log_error (ctx->h, "shard %d: error forwarding request",
+                        shard->index);
+        if (flux_respond_error (ctx->h, msg, errno, NULL) < 0)
+            flux_log_error (ctx->h, "error responding to request");
+    }
+}
+
+/* Tell workers about a new epoch.  Since channels are ordered, stores
+ * forwarded after this point are stamped with the new epoch, just as they
+ * would be in the unsharded case.
+ */
+static void shards_set_epoch (struct content_sqlite *ctx)
+{
+    for (int i = 0; i < ctx->shard_count; i++) {
+        flux_future_t *f;
+
+        if (!(f = flux_rpc_pack (ctx->shards[i]->h,
+                                 "content-sqlite.shard-epoch",
+                                 FLUX_NODEID_ANY,
+                                 FLUX_RPC_NORESPONSE,
+                                 "{s:I}",
+                                 "epoch", ctx->current_epoch)))
+            flux_log_error (ctx->h, "shard %d: error sending epoch", i);
+        flux_future_destroy (f);
+    }
+}
+
 static void load_cb (flux_t *h,
                      flux_msg_handler_t *mh,
                      const flux_msg_t *msg,
@@ -437,8 +891,7 @@ static void load_cb (flux_t *h,
     struct content_sqlite *ctx = arg;
     const void *hash;
     size_t hash_size;
-    const void *data;
-    int size;
+    flux_msg_t *rsp = NULL;
     struct timespec t0;
 
     if (flux_request_decode_raw (msg,
@@ -450,15 +903,25 @@ static void load_cb (flux_t *h,
         errno = EPROTO;
         goto error;
     }
+    if (ctx->shards) {
+        shard_forward (ctx, msg, hash);
+        return;
+    }
+    /* The blob is loaded straight into the response message, which is
+     * then handed off to the connector without being copied.
+     */
     monotime (&t0);
-    if (content_sqlite_load (ctx, hash, hash_size, &data, &size) < 0)
+    if (!(rsp = flux_response_derive (msg, 0))
+        || content_sqlite_load (ctx, hash, hash_size, rsp) < 0)
         goto error;
     tstat_push (&ctx->stats.load, monotime_since (t0));
-    if (flux_respond_raw (h, msg, data, size) < 0)
-        flux_log_error (h, "load: flux_respond_raw");
-    (void )sqlite3_reset (ctx->load_stmt);
+    if (!flux_msg_is_noresponse (msg)
+        && flux_send_new (h, &rsp, 0) < 0)
+        flux_log_error (h, "load: flux_send_new");
+    flux_msg_destroy (rsp);
     return;
 error:
+    flux_msg_destroy (rsp);
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "load: flux_respond_error");
 }
@@ -479,6 +942,20 @@ void store_cb (flux_t *h,
         flux_log_error (h, "store: request decode failed");
         goto error;
     }
+    /* The hash must be computed here to select the shard.  The worker
+     * computes it again, but that is cheap next to compression and the
+     * database insert, which are moved off this thread.
+     */
+    if (ctx->shards) {
+        if (blobref_hash_raw (ctx->hashfun,
+                              data,
+                              size,
+                              hash,
+                              sizeof (hash)) < 0)
+            goto error;
+        shard_forward (ctx, msg, hash);
+        return;
+    }
     monotime (&t0);
     if ((hash_size = content_sqlite_store (ctx,
                                            data,
@@ -489,6 +966,7 @@ void store_cb (flux_t *h,
     tstat_push (&ctx->stats.store, monotime_since (t0));
     if (flux_respond_raw (h, msg, hash, hash_size) < 0)
         flux_log_error (h, "store: flux_respond_raw");
+    dict_train_if_ready (ctx);
     return;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
@@ -513,6 +991,10 @@ static void validate_cb (flux_t *h,
         errno = EPROTO;
         goto error;
     }
+    if (ctx->shards) {
+        shard_forward (ctx, msg, hash);
+        return;
+    }
     if (content_sqlite_validate (ctx, hash, hash_size) < 0)
         goto error;
     if (flux_respond_raw (h, msg, NULL, 0) < 0)
@@ -636,6 +1118,7 @@ void checkpoint_put_cb (flux_t *h,
               LOG_DEBUG,
               "checkpoint-put: advanced epoch to %jd",
               (intmax_t)ctx->current_epoch);
+    shards_set_epoch (ctx);
     if (sqlite3_bind_int (ctx->checkpt_prune_stmt,
                           1,
                           ctx->max_checkpoints) != SQLITE_OK) {
@@ -736,35 +1219,45 @@ static void content_sqlite_closedb (struct content_sqlite *ctx)
         if (ctx->validate_stmt) {
             if (sqlite3_finalize (ctx->validate_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize validate_stmt");
+            ctx->validate_stmt = NULL;
         }
         if (ctx->store_stmt) {
             if (sqlite3_finalize (ctx->store_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize store_stmt");
+            ctx->store_stmt = NULL;
         }
         if (ctx->load_stmt) {
             if (sqlite3_finalize (ctx->load_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize load_stmt");
+            ctx->load_stmt = NULL;
         }
         if (ctx->checkpt_get_stmt) {
             if (sqlite3_finalize (ctx->checkpt_get_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize checkpt_get_stmt");
+            ctx->checkpt_get_stmt = NULL;
         }
         if (ctx->checkpt_put_stmt) {
             if (sqlite3_finalize (ctx->checkpt_put_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize checkpt_put_stmt");
+            ctx->checkpt_put_stmt = NULL;
         }
         if (ctx->checkpt_prune_stmt) {
             if (sqlite3_finalize (ctx->checkpt_prune_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize checkpt_prune_stmt");
+            ctx->checkpt_prune_stmt = NULL;
         }
         if (ctx->checkpt_get_all_stmt) {
             if (sqlite3_finalize (ctx->checkpt_get_all_stmt) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite_finalize checkpt_get_all_stmt");
+            ctx->checkpt_get_all_stmt = NULL;
         }
         if (ctx->db) {
             if (sqlite3_close (ctx->db) != SQLITE_OK)
                 log_sqlite_error (ctx, "sqlite3_close");
+            ctx->db = NULL;
         }
+        content_codec_destroy (ctx->codec);
+        ctx->codec = NULL;
         errno = saved_errno;
     }
 }
@@ -823,117 +1316,21 @@ static unsigned long long get_fs_free (const char *path)
     return sb.f_bsize * sb.f_bavail;
 }
 
-void stats_get_cb (flux_t *h,
-                   flux_msg_handler_t *mh,
-                   const flux_msg_t *msg,
-                   void *arg)
-{
-    struct content_sqlite *ctx = arg;
-    int64_t count;
-    const char *errmsg = NULL;
-    flux_error_t error;
-    json_t *load_time = NULL;
-    json_t *store_time = NULL;
-    json_t *checkpoints = NULL;
-
-    if (sqlite3_exec (ctx->db,
-                      sql_objects_count,
-                      set_count,
-                      &count,
-                      NULL) != SQLITE_OK) {
-        errmsg = set_text_from_sqlite_error (ctx, &error);
-        errno = EPERM;
-        goto error;
-    }
-    if (!(load_time = pack_tstat (&ctx->stats.load))
-        || !(store_time = pack_tstat (&ctx->stats.store)))
-        goto error;
-    if (!(checkpoints = stats_checkpoints (ctx, &error))) {
-        errmsg = error.text;
-        goto error;
-    }
-    if (flux_respond_pack (h,
-                           msg,
-                           "{s:I s:I s:I s:I s:O s:O s:{s:s s:s} s:O}",
-                           "object_count", count,
-                           "current_epoch", ctx->current_epoch,
-                           "dbfile_size", get_file_size (ctx->dbfile),
-                           "dbfile_free", get_fs_free (ctx->dbfile),
-                           "load_time", load_time,
-                           "store_time", store_time,
-                           "config",
-                             "journal_mode", ctx->journal_mode,
-                             "synchronous", ctx->synchronous,
-                           "checkpoints", checkpoints) < 0)
-        flux_log_error (h, "error responding to stats-get request");
-    json_decref (load_time);
-    json_decref (store_time);
-    json_decref (checkpoints);
-    return;
-error:
-    if (flux_respond_error (h, msg, errno, errmsg) < 0)
-        flux_log_error (h, "error responding to stats-get request");
-    json_decref (load_time);
-    json_decref (store_time);
-    json_decref (checkpoints);
-}
-
-/* content-backing.mark - mark a batch of blobs to target epoch
- * Request: {"epoch":I, "hashes":[s,s,...]}  (hashes are blobref strings)
- * Response: {"marked":i}
- *
- * Raise the epoch of each named blob to at least 'epoch' (the GC horizon H),
- * protecting it from a later sweep.  This is the "mark" half of the online
- * mark-and-sweep GC driven by flux-gc: the tool walks the reachable KVS tree
- * and marks every reachable blob to H, then sweeps everything left below H.
- *
- * The update is UPDATE ... SET epoch = MAX(epoch, ?) so it is idempotent and
- * monotonic: re-marking never lowers an epoch, and a blob absent from the
- * store (already swept, or never stored) simply matches no row.  'marked' is
- * the number of rows actually changed, for the caller's progress accounting.
- *
- * The batch is capped at MARK_HASHES_MAX because the whole loop runs
- * synchronously on this module's reactor thread, blocking all other content
- * requests until it completes; the cap bounds that stall (and rejects a
- * malformed or hostile request that would otherwise pin the reactor).
+/* Raise the epoch of each blob in 'hashes' (an array of blobref strings) to
+ * at least 'epoch', in a single transaction, and set *markedp to the number
+ * of rows changed.  On failure, return -1 with errno and 'errp' set.
  */
-static void mark_cb (flux_t *h,
-                     flux_msg_handler_t *mh,
-                     const flux_msg_t *msg,
-                     void *arg)
+static int content_sqlite_mark (struct content_sqlite *ctx,
+                                int64_t epoch,
+                                json_t *hashes,
+                                int *markedp,
+                                flux_error_t *errp)
 {
-    struct content_sqlite *ctx = arg;
-    int64_t target_epoch;
-    json_t *hashes;
     size_t index;
     json_t *hash_str;
     sqlite3_stmt *stmt = NULL;
     int marked_count = 0;
     bool in_txn = false;
-    flux_error_t error;
-    const char *errstr = NULL;
-
-    if (flux_request_unpack (msg,
-                             NULL,
-                             "{s:I s:o}",
-                             "epoch", &target_epoch,
-                             "hashes", &hashes) < 0)
-        goto error;
-
-    if (!json_is_array (hashes)) {
-        errno = EPROTO;
-        goto error;
-    }
-    /* Bound the synchronous work per request (see function comment). */
-    if (json_array_size (hashes) > MARK_HASHES_MAX) {
-        errprintf (&error,
-                   "mark request of %zu hashes exceeds limit of %d",
-                   json_array_size (hashes),
-                   MARK_HASHES_MAX);
-        errstr = error.text;
-        errno = EINVAL;
-        goto error;
-    }
 
     /* Wrap the batch in a single transaction.  In autocommit mode each
      * sqlite3_step() below would be its own implicit transaction, so a mark of
@@ -943,9 +1340,7 @@ static void mark_cb (flux_t *h,
      */
     if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
         log_sqlite_error (ctx, "mark: BEGIN");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
     in_txn = true;
 
@@ -956,9 +1351,7 @@ static void mark_cb (flux_t *h,
                             &stmt,
                             NULL) != SQLITE_OK) {
         log_sqlite_error (ctx, "mark: preparing statement");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
 
     json_array_foreach (hashes, index, hash_str) {
@@ -984,25 +1377,19 @@ static void mark_cb (flux_t *h,
             goto error;
         }
 
-        if (sqlite3_bind_int64 (stmt, 1, target_epoch) != SQLITE_OK) {
+        if (sqlite3_bind_int64 (stmt, 1, epoch) != SQLITE_OK) {
             log_sqlite_error (ctx, "mark: binding epoch");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
-            goto error;
+            goto error_sqlite;
         }
 
         if (sqlite3_bind_text (stmt, 2, hash, hash_len, SQLITE_TRANSIENT) != SQLITE_OK) {
             log_sqlite_error (ctx, "mark: binding hash");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
-            goto error;
+            goto error_sqlite;
         }
 
         if (sqlite3_step (stmt) != SQLITE_DONE) {
             log_sqlite_error (ctx, "mark: executing statement");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
-            goto error;
+            goto error_sqlite;
         }
 
         /* sqlite3_changes() is 0 when the hash matched no row or MAX() left
@@ -1017,95 +1404,47 @@ static void mark_cb (flux_t *h,
     stmt = NULL;
     if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
         log_sqlite_error (ctx, "mark: COMMIT");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
-    in_txn = false;
-
-    if (flux_respond_pack (h, msg, "{s:i}", "marked", marked_count) < 0)
-        flux_log_error (h, "mark: flux_respond_pack");
-    return;
+    *markedp = marked_count;
+    return 0;
 
+error_sqlite:
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    goto cleanup;
 error:
+    errprintf (errp, "%s", strerror (errno));
+cleanup:
     if (stmt)
         sqlite3_finalize (stmt);
     if (in_txn)
-        sqlite3_exec (ctx->db, "ROLLBACK", NULL, NULL, NULL);
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "mark: flux_respond_error");
+        ERRNO_SAFE_WRAP (sqlite3_exec, ctx->db, "ROLLBACK", NULL, NULL, NULL);
+    return -1;
 }
 
-/* content-backing.sweep - delete a bounded batch of blobs with epoch < H
- * Request:  {"epoch":I, "cursor":I, "high_water":I, "delete_cap":i, "window":i}
- * Response: {"deleted":I, "cursor":I}
- *
- * Delete blobs with epoch < 'epoch' (the GC horizon H) whose rowid lies in
- * (cursor, min(high_water, cursor+window)], ascending by rowid, stopping after
- * 'delete_cap' deletions.  Returns the number deleted and a new cursor for the
- * caller to pass to the next call.  The caller sweeps by looping until the
- * cursor reaches the high-water rowid it froze at the start of the run (via
- * gc-info); a call that deletes nothing still advances the cursor by the
- * window, so the loop always makes progress and terminates deterministically.
- *
- * Two caps bound the synchronous per-call work independently: 'delete_cap'
- * limits rows deleted (the dominant cost) and 'window' limits rows scanned (so
- * a sparse span does not stall scanning for delete_cap matches).  Both are
- * clamped to server ceilings rather than rejected -- since termination is by
- * cursor, not batch size, a clamped call is harmless.
- *
- * The rowid cursor makes the whole sweep a single ascending pass: every row at
- * or below the returned cursor is settled (deleted, or epoch >= H and staying
- * so, since epochs only rise), so it is never rescanned.  Bounding at
- * high_water keeps the sweep from chasing blobs stored after the run began.
+/* Delete a bounded batch of blobs with epoch < 'epoch' and rowid in
+ * (cursor, scan_limit], at most 'delete_cap' of them.  Set *deletedp to the
+ * number deleted and *cursorp to the new cursor (see sweep_cb).
+ * On failure, return -1 with errno and 'errp' set.
  */
-static void sweep_cb (flux_t *h,
-                      flux_msg_handler_t *mh,
-                      const flux_msg_t *msg,
-                      void *arg)
+static int content_sqlite_sweep (struct content_sqlite *ctx,
+                                 int64_t epoch,
+                                 int64_t cursor,
+                                 int64_t scan_limit,
+                                 int delete_cap,
+                                 int64_t *deletedp,
+                                 int64_t *cursorp,
+                                 flux_error_t *errp)
 {
-    struct content_sqlite *ctx = arg;
-    int64_t threshold_epoch;
-    int64_t cursor;
-    int64_t high_water;
-    int delete_cap;
-    int window;
     sqlite3_stmt *select_stmt = NULL;
     sqlite3_stmt *delete_stmt = NULL;
     int64_t *rowids = NULL;
-    int64_t scan_limit;
     int64_t deleted = 0;
     bool in_txn = false;
     int n = 0;
     int i;
     int rc;
-    const char *errstr = NULL;
-    flux_error_t error;
-
-    if (flux_request_unpack (msg,
-                             NULL,
-                             "{s:I s:I s:I s:i s:i}",
-                             "epoch", &threshold_epoch,
-                             "cursor", &cursor,
-                             "high_water", &high_water,
-                             "delete_cap", &delete_cap,
-                             "window", &window) < 0)
-        goto error;
-
-    if (cursor < 0 || high_water < 0 || delete_cap <= 0 || window <= 0) {
-        errno = EINVAL;
-        goto error;
-    }
-    /* Clamp both caps to their ceilings (see SWEEP_DELETE_MAX / _WINDOW_MAX). */
-    if (delete_cap > SWEEP_DELETE_MAX)
-        delete_cap = SWEEP_DELETE_MAX;
-    if (window > SWEEP_WINDOW_MAX)
-        window = SWEEP_WINDOW_MAX;
-
-    /* Scan the window (cursor, scan_limit], capped at high_water. */
-    scan_limit = cursor + window;
-    if (scan_limit > high_water)
-        scan_limit = high_water;
 
     if (!(rowids = malloc (delete_cap * sizeof (rowids[0])))) {
         errno = ENOMEM;
@@ -1119,52 +1458,40 @@ static void sweep_cb (flux_t *h,
     if (sqlite3_prepare_v2 (ctx->db, sql_sweep_select, -1, &select_stmt, NULL)
             != SQLITE_OK) {
         log_sqlite_error (ctx, "sweep: preparing select");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
-    if (sqlite3_bind_int64 (select_stmt, 1, threshold_epoch) != SQLITE_OK
+    if (sqlite3_bind_int64 (select_stmt, 1, epoch) != SQLITE_OK
         || sqlite3_bind_int64 (select_stmt, 2, cursor) != SQLITE_OK
         || sqlite3_bind_int64 (select_stmt, 3, scan_limit) != SQLITE_OK
         || sqlite3_bind_int (select_stmt, 4, delete_cap) != SQLITE_OK) {
         log_sqlite_error (ctx, "sweep: binding select");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
     while ((rc = sqlite3_step (select_stmt)) == SQLITE_ROW)
         rowids[n++] = sqlite3_column_int64 (select_stmt, 0);
     if (rc != SQLITE_DONE) {
         log_sqlite_error (ctx, "sweep: executing select");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
     sqlite3_finalize (select_stmt);
     select_stmt = NULL;
 
-    /* Delete the collected rowids in one transaction (as in mark_cb). */
+    /* Delete the collected rowids in one transaction (as in mark). */
     if (sqlite3_prepare_v2 (ctx->db, sql_sweep_delete, -1, &delete_stmt, NULL)
             != SQLITE_OK) {
         log_sqlite_error (ctx, "sweep: preparing delete");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
     if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
         log_sqlite_error (ctx, "sweep: BEGIN");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
     in_txn = true;
     for (i = 0; i < n; i++) {
         if (sqlite3_bind_int64 (delete_stmt, 1, rowids[i]) != SQLITE_OK
             || sqlite3_step (delete_stmt) != SQLITE_DONE) {
             log_sqlite_error (ctx, "sweep: executing delete");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
-            goto error;
+            goto error_sqlite;
         }
         deleted += sqlite3_changes (ctx->db);
         sqlite3_reset (delete_stmt);
@@ -1173,11 +1500,8 @@ static void sweep_cb (flux_t *h,
     delete_stmt = NULL;
     if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
         log_sqlite_error (ctx, "sweep: COMMIT");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
-        goto error;
+        goto error_sqlite;
     }
-    in_txn = false;
 
     /* Advance the cursor.  If delete_cap bounded the scan (the select returned
      * a full batch), the window may still hold garbage past the last row, so
@@ -1185,88 +1509,55 @@ static void sweep_cb (flux_t *h,
      * ascending, so the last one is the highest.
      */
     if (n == delete_cap)
-        cursor = rowids[n - 1];
+        *cursorp = rowids[n - 1];
     else
-        cursor = scan_limit;
-
+        *cursorp = scan_limit;
+    *deletedp = deleted;
     free (rowids);
-    if (flux_respond_pack (h,
-                           msg,
-                           "{s:I s:I}",
-                           "deleted", deleted,
-                           "cursor", cursor) < 0)
-        flux_log_error (h, "sweep: flux_respond_pack");
-    return;
+    return 0;
 
+error_sqlite:
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    goto cleanup;
 error:
+    errprintf (errp, "%s", strerror (errno));
+cleanup:
     if (select_stmt)
         sqlite3_finalize (select_stmt);
     if (delete_stmt)
         sqlite3_finalize (delete_stmt);
     if (in_txn)
-        sqlite3_exec (ctx->db, "ROLLBACK", NULL, NULL, NULL);
-    free (rowids);
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "sweep: flux_respond_error");
+        ERRNO_SAFE_WRAP (sqlite3_exec, ctx->db, "ROLLBACK", NULL, NULL, NULL);
+    ERRNO_SAFE_WRAP (free, rowids);
+    return -1;
 }
 
-/* content-backing.gc-info - get GC information
- * Request: {"epoch":I get_count?b}
- * Response: {"current_epoch":I "high_water":I candidates?I}
- *
- * 'high_water' is MAX(rowid) of the objects table -- the largest rowid present
- * when the run begins.  flux-gc freezes it and bounds the sweep at it so the
- * sweep terminates deterministically without chasing blobs stored after the
- * run began (which get a higher rowid and epoch >= H).  It is cheap: MAX(rowid)
- * on a rowid table reads the last btree entry, no scan.
- *
- * 'candidates' (the count of blobs with epoch < the requested threshold) is
- * only computed and returned when 'get_count' is true.  It requires a COUNT(*)
- * over the objects table -- an UNBOUNDED full-table scan that runs synchronously
- * on this module's single reactor thread, blocking all other content traffic
- * for its duration.  On a large production store that stall can be seconds or
- * more, so 'get_count' must NOT be used on a hot path.  flux-gc never sets it
- * (it reads only current_epoch and high_water, and the count is not even a
- * meaningful "reclaimable" estimate before the mark phase runs, since it
- * includes reachable data); the count exists solely for the test suite and
- * deliberate, low-frequency ad-hoc inspection where the stall is acceptable.
+/* Set *high_waterp to MAX(rowid) of the objects table and, if 'candidatesp'
+ * is non-NULL, *candidatesp to the number of blobs with epoch < 'epoch'
+ * (see gc_info_cb).  On failure, return -1 with errno and 'errp' set.
  */
-static void gc_info_cb (flux_t *h,
-                        flux_msg_handler_t *mh,
-                        const flux_msg_t *msg,
-                        void *arg)
+static int content_sqlite_gc_info (struct content_sqlite *ctx,
+                                   int64_t epoch,
+                                   int64_t *high_waterp,
+                                   int64_t *candidatesp,
+                                   flux_error_t *errp)
 {
-    struct content_sqlite *ctx = arg;
-    int64_t threshold_epoch;
-    int get_count = 0;
     sqlite3_stmt *stmt = NULL;
     sqlite3_stmt *hw_stmt = NULL;
-    int64_t candidates = 0;
-    int64_t high_water = 0;
-    const char *errstr = NULL;
-    flux_error_t error;
-
-    if (flux_request_unpack (msg,
-                             NULL,
-                             "{s:I s?b}",
-                             "epoch", &threshold_epoch,
-                             "get_count", &get_count) < 0)
-        goto error;
 
     /* MAX(rowid); NULL (empty table) reads back as 0 via column_int64. */
     if (sqlite3_prepare_v2 (ctx->db, sql_max_rowid, -1, &hw_stmt, NULL)
             != SQLITE_OK
         || sqlite3_step (hw_stmt) != SQLITE_ROW) {
         log_sqlite_error (ctx, "gc-info: querying high_water");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
         goto error;
     }
-    high_water = sqlite3_column_int64 (hw_stmt, 0);
+    *high_waterp = sqlite3_column_int64 (hw_stmt, 0);
 
-    if (get_count) {
+    if (candidatesp) {
         /* Unbounded full-table scan on the reactor thread -- test / ad-hoc
-         * inspection only, never a hot path (see function comment).
+         * inspection only, never a hot path (see gc_info_cb).
          */
         if (sqlite3_prepare_v2 (ctx->db,
                                 sql_count_sweep_candidates,
@@ -1274,53 +1565,2344 @@ static void gc_info_cb (flux_t *h,
                                 &stmt,
                                 NULL) != SQLITE_OK) {
             log_sqlite_error (ctx, "gc-info: preparing statement");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
             goto error;
         }
 
-        if (sqlite3_bind_int64 (stmt, 1, threshold_epoch) != SQLITE_OK) {
+        if (sqlite3_bind_int64 (stmt, 1, epoch) != SQLITE_OK) {
             log_sqlite_error (ctx, "gc-info: binding epoch");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
             goto error;
         }
 
         if (sqlite3_step (stmt) != SQLITE_ROW) {
             log_sqlite_error (ctx, "gc-info: executing statement");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
             goto error;
         }
-
-        candidates = sqlite3_column_int64 (stmt, 0);
+
+        *candidatesp = sqlite3_column_int64 (stmt, 0);
+    }
+    sqlite3_finalize (hw_stmt);
+    sqlite3_finalize (stmt);
+    return 0;
+error:
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    if (hw_stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, hw_stmt);
+    if (stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    return -1;
+}
+
+static int meta_get (struct content_sqlite *ctx,
+                     const char *key,
+                     int64_t *valuep);
+static int meta_put (struct content_sqlite *ctx,
+                     const char *key,
+                     int64_t value);
+
+/* Bind a blobref string to parameter 'index' of 'stmt' as a raw hash.
+ */
+static int bind_blobref (struct content_sqlite *ctx,
+                         sqlite3_stmt *stmt,
+                         int index,
+                         const char *blobref)
+{
+    char hash[BLOBREF_MAX_DIGEST_SIZE];
+    ssize_t hash_len;
+
+    if ((hash_len = blobref_strtohash (blobref, hash, sizeof (hash))) < 0
+        || hash_len != ctx->hash_size) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (sqlite3_bind_text (stmt,
+                           index,
+                           hash,
+                           hash_len,
+                           SQLITE_TRANSIENT) != SQLITE_OK) {
+        set_errno_from_sqlite_error (ctx);
+        return -1;
+    }
+    return 0;
+}
+
+/* Run a single row query on 'stmt' and return the integer in its first
+ * column, 0 if there is no row, or -1 on error.  The statement is reset.
+ */
+static int64_t query_int (sqlite3_stmt *stmt)
+{
+    int64_t value = 0;
+    int rc;
+
+    if ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+        value = sqlite3_column_int64 (stmt, 0);
+    else if (rc != SQLITE_DONE)
+        value = -1;
+    sqlite3_reset (stmt);
+    return value;
+}
+
+/* Append the references held by directory 'dir' to 'refs', as
+ * [blobref, is_tree] pairs, descending into inline directories.
+ */
+static int gc_dir_refs (json_t *dir, json_t *refs)
+{
+    json_t *data;
+    const char *name;
+    json_t *entry;
+
+    if (!(data = treeobj_get_data (dir)))
+        return -1;
+    json_object_foreach (data, name, entry) {
+        if (treeobj_is_dir (entry)) {
+            if (gc_dir_refs (entry, refs) < 0)
+                return -1;
+        }
+        else if (treeobj_is_dirref (entry) || treeobj_is_valref (entry)) {
+            int count = treeobj_get_count (entry);
+            for (int i = 0; i < count; i++) {
+                const char *blobref;
+                json_t *o;
+
+                if (!(blobref = treeobj_get_blobref (entry, i)))
+                    return -1;
+                if (!(o = json_pack ("[s b]",
+                                     blobref,
+                                     treeobj_is_dirref (entry)))
+                    || json_array_append_new (refs, o) < 0) {
+                    errno = ENOMEM;
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* Load tree object 'blobref' and return its references (see gc_dir_refs).
+ * On failure, return NULL with errno and 'errp' set.
+ */
+static json_t *gc_load_refs (struct content_sqlite *ctx,
+                             const char *blobref,
+                             flux_error_t *errp)
+{
+    char hash[BLOBREF_MAX_DIGEST_SIZE];
+    ssize_t hash_len;
+    flux_msg_t *msg;
+    const void *buf;
+    size_t size;
+    json_t *obj = NULL;
+    json_t *refs = NULL;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_RESPONSE)))
+        goto error;
+    if ((hash_len = blobref_strtohash (blobref, hash, sizeof (hash))) < 0
+        || content_sqlite_load (ctx, hash, hash_len, msg) < 0
+        || flux_msg_get_payload (msg, &buf, &size) < 0) {
+        errprintf (errp, "%s: %s", blobref, strerror (errno));
+        goto error;
+    }
+    if (!(obj = treeobj_decodeb (buf, size)) || !treeobj_is_dir (obj)) {
+        errprintf (errp, "%s: not a KVS directory", blobref);
+        errno = EINVAL;
+        goto error;
+    }
+    if (!(refs = json_array ()) || gc_dir_refs (obj, refs) < 0) {
+        errprintf (errp, "%s: %s", blobref, strerror (errno));
+        goto error;
+    }
+    json_decref (obj);
+    flux_msg_destroy (msg);
+    return refs;
+error:
+    ERRNO_SAFE_WRAP (json_decref, refs);
+    ERRNO_SAFE_WRAP (json_decref, obj);
+    flux_msg_destroy (msg);
+    return NULL;
+}
+
+/* Push unwalked tree objects from the index onto 'queue', at most 'limit'.
+ * This picks up walks left unfinished by an interrupted or concurrent run.
+ */
+static int gc_queue_unwalked (struct content_sqlite *ctx,
+                              sqlite3_stmt *stmt,
+                              int limit,
+                              json_t *queue)
+{
+    char blobref[BLOBREF_MAX_STRING_SIZE];
+    int rc;
+
+    if (sqlite3_bind_int (stmt, 1, limit) != SQLITE_OK)
+        goto error_sqlite;
+    while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
+        if (blobref_hashtostr (ctx->hashfun,
+                               sqlite3_column_blob (stmt, 0),
+                               sqlite3_column_bytes (stmt, 0),
+                               blobref,
+                               sizeof (blobref)) < 0
+            || json_array_append_new (queue, json_string (blobref)) < 0) {
+            sqlite3_reset (stmt);
+            errno = EPROTO;
+            return -1;
+        }
+    }
+    if (rc != SQLITE_DONE)
+        goto error_sqlite;
+    sqlite3_reset (stmt);
+    return 0;
+error_sqlite:
+    set_errno_from_sqlite_error (ctx);
+    sqlite3_reset (stmt);
+    return -1;
+}
+
+/* Walk tree objects from 'queue' (an array of blobrefs, consumed from the
+ * end) into the reachability index, in a single transaction.  Unwalked
+ * trees that are found are pushed onto the queue.  Stop when the queue is
+ * empty or a bound is reached (see GC_INDEX_TREES_MAX), leaving the rest
+ * in 'queue', and set *walkedp to the number of trees walked.
+ * On failure, return -1 with errno and 'errp' set.
+ */
+static int content_sqlite_gc_index (struct content_sqlite *ctx,
+                                    json_t *queue,
+                                    int *walkedp,
+                                    flux_error_t *errp)
+{
+    const char *sql[] = {
+        sql_gc_walked_get,
+        sql_gc_walked_set,
+        sql_gc_ref_add,
+        sql_gc_node_ref,
+        sql_gc_unwalked_get,
+    };
+    sqlite3_stmt *stmt[ARRAY_SIZE (sql)] = { NULL };
+    sqlite3_stmt *walked_get;
+    sqlite3_stmt *walked_set;
+    sqlite3_stmt *ref_add;
+    sqlite3_stmt *node_ref;
+    sqlite3_stmt *unwalked_get;
+    json_t *refs = NULL;
+    bool in_txn = false;
+    int walked = 0;
+    int nrefs = 0;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE (sql); i++) {
+        if (sqlite3_prepare_v2 (ctx->db, sql[i], -1, &stmt[i], NULL)
+                != SQLITE_OK) {
+            log_sqlite_error (ctx, "gc-index: preparing statement");
+            goto error_sqlite;
+        }
+    }
+    walked_get = stmt[0];
+    walked_set = stmt[1];
+    ref_add = stmt[2];
+    node_ref = stmt[3];
+    unwalked_get = stmt[4];
+
+    if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-index: BEGIN");
+        goto error_sqlite;
+    }
+    in_txn = true;
+
+    while (walked < GC_INDEX_TREES_MAX && nrefs < GC_INDEX_REFS_MAX) {
+        size_t last = json_array_size (queue);
+        char blobref[BLOBREF_MAX_STRING_SIZE];
+        size_t index;
+        json_t *ref;
+        int64_t rc;
+
+        if (last == 0) {
+            if (gc_queue_unwalked (ctx,
+                                   unwalked_get,
+                                   GC_INDEX_TREES_MAX - walked,
+                                   queue) < 0)
+                goto error;
+            if ((last = json_array_size (queue)) == 0)
+                break;
+        }
+        if (!json_is_string (json_array_get (queue, last - 1))
+            || snprintf (blobref,
+                         sizeof (blobref),
+                         "%s",
+                         json_string_value (json_array_get (queue, last - 1)))
+                >= sizeof (blobref)) {
+            errno = EPROTO;
+            goto error;
+        }
+        json_array_remove (queue, last - 1);
+
+        if (bind_blobref (ctx, walked_get, 1, blobref) < 0)
+            goto error;
+        if ((rc = query_int (walked_get)) < 0) {
+            log_sqlite_error (ctx, "gc-index: querying node");
+            goto error_sqlite;
+        }
+        if (rc == 1)
+            continue;
+        if (!(refs = gc_load_refs (ctx, blobref, errp)))
+            goto cleanup;
+        if (bind_blobref (ctx, walked_set, 1, blobref) < 0)
+            goto error;
+        if (sqlite3_step (walked_set) != SQLITE_DONE) {
+            log_sqlite_error (ctx, "gc-index: updating node");
+            goto error_sqlite;
+        }
+        sqlite3_reset (walked_set);
+        json_array_foreach (refs, index, ref) {
+            const char *child = json_string_value (json_array_get (ref, 0));
+            int is_tree = json_is_true (json_array_get (ref, 1));
+
+            if (bind_blobref (ctx, ref_add, 1, blobref) < 0
+                || bind_blobref (ctx, ref_add, 2, child) < 0)
+                goto error;
+            if (sqlite3_step (ref_add) != SQLITE_DONE) {
+                log_sqlite_error (ctx, "gc-index: adding reference");
+                goto error_sqlite;
+            }
+            sqlite3_reset (ref_add);
+            if (sqlite3_changes (ctx->db) == 0)
+                continue;
+            if (bind_blobref (ctx, node_ref, 1, child) < 0
+                || sqlite3_bind_int (node_ref, 2, is_tree) != SQLITE_OK
+                || sqlite3_step (node_ref) != SQLITE_DONE) {
+                log_sqlite_error (ctx, "gc-index: adding node");
+                goto error_sqlite;
+            }
+            sqlite3_reset (node_ref);
+            nrefs++;
+            if (!is_tree)
+                continue;
+            if (bind_blobref (ctx, walked_get, 1, child) < 0)
+                goto error;
+            if ((rc = query_int (walked_get)) < 0) {
+                log_sqlite_error (ctx, "gc-index: querying node");
+                goto error_sqlite;
+            }
+            if (rc == 0
+                && json_array_append_new (queue, json_string (child)) < 0) {
+                errno = ENOMEM;
+                goto error;
+            }
+        }
+        json_decref (refs);
+        refs = NULL;
+        walked++;
+    }
+
+    for (i = 0; i < ARRAY_SIZE (stmt); i++) {
+        sqlite3_finalize (stmt[i]);
+        stmt[i] = NULL;
+    }
+    if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-index: COMMIT");
+        goto error_sqlite;
+    }
+    *walkedp = walked;
+    return 0;
+
+error_sqlite:
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    goto cleanup;
+error:
+    errprintf (errp, "%s", strerror (errno));
+cleanup:
+    ERRNO_SAFE_WRAP (json_decref, refs);
+    for (i = 0; i < ARRAY_SIZE (stmt); i++) {
+        if (stmt[i])
+            ERRNO_SAFE_WRAP (sqlite3_finalize, stmt[i]);
+    }
+    if (in_txn)
+        ERRNO_SAFE_WRAP (sqlite3_exec, ctx->db, "ROLLBACK", NULL, NULL, NULL);
+    return -1;
+}
+
+/* Replace the pinned roots with 'roots' (an array of blobrefs) taken at GC
+ * horizon 'epoch', and record the epoch.  If the current pins were taken at
+ * a later epoch, do nothing and set *pinnedp to false.  Every root must be
+ * walked, and no walk may be left unfinished, so that the pinned roots are
+ * completely indexed; otherwise fail with EAGAIN.  Empty 'roots' releases
+ * the index regardless.
+ * On failure, return -1 with errno and 'errp' set.
+ */
+static int content_sqlite_gc_pin (struct content_sqlite *ctx,
+                                  int64_t epoch,
+                                  json_t *roots,
+                                  bool *pinnedp,
+                                  flux_error_t *errp)
+{
+    sqlite3_stmt *add_stmt = NULL;
+    sqlite3_stmt *check_stmt = NULL;
+    sqlite3_stmt *any_stmt = NULL;
+    int64_t pin_epoch;
+    bool in_txn = false;
+    size_t index;
+    json_t *root;
+    int rc;
+
+    if ((rc = meta_get (ctx, "gc_pin_epoch", &pin_epoch)) < 0)
+        goto error_sqlite;
+    if (rc == 1 && epoch < pin_epoch) {
+        *pinnedp = false;
+        return 0;
+    }
+    if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-pin: BEGIN");
+        goto error_sqlite;
+    }
+    in_txn = true;
+    if (sqlite3_prepare_v2 (ctx->db, sql_gc_newpin_add, -1, &add_stmt, NULL)
+            != SQLITE_OK
+        || sqlite3_prepare_v2 (ctx->db,
+                               sql_gc_newpin_unwalked,
+                               -1,
+                               &check_stmt,
+                               NULL) != SQLITE_OK
+        || sqlite3_prepare_v2 (ctx->db,
+                               sql_gc_unwalked_any,
+                               -1,
+                               &any_stmt,
+                               NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-pin: preparing statement");
+        goto error_sqlite;
+    }
+    json_array_foreach (roots, index, root) {
+        if (!json_is_string (root)) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (bind_blobref (ctx, add_stmt, 1, json_string_value (root)) < 0)
+            goto error;
+        if (sqlite3_step (add_stmt) != SQLITE_DONE) {
+            log_sqlite_error (ctx, "gc-pin: adding root");
+            goto error_sqlite;
+        }
+        sqlite3_reset (add_stmt);
+    }
+    if ((rc = query_int (check_stmt)) != 0) {
+        if (rc < 0) {
+            log_sqlite_error (ctx, "gc-pin: checking roots");
+            goto error_sqlite;
+        }
+        errprintf (errp, "roots are not indexed");
+        errno = EAGAIN;
+        goto cleanup;
+    }
+    if (json_array_size (roots) > 0 && (rc = query_int (any_stmt)) != 0) {
+        if (rc < 0) {
+            log_sqlite_error (ctx, "gc-pin: checking index");
+            goto error_sqlite;
+        }
+        errprintf (errp, "index is incomplete");
+        errno = EAGAIN;
+        goto cleanup;
+    }
+    for (int i = 0; i < ARRAY_SIZE (sql_gc_pin_swap); i++) {
+        if (sqlite3_exec (ctx->db, sql_gc_pin_swap[i], NULL, NULL, NULL)
+                != SQLITE_OK) {
+            log_sqlite_error (ctx, "gc-pin: updating pins");
+            goto error_sqlite;
+        }
+    }
+    if (meta_put (ctx, "gc_pin_epoch", epoch) < 0)
+        goto error_sqlite;
+    sqlite3_finalize (add_stmt);
+    sqlite3_finalize (check_stmt);
+    sqlite3_finalize (any_stmt);
+    add_stmt = check_stmt = any_stmt = NULL;
+    if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-pin: COMMIT");
+        goto error_sqlite;
+    }
+    *pinnedp = true;
+    return 0;
+
+error_sqlite:
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    goto cleanup;
+error:
+    errprintf (errp, "%s", strerror (errno));
+cleanup:
+    if (add_stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, add_stmt);
+    if (check_stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, check_stmt);
+    if (any_stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, any_stmt);
+    if (in_txn)
+        ERRNO_SAFE_WRAP (sqlite3_exec, ctx->db, "ROLLBACK", NULL, NULL, NULL);
+    return -1;
+}
+
+/* Remove up to GC_COLLECT_MAX unreferenced objects from the reachability
+ * index in a single transaction, releasing their references in turn.  Set
+ * *collectedp to the number removed and *donep if none remain.
+ * On failure, return -1 with errno and 'errp' set.
+ */
+static int content_sqlite_gc_collect (struct content_sqlite *ctx,
+                                      int *collectedp,
+                                      bool *donep,
+                                      flux_error_t *errp)
+{
+    const char *sql[] = {
+        sql_gc_unref_get,
+        sql_gc_unref_children,
+        sql_gc_refs_del,
+        sql_gc_node_del,
+    };
+    sqlite3_stmt *stmt[ARRAY_SIZE (sql)] = { NULL };
+    bool in_txn = false;
+    int collected = 0;
+    bool done = false;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE (sql); i++) {
+        if (sqlite3_prepare_v2 (ctx->db, sql[i], -1, &stmt[i], NULL)
+                != SQLITE_OK) {
+            log_sqlite_error (ctx, "gc-collect: preparing statement");
+            goto error;
+        }
+    }
+    if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-collect: BEGIN");
+        goto error;
+    }
+    in_txn = true;
+    while (collected < GC_COLLECT_MAX) {
+        char hash[BLOBREF_MAX_DIGEST_SIZE];
+        int hash_len;
+        int rc;
+
+        if ((rc = sqlite3_step (stmt[0])) == SQLITE_DONE) {
+            done = true;
+            break;
+        }
+        if (rc != SQLITE_ROW
+            || (hash_len = sqlite3_column_bytes (stmt[0], 0)) > sizeof (hash)) {
+            log_sqlite_error (ctx, "gc-collect: selecting node");
+            goto error;
+        }
+        memcpy (hash, sqlite3_column_blob (stmt[0], 0), hash_len);
+        sqlite3_reset (stmt[0]);
+        for (i = 1; i < ARRAY_SIZE (stmt); i++) {
+            if (sqlite3_bind_text (stmt[i],
+                                   1,
+                                   hash,
+                                   hash_len,
+                                   SQLITE_STATIC) != SQLITE_OK
+                || sqlite3_step (stmt[i]) != SQLITE_DONE) {
+                log_sqlite_error (ctx, "gc-collect: removing node");
+                goto error;
+            }
+            sqlite3_reset (stmt[i]);
+        }
+        collected++;
+    }
+    for (i = 0; i < ARRAY_SIZE (stmt); i++) {
+        sqlite3_finalize (stmt[i]);
+        stmt[i] = NULL;
+    }
+    if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "gc-collect: COMMIT");
+        goto error;
+    }
+    *collectedp = collected;
+    *donep = done;
+    return 0;
+error:
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    for (i = 0; i < ARRAY_SIZE (stmt); i++) {
+        if (stmt[i])
+            ERRNO_SAFE_WRAP (sqlite3_finalize, stmt[i]);
+    }
+    if (in_txn)
+        ERRNO_SAFE_WRAP (sqlite3_exec, ctx->db, "ROLLBACK", NULL, NULL, NULL);
+    return -1;
+}
+
+/* Background sweep.
+ *
+ * sweep-start deletes blobs with epoch < 'epoch' as the client driven
+ * sweep does, but the module walks the cursor itself, one slice at a time
+ * from prep/check/idle watchers, so it only runs when the reactor has
+ * nothing else to do.  If sweep_rate is set, a token bucket holds deletes
+ * to that many per second, and the sweep sleeps on a timer while the
+ * budget is spent.  Once the scan reaches the high water rowid frozen at
+ * the start of the run, free pages are returned to the filesystem with
+ * incremental_vacuum (if the database was created with auto_vacuum), the
+ * WAL is checkpointed, and the requests covered by the run are answered.
+ */
+
+static void sweeper_watchers_destroy (struct sweeper *sw)
+{
+    flux_watcher_destroy (sw->prep);
+    flux_watcher_destroy (sw->check);
+    flux_watcher_destroy (sw->idle);
+    flux_watcher_destroy (sw->timer);
+    sw->prep = sw->check = sw->idle = sw->timer = NULL;
+}
+
+/* Stop the run, if any, and fail pending sweep-start requests.
+ * Call while the reactor that owns the watchers still exists.
+ */
+static void sweeper_stop (struct content_sqlite *ctx)
+{
+    struct sweeper *sw = &ctx->sweep;
+    const flux_msg_t *msg;
+
+    while ((msg = flux_msglist_pop (sw->requests))) {
+        if (flux_respond_error (ctx->h,
+                                msg,
+                                ENOSYS,
+                                "content-sqlite is unloading") < 0)
+            flux_log_error (ctx->h, "sweep-start: flux_respond_error");
+        flux_msg_decref (msg);
+    }
+    sweeper_watchers_destroy (sw);
+    sw->phase = SWEEP_INACTIVE;
+}
+
+/* Hold off for 't' seconds while the rate budget refills.
+ */
+static void sweeper_pause (struct sweeper *sw, double t)
+{
+    flux_watcher_stop (sw->prep);
+    flux_watcher_stop (sw->check);
+    flux_watcher_stop (sw->idle);
+    flux_timer_watcher_reset (sw->timer, t, 0.);
+    flux_watcher_start (sw->timer);
+}
+
+/* Return the number of free pages in the database, or -1 on error.
+ */
+static int64_t freelist_count (struct content_sqlite *ctx)
+{
+    int64_t count;
+
+    if (sqlite3_exec (ctx->db,
+                      "PRAGMA freelist_count",
+                      set_count,
+                      &count,
+                      NULL) != SQLITE_OK)
+        return -1;
+    return count;
+}
+
+/* Free up to SWEEP_SLICE_PAGES pages.  Set *freedp to the number freed.
+ */
+static int sweeper_vacuum (struct content_sqlite *ctx,
+                           int64_t *freedp,
+                           flux_error_t *errp)
+{
+    char s[64];
+    int64_t before;
+    int64_t after;
+
+    if ((before = freelist_count (ctx)) < 0)
+        goto error;
+    if (before > 0) {
+        snprintf (s,
+                  sizeof (s),
+                  "PRAGMA incremental_vacuum(%d)",
+                  SWEEP_SLICE_PAGES);
+        if (sqlite3_exec (ctx->db, s, NULL, NULL, NULL) != SQLITE_OK
+            || (after = freelist_count (ctx)) < 0)
+            goto error;
+        *freedp = before - after;
+    }
+    else
+        *freedp = 0;
+    return 0;
+error:
+    log_sqlite_error (ctx, "sweep: incremental_vacuum");
+    set_errno_from_sqlite_error (ctx);
+    set_text_from_sqlite_error (ctx, errp);
+    return -1;
+}
+
+/* Do one slice of the current phase.
+ * Returns 1 if the run is complete, 0 if not, or -1 on error.
+ */
+static int sweeper_step (struct content_sqlite *ctx, flux_error_t *errp)
+{
+    struct sweeper *sw = &ctx->sweep;
+    int64_t scan_limit;
+    int64_t deleted;
+    int64_t freed;
+    int delete_cap = SWEEP_SLICE_DELETES;
+
+    switch (sw->phase) {
+        case SWEEP_SCAN:
+            if (ctx->sweep_rate > 0) {
+                double now = flux_reactor_now (flux_get_reactor (ctx->h));
+
+                sw->tokens += (now - sw->t_tokens) * ctx->sweep_rate;
+                if (sw->tokens > ctx->sweep_rate)
+                    sw->tokens = ctx->sweep_rate;
+                sw->t_tokens = now;
+                if (sw->tokens < 1.) {
+                    sweeper_pause (sw, (1. - sw->tokens) / ctx->sweep_rate);
+                    return 0;
+                }
+                if (delete_cap > sw->tokens)
+                    delete_cap = sw->tokens;
+            }
+            scan_limit = sw->cursor + SWEEP_SLICE_WINDOW;
+            if (scan_limit > sw->high_water)
+                scan_limit = sw->high_water;
+            if (content_sqlite_sweep (ctx,
+                                      sw->epoch,
+                                      sw->cursor,
+                                      scan_limit,
+                                      delete_cap,
+                                      &deleted,
+                                      &sw->cursor,
+                                      errp) < 0)
+                return -1;
+            sw->tokens -= deleted;
+            sw->deleted += deleted;
+            sw->total_deleted += deleted;
+            if (sw->cursor >= sw->high_water)
+                sw->phase = SWEEP_VACUUM;
+            return 0;
+        case SWEEP_VACUUM:
+            freed = 0;
+            if (ctx->auto_vacuum == SQLITE_AUTO_VACUUM_INCREMENTAL
+                && sweeper_vacuum (ctx, &freed, errp) < 0)
+                return -1;
+            sw->vacuumed_pages += freed;
+            if (freed == 0)
+                sw->phase = SWEEP_CHECKPOINT;
+            return 0;
+        case SWEEP_CHECKPOINT:
+            if (streq (ctx->journal_mode, "WAL")
+                && sqlite3_exec (ctx->db,
+                                 "PRAGMA wal_checkpoint(TRUNCATE)",
+                                 NULL,
+                                 NULL,
+                                 NULL) != SQLITE_OK) {
+                log_sqlite_error (ctx, "sweep: wal_checkpoint");
+                set_errno_from_sqlite_error (ctx);
+                set_text_from_sqlite_error (ctx, errp);
+                return -1;
+            }
+            return 1;
+        case SWEEP_INACTIVE:
+            break;
+    }
+    return 1;
+}
+
+static void sweep_prep_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    struct content_sqlite *ctx = arg;
+
+    flux_watcher_start (ctx->sweep.idle);
+}
+
+static void sweeper_finish (struct content_sqlite *ctx,
+                            int errnum,
+                            const char *errstr);
+
+static void sweep_check_cb (flux_reactor_t *r,
+                            flux_watcher_t *w,
+                            int revents,
+                            void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    flux_error_t error;
+    int rc;
+
+    flux_watcher_stop (ctx->sweep.idle);
+    if ((rc = sweeper_step (ctx, &error)) < 0)
+        sweeper_finish (ctx, errno, error.text);
+    else if (rc > 0)
+        sweeper_finish (ctx, 0, NULL);
+}
+
+static void sweep_timer_cb (flux_reactor_t *r,
+                            flux_watcher_t *w,
+                            int revents,
+                            void *arg)
+{
+    struct content_sqlite *ctx = arg;
+
+    flux_watcher_start (ctx->sweep.prep);
+    flux_watcher_start (ctx->sweep.check);
+}
+
+/* Start a run that sweeps blobs with epoch < 'epoch' up to the current
+ * high water rowid.
+ */
+static int sweeper_start (struct content_sqlite *ctx,
+                          int64_t epoch,
+                          flux_error_t *errp)
+{
+    struct sweeper *sw = &ctx->sweep;
+    flux_reactor_t *r = flux_get_reactor (ctx->h);
+    int64_t high_water;
+
+    if (content_sqlite_gc_info (ctx, 0, &high_water, NULL, errp) < 0)
+        return -1;
+    if (!sw->prep) {
+        if (!(sw->prep = flux_prepare_watcher_create (r, sweep_prep_cb, ctx))
+            || !(sw->check = flux_check_watcher_create (r,
+                                                        sweep_check_cb,
+                                                        ctx))
+            || !(sw->idle = flux_idle_watcher_create (r, NULL, NULL))
+            || !(sw->timer = flux_timer_watcher_create (r,
+                                                        0.,
+                                                        0.,
+                                                        sweep_timer_cb,
+                                                        ctx))) {
+            errprintf (errp, "error creating sweep watchers");
+            sweeper_watchers_destroy (sw);
+            return -1;
+        }
+    }
+    sw->phase = SWEEP_SCAN;
+    sw->epoch = epoch;
+    sw->cursor = 0;
+    sw->high_water = high_water;
+    sw->deleted = 0;
+    sw->vacuumed_pages = 0;
+    sw->tokens = 0.;
+    sw->t_tokens = flux_reactor_now (r);
+    sw->runs++;
+    flux_watcher_start (sw->prep);
+    flux_watcher_start (sw->check);
+    return 0;
+}
+
+/* The run has ended.  Answer the requests it covered (or all of them,
+ * if it failed) and start another run for any that remain.
+ */
+static void sweeper_finish (struct content_sqlite *ctx,
+                            int errnum,
+                            const char *errstr)
+{
+    struct sweeper *sw = &ctx->sweep;
+    const flux_msg_t *msg;
+    int64_t next_epoch = -1;
+    flux_error_t error;
+    int rc;
+
+    sw->phase = SWEEP_INACTIVE;
+    flux_watcher_stop (sw->prep);
+    flux_watcher_stop (sw->check);
+    flux_watcher_stop (sw->idle);
+    flux_watcher_stop (sw->timer);
+
+    msg = flux_msglist_first (sw->requests);
+    while (msg) {
+        int64_t epoch;
+
+        if (errnum != 0)
+            rc = flux_respond_error (ctx->h, msg, errnum, errstr);
+        else if (flux_request_unpack (msg, NULL, "{s:I}", "epoch", &epoch) < 0)
+            rc = flux_respond_error (ctx->h, msg, errno, NULL);
+        else if (epoch <= sw->epoch)
+            rc = flux_respond_pack (ctx->h,
+                                    msg,
+                                    "{s:I}",
+                                    "deleted", sw->deleted);
+        else {
+            if (next_epoch < epoch)
+                next_epoch = epoch;
+            goto next;
+        }
+        if (rc < 0)
+            flux_log_error (ctx->h, "sweep-start: error responding");
+        flux_msglist_delete (sw->requests);
+next:
+        msg = flux_msglist_next (sw->requests);
+    }
+    if (next_epoch >= 0) {
+        if (sweeper_start (ctx, next_epoch, &error) < 0)
+            sweeper_finish (ctx, errno, error.text);
+        return;
+    }
+    sweeper_watchers_destroy (sw);
+}
+
+/* State for a request that is fanned out to the shards and answered when
+ * every shard that was sent a part has responded.  A composite future is
+ * not used since its children must all be bound to the same flux_t.
+ */
+struct shard_call;
+
+typedef void (*shard_call_f)(struct shard_call *call);
+
+struct shard_call {
+    struct content_sqlite *ctx;
+    flux_msg_t *msg;
+    flux_future_t *f[SHARDS_MAX];   // indexed by shard, NULL if not sent
+    int pending;
+    shard_call_f cb;
+    int64_t scan_limit;             // sweep only
+    json_t *result;                 // stats-get only
+};
+
+static void shard_call_destroy (struct shard_call *call)
+{
+    if (call) {
+        int saved_errno = errno;
+        for (int i = 0; i < SHARDS_MAX; i++)
+            flux_future_destroy (call->f[i]);
+        flux_msg_decref (call->msg);
+        json_decref (call->result);
+        free (call);
+        errno = saved_errno;
+    }
+}
+
+/* Create a call for request 'msg'.  Once all the pushed RPCs are fulfilled,
+ * 'cb' is called to respond to 'msg', then the call is destroyed.
+ */
+static struct shard_call *shard_call_create (struct content_sqlite *ctx,
+                                             const flux_msg_t *msg,
+                                             shard_call_f cb)
+{
+    struct shard_call *call;
+
+    if (!(call = calloc (1, sizeof (*call))))
+        return NULL;
+    call->ctx = ctx;
+    call->msg = (flux_msg_t *)flux_msg_incref (msg);
+    call->cb = cb;
+    return call;
+}
+
+static void shard_call_continuation (flux_future_t *f, void *arg)
+{
+    struct shard_call *call = arg;
+
+    if (--call->pending == 0) {
+        call->cb (call);
+        shard_call_destroy (call);
+    }
+}
+
+/* Add RPC 'f' sent to shard 'index'.  'f' may be NULL (failed to send),
+ * which is passed through as an error.
+ */
+static int shard_call_push (struct shard_call *call,
+                            int index,
+                            flux_future_t *f)
+{
+    if (!f || flux_future_then (f, -1, shard_call_continuation, call) < 0) {
+        flux_future_destroy (f);
+        return -1;
+    }
+    call->f[index] = f;
+    call->pending++;
+    return 0;
+}
+
+/* Call after all RPCs are pushed.  If there were none, e.g. an empty
+ * mark request, respond immediately.
+ */
+static void shard_call_start (struct shard_call *call)
+{
+    if (call->pending == 0) {
+        call->cb (call);
+        shard_call_destroy (call);
+    }
+}
+
+/* Map a shard rowid to a position in the single "virtual rowid" space that
+ * the sweep cursor protocol walks when objects are sharded.  Shard i's
+ * rowid r maps to r * N + i, so a window of the virtual space covers
+ * roughly window / N rows of each shard.
+ */
+static int64_t vrowid_encode (struct content_sqlite *ctx,
+                              int index,
+                              int64_t rowid)
+{
+    return rowid * ctx->shard_count + index;
+}
+
+/* Return the largest shard rowid r with vrowid_encode (r) <= vrowid,
+ * i.e. floor ((vrowid - index) / N).  May be -1.
+ */
+static int64_t vrowid_decode (struct content_sqlite *ctx,
+                              int index,
+                              int64_t vrowid)
+{
+    int64_t n = vrowid - index;
+
+    if (n < 0)
+        return -1;
+    return n / ctx->shard_count;
+}
+
+static void mark_sharded_respond (struct shard_call *call)
+{
+    struct content_sqlite *ctx = call->ctx;
+    int marked_count = 0;
+    int i;
+
+    for (i = 0; i < ctx->shard_count; i++) {
+        int marked;
+
+        if (!call->f[i])
+            continue;
+        if (flux_rpc_get_unpack (call->f[i], "{s:i}", "marked", &marked) < 0)
+            goto error;
+        marked_count += marked;
+    }
+    if (flux_respond_pack (ctx->h,
+                           call->msg,
+                           "{s:i}",
+                           "marked", marked_count) < 0)
+        flux_log_error (ctx->h, "mark: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (ctx->h,
+                            call->msg,
+                            errno,
+                            future_strerror (call->f[i], errno)) < 0)
+        flux_log_error (ctx->h, "mark: flux_respond_error");
+}
+
+/* Split 'hashes' by owning shard and send each shard its part.
+ * Hashes are validated here since they must be decoded to pick the shard.
+ */
+static int mark_sharded (struct content_sqlite *ctx,
+                         const flux_msg_t *msg,
+                         int64_t target_epoch,
+                         json_t *hashes)
+{
+    json_t *parts[SHARDS_MAX] = { NULL };
+    struct shard_call *call = NULL;
+    size_t index;
+    json_t *hash_str;
+    int i;
+
+    json_array_foreach (hashes, index, hash_str) {
+        const char *blobref = json_string_value (hash_str);
+        char hash[BLOBREF_MAX_DIGEST_SIZE];
+        struct shard *shard;
+
+        if (!blobref
+            || blobref_strtohash (blobref, hash, sizeof (hash))
+                                                        != ctx->hash_size) {
+            errno = EPROTO;
+            goto error;
+        }
+        shard = shard_lookup (ctx, hash);
+        if ((!parts[shard->index] && !(parts[shard->index] = json_array ()))
+            || json_array_append (parts[shard->index], hash_str) < 0) {
+            errno = ENOMEM;
+            goto error;
+        }
+    }
+    if (!(call = shard_call_create (ctx, msg, mark_sharded_respond)))
+        goto error;
+    for (i = 0; i < ctx->shard_count; i++) {
+        if (!parts[i])
+            continue;
+        if (shard_call_push (call,
+                             i,
+                             flux_rpc_pack (ctx->shards[i]->h,
+                                            "content-sqlite.shard-mark",
+                                            FLUX_NODEID_ANY,
+                                            0,
+                                            "{s:I s:O}",
+                                            "epoch", target_epoch,
+                                            "hashes", parts[i])) < 0)
+            goto error;
+    }
+    shard_call_start (call);
+    for (i = 0; i < ctx->shard_count; i++)
+        json_decref (parts[i]);
+    return 0;
+error:
+    for (i = 0; i < ctx->shard_count; i++)
+        ERRNO_SAFE_WRAP (json_decref, parts[i]);
+    shard_call_destroy (call);
+    return -1;
+}
+
+static void sweep_sharded_respond (struct shard_call *call)
+{
+    struct content_sqlite *ctx = call->ctx;
+    int64_t deleted = 0;
+    int64_t cursor = call->scan_limit;
+    int i;
+
+    /* The new virtual cursor is the lowest position that every shard has
+     * settled: scan_limit for a shard that finished its part of the window,
+     * or the encoded last rowid for a shard that was stopped by delete_cap.
+     */
+    for (i = 0; i < ctx->shard_count; i++) {
+        int64_t shard_deleted;
+        int64_t shard_cursor;
+
+        if (!call->f[i])
+            continue;
+        if (flux_rpc_get_unpack (call->f[i],
+                                 "{s:I s:I}",
+                                 "deleted", &shard_deleted,
+                                 "cursor", &shard_cursor) < 0)
+            goto error;
+        deleted += shard_deleted;
+        if (shard_cursor < vrowid_decode (ctx, i, call->scan_limit)) {
+            int64_t vrowid = vrowid_encode (ctx, i, shard_cursor);
+            if (cursor > vrowid)
+                cursor = vrowid;
+        }
+    }
+    if (flux_respond_pack (ctx->h,
+                           call->msg,
+                           "{s:I s:I}",
+                           "deleted", deleted,
+                           "cursor", cursor) < 0)
+        flux_log_error (ctx->h, "sweep: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (ctx->h,
+                            call->msg,
+                            errno,
+                            future_strerror (call->f[i], errno)) < 0)
+        flux_log_error (ctx->h, "sweep: flux_respond_error");
+}
+
+/* Sweep the virtual rowid window (cursor, scan_limit] by sweeping the
+ * corresponding rowid range of each shard in parallel.
+ */
+static int sweep_sharded (struct content_sqlite *ctx,
+                          const flux_msg_t *msg,
+                          int64_t threshold_epoch,
+                          int64_t cursor,
+                          int64_t scan_limit,
+                          int delete_cap)
+{
+    struct shard_call *call;
+    int i;
+
+    if (!(call = shard_call_create (ctx, msg, sweep_sharded_respond)))
+        return -1;
+    call->scan_limit = scan_limit;
+    for (i = 0; i < ctx->shard_count; i++) {
+        int64_t lo = vrowid_decode (ctx, i, cursor);
+        int64_t hi = vrowid_decode (ctx, i, scan_limit);
+
+        if (lo >= hi)
+            continue;
+        if (shard_call_push (call,
+                             i,
+                             flux_rpc_pack (ctx->shards[i]->h,
+                                            "content-sqlite.shard-sweep",
+                                            FLUX_NODEID_ANY,
+                                            0,
+                                            "{s:I s:I s:I s:i}",
+                                            "epoch", threshold_epoch,
+                                            "cursor", lo,
+                                            "scan_limit", hi,
+                                            "delete_cap", delete_cap)) < 0)
+            goto error;
+    }
+    shard_call_start (call);
+    return 0;
+error:
+    shard_call_destroy (call);
+    return -1;
+}
+
+static void sweep_start_sharded_respond (struct shard_call *call)
+{
+    struct content_sqlite *ctx = call->ctx;
+    struct flux_msglist *requests = ctx->sweep.requests;
+    const flux_msg_t *msg;
+    int64_t deleted = 0;
+    int i;
+
+    /* The request is answered early if the module is unloading.
+     */
+    msg = flux_msglist_first (requests);
+    while (msg && msg != call->msg)
+        msg = flux_msglist_next (requests);
+    if (!msg)
+        return;
+    flux_msglist_delete (requests);
+
+    for (i = 0; i < ctx->shard_count; i++) {
+        int64_t shard_deleted;
+
+        if (flux_rpc_get_unpack (call->f[i],
+                                 "{s:I}",
+                                 "deleted", &shard_deleted) < 0)
+            goto error;
+        deleted += shard_deleted;
+    }
+    if (flux_respond_pack (ctx->h,
+                           call->msg,
+                           "{s:I}",
+                           "deleted", deleted) < 0)
+        flux_log_error (ctx->h, "sweep-start: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (ctx->h,
+                            call->msg,
+                            errno,
+                            future_strerror (call->f[i], errno)) < 0)
+        flux_log_error (ctx->h, "sweep-start: flux_respond_error");
+}
+
+/* Start a background sweep in every shard, and respond once all of
+ * them have finished.
+ */
+static int sweep_start_sharded (struct content_sqlite *ctx,
+                                const flux_msg_t *msg,
+                                int64_t threshold_epoch)
+{
+    struct shard_call *call;
+    int i;
+
+    if (!(call = shard_call_create (ctx, msg, sweep_start_sharded_respond)))
+        return -1;
+    for (i = 0; i < ctx->shard_count; i++) {
+        if (shard_call_push (call,
+                             i,
+                             flux_rpc_pack (ctx->shards[i]->h,
+                                            "content-sqlite.shard-sweep-start",
+                                            FLUX_NODEID_ANY,
+                                            0,
+                                            "{s:I}",
+                                            "epoch", threshold_epoch)) < 0)
+            goto error;
+    }
+    if (flux_msglist_append (ctx->sweep.requests, msg) < 0)
+        goto error;
+    shard_call_start (call);
+    return 0;
+error:
+    shard_call_destroy (call);
+    return -1;
+}
+
+static void gc_info_sharded_respond (struct shard_call *call)
+{
+    struct content_sqlite *ctx = call->ctx;
+    int get_count = 0;
+    int64_t high_water = 0;
+    int64_t candidates = 0;
+    int i;
+
+    (void)flux_request_unpack (call->msg,
+                               NULL,
+                               "{s?b}",
+                               "get_count", &get_count);
+
+    for (i = 0; i < ctx->shard_count; i++) {
+        int64_t shard_high_water;
+        int64_t shard_candidates = 0;
+
+        if (flux_rpc_get_unpack (call->f[i],
+                                 "{s:I s?I}",
+                                 "high_water", &shard_high_water,
+                                 "candidates", &shard_candidates) < 0)
+            goto error;
+        if (shard_high_water > 0) {
+            int64_t vrowid = vrowid_encode (ctx, i, shard_high_water);
+            if (high_water < vrowid)
+                high_water = vrowid;
+        }
+        candidates += shard_candidates;
+    }
+    if (flux_respond_pack (ctx->h,
+                           call->msg,
+                           get_count ? "{s:I s:I s:I}" : "{s:I s:I}",
+                           "current_epoch", ctx->current_epoch,
+                           "high_water", high_water,
+                           "candidates", candidates) < 0)
+        flux_log_error (ctx->h, "gc-info: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (ctx->h,
+                            call->msg,
+                            errno,
+                            future_strerror (call->f[i], errno)) < 0)
+        flux_log_error (ctx->h, "gc-info: flux_respond_error");
+}
+
+static int gc_info_sharded (struct content_sqlite *ctx,
+                            const flux_msg_t *msg,
+                            int64_t threshold_epoch,
+                            bool get_count)
+{
+    struct shard_call *call;
+    int i;
+
+    if (!(call = shard_call_create (ctx, msg, gc_info_sharded_respond)))
+        return -1;
+    for (i = 0; i < ctx->shard_count; i++) {
+        if (shard_call_push (call,
+                             i,
+                             flux_rpc_pack (ctx->shards[i]->h,
+                                            "content-sqlite.shard-gc-info",
+                                            FLUX_NODEID_ANY,
+                                            0,
+                                            "{s:I s:b}",
+                                            "epoch", threshold_epoch,
+                                            "get_count", get_count)) < 0)
+            goto error;
+    }
+    shard_call_start (call);
+    return 0;
+error:
+    shard_call_destroy (call);
+    return -1;
+}
+
+/* content-backing.mark - mark a batch of blobs to target epoch
+ * Request: {"epoch":I, "hashes":[s,s,...]}  (hashes are blobref strings)
+ * Response: {"marked":i}
+ *
+ * Raise the epoch of each named blob to at least 'epoch' (the GC horizon H),
+ * protecting it from a later sweep.  This is the "mark" half of the online
+ * mark-and-sweep GC driven by flux-gc: the tool walks the reachable KVS tree
+ * and marks every reachable blob to H, then sweeps everything left below H.
+ *
+ * The update is UPDATE ... SET epoch = MAX(epoch, ?) so it is idempotent and
+ * monotonic: re-marking never lowers an epoch, and a blob absent from the
+ * store (already swept, or never stored) simply matches no row.  'marked' is
+ * the number of rows actually changed, for the caller's progress accounting.
+ *
+ * The batch is capped at MARK_HASHES_MAX because the whole loop runs
+ * synchronously on this module's reactor thread, blocking all other content
+ * requests until it completes; the cap bounds that stall (and rejects a
+ * malformed or hostile request that would otherwise pin the reactor).
+ * When sharded, each shard marks its part of the batch on its own thread.
+ */
+static void mark_cb (flux_t *h,
+                     flux_msg_handler_t *mh,
+                     const flux_msg_t *msg,
+                     void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    int64_t target_epoch;
+    json_t *hashes;
+    int marked_count;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:o}",
+                             "epoch", &target_epoch,
+                             "hashes", &hashes) < 0)
+        goto error;
+
+    if (!json_is_array (hashes)) {
+        errno = EPROTO;
+        goto error;
+    }
+    /* Bound the synchronous work per request (see function comment). */
+    if (json_array_size (hashes) > MARK_HASHES_MAX) {
+        errprintf (&error,
+                   "mark request of %zu hashes exceeds limit of %d",
+                   json_array_size (hashes),
+                   MARK_HASHES_MAX);
+        errstr = error.text;
+        errno = EINVAL;
+        goto error;
+    }
+    if (ctx->shards) {
+        if (mark_sharded (ctx, msg, target_epoch, hashes) < 0)
+            goto error;
+        return;
+    }
+    if (content_sqlite_mark (ctx,
+                             target_epoch,
+                             hashes,
+                             &marked_count,
+                             &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h, msg, "{s:i}", "marked", marked_count) < 0)
+        flux_log_error (h, "mark: flux_respond_pack");
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "mark: flux_respond_error");
+}
+
+/* content-backing.sweep - delete a bounded batch of blobs with epoch < H
+ * Request:  {"epoch":I, "cursor":I, "high_water":I, "delete_cap":i, "window":i}
+ * Response: {"deleted":I, "cursor":I}
+ *
+ * Delete blobs with epoch < 'epoch' (the GC horizon H) whose rowid lies in
+ * (cursor, min(high_water, cursor+window)], ascending by rowid, stopping after
+ * 'delete_cap' deletions.  Returns the number deleted and a new cursor for the
+ * caller to pass to the next call.  The caller sweeps by looping until the
+ * cursor reaches the high-water rowid it froze at the start of the run (via
+ * gc-info); a call that deletes nothing still advances the cursor by the
+ * window, so the loop always makes progress and terminates deterministically.
+ *
+ * Two caps bound the synchronous per-call work independently: 'delete_cap'
+ * limits rows deleted (the dominant cost) and 'window' limits rows scanned (so
+ * a sparse span does not stall scanning for delete_cap matches).  Both are
+ * clamped to server ceilings rather than rejected -- since termination is by
+ * cursor, not batch size, a clamped call is harmless.
+ *
+ * The rowid cursor makes the whole sweep a single ascending pass: every row at
+ * or below the returned cursor is settled (deleted, or epoch >= H and staying
+ * so, since epochs only rise), so it is never rescanned.  Bounding at
+ * high_water keeps the sweep from chasing blobs stored after the run began.
+ *
+ * When sharded, cursor and high_water refer to the virtual rowid space
+ * described at vrowid_encode(), and 'delete_cap' applies to each shard.
+ * Blobs stored in a shard after the run began may then fall below
+ * high_water, but like any blob stored after H was frozen they carry
+ * epoch >= H and are not deleted.
+ */
+static void sweep_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    int64_t threshold_epoch;
+    int64_t cursor;
+    int64_t high_water;
+    int delete_cap;
+    int window;
+    int64_t scan_limit;
+    int64_t deleted;
+    const char *errstr = NULL;
+    flux_error_t error;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:I s:I s:i s:i}",
+                             "epoch", &threshold_epoch,
+                             "cursor", &cursor,
+                             "high_water", &high_water,
+                             "delete_cap", &delete_cap,
+                             "window", &window) < 0)
+        goto error;
+
+    if (cursor < 0 || high_water < 0 || delete_cap <= 0 || window <= 0) {
+        errno = EINVAL;
+        goto error;
+    }
+    /* Clamp both caps to their ceilings (see SWEEP_DELETE_MAX / _WINDOW_MAX). */
+    if (delete_cap > SWEEP_DELETE_MAX)
+        delete_cap = SWEEP_DELETE_MAX;
+    if (window > SWEEP_WINDOW_MAX)
+        window = SWEEP_WINDOW_MAX;
+
+    /* Scan the window (cursor, scan_limit], capped at high_water. */
+    scan_limit = cursor + window;
+    if (scan_limit > high_water)
+        scan_limit = high_water;
+
+    if (ctx->shards) {
+        if (sweep_sharded (ctx,
+                           msg,
+                           threshold_epoch,
+                           cursor,
+                           scan_limit,
+                           delete_cap) < 0)
+            goto error;
+        return;
+    }
+    if (content_sqlite_sweep (ctx,
+                              threshold_epoch,
+                              cursor,
+                              scan_limit,
+                              delete_cap,
+                              &deleted,
+                              &cursor,
+                              &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:I s:I}",
+                           "deleted", deleted,
+                           "cursor", cursor) < 0)
+        flux_log_error (h, "sweep: flux_respond_pack");
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "sweep: flux_respond_error");
+}
+
+/* content-backing.sweep-start - sweep in the background
+ * Request: {"epoch":I}
+ * Response: {"deleted":I}
+ *
+ * Delete all blobs with epoch < 'epoch' that were stored before the
+ * request, as a loop over content-backing.sweep would, then reclaim the
+ * free space.  The response is sent when the run finishes, and 'deleted'
+ * is the number of blobs it deleted.  A request that arrives during a run
+ * with an equal or lower epoch joins it, since blobs behind the cursor
+ * have already been swept with at least that epoch; otherwise it waits
+ * for the next run.  When sharded, each shard runs its own sweep.
+ */
+static void sweep_start_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    int64_t epoch;
+    flux_error_t error;
+
+    if (flux_request_unpack (msg, NULL, "{s:I}", "epoch", &epoch) < 0)
+        goto error;
+    if (ctx->shards) {
+        if (sweep_start_sharded (ctx, msg, epoch) < 0)
+            goto error;
+        return;
+    }
+    if (flux_msglist_append (ctx->sweep.requests, msg) < 0)
+        goto error;
+    if (ctx->sweep.phase == SWEEP_INACTIVE
+        && sweeper_start (ctx, epoch, &error) < 0)
+        sweeper_finish (ctx, errno, error.text);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "sweep-start: flux_respond_error");
+}
+
+/* content-backing.gc-info - get GC information
+ * Request: {"epoch":I get_count?b}
+ * Response: {"current_epoch":I "high_water":I candidates?I}
+ *
+ * 'high_water' is MAX(rowid) of the objects table -- the largest rowid present
+ * when the run begins.  flux-gc freezes it and bounds the sweep at it so the
+ * sweep terminates deterministically without chasing blobs stored after the
+ * run began (which get a higher rowid and epoch >= H).  It is cheap: MAX(rowid)
+ * on a rowid table reads the last btree entry, no scan.  When sharded, it is
+ * the highest virtual rowid over all shards.
+ *
+ * 'candidates' (the count of blobs with epoch < the requested threshold) is
+ * only computed and returned when 'get_count' is true.  It requires a COUNT(*)
+ * over the objects table -- an UNBOUNDED full-table scan that runs synchronously
+ * on this module's single reactor thread, blocking all other content traffic
+ * for its duration.  On a large production store that stall can be seconds or
+ * more, so 'get_count' must NOT be used on a hot path.  flux-gc never sets it
+ * (it reads only current_epoch and high_water, and the count is not even a
+ * meaningful "reclaimable" estimate before the mark phase runs, since it
+ * includes reachable data); the count exists solely for the test suite and
+ * deliberate, low-frequency ad-hoc inspection where the stall is acceptable.
+ */
+static void gc_info_cb (flux_t *h,
+                        flux_msg_handler_t *mh,
+                        const flux_msg_t *msg,
+                        void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    int64_t threshold_epoch;
+    int get_count = 0;
+    int64_t candidates = 0;
+    int64_t high_water = 0;
+    const char *errstr = NULL;
+    flux_error_t error;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s?b}",
+                             "epoch", &threshold_epoch,
+                             "get_count", &get_count) < 0)
+        goto error;
+
+    if (ctx->shards) {
+        if (gc_info_sharded (ctx, msg, threshold_epoch, get_count) < 0)
+            goto error;
+        return;
+    }
+    if (content_sqlite_gc_info (ctx,
+                                threshold_epoch,
+                                &high_water,
+                                get_count ? &candidates : NULL,
+                                &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           get_count ? "{s:I s:I s:I}" : "{s:I s:I}",
+                           "current_epoch", ctx->current_epoch,
+                           "high_water", high_water,
+                           "candidates", candidates) < 0)
+        flux_log_error (h, "gc-info: flux_respond_pack");
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "gc-info: flux_respond_error");
+}
+
+/* content-backing.gc-index - walk tree objects into the reachability index
+ * Request:  {"hashes":[blobref,...]}
+ * Response: {"walked":i, "pending":[blobref,...]}
+ *
+ * The reachability index lets flux-gc find the live objects without
+ * walking the whole KVS on every run.  It records every object reachable
+ * from the pinned roots (see gc_pin_cb), with the references held by each
+ * tree object and a count of references to each object.  Objects in the
+ * index are never swept.  A run walks only the tree objects that are new
+ * since the last run, since a tree object that is already indexed is
+ * skipped along with everything below it.
+ *
+ * Each call walks the trees in 'hashes' and any unwalked trees they refer
+ * to, and if that leaves budget, any unwalked trees left in the index by an
+ * interrupted run.  Like mark, this runs synchronously on the reactor
+ * thread, so the work per call is bounded (see GC_INDEX_TREES_MAX) and
+ * whatever is left is returned in 'pending' for the caller to send back.
+ * The walk is complete when a call returns no pending trees.  Tree objects
+ * are read from the backing store, so the caller must first flush the
+ * content cache.
+ *
+ * The index is not sharded, so with shards=N this fails with ENOSYS and
+ * flux-gc falls back to marking.
+ */
+static void gc_index_cb (flux_t *h,
+                         flux_msg_handler_t *mh,
+                         const flux_msg_t *msg,
+                         void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    json_t *hashes;
+    json_t *queue = NULL;
+    int walked;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg, NULL, "{s:o}", "hashes", &hashes) < 0)
+        goto error;
+    if (!json_is_array (hashes)) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (json_array_size (hashes) > MARK_HASHES_MAX) {
+        errprintf (&error,
+                   "gc-index request of %zu hashes exceeds limit of %d",
+                   json_array_size (hashes),
+                   MARK_HASHES_MAX);
+        errstr = error.text;
+        errno = EINVAL;
+        goto error;
+    }
+    if (ctx->shards) {
+        errstr = "gc-index is not supported with shards";
+        errno = ENOSYS;
+        goto error;
+    }
+    if (!(queue = json_copy (hashes))) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (content_sqlite_gc_index (ctx, queue, &walked, &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:O}",
+                           "walked", walked,
+                           "pending", queue) < 0)
+        flux_log_error (h, "gc-index: flux_respond_pack");
+    json_decref (queue);
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "gc-index: flux_respond_error");
+    json_decref (queue);
+}
+
+/* content-backing.gc-pin - set the roots of the reachability index
+ * Request:  {"epoch":I, "roots":[blobref,...]}
+ * Response: {"pinned":b}
+ *
+ * Replace the pinned roots with 'roots', which flux-gc enumerated after
+ * freezing GC horizon 'epoch'.  Objects that are no longer reachable from
+ * a pinned root become unreferenced, to be removed by gc-collect and then
+ * swept.  Every root must have been walked with gc-index and no walk may
+ * be unfinished, or this fails with EAGAIN and the caller should walk
+ * again.  An empty 'roots' releases the whole index.
+ *
+ * A sweep at horizon H deletes unindexed objects with epoch < H, so it
+ * relies on the pinned roots covering everything that was live at H.  Any
+ * roots enumerated after H do, so pins only move forward: if the current
+ * pins were taken at a later epoch, the request does nothing and 'pinned'
+ * is false.
+ */
+static void gc_pin_cb (flux_t *h,
+                       flux_msg_handler_t *mh,
+                       const flux_msg_t *msg,
+                       void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    int64_t epoch;
+    json_t *roots;
+    bool pinned;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:o}",
+                             "epoch", &epoch,
+                             "roots", &roots) < 0)
+        goto error;
+    if (!json_is_array (roots) || json_array_size (roots) > MARK_HASHES_MAX) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (ctx->shards) {
+        errstr = "gc-pin is not supported with shards";
+        errno = ENOSYS;
+        goto error;
+    }
+    if (content_sqlite_gc_pin (ctx, epoch, roots, &pinned, &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h, msg, "{s:b}", "pinned", pinned) < 0)
+        flux_log_error (h, "gc-pin: flux_respond_pack");
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "gc-pin: flux_respond_error");
+}
+
+/* content-backing.gc-collect - remove unreferenced objects from the index
+ * Request:  {}
+ * Response: {"collected":i, "done":b}
+ *
+ * Remove a bounded batch of objects that are no longer referenced by a
+ * pinned root or an indexed tree object (see GC_COLLECT_MAX), so that the
+ * next sweep can delete them.  The caller repeats until 'done' is true.
+ */
+static void gc_collect_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    int collected;
+    bool done;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_decode (msg, NULL, NULL) < 0)
+        goto error;
+    if (ctx->shards) {
+        errstr = "gc-collect is not supported with shards";
+        errno = ENOSYS;
+        goto error;
+    }
+    if (content_sqlite_gc_collect (ctx, &collected, &done, &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:i s:b}",
+                           "collected", collected,
+                           "done", done) < 0)
+        flux_log_error (h, "gc-collect: flux_respond_pack");
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "gc-collect: flux_respond_error");
+}
+
+/* Pack the stats that are kept for each objects table.
+ * On failure, returns NULL with errno and 'errp' set.
+ */
+static json_t *stats_pack_objects (struct content_sqlite *ctx,
+                                   flux_error_t *errp)
+{
+    struct sweeper *sw = &ctx->sweep;
+    int64_t count;
+    json_t *load_time = NULL;
+    json_t *store_time = NULL;
+    json_t *sweep = NULL;
+    json_t *o = NULL;
+
+    if (sqlite3_exec (ctx->db,
+                      sql_objects_count,
+                      set_count,
+                      &count,
+                      NULL) != SQLITE_OK) {
+        set_text_from_sqlite_error (ctx, errp);
+        errno = EPERM;
+        return NULL;
+    }
+    if (!(load_time = pack_tstat (&ctx->stats.load))
+        || !(store_time = pack_tstat (&ctx->stats.store))
+        || !(sweep = json_pack ("{s:b s:I s:I s:I s:I s:I s:I s:I}",
+                                "active", sw->phase != SWEEP_INACTIVE,
+                                "epoch", sw->epoch,
+                                "cursor", sw->cursor,
+                                "high_water", sw->high_water,
+                                "deleted", sw->deleted,
+                                "vacuumed_pages", sw->vacuumed_pages,
+                                "runs", sw->runs,
+                                "total_deleted", sw->total_deleted))
+        || !(o = json_pack ("{s:I s:I s:O s:O s:I s:I s:I s:O}",
+                            "object_count", count,
+                            "dbfile_size", get_file_size (ctx->dbfile),
+                            "load_time", load_time,
+                            "store_time", store_time,
+                            "load_bytes", (json_int_t)ctx->stats.load_bytes,
+                            "load_copy_bytes",
+                              (json_int_t)ctx->stats.load_copy_bytes,
+                            "dict_id",
+                              (json_int_t)content_codec_dict_id (ctx->codec),
+                            "sweep", sweep))) {
+        errprintf (errp, "out of memory");
+        errno = ENOMEM;
+    }
+    json_decref (load_time);
+    json_decref (store_time);
+    json_decref (sweep);
+    return o;
+}
+
+/* Stats that are summed over the shards (and the reactor thread, which
+ * copies load responses as it relays them) for the top level totals.
+ */
+static const char *stats_sum_keys[] = {
+    "object_count",
+    "dbfile_size",
+    "load_bytes",
+    "load_copy_bytes",
+};
+
+static void stats_sharded_respond (struct shard_call *call)
+{
+    struct content_sqlite *ctx = call->ctx;
+    json_t *shards;
+    int i;
+
+    if (!(shards = json_array ())
+        || json_object_set_new (call->result, "shards", shards) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    for (i = 0; i < ctx->shard_count; i++) {
+        json_t *o;
+
+        if (flux_rpc_get_unpack (call->f[i], "o", &o) < 0
+            || json_array_append (shards, o) < 0)
+            goto error;
+    }
+    for (int k = 0; k < ARRAY_SIZE (stats_sum_keys); k++) {
+        const char *key = stats_sum_keys[k];
+        json_int_t total;
+        size_t index;
+        json_t *o;
+
+        total = json_integer_value (json_object_get (call->result, key));
+        json_array_foreach (shards, index, o)
+            total += json_integer_value (json_object_get (o, key));
+        if (json_object_set_new (call->result,
+                                 key,
+                                 json_integer (total)) < 0) {
+            errno = ENOMEM;
+            goto error;
+        }
+    }
+    if (flux_respond_pack (ctx->h, call->msg, "O", call->result) < 0)
+        flux_log_error (ctx->h, "error responding to stats-get request");
+    return;
+error:
+    if (flux_respond_error (ctx->h, call->msg, errno, NULL) < 0)
+        flux_log_error (ctx->h, "error responding to stats-get request");
+}
+
+/* Collect per-shard stats and respond with 'o' updated to include them.
+ * Takes a reference on 'o'.
+ */
+static int stats_sharded (struct content_sqlite *ctx,
+                          const flux_msg_t *msg,
+                          json_t *o)
+{
+    struct shard_call *call;
+    int i;
+
+    if (!(call = shard_call_create (ctx, msg, stats_sharded_respond)))
+        return -1;
+    call->result = json_incref (o);
+    for (i = 0; i < ctx->shard_count; i++) {
+        if (shard_call_push (call,
+                             i,
+                             flux_rpc (ctx->shards[i]->h,
+                                       "content-sqlite.shard-stats",
+                                       NULL,
+                                       FLUX_NODEID_ANY,
+                                       0)) < 0)
+            goto error;
+    }
+    shard_call_start (call);
+    return 0;
+error:
+    shard_call_destroy (call);
+    return -1;
+}
+
+void stats_get_cb (flux_t *h,
+                   flux_msg_handler_t *mh,
+                   const flux_msg_t *msg,
+                   void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    const char *errmsg = NULL;
+    flux_error_t error;
+    json_t *o = NULL;
+    json_t *checkpoints = NULL;
+    json_t *config = NULL;
+    bool incremental = ctx->auto_vacuum == SQLITE_AUTO_VACUUM_INCREMENTAL;
+
+    if (!(o = stats_pack_objects (ctx, &error))) {
+        errmsg = error.text;
+        goto error;
+    }
+    if (!(checkpoints = stats_checkpoints (ctx, &error))) {
+        errmsg = error.text;
+        goto error;
+    }
+    if (!(config = json_pack ("{s:s s:s s:i s:s s:i s:b}",
+                              "journal_mode", ctx->journal_mode,
+                              "synchronous", ctx->synchronous,
+                              "shards", ctx->shard_count,
+                              "codec", ctx->codec_name,
+                              "sweep_rate", ctx->sweep_rate,
+                              "auto_vacuum", incremental))
+        || json_object_set_new (o,
+                                "current_epoch",
+                                json_integer (ctx->current_epoch)) < 0
+        || json_object_set_new (o,
+                                "dbfile_free",
+                                json_integer (get_fs_free (ctx->dbfile))) < 0
+        || json_object_set (o, "config", config) < 0
+        || json_object_set (o, "checkpoints", checkpoints) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (ctx->shards) {
+        if (stats_sharded (ctx, msg, o) < 0)
+            goto error;
+    }
+    else if (flux_respond_pack (h, msg, "O", o) < 0)
+        flux_log_error (h, "error responding to stats-get request");
+    json_decref (o);
+    json_decref (checkpoints);
+    json_decref (config);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to stats-get request");
+    json_decref (o);
+    json_decref (checkpoints);
+    json_decref (config);
+}
+
+/* Shard worker thread.
+ *
+ * The worker owns its shard database and an interthread channel.  Requests
+ * forwarded by the reactor thread are handled by the same callbacks used in
+ * the unsharded case, called directly with the shard context (whose
+ * 'shards' is NULL, so they run locally) and the worker's end of the channel.
+ * Stores are the exception: they are batched into one transaction per
+ * wakeup, and not answered until it commits.
+ */
+
+static void shard_epoch_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct content_sqlite *db = arg;
+    int64_t epoch;
+
+    if (flux_request_unpack (msg, NULL, "{s:I}", "epoch", &epoch) < 0) {
+        flux_log_error (h, "shard-epoch: error decoding request");
+        return;
+    }
+    db->current_epoch = epoch;
+}
+
+static void shard_mark_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    struct content_sqlite *db = arg;
+    int64_t epoch;
+    json_t *hashes;
+    int marked;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:o}",
+                             "epoch", &epoch,
+                             "hashes", &hashes) < 0)
+        goto error;
+    if (content_sqlite_mark (db, epoch, hashes, &marked, &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h, msg, "{s:i}", "marked", marked) < 0)
+        flux_log_error (h, "shard-mark: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "shard-mark: flux_respond_error");
+}
+
+static void shard_sweep_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct content_sqlite *db = arg;
+    int64_t epoch;
+    int64_t cursor;
+    int64_t scan_limit;
+    int delete_cap;
+    int64_t deleted;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:I s:I s:i}",
+                             "epoch", &epoch,
+                             "cursor", &cursor,
+                             "scan_limit", &scan_limit,
+                             "delete_cap", &delete_cap) < 0)
+        goto error;
+    if (content_sqlite_sweep (db,
+                              epoch,
+                              cursor,
+                              scan_limit,
+                              delete_cap,
+                              &deleted,
+                              &cursor,
+                              &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:I s:I}",
+                           "deleted", deleted,
+                           "cursor", cursor) < 0)
+        flux_log_error (h, "shard-sweep: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "shard-sweep: flux_respond_error");
+}
+
+static void shard_gc_info_cb (flux_t *h,
+                              flux_msg_handler_t *mh,
+                              const flux_msg_t *msg,
+                              void *arg)
+{
+    struct content_sqlite *db = arg;
+    int64_t epoch;
+    int get_count;
+    int64_t high_water;
+    int64_t candidates = 0;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:b}",
+                             "epoch", &epoch,
+                             "get_count", &get_count) < 0)
+        goto error;
+    if (content_sqlite_gc_info (db,
+                                epoch,
+                                &high_water,
+                                get_count ? &candidates : NULL,
+                                &error) < 0) {
+        errstr = error.text;
+        goto error;
+    }
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:I s:I}",
+                           "high_water", high_water,
+                           "candidates", candidates) < 0)
+        flux_log_error (h, "shard-gc-info: flux_respond_pack");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "shard-gc-info: flux_respond_error");
+}
+
+static void shard_stats_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct content_sqlite *db = arg;
+    json_t *o;
+    json_t *batch = NULL;
+    flux_error_t error;
+    const char *errstr = NULL;
+
+    if (!(o = stats_pack_objects (db, &error))) {
+        errstr = error.text;
+        goto error;
+    }
+    if (!(batch = pack_tstat (&db->stats.batch))
+        || json_object_set (o, "batch_size", batch) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (flux_respond_pack (h, msg, "O", o) < 0)
+        flux_log_error (h, "shard-stats: flux_respond_pack");
+    json_decref (batch);
+    json_decref (o);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        flux_log_error (h, "shard-stats: flux_respond_error");
+    json_decref (batch);
+    json_decref (o);
+}
+
+/* Stop the background sweep, which has watchers on the worker reactor.
+ */
+static void shard_shutdown_cb (flux_t *h,
+                               flux_msg_handler_t *mh,
+                               const flux_msg_t *msg,
+                               void *arg)
+{
+    struct content_sqlite *db = arg;
+
+    sweeper_stop (db);
+}
+
+/* Requests handled by the worker, other than store.
+ * 'commit' requests force stores already in the batch to be committed
+ * (and answered) first.
+ */
+static const struct shard_method {
+    const char *topic;
+    flux_msg_handler_f cb;
+    bool commit;
+} shard_methods[] = {
+    { "content-backing.load", load_cb, false },
+    { "content-backing.validate", validate_cb, true },
+    { "content-sqlite.shard-epoch", shard_epoch_cb, false },
+    { "content-sqlite.shard-mark", shard_mark_cb, true },
+    { "content-sqlite.shard-sweep", shard_sweep_cb, true },
+    { "content-sqlite.shard-sweep-start", sweep_start_cb, true },
+    { "content-sqlite.shard-gc-info", shard_gc_info_cb, true },
+    { "content-sqlite.shard-stats", shard_stats_cb, true },
+    { "content-sqlite.shard-shutdown", shard_shutdown_cb, true },
+};
+
+struct shard_store {
+    const flux_msg_t *msg;
+    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+    int errnum;
+};
+
+struct shard_batch {
+    struct shard_store stores[SHARD_BATCH_MAX];
+    int count;
+    bool in_txn;
+};
+
+/* Commit the open store transaction, if any, then respond to the stores in
+ * the batch.  Responses are held until now so that a successful store
+ * response still means the blob is in the database.
+ */
+static void shard_commit (struct content_sqlite *db, struct shard_batch *b)
+{
+    int commit_errnum = 0;
+    int i;
+
+    if (b->in_txn) {
+        if (sqlite3_exec (db->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+            log_sqlite_error (db, "store: COMMIT");
+            set_errno_from_sqlite_error (db);
+            commit_errnum = errno;
+            (void)sqlite3_exec (db->db, "ROLLBACK", NULL, NULL, NULL);
+            dict_samples_rollback (db);
+        }
+        else
+            dict_samples_commit (db);
+        b->in_txn = false;
+    }
+    for (i = 0; i < b->count; i++) {
+        struct shard_store *store = &b->stores[i];
+        int errnum = store->errnum ? store->errnum : commit_errnum;
+
+        if (errnum) {
+            if (flux_respond_error (db->h, store->msg, errnum, NULL) < 0)
+                flux_log_error (db->h, "store: flux_respond_error");
+        }
+        else if (flux_respond_raw (db->h,
+                                   store->msg,
+                                   store->hash,
+                                   store->hash_size) < 0)
+            flux_log_error (db->h, "store: flux_respond_raw");
+    }
+    if (b->count > 0)
+        tstat_push (&db->stats.batch, b->count);
+    b->count = 0;
+}
+
+/* Add a store to the batch, executing it within the batch transaction.
+ */
+static void shard_store (struct content_sqlite *db,
+                         struct shard_batch *b,
+                         const flux_msg_t *msg)
+{
+    struct shard_store *store = &b->stores[b->count++];
+    const void *data;
+    size_t size;
+    struct timespec t0;
+
+    store->msg = msg;
+    store->errnum = 0;
+    if (flux_request_decode_raw (msg, NULL, &data, &size) < 0)
+        goto error;
+    if (!b->in_txn) {
+        if (sqlite3_exec (db->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+            log_sqlite_error (db, "store: BEGIN");
+            set_errno_from_sqlite_error (db);
+            goto error;
+        }
+        b->in_txn = true;
+    }
+    monotime (&t0);
+    if ((store->hash_size = content_sqlite_store (db,
+                                                  data,
+                                                  size,
+                                                  store->hash,
+                                                  sizeof (store->hash))) < 0)
+        goto error;
+    tstat_push (&db->stats.store, monotime_since (t0));
+    return;
+error:
+    store->errnum = errno;
+    /* Some errors cause sqlite to roll back the whole transaction.
+     * If that happened, earlier stores in the batch were lost too.
+     */
+    if (b->in_txn && sqlite3_get_autocommit (db->db)) {
+        for (int i = 0; i < b->count; i++) {
+            if (!b->stores[i].errnum)
+                b->stores[i].errnum = store->errnum;
+        }
+        dict_samples_rollback (db);
+        b->in_txn = false;
+    }
+}
+
+/* Handle a batch of messages.  Returns true if shutdown was requested.
+ */
+static bool shard_process (struct content_sqlite *db,
+                           struct shard_batch *b,
+                           flux_msg_t **msgs,
+                           int count)
+{
+    bool shutdown = false;
+
+    for (int i = 0; i < count; i++) {
+        const char *topic;
+        const struct shard_method *m = NULL;
+
+        if (flux_msg_get_topic (msgs[i], &topic) < 0)
+            continue;
+        if (streq (topic, "content-backing.store")) {
+            shard_store (db, b, msgs[i]);
+            continue;
+        }
+        for (int j = 0; j < ARRAY_SIZE (shard_methods); j++) {
+            if (streq (topic, shard_methods[j].topic)) {
+                m = &shard_methods[j];
+                break;
+            }
+        }
+        if (!m) {
+            if (flux_respond_error (db->h, msgs[i], ENOSYS, NULL) < 0)
+                flux_log_error (db->h, "error responding to %s", topic);
+            continue;
+        }
+        if (m->commit)
+            shard_commit (db, b);
+        m->cb (db->h, NULL, msgs[i], db);
+        if (m->cb == shard_shutdown_cb)
+            shutdown = true;
     }
+    shard_commit (db, b);
+    dict_train_if_ready (db);
+    return shutdown;
+}
 
-    if (flux_respond_pack (h,
-                           msg,
-                           get_count ? "{s:I s:I s:I}" : "{s:I s:I}",
-                           "current_epoch", ctx->current_epoch,
-                           "high_water", high_water,
-                           "candidates", candidates) < 0)
-        flux_log_error (h, "gc-info: flux_respond_pack");
+/* The channel has messages.  Take up to SHARD_BATCH_MAX of them at once
+ * so that the stores among them share one transaction.
+ */
+static void shard_recv_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    struct shard *shard = arg;
+    flux_msg_t *msgs[SHARD_BATCH_MAX];
+    int count = 0;
+
+    while (count < SHARD_BATCH_MAX
+           && (msgs[count] = flux_recv (shard->h_worker,
+                                        FLUX_MATCH_ANY,
+                                        FLUX_O_NONBLOCK)))
+        count++;
+    if (shard_process (shard->db, shard->batch, msgs, count))
+        flux_reactor_stop (r);
+    for (int i = 0; i < count; i++)
+        flux_msg_destroy (msgs[i]);
+}
 
-    sqlite3_finalize (hw_stmt);
-    sqlite3_finalize (stmt);
-    return;
+static void *shard_thread (void *arg)
+{
+    struct shard *shard = arg;
 
-error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "gc-info: flux_respond_error");
-    if (hw_stmt)
-        sqlite3_finalize (hw_stmt);
-    if (stmt)
-        sqlite3_finalize (stmt);
+    if (flux_reactor_run (shard->r, 0) < 0)
+        flux_log_error (shard->h_worker,
+                        "shard %d: flux_reactor_run",
+                        shard->index);
+    return NULL;
 }
 
-/* Check if epoch column exists in objects table.
+/* Check if column 'name' exists in objects table.
  * Returns 1 if exists, 0 if not, -1 on error.
  */
-static int epoch_column_exists (struct content_sqlite *ctx)
+static int column_exists (struct content_sqlite *ctx, const char *name)
 {
     sqlite3_stmt *stmt = NULL;
     int exists = 0;
@@ -1337,7 +3919,7 @@ static int epoch_column_exists (struct content_sqlite *ctx)
 
     while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
         const unsigned char *col_name = sqlite3_column_text (stmt, 1);
-        if (col_name && streq ((const char *)col_name, "epoch")) {
+        if (col_name && streq ((const char *)col_name, name)) {
             exists = 1;
             break;
         }
@@ -1353,27 +3935,29 @@ static int epoch_column_exists (struct content_sqlite *ctx)
     return exists;
 }
 
-/* Add epoch column to objects table if it doesn't exist.
+/* Add column 'name' to objects table if it doesn't exist.
  */
-static int migrate_add_epoch_column (struct content_sqlite *ctx)
+static int migrate_add_column (struct content_sqlite *ctx,
+                               const char *name,
+                               const char *sql_alter)
 {
-    int exists = epoch_column_exists (ctx);
+    int exists = column_exists (ctx, name);
 
     if (exists < 0)
         return -1;
 
     if (exists) {
-        flux_log (ctx->h, LOG_DEBUG, "epoch column already exists");
+        flux_log (ctx->h, LOG_DEBUG, "%s column already exists", name);
         return 0;
     }
 
-    flux_log (ctx->h, LOG_INFO, "adding epoch column to objects table");
+    flux_log (ctx->h, LOG_INFO, "adding %s column to objects table", name);
     if (sqlite3_exec (ctx->db,
-                      sql_alter_objects_add_epoch,
+                      sql_alter,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "adding epoch column");
+        log_sqlite_error (ctx, "adding %s column", name);
         set_errno_from_sqlite_error (ctx);
         return -1;
     }
@@ -1436,6 +4020,24 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "opening %s", ctx->dbfile);
         goto error;
     }
+    /* Let the background sweep return free pages to the file system.
+     * This only takes effect on a new database, and must precede the
+     * journal_mode pragma.  Existing databases keep their mode and reuse
+     * the free pages instead.
+     */
+    if (sqlite3_exec (ctx->db,
+                      "PRAGMA auto_vacuum=INCREMENTAL",
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK
+        || sqlite3_exec (ctx->db,
+                         "PRAGMA auto_vacuum",
+                         set_count,
+                         &ctx->auto_vacuum,
+                         NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "setting sqlite 'auto_vacuum' pragma");
+        goto error;
+    }
     snprintf (s, sizeof (s), "PRAGMA journal_mode=%s", ctx->journal_mode);
     if (sqlite3_exec (ctx->db,
                       s,
@@ -1478,18 +4080,59 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "creating object table");
         goto error;
     }
+    if (migrate_add_column (ctx, "epoch", sql_alter_objects_add_epoch) < 0
+        || migrate_add_column (ctx, "codec", sql_alter_objects_add_codec) < 0)
+        goto error;
     if (sqlite3_exec (ctx->db,
-                      sql_create_table_checkpt_v2,
+                      sql_create_table_dict,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "creating checkpt table");
+        log_sqlite_error (ctx, "creating dictionaries table");
         goto error;
     }
-    if (migrate_add_epoch_column (ctx) < 0)
-        goto error;
-    if (init_current_epoch (ctx) < 0)
+    /* The sweep queries consult the reachability index, so it is created
+     * in shard databases too, where it remains empty.
+     */
+    if (sqlite3_exec (ctx->db,
+                      sql_create_table_gc_nodes,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK
+        || sqlite3_exec (ctx->db,
+                         sql_create_index_gc_unref,
+                         NULL,
+                         NULL,
+                         NULL) != SQLITE_OK
+        || sqlite3_exec (ctx->db,
+                         sql_create_index_gc_unwalked,
+                         NULL,
+                         NULL,
+                         NULL) != SQLITE_OK
+        || sqlite3_exec (ctx->db,
+                         sql_create_table_gc_refs,
+                         NULL,
+                         NULL,
+                         NULL) != SQLITE_OK
+        || sqlite3_exec (ctx->db,
+                         sql_create_table_gc_pins,
+                         NULL,
+                         NULL,
+                         NULL) != SQLITE_OK
+        || sqlite3_exec (ctx->db,
+                         sql_create_table_gc_newpins,
+                         NULL,
+                         NULL,
+                         NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "creating gc index tables");
         goto error;
+    }
+    if (!(ctx->codec = content_codec_create (ctx->codec_name, NULL))) {
+        flux_log_error (ctx->h, "error creating %s codec", ctx->codec_name);
+        goto error_close;
+    }
+    if (dict_load_all (ctx) < 0)
+        goto error_close;
     if (sqlite3_prepare_v2 (ctx->db,
                             sql_load,
                             -1,
@@ -1514,6 +4157,29 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "preparing validate stmt");
         goto error;
     }
+    /* A shard database holds only objects.  Its epoch is set by the
+     * reactor thread (see shards_set_epoch()).
+     */
+    if (ctx->is_shard)
+        goto done;
+    if (sqlite3_exec (ctx->db,
+                      sql_create_table_checkpt_v2,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "creating checkpt table");
+        goto error;
+    }
+    if (sqlite3_exec (ctx->db,
+                      sql_create_table_meta,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (ctx, "creating meta table");
+        goto error;
+    }
+    if (init_current_epoch (ctx) < 0)
+        goto error;
     if (sqlite3_prepare_v2 (ctx->db,
                             sql_checkpt_get_v2,
                             -1,
@@ -1546,6 +4212,7 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
         log_sqlite_error (ctx, "preparing checkpt get_all stmt");
         goto error;
     }
+done:
     if (sqlite3_exec (ctx->db,
                       sql_objects_count,
                       set_count,
@@ -1556,14 +4223,17 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
     }
     flux_log (ctx->h,
               LOG_DEBUG,
-              "%s (%jd objects) journal_mode=%s synchronous=%s",
+              "%s (%jd objects) journal_mode=%s synchronous=%s codec=%s",
               ctx->dbfile,
               (intmax_t)count,
               ctx->journal_mode,
-              ctx->synchronous);
+              ctx->synchronous,
+              ctx->codec_name);
     return 0;
 error:
     set_errno_from_sqlite_error (ctx);
+error_close:
+    content_sqlite_closedb (ctx);
     return -1;
 }
 
@@ -1690,7 +4360,10 @@ static void content_sqlite_destroy (struct content_sqlite *ctx)
         int saved_errno = errno;
         flux_msg_handler_delvec (ctx->handlers);
         free (ctx->dbfile);
-        free (ctx->lzo_buf);
+        free (ctx->compress_buf);
+        free (ctx->codec_name);
+        dict_samples_clear (ctx);
+        flux_msglist_destroy (ctx->sweep.requests);
         free (ctx->hashfun);
         free (ctx->journal_mode);
         free (ctx->synchronous);
@@ -1699,6 +4372,384 @@ static void content_sqlite_destroy (struct content_sqlite *ctx)
     }
 }
 
+/* Pass a response or log message from a worker on to the broker.
+ */
+static void shard_relay_cb (flux_t *h,
+                            flux_msg_handler_t *mh,
+                            const flux_msg_t *msg,
+                            void *arg)
+{
+    struct shard *shard = arg;
+    const char *topic;
+    const void *data;
+    size_t size;
+
+    /* N.B. flux_send() copies the message, including any load payload.
+     * Account for that so load_copy_bytes reflects the extra hop.
+     */
+    if (flux_msg_get_topic (msg, &topic) == 0
+        && streq (topic, "content-backing.load")
+        && flux_msg_cmp (msg, FLUX_MATCH_RESPONSE)
+        && flux_msg_get_payload (msg, &data, &size) == 0)
+        shard->ctx->stats.load_copy_bytes += size;
+    if (flux_send (shard->ctx->h, msg, 0) < 0)
+        flux_log_error (shard->ctx->h,
+                        "shard %d: error relaying message",
+                        shard->index);
+}
+
+static const struct flux_msg_handler_spec shard_htab[] = {
+    {
+        FLUX_MSGTYPE_RESPONSE,
+        "content-backing.*",
+        shard_relay_cb,
+        0
+    },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "log.append",
+        shard_relay_cb,
+        0
+    },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+static void shard_destroy (struct shard *shard)
+{
+    if (shard) {
+        int saved_errno = errno;
+        if (shard->started) {
+            flux_future_t *f;
+            flux_msg_t *msg;
+
+            if (!(f = flux_rpc (shard->h,
+                                "content-sqlite.shard-shutdown",
+                                NULL,
+                                FLUX_NODEID_ANY,
+                                FLUX_RPC_NORESPONSE))
+                || pthread_join (shard->thread, NULL) != 0)
+                flux_log_error (shard->ctx->h,
+                                "shard %d: error stopping worker",
+                                shard->index);
+            flux_future_destroy (f);
+            /* Relay anything the worker sent after the reactor stopped.
+             */
+            while ((msg = flux_recv (shard->h,
+                                     FLUX_MATCH_ANY,
+                                     FLUX_O_NONBLOCK))) {
+                if (flux_msg_route_count (msg) > 0
+                    || flux_msg_cmp (msg, FLUX_MATCH_REQUEST))
+                    (void)flux_send (shard->ctx->h, msg, 0);
+                flux_msg_destroy (msg);
+            }
+        }
+        flux_msg_handler_delvec (shard->handlers);
+        flux_watcher_destroy (shard->w);
+        flux_reactor_destroy (shard->r);
+        free (shard->batch);
+        if (shard->db) {
+            shard->db->h = shard->ctx->h;
+            content_sqlite_closedb (shard->db);
+            content_sqlite_destroy (shard->db);
+        }
+        flux_close (shard->h_worker);
+        flux_close (shard->h);
+        free (shard);
+        errno = saved_errno;
+    }
+}
+
+/* Create shard database context, copying configuration from the parent.
+ */
+static struct content_sqlite *shard_db_create (struct content_sqlite *ctx,
+                                               int index)
+{
+    struct content_sqlite *db;
+
+    if (!(db = calloc (1, sizeof (*db))))
+        return NULL;
+    db->h = ctx->h;
+    db->is_shard = true;
+    db->hash_size = ctx->hash_size;
+    db->current_epoch = ctx->current_epoch;
+    /* Each shard sweeps on its own, so split the rate among them.
+     */
+    if (ctx->sweep_rate > 0) {
+        db->sweep_rate = ctx->sweep_rate / ctx->shard_count;
+        if (db->sweep_rate == 0)
+            db->sweep_rate = 1;
+    }
+    if (!(db->sweep.requests = flux_msglist_create ()))
+        goto error;
+    if (!(db->compress_buf = calloc (1, compress_buf_chunksize)))
+        goto error;
+    db->compress_bufsize = compress_buf_chunksize;
+    if (set_config (&db->hashfun, ctx->hashfun) < 0
+        || set_config (&db->codec_name, ctx->codec_name) < 0
+        || set_config (&db->journal_mode, ctx->journal_mode) < 0
+        || set_config (&db->synchronous, ctx->synchronous) < 0
+        || asprintf (&db->dbfile, "%s.%d", ctx->dbfile, index) < 0)
+        goto error;
+    return db;
+error:
+    content_sqlite_destroy (db);
+    return NULL;
+}
+
+static struct shard *shard_create (struct content_sqlite *ctx,
+                                   int index,
+                                   bool truncate)
+{
+    struct shard *shard;
+    char uri[64];
+    char rankstr[16];
+    uint32_t rank;
+    int e;
+
+    if (!(shard = calloc (1, sizeof (*shard))))
+        return NULL;
+    shard->ctx = ctx;
+    shard->index = index;
+    snprintf (uri,
+              sizeof (uri),
+              "interthread://content-sqlite-shard-%d",
+              index);
+    if (!(shard->h = flux_open (uri, 0))
+        || !(shard->h_worker = flux_open (uri, 0))
+        || flux_set_reactor (shard->h, flux_get_reactor (ctx->h)) < 0
+        || flux_msg_handler_addvec (shard->h,
+                                    shard_htab,
+                                    shard,
+                                    &shard->handlers) < 0) {
+        flux_log_error (ctx->h, "shard %d: error creating channel", index);
+        goto error;
+    }
+    if (!(shard->db = shard_db_create (ctx, index))
+        || content_sqlite_opendb (shard->db, truncate) < 0)
+        goto error;
+    /* N.B. the worker can't use a blocking flux_recv() on its end of the
+     * channel, as that would spin.  Give it a reactor of its own.
+     */
+    if (!(shard->batch = calloc (1, sizeof (*shard->batch)))
+        || !(shard->r = flux_reactor_create (0))
+        || flux_set_reactor (shard->h_worker, shard->r) < 0
+        || !(shard->w = flux_handle_watcher_create (shard->r,
+                                                    shard->h_worker,
+                                                    FLUX_POLLIN,
+                                                    shard_recv_cb,
+                                                    shard))) {
+        flux_log_error (ctx->h, "shard %d: error creating reactor", index);
+        goto error;
+    }
+    flux_watcher_start (shard->w);
+    /* Worker log messages travel over the channel to shard_relay_cb().
+     * Set the hostname so flux_log() doesn't try to look up the rank with
+     * an RPC from the worker end, which nothing would answer.
+     */
+    if (flux_get_rank (ctx->h, &rank) < 0)
+        goto error;
+    snprintf (rankstr, sizeof (rankstr), "%ju", (uintmax_t)rank);
+    flux_log_set_hostname (shard->h_worker, rankstr);
+    flux_log_set_appname (shard->h_worker, "content-sqlite");
+    shard->db->h = shard->h_worker;
+    if ((e = pthread_create (&shard->thread, NULL, shard_thread, shard)) != 0) {
+        errno = e;
+        flux_log_error (ctx->h, "shard %d: pthread_create", index);
+        shard->db->h = ctx->h;
+        goto error;
+    }
+    shard->started = true;
+    return shard;
+error:
+    shard_destroy (shard);
+    return NULL;
+}
+
+/* Get an integer from the meta table.
+ * Returns 1 and sets *valuep if found, 0 if not found, -1 on error.
+ */
+static int meta_get (struct content_sqlite *ctx,
+                     const char *key,
+                     int64_t *valuep)
+{
+    sqlite3_stmt *stmt = NULL;
+    int rc;
+
+    if (sqlite3_prepare_v2 (ctx->db, sql_meta_get, -1, &stmt, NULL) != SQLITE_OK
+        || sqlite3_bind_text (stmt, 1, key, -1, SQLITE_STATIC) != SQLITE_OK) {
+        log_sqlite_error (ctx, "meta_get: preparing stmt");
+        goto error;
+    }
+    if ((rc = sqlite3_step (stmt)) == SQLITE_ROW)
+        *valuep = sqlite3_column_int64 (stmt, 0);
+    else if (rc != SQLITE_DONE) {
+        log_sqlite_error (ctx, "meta_get: executing stmt");
+        goto error;
+    }
+    sqlite3_finalize (stmt);
+    return rc == SQLITE_ROW ? 1 : 0;
+error:
+    set_errno_from_sqlite_error (ctx);
+    if (stmt)
+        ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    return -1;
+}
+
+static int meta_put (struct content_sqlite *ctx,
+                     const char *key,
+                     int64_t value)
+{
+    sqlite3_stmt *stmt = NULL;
+
+    if (sqlite3_prepare_v2 (ctx->db, sql_meta_put, -1, &stmt, NULL) != SQLITE_OK
+        || sqlite3_bind_text (stmt, 1, key, -1, SQLITE_STATIC) != SQLITE_OK
+        || sqlite3_bind_int64 (stmt, 2, value) != SQLITE_OK
+        || sqlite3_step (stmt) != SQLITE_DONE) {
+        log_sqlite_error (ctx, "meta_put: %s", key);
+        set_errno_from_sqlite_error (ctx);
+        if (stmt)
+            ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+        return -1;
+    }
+    sqlite3_finalize (stmt);
+    return 0;
+}
+
+/* Remove shard files 'first' and up, e.g. those left by a previous
+ * database with more shards than this one, and their sqlite journals.
+ */
+static int shards_remove_stale (struct content_sqlite *ctx, int first)
+{
+    const char *suffix[] = { "", "-wal", "-shm", "-journal" };
+    char path[PATH_MAX];
+
+    for (int i = first; ; i++) {
+        bool found = false;
+
+        for (int j = 0; j < ARRAY_SIZE (suffix); j++) {
+            if (snprintf (path,
+                          sizeof (path),
+                          "%s.%d%s",
+                          ctx->dbfile,
+                          i,
+                          suffix[j]) >= sizeof (path)) {
+                errno = ENAMETOOLONG;
+                return -1;
+            }
+            if (unlink (path) < 0) {
+                if (errno != ENOENT) {
+                    flux_log_error (ctx->h, "error removing %s", path);
+                    return -1;
+                }
+            }
+            else if (j == 0)
+                found = true;
+        }
+        if (!found)
+            break;
+        flux_log (ctx->h,
+                  LOG_INFO,
+                  "removed stale shard %s.%d",
+                  ctx->dbfile,
+                  i);
+    }
+    return 0;
+}
+
+/* The shard count is recorded in the main database when first used, and
+ * may not change afterwards, since blobs would then be looked up in the
+ * wrong shard.  Likewise, sharding cannot be enabled on a database that
+ * already holds objects.
+ */
+static int shards_check_config (struct content_sqlite *ctx, bool truncate)
+{
+    int64_t shards;
+    int64_t count;
+    char path[PATH_MAX];
+    int rc;
+
+    if ((rc = meta_get (ctx, "shards", &shards)) < 0)
+        return -1;
+    if (rc == 0) {
+        if (ctx->shard_count == 0)
+            return 0;
+        /* Shard files that the database does not record would be opened
+         * as this database's shards, resurrecting their objects.
+         */
+        snprintf (path, sizeof (path), "%s.0", ctx->dbfile);
+        if (!truncate && access (path, F_OK) == 0) {
+            flux_log (ctx->h,
+                      LOG_ERR,
+                      "%s does not belong to %s (remove it or truncate)",
+                      path,
+                      ctx->dbfile);
+            errno = EINVAL;
+            return -1;
+        }
+        if (sqlite3_exec (ctx->db,
+                          sql_objects_count,
+                          set_count,
+                          &count,
+                          NULL) != SQLITE_OK) {
+            log_sqlite_error (ctx, "querying objects count");
+            set_errno_from_sqlite_error (ctx);
+            return -1;
+        }
+        if (count > 0) {
+            flux_log (ctx->h,
+                      LOG_ERR,
+                      "shards cannot be enabled on a database"
+                      " that contains objects");
+            errno = EINVAL;
+            return -1;
+        }
+        return meta_put (ctx, "shards", ctx->shard_count);
+    }
+    if (shards != ctx->shard_count) {
+        flux_log (ctx->h,
+                  LOG_ERR,
+                  "shards=%d requested but database has shards=%jd",
+                  ctx->shard_count,
+                  (intmax_t)shards);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+static void shards_destroy (struct content_sqlite *ctx)
+{
+    if (ctx->shards) {
+        for (int i = 0; i < ctx->shard_count; i++)
+            shard_destroy (ctx->shards[i]);
+        free (ctx->shards);
+        ctx->shards = NULL;
+    }
+}
+
+static int shards_create (struct content_sqlite *ctx, bool truncate)
+{
+    /* Shards below shard_count are truncated by shard_create().
+     */
+    if (truncate && shards_remove_stale (ctx, ctx->shard_count) < 0)
+        return -1;
+    if (shards_check_config (ctx, truncate) < 0)
+        return -1;
+    if (ctx->shard_count == 0)
+        return 0;
+    if (!(ctx->shards = calloc (ctx->shard_count, sizeof (ctx->shards[0]))))
+        return -1;
+    for (int i = 0; i < ctx->shard_count; i++) {
+        if (!(ctx->shards[i] = shard_create (ctx, i, truncate)))
+            return -1;
+    }
+    flux_log (ctx->h,
+              LOG_DEBUG,
+              "objects sharded across %d databases",
+              ctx->shard_count);
+    return 0;
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     {
         FLUX_MSGTYPE_REQUEST,
@@ -1748,12 +4799,36 @@ static const struct flux_msg_handler_spec htab[] = {
         sweep_cb,
         0
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content-backing.sweep-start",
+        sweep_start_cb,
+        0
+    },
     {
         FLUX_MSGTYPE_REQUEST,
         "content-backing.gc-info",
         gc_info_cb,
         0
     },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content-backing.gc-index",
+        gc_index_cb,
+        0
+    },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content-backing.gc-pin",
+        gc_pin_cb,
+        0
+    },
+    {
+        FLUX_MSGTYPE_REQUEST,
+        "content-backing.gc-collect",
+        gc_collect_cb,
+        0
+    },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -1765,15 +4840,19 @@ static struct content_sqlite *content_sqlite_create (flux_t *h)
 
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
-    if (!(ctx->lzo_buf = calloc (1, lzo_buf_chunksize)))
+    if (!(ctx->compress_buf = calloc (1, compress_buf_chunksize)))
         goto error;
-    ctx->lzo_bufsize = lzo_buf_chunksize;
+    ctx->compress_bufsize = compress_buf_chunksize;
     ctx->h = h;
     if (set_config (&ctx->journal_mode, "WAL") < 0)
         goto error;
+    if (set_config (&ctx->codec_name, "lz4") < 0)
+        goto error;
     if (set_config (&ctx->synchronous, "NORMAL") < 0)
         goto error;
     ctx->max_checkpoints = MAX_CHECKPOINTS_DEFAULT;
+    if (!(ctx->sweep.requests = flux_msglist_create ()))
+        goto error;
 
     /* Some tunables:
      * - the hash function, e.g. sha1, sha256
@@ -1849,21 +4928,40 @@ static bool synchronous_valid (const char *s)
     return true;
 }
 
+static int set_codec (struct content_sqlite *ctx, const char *name)
+{
+    struct content_codec *codec;
+    flux_error_t error;
+
+    if (!(codec = content_codec_create (name, &error))) {
+        flux_log (ctx->h, LOG_ERR, "invalid codec: %s", error.text);
+        return -1;
+    }
+    content_codec_destroy (codec);
+    return set_config (&ctx->codec_name, name);
+}
+
 static int process_config (struct content_sqlite *ctx,
                            const flux_conf_t *conf)
 {
     flux_error_t error;
     const char *journal_mode = NULL;
     const char *synchronous = NULL;
+    const char *codec = NULL;
     int tmp_max_checkpoints = ctx->max_checkpoints;
+    int shards = ctx->shard_count;
+    int sweep_rate = ctx->sweep_rate;
 
     if (flux_conf_unpack (conf,
                           &error,
-                          "{s?{s?s s?s s?i}}",
+                          "{s?{s?s s?s s?i s?i s?s s?i}}",
                           "content-sqlite",
                             "journal_mode", &journal_mode,
                             "synchronous", &synchronous,
-                            "max_checkpoints", &tmp_max_checkpoints) < 0) {
+                            "max_checkpoints", &tmp_max_checkpoints,
+                            "shards", &shards,
+                            "codec", &codec,
+                            "sweep_rate", &sweep_rate) < 0) {
         flux_log_error (ctx->h, "%s", error.text);
         return -1;
     }
@@ -1891,6 +4989,20 @@ static int process_config (struct content_sqlite *ctx,
         return -1;
     }
     ctx->max_checkpoints = tmp_max_checkpoints;
+    if (shards < 0 || shards > SHARDS_MAX) {
+        flux_log (ctx->h, LOG_ERR, "invalid shards config");
+        errno = EINVAL;
+        return -1;
+    }
+    ctx->shard_count = shards;
+    if (codec && set_codec (ctx, codec) < 0)
+        return -1;
+    if (sweep_rate < 0) {
+        flux_log (ctx->h, LOG_ERR, "invalid sweep_rate config");
+        errno = EINVAL;
+        return -1;
+    }
+    ctx->sweep_rate = sweep_rate;
 
     return 0;
 }
@@ -1934,6 +5046,40 @@ static int process_args (struct content_sqlite *ctx,
             }
             ctx->max_checkpoints = tmp_max_checkpoints;
         }
+        else if (strstarts (argv[i], "shards=")) {
+            char *endptr;
+            long shards;
+            errno = 0;
+            shards = strtol (argv[i] + 7, &endptr, 10);
+            if (errno != 0
+                || *endptr != '\0'
+                || shards < 0
+                || shards > SHARDS_MAX) {
+                flux_log (ctx->h, LOG_ERR, "invalid shards specified");
+                errno = EINVAL;
+                return -1;
+            }
+            ctx->shard_count = shards;
+        }
+        else if (strstarts (argv[i], "sweep-rate=")) {
+            char *endptr;
+            long rate;
+            errno = 0;
+            rate = strtol (argv[i] + 11, &endptr, 10);
+            if (errno != 0
+                || *endptr != '\0'
+                || rate < 0
+                || rate > INT_MAX) {
+                flux_log (ctx->h, LOG_ERR, "invalid sweep-rate specified");
+                errno = EINVAL;
+                return -1;
+            }
+            ctx->sweep_rate = rate;
+        }
+        else if (strstarts (argv[i], "codec=")) {
+            if (set_codec (ctx, argv[i] + 6) < 0)
+                return -1;
+        }
         else if (streq ("truncate", argv[i])) {
             *truncate = true;
         }
@@ -1967,6 +5113,8 @@ int mod_main (flux_t *h, int argc, char **argv)
         || (exists
             && content_sqlite_checkpt_migrate (ctx) < 0))
         goto done;
+    if (shards_create (ctx, truncate) < 0)
+        goto done;
     if (content_register_service (h, "content-backing") < 0)
         goto done;
     if (content_register_backing_store (h, "content-sqlite") < 0)
@@ -1979,6 +5127,8 @@ int mod_main (flux_t *h, int argc, char **argv)
 done_unreg:
     (void)content_unregister_backing_store (h);
 done:
+    sweeper_stop (ctx);
+    shards_destroy (ctx);
     content_sqlite_closedb (ctx);
     content_sqlite_destroy (ctx);
     return rc;
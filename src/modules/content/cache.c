@@ -30,11 +30,25 @@
 #include "checkpoint.h"
 #include "mmap.h"
 
-/* A periodic callback purges the cache of least recently used entries.
- * The callback is synchronized with the instance heartbeat, with a
- * sync period upper bound set to 'sync_max' seconds.
+/* Valid, clean entries are kept on a segmented LRU.  An entry starts out
+ * in the probation segment and is promoted to the protected segment when
+ * it is looked up again.  The protected segment is limited to a share of
+ * purge_target_size, and its least recently used entries are demoted back
+ * to probation when it is over.  The purge evicts from probation first,
+ * so a burst of entries that are used once, like a large value read by a
+ * single 'flux kvs get', cannot push out the working set.  Entries larger
+ * than a fraction of the protected segment are never promoted, since one
+ * of them would displace many small ones.
+ *
+ * The purge runs from a prepare watcher whenever an entry is added while
+ * the cache is over purge_target_size, and from a periodic callback that
+ * is synchronized with the instance heartbeat, with a sync period upper
+ * bound set to 'sync_max' seconds.  The periodic callback catches entries
+ * that were too young to be purged when they were added.
  */
 static double sync_max = 10.;
+static const int lru_protected_percent = 80;
+static const int lru_protected_entry_divisor = 8;
 
 static const char *default_hash = "sha1";
 
@@ -72,6 +86,7 @@ struct cache_entry {
     uint8_t load_pending:1;
     uint8_t store_pending:1;
     uint8_t mmapped:1;
+    uint8_t lru_segment:2;          // LRU_NONE if not on the LRU
     struct msgstack *load_requests;
     struct msgstack *store_requests;
     double lastused;
@@ -79,6 +94,20 @@ struct cache_entry {
     struct list_node list;
 };
 
+enum {
+    LRU_NONE = 0,
+    LRU_PROBATION = 1,
+    LRU_PROTECTED = 2,
+};
+
+struct lru_segment {
+    struct list_head list;          // most recently used first
+    uint64_t size;
+    uint32_t count;
+    uint64_t hits;
+    uint64_t evictions;
+};
+
 struct content_cache {
     flux_t *h;
     flux_reactor_t *reactor;
@@ -91,7 +120,12 @@ struct content_cache {
     char *hash_name;
     struct msgstack *flush_requests;
 
-    struct list_head lru;           // LRU is for valid, clean entries only
+    struct lru_segment probation;   // LRU is for valid, clean entries only
+    struct lru_segment protected;
+    uint64_t lru_misses;
+    uint64_t lru_promotions;
+    uint64_t lru_demotions;
+    flux_watcher_t *purge_w;
     struct list_head flush;         // dirties queued due to batch limit
 
     uint32_t blob_size_limit;
@@ -105,6 +139,7 @@ struct content_cache {
     uint64_t acct_size;             // total size of all cache entries
     uint32_t acct_valid;            // count of valid cache entries
     uint32_t acct_dirty;            // count of dirty cache entries
+    uint64_t load_copy_bytes;       // bytes copied into load responses
 
     struct content_checkpoint *checkpoint;
     struct content_mmap *mmap;
@@ -112,6 +147,8 @@ struct content_cache {
 
 static void flush_respond (struct content_cache *cache);
 static int cache_flush (struct content_cache *cache);
+static void cache_entry_remove (struct content_cache *cache,
+                                struct cache_entry *e);
 
 static int msgstack_push (struct msgstack **msp, const flux_msg_t *msg)
 {
@@ -148,8 +185,9 @@ static void msgstack_destroy (struct msgstack **msp)
 /* Respond identically to a list of requests.
  * The list is always run to completion.
  * On error, log at LOG_ERR level.
+ * Return the number of responses whose payload was filled in.
  */
-static void request_list_respond_raw (struct msgstack **l,
+static int request_list_respond_raw (struct msgstack **l,
                                       flux_t *h,
                                       int flag,
                                       const void *data,
@@ -157,16 +195,22 @@ static void request_list_respond_raw (struct msgstack **l,
                                       const char *type)
 {
     const flux_msg_t *msg;
+    int count = 0;
     while ((msg = msgstack_pop (l))) {
         flux_msg_t *response;
         if (!(response = flux_response_derive (msg, 0))
-            || flux_msg_set_payload (response, data, len) < 0
-            || flux_msg_set_flag (response, flag) < 0
-            || flux_send (h, response, 0) < 0)
+            || flux_msg_set_payload (response, data, len) < 0)
             flux_log_error (h, "%s (%s):", __FUNCTION__, type);
+        else {
+            count++;
+            if (flux_msg_set_flag (response, flag) < 0
+                || flux_send (h, response, 0) < 0)
+                flux_log_error (h, "%s (%s):", __FUNCTION__, type);
+        }
         flux_msg_decref (response);
         flux_msg_decref (msg);
     }
+    return count;
 }
 
 /* Same as above only send errnum, errmsg response
@@ -240,6 +284,91 @@ static struct cache_entry *cache_entry_create (const void *hash)
     return e;
 }
 
+static struct lru_segment *lru_segment (struct content_cache *cache,
+                                        struct cache_entry *e)
+{
+    switch (e->lru_segment) {
+        case LRU_PROBATION:
+            return &cache->probation;
+        case LRU_PROTECTED:
+            return &cache->protected;
+    }
+    return NULL;
+}
+
+static void lru_segment_add (struct content_cache *cache,
+                             struct cache_entry *e,
+                             int segment)
+{
+    struct lru_segment *seg;
+
+    e->lru_segment = segment;
+    seg = lru_segment (cache, e);
+    list_add (&seg->list, &e->list);
+    seg->size += e->len;
+    seg->count++;
+}
+
+/* Take entry off the LRU, if it is on it.
+ */
+static void lru_remove (struct content_cache *cache, struct cache_entry *e)
+{
+    struct lru_segment *seg;
+
+    if ((seg = lru_segment (cache, e))) {
+        list_del_from (&seg->list, &e->list);
+        seg->size -= e->len;
+        seg->count--;
+        e->lru_segment = LRU_NONE;
+    }
+}
+
+static uint64_t lru_protected_limit (struct content_cache *cache)
+{
+    return (uint64_t)cache->purge_target_size * lru_protected_percent / 100;
+}
+
+/* Add a newly valid, clean entry to the probation segment, and arrange
+ * for a purge if the cache has grown past its target size.
+ */
+static void lru_add (struct content_cache *cache, struct cache_entry *e)
+{
+    lru_segment_add (cache, e, LRU_PROBATION);
+    e->lastused = flux_reactor_now (cache->reactor);
+    if (cache->acct_size > cache->purge_target_size)
+        flux_watcher_start (cache->purge_w);
+}
+
+/* Entry was used again.  Promote it from probation, or move it to the
+ * front of the protected segment.  Demote the least recently used
+ * protected entries if that puts the segment over its limit.
+ */
+static void lru_touch (struct content_cache *cache, struct cache_entry *e)
+{
+    uint64_t limit = lru_protected_limit (cache);
+    int segment = e->lru_segment;
+
+    lru_remove (cache, e);
+    if (segment == LRU_PROBATION
+        && e->len > limit / lru_protected_entry_divisor)
+        lru_segment_add (cache, e, LRU_PROBATION);
+    else {
+        if (segment == LRU_PROBATION)
+            cache->lru_promotions++;
+        lru_segment_add (cache, e, LRU_PROTECTED);
+    }
+    e->lastused = flux_reactor_now (cache->reactor);
+
+    while (cache->protected.size > limit) {
+        struct cache_entry *victim;
+
+        victim = list_tail (&cache->protected.list, struct cache_entry, list);
+        lru_remove (cache, victim);
+        lru_segment_add (cache, victim, LRU_PROBATION);
+        cache->lru_demotions++;
+    }
+}
+
 static void cache_entry_dirty_clear (struct content_cache *cache,
                                      struct cache_entry *e)
 {
@@ -248,8 +377,7 @@ static void cache_entry_dirty_clear (struct content_cache *cache,
         e->dirty = 0;
 
         assert (e->valid);
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
+        lru_add (cache, e);
 
         request_list_respond_raw (&e->store_requests,
                                   cache->h,
@@ -284,8 +412,22 @@ static struct cache_entry *cache_entry_insert (struct content_cache *cache,
     return e;
 }
 
-/* Look up a cache entry.
- * Move to front of LRU because it was looked up.
+/* Find a cache entry without counting it as used.
+ * Returns entry on success, NULL on failure.
+ * N.B. errno is not set
+ */
+static struct cache_entry *cache_entry_find (struct content_cache *cache,
+                                             const void *hash,
+                                             int hash_size)
+{
+    if (hash_size != content_hash_size)
+        return NULL;
+    return zhashx_lookup (cache->entries, hash);
+}
+
+/* Look up a cache entry to load it.
+ * Count a hit in the LRU segment it was found in, or a miss if it was not
+ * found or not valid, then promote it because it was looked up.
  * Returns entry on success, NULL on failure.
  * N.B. errno is not set
  */
@@ -294,18 +436,16 @@ static struct cache_entry *cache_entry_lookup (struct content_cache *cache,
                                                int hash_size)
 {
     struct cache_entry *e;
+    struct lru_segment *seg;
 
-    if (hash_size != content_hash_size)
-        return NULL;
-    if (!(e = zhashx_lookup (cache->entries, hash)))
-        return NULL;
-
-    if (e->valid && !e->dirty) {
-        list_del_from (&cache->lru, &e->list);
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
+    if (!(e = cache_entry_find (cache, hash, hash_size)) || !e->valid) {
+        cache->lru_misses++;
+        return e;
+    }
+    if ((seg = lru_segment (cache, e))) {
+        seg->hits++;
+        lru_touch (cache, e);
     }
-
     return e;
 }
 
@@ -317,7 +457,10 @@ static void cache_entry_remove (struct content_cache *cache,
     assert (e->load_requests == NULL);
     assert (e->store_requests == NULL);
     assert (!e->dirty);
-    list_del (&e->list);
+    if (e->lru_segment != LRU_NONE)
+        lru_remove (cache, e);
+    else
+        list_del (&e->list);
     if (e->valid) {
         cache->acct_size -= e->len;
         cache->acct_valid--;
@@ -342,6 +485,7 @@ static void cache_load_continuation (flux_future_t *f, void *arg)
     struct cache_entry *e = flux_future_aux_get (f, "entry");
     const flux_msg_t *msg;
     const char *errmsg = NULL;
+    int count;
 
     e->load_pending = 0;
     if (flux_future_get (f, (const void **)&msg) < 0) {
@@ -369,14 +513,14 @@ static void cache_load_continuation (flux_future_t *f, void *arg)
             e->ephemeral = 1;
         cache->acct_valid++;
         cache->acct_size += e->len;
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
-        request_list_respond_raw (&e->load_requests,
-                                  cache->h,
-                                  e->ephemeral ? FLUX_MSGFLAG_USER1 : 0,
-                                  e->data,
-                                  e->len,
-                                  "load");
+        lru_add (cache, e);
+        count = request_list_respond_raw (&e->load_requests,
+                                          cache->h,
+                                          e->ephemeral ? FLUX_MSGFLAG_USER1 : 0,
+                                          e->data,
+                                          e->len,
+                                          "load");
+        cache->load_copy_bytes += (uint64_t)count * e->len;
     }
     flux_future_destroy (f);
     return;
@@ -456,8 +600,7 @@ static void content_load_request (flux_t *h,
             e->mmapped = 1;
             cache->acct_valid++;
             cache->acct_size += e->len;
-            list_add (&cache->lru, &e->list);
-            e->lastused = flux_reactor_now (cache->reactor);
+            lru_add (cache, e);
         }
     }
     if (!e->valid) {
@@ -492,6 +635,8 @@ static void content_load_request (flux_t *h,
         || flux_send (h, response, 0) < 0) {
         flux_log_error (h, "content load: error sending response");
     }
+    else
+        cache->load_copy_bytes += e->len;
     flux_msg_decref (response);
     return;
 error:
@@ -634,6 +779,7 @@ static void content_store_request (flux_t *h,
     struct cache_entry *e = NULL;
     uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
     int hash_size;
+    int count;
 
     if (flux_request_decode_raw (msg, NULL, &data, &len) < 0)
         goto error;
@@ -651,7 +797,7 @@ static void content_store_request (flux_t *h,
      * replaced with a new entry.  N.B. it can be assumed that an entry with
      * the ephemeral bit set is valid and not dirty.
      */
-    if ((e = cache_entry_lookup (cache, hash, hash_size))
+    if ((e = cache_entry_find (cache, hash, hash_size))
         && e->ephemeral) {
         cache_entry_remove (cache, e);
         e = NULL;
@@ -675,19 +821,20 @@ static void content_store_request (flux_t *h,
         cache->acct_valid++;
         cache->acct_size += e->len;
         cache->acct_dirty++;
-        request_list_respond_raw (&e->load_requests,
-                                  cache->h,
-                                  0,
-                                  e->data,
-                                  e->len,
-                                  "load");
+        count = request_list_respond_raw (&e->load_requests,
+                                          cache->h,
+                                          0,
+                                          e->data,
+                                          e->len,
+                                          "load");
+        cache->load_copy_bytes += (uint64_t)count * e->len;
     }
     /* If entry was already valid (dedup case), mark it dirty to ensure
      * it eventually reaches backing store.  This supports online GC by
      * ensuring all referenced blobs are eventually persisted.
      */
     else if (!e->dirty) {
-        list_del (&e->list);  // remove from LRU
+        lru_remove (cache, e);
         e->dirty = 1;
         cache->acct_dirty++;
     }
@@ -842,6 +989,17 @@ error:
  * valid and clean.
  */
 
+static void lru_segment_drop (struct content_cache *cache,
+                              struct lru_segment *seg)
+{
+    struct cache_entry *e = NULL;
+    struct cache_entry *next;
+
+    list_for_each_safe (&seg->list, e, next, list) {
+        cache_entry_remove (cache, e);
+    }
+}
+
 static void content_dropcache_request (flux_t *h,
                                        flux_msg_handler_t *mh,
                                        const flux_msg_t *msg,
@@ -849,14 +1007,11 @@ static void content_dropcache_request (flux_t *h,
 {
     struct content_cache *cache = arg;
     int orig_size;
-    struct cache_entry *e = NULL;
-    struct cache_entry *next;
 
     orig_size = zhashx_size (cache->entries);
 
-    list_for_each_safe (&cache->lru, e, next, list) {
-        cache_entry_remove (cache, e);
-    }
+    lru_segment_drop (cache, &cache->probation);
+    lru_segment_drop (cache, &cache->protected);
 
     flux_log (h, LOG_DEBUG, "content dropcache %d/%d",
               orig_size - (int)zhashx_size (cache->entries), orig_size);
@@ -874,17 +1029,43 @@ static void content_stats_request (flux_t *h,
 {
     struct content_cache *cache = arg;
     json_t *o = content_mmap_get_stats (cache->mmap);
-
+    json_t *lru;
+
+    if (!(lru = json_pack ("{s:{s:i s:I s:I s:I} s:{s:i s:I s:I s:I}"
+                           " s:I s:I s:I}",
+                           "probation",
+                             "count", cache->probation.count,
+                             "size", (json_int_t)cache->probation.size,
+                             "hits", (json_int_t)cache->probation.hits,
+                             "evictions",
+                               (json_int_t)cache->probation.evictions,
+                           "protected",
+                             "count", cache->protected.count,
+                             "size", (json_int_t)cache->protected.size,
+                             "hits", (json_int_t)cache->protected.hits,
+                             "evictions",
+                               (json_int_t)cache->protected.evictions,
+                           "misses", (json_int_t)cache->lru_misses,
+                           "promotions", (json_int_t)cache->lru_promotions,
+                           "demotions", (json_int_t)cache->lru_demotions))) {
+        if (flux_respond_error (h, msg, ENOMEM, NULL) < 0)
+            flux_log_error (h, "content stats");
+        json_decref (o);
+        return;
+    }
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:i s:i s:I s:i s:O}",
+                           "{s:i s:i s:i s:I s:i s:I s:O s:O}",
                            "count", zhashx_size (cache->entries),
                            "valid", cache->acct_valid,
                            "dirty", cache->acct_dirty,
                            "size", cache->acct_size,
                            "flush-batch-count", cache->flush_batch_count,
-                           "mmap", o ? o : json_null ()) < 0)
+                           "load-copy-bytes", (json_int_t)cache->load_copy_bytes,
+                           "mmap", o ? o : json_null (),
+                           "lru", lru) < 0)
         flux_log_error (h, "content stats");
+    json_decref (lru);
     json_decref (o);
 }
 
@@ -953,25 +1134,51 @@ error:
         flux_log_error (h, "error responding to content flush");
 }
 
-/* Heartbeat drives periodic cache purge
+/* Purge drops least recently used entries that are at least
+ * purge_old_entry seconds old until the cache is at purge_target_size,
+ * from the probation segment first.
  */
 
-static void cache_purge (struct content_cache *cache)
+static void lru_segment_purge (struct content_cache *cache,
+                               struct lru_segment *seg,
+                               double now)
 {
-    double now = flux_reactor_now (cache->reactor);
     struct cache_entry *e = NULL;
     struct cache_entry *next;
 
-    list_for_each_rev_safe (&cache->lru, e, next, list) {
+    list_for_each_rev_safe (&seg->list, e, next, list) {
         if (cache->acct_size <= cache->purge_target_size
             || now - e->lastused < cache->purge_old_entry)
             break;
         assert (e->valid);
         assert (!e->dirty);
         cache_entry_remove (cache, e);
+        seg->evictions++;
     }
 }
 
+static void cache_purge (struct content_cache *cache)
+{
+    double now = flux_reactor_now (cache->reactor);
+
+    lru_segment_purge (cache, &cache->probation, now);
+    lru_segment_purge (cache, &cache->protected, now);
+}
+
+/* An entry was added with the cache over its target size.  Purge once
+ * the current batch of messages has been handled.
+ */
+static void purge_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct content_cache *cache = arg;
+
+    flux_watcher_stop (w);
+    cache_purge (cache);
+}
+
 static void update_stats (struct content_cache *cache)
 {
     flux_stats_gauge_set (cache->h, "content-cache.count",
@@ -1130,6 +1337,7 @@ void content_cache_destroy (struct content_cache *cache)
     if (cache) {
         int saved_errno = errno;
         flux_future_destroy (cache->f_sync);
+        flux_watcher_destroy (cache->purge_w);
         flux_msg_handler_delvec (cache->handlers);
         free (cache->backing_name);
         zhashx_destroy (&cache->entries);
@@ -1173,8 +1381,13 @@ struct content_cache *content_cache_create (flux_t *h, int argc, char **argv)
     if (get_hash_name (cache) < 0)
         goto error;
 
-    list_head_init (&cache->lru);
+    list_head_init (&cache->probation.list);
+    list_head_init (&cache->protected.list);
     list_head_init (&cache->flush);
+    if (!(cache->purge_w = flux_prepare_watcher_create (cache->reactor,
+                                                        purge_cb,
+                                                        cache)))
+        goto error;
 
     if (flux_get_rank (h, &cache->rank) < 0)
         goto error;
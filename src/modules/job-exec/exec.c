@@ -250,31 +250,75 @@ static void barrier_timer_start (struct exec_ctx *ctx)
 }
 
 
+/*  Parse the ranks entering the barrier from 'msg'.  A shell enters with
+ *   its own "rank".  A tree launch relays a batch of shells with "ranks".
+ */
+static struct idset *barrier_enter_ranks (const flux_msg_t *msg)
+{
+    struct idset *ids;
+    const char *ranks = NULL;
+    int rank = -1;
+
+    if (flux_msg_unpack (msg,
+                         "{s?i s?s}",
+                         "rank", &rank,
+                         "ranks", &ranks) < 0)
+        return NULL;
+    if (ranks)
+        return idset_decode (ranks);
+    if (rank < 0) {
+        errno = EPROTO;
+        return NULL;
+    }
+    if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || idset_set (ids, rank) < 0) {
+        idset_destroy (ids);
+        return NULL;
+    }
+    return ids;
+}
+
 static int exec_barrier_enter (struct bulk_exec *exec, const flux_msg_t *msg)
 {
     struct exec_ctx *ctx = bulk_exec_aux_get (exec, "ctx");
-    int rank;
+    struct idset *ranks;
+    struct idset *extra;
+    size_t count;
 
     if (!ctx)
         return -1;
 
-    if (flux_msg_unpack (msg, "{s:i}", "rank", &rank) < 0)
+    if (!(ranks = barrier_enter_ranks (msg)))
         return -1;
-    /*  Reject a request whose rank is out of range or not pending
+    /*  Reject a request whose ranks are not all pending
      *  to avoid corrupting barrier accounting.
      */
-    if (rank < 0 || !idset_test (ctx->barrier_pending_ranks, rank)) {
+    if (!(extra = idset_difference (ranks, ctx->barrier_pending_ranks))) {
+        idset_destroy (ranks);
+        return -1;
+    }
+    if (!idset_empty (extra) || idset_empty (ranks)) {
         flux_error_t error;
-        errprintf (&error, "rank %d is not pending in barrier", rank);
+        char *s = idset_encode (idset_empty (extra) ? ranks : extra,
+                                IDSET_FLAG_RANGE);
+        errprintf (&error,
+                   "rank %s is not pending in barrier",
+                   s ? s : "(unknown)");
         if (shell_barrier_respond_error (ctx->job->h,
                                          msg,
                                          EINVAL,
                                          error.text) < 0)
             flux_log_error (ctx->job->h, "shell-barrier: error responding");
+        free (s);
+        idset_destroy (extra);
+        idset_destroy (ranks);
         return 0;
     }
-    (void) idset_clear (ctx->barrier_pending_ranks, rank);
-    ctx->barrier_enter_count++;
+    count = idset_count (ranks);
+    (void) idset_subtract (ctx->barrier_pending_ranks, ranks);
+    ctx->barrier_enter_count += count;
+    idset_destroy (extra);
+    idset_destroy (ranks);
 
     /*
      *  Terminate barrier with error immediately when a shell enters after
@@ -308,7 +352,7 @@ static int exec_barrier_enter (struct bulk_exec *exec, const flux_msg_t *msg)
      *   which the job will be terminated if all shells have not reached
      *   the barrier.
      */
-    else if (ctx->barrier_enter_count == 1)
+    else if (ctx->barrier_enter_count == count)
         barrier_timer_start (ctx);
 
     return 0;
@@ -918,6 +962,21 @@ static int exec_init (struct jobinfo *job)
         flux_log_error (job->h, "exec_init: bulk_exec_create");
         goto err;
     }
+    /* Large jobs on the rexec service are launched down the TBON with
+     * one request rather than one request per rank.  Shell barrier entries
+     * are then reduced on the way back up the tree.
+     */
+    if (streq (service, "rexec")
+        && config_get_tree_launch_threshold () > 0
+        && idset_count (ranks) >= config_get_tree_launch_threshold ()) {
+        if (bulk_exec_set_tree_launch (exec, true) < 0
+            || bulk_exec_set_tree_barrier (exec,
+                                           "job-exec.shell-barrier",
+                                           job->userid) < 0) {
+            flux_log_error (job->h, "exec_init: bulk_exec_set_tree_launch");
+            goto err;
+        }
+    }
     if (!(ctx = exec_ctx_create (job, ranks, &error))) {
         flux_log (job->h, LOG_ERR, "exec_ctx_create: %s", error.text);
         goto err;
@@ -44,6 +44,7 @@ struct exec_config {
     int sdexec_constrain_resources;
     double default_barrier_timeout;
     double shell_exit_timeout;  /* <=0 means disabled */
+    int tree_launch_threshold;  /* <=0 means disabled */
 };
 
 /* Global configs initialized in config_init() */
@@ -139,11 +140,16 @@ double config_get_shell_exit_timeout (void)
     return exec_conf.shell_exit_timeout;
 }
 
+int config_get_tree_launch_threshold (void)
+{
+    return exec_conf.tree_launch_threshold;
+}
+
 int config_get_stats (json_t **config_stats)
 {
     json_t *o = NULL;
 
-    if (!(o = json_pack ("{s:s? s:s? s:s? s:s? s:i s:f s:f s:i s:i s:i}",
+    if (!(o = json_pack ("{s:s? s:s? s:s? s:s? s:i s:f s:f s:i s:i s:i s:i}",
                          "default_cwd", default_cwd,
                          "default_job_shell", exec_conf.default_job_shell,
                          "flux_imp_path", exec_conf.flux_imp_path,
@@ -159,7 +165,9 @@ int config_get_stats (json_t **config_stats)
                          "sdexec_stop_timer_signal",
                          exec_conf.sdexec_stop_timer_signal,
                          "sdexec_constrain_resources",
-                         exec_conf.sdexec_constrain_resources))) {
+                         exec_conf.sdexec_constrain_resources,
+                         "tree_launch_threshold",
+                         exec_conf.tree_launch_threshold))) {
         errno = ENOMEM;
         return -1;
     }
@@ -193,6 +201,7 @@ static void exec_config_init (struct exec_config *ec)
     ec->sdexec_constrain_resources = 0;
     ec->default_barrier_timeout = 1800.;
     ec->shell_exit_timeout = DEFAULT_SHELL_EXIT_TIMEOUT;
+    ec->tree_launch_threshold = 0;
 }
 
 /*  Initialize configurations for use by job-exec bulk-exec
@@ -363,6 +372,20 @@ int config_setup (flux_t *h,
         }
     }
 
+    /*  Check configuration for exec.tree-launch-threshold */
+    if (flux_conf_unpack (conf,
+                          &err,
+                          "{s?{s?i}}",
+                          "exec",
+                            "tree-launch-threshold",
+                              &tmpconf.tree_launch_threshold) < 0) {
+        errprintf (errp,
+                   "error reading config value"
+                   " exec.tree-launch-threshold: %s",
+                   err.text);
+        return -1;
+    }
+
     if (argv && argc) {
         /* Finally, override values on cmdline */
         for (int i = 0; i < argc; i++) {
@@ -19,6 +19,8 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libjob/job.h"
+#include "src/common/libeventlog/eventlog.h"
+#include "src/common/libioencode/iochunk.h"
 #include "ccan/str/str.h"
 
 #include "job-info.h"
@@ -261,6 +263,60 @@ static void send_initial_sentinel (struct watch_ctx *w)
     }
 }
 
+/* Binary job output (shell output.binary option) is appended to
+ * guest.output-data as iochunk records instead of to the output eventlog.
+ */
+static bool is_output_data (struct watch_ctx *w)
+{
+    if (w->guest)
+        return streq (w->path, "output-data");
+    if (w->guest_in_main)
+        return streq (w->path, "guest.output-data");
+    return false;
+}
+
+/* Respond with one RFC 24 data event per iochunk record in 'buf',
+ * so readers of output-data see the same entries as in the output
+ * eventlog.  Return -1 with errno set on malformed data, or -2 if a
+ * response could not be sent.
+ */
+static int respond_output_data (struct watch_ctx *w,
+                                const void *buf,
+                                size_t size)
+{
+    struct iochunk_record rec;
+    ssize_t n;
+
+    while (size > 0) {
+        json_t *context = NULL;
+        json_t *entry = NULL;
+        char *s = NULL;
+        int rc;
+
+        if ((n = iochunk_decode (buf, size, &rec)) < 0)
+            return -1;
+        if (!(context = iochunk_ioencode (&rec))
+            || !(entry = eventlog_entry_pack (rec.timestamp,
+                                              "data",
+                                              "O",
+                                              context))
+            || !(s = eventlog_entry_encode (entry))) {
+            json_decref (context);
+            json_decref (entry);
+            return -1;
+        }
+        rc = flux_respond_pack (w->ctx->h, w->msg, "{s:s}", "event", s);
+        json_decref (context);
+        json_decref (entry);
+        free (s);
+        if (rc < 0)
+            return -2;
+        buf = (const char *)buf + n;
+        size -= n;
+    }
+    return 0;
+}
+
 static void watch_continuation (flux_future_t *f, void *arg)
 {
     struct watch_ctx *w = arg;
@@ -328,6 +384,32 @@ static void watch_continuation (flux_future_t *f, void *arg)
         goto out;
     }
 
+    if (is_output_data (w)) {
+        const void *buf;
+        size_t size;
+        int rc;
+
+        if (flux_kvs_lookup_get_raw (f, &buf, &size) < 0)
+            goto error;
+        if ((rc = respond_output_data (w, buf, size)) == -2) {
+            flux_log_error (ctx->h,
+                            "%s: flux_respond_pack",
+                            __FUNCTION__);
+            if (!w->kvs_watch_canceled) {
+                if (flux_kvs_lookup_cancel (w->watch_f) < 0)
+                    flux_log_error (ctx->h,
+                                    "%s: flux_kvs_lookup_cancel",
+                                    __FUNCTION__);
+            }
+            goto cleanup;
+        }
+        if (rc < 0) {
+            errmsg = "error decoding output data";
+            goto error;
+        }
+        goto out;
+    }
+
     input = s;
     while (get_next_eventlog_entry (&input, &tok, &toklen)) {
         if (flux_respond_pack (ctx->h,
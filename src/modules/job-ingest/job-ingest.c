@@ -696,7 +696,8 @@ static int job_ingest_configure (struct job_ingest_ctx *ctx,
     for (int i = 0; i < argc; i++) {
         if (strstarts (argv[i], "validator-args=")
             || strstarts (argv[i], "validator-plugins=")
-            || streq (argv[i], "disable-validator")) {
+            || streq (argv[i], "disable-validator")
+            || streq (argv[i], "disable-native-validator")) {
             /* handled in pipeline.c */
         }
         else if (strstarts (argv[i], "batch-count=")) {
@@ -22,12 +22,14 @@
 
 #include "util.h"
 #include "workcrew.h"
+#include "validator.h"
 #include "pipeline.h"
 
 struct pipeline {
     flux_t *h;
     struct workcrew *validate;
     struct workcrew *frobnicate;
+    struct validator *native;
     int process_count;
     flux_watcher_t *shutdown_timer;
     bool validator_bypass;
@@ -88,6 +90,13 @@ static bool validator_bypass (struct pipeline *pl, struct job *job)
     return false;
 }
 
+/* Return true if the job needs no further validation.
+ */
+static bool validator_done (struct pipeline *pl, struct job *job)
+{
+    return validator_bypass (pl, job) || validator_accept (pl->native, job);
+}
+
 static flux_future_t *validate_job (struct pipeline *pl,
                                     struct job *job,
                                     flux_error_t *error)
@@ -150,7 +159,7 @@ static void frobnicate_continuation (flux_future_t *f1, void *arg)
     json_decref (job->jobspec);
     job->jobspec = jobspec;
 
-    if (!validator_bypass (pl, job)) {
+    if (!validator_done (pl, job)) {
         flux_future_t *f2;
 
         if (!(f2 = validate_job (pl, job, &error))) {
@@ -173,7 +182,8 @@ done:
 /* N.B. this function could be a little simpler if futures for the pipeline
  * stages were unconditionally chained;  instead, minimize overhead for:
  * - frobnicator not configured
- * - frobnicator not configured AND validator bypassed
+ * - frobnicator not configured AND validator bypassed or the job was
+ *   accepted by the native validator
  */
 int pipeline_process_job (struct pipeline *pl,
                           struct job *job,
@@ -197,7 +207,7 @@ int pipeline_process_job (struct pipeline *pl,
     else {
         flux_future_t *f;
 
-        if (validator_bypass (pl, job))
+        if (validator_done (pl, job))
             *fp = NULL;
         else {
             if (!(f = validate_job (pl, job, error)))
@@ -280,6 +290,7 @@ int pipeline_configure (struct pipeline *pl,
     char *frobnicator_plugins = NULL;
     char *frobnicator_args = NULL;
     bool frobnicator_bypass = false;
+    int native = 1;
     int rc = -1;
 
     /* Process toml
@@ -293,6 +304,17 @@ int pipeline_configure (struct pipeline *pl,
                    conf_error.text);
         return -1;
     }
+    if (flux_conf_unpack (conf,
+                          &conf_error,
+                          "{s?{s?{s?b}}}",
+                          "ingest",
+                            "validator",
+                              "native", &native) < 0) {
+        errprintf (error,
+                   "error parsing [ingest.validator] config table: %s",
+                   conf_error.text);
+        return -1;
+    }
     if (unpack_ingest_subtable (ingest,
                                 "validator",
                                 &validator_plugins,
@@ -321,6 +343,8 @@ int pipeline_configure (struct pipeline *pl,
         }
         else if (streq (argv[i], "disable-validator"))
             pl->validator_bypass = true;
+        else if (streq (argv[i], "disable-native-validator"))
+            native = 0;
     }
 
     /* Enable the frobnicator if not bypassed AND either explicitly configured
@@ -374,6 +398,14 @@ int pipeline_configure (struct pipeline *pl,
                    strerror (errno));
         goto error;
     }
+    validator_configure (pl->native,
+                         validator_plugins,
+                         validator_args,
+                         native ? true : false);
+    flux_log (pl->h,
+              LOG_DEBUG,
+              "native validator %s",
+              validator_enabled (pl->native) ? "enabled" : "disabled");
     rc = 0;
 error:
     ERRNO_SAFE_WRAP (free, validator_plugins);
@@ -389,11 +421,14 @@ json_t *pipeline_stats_get (struct pipeline *pl)
     if (pl) {
         json_t *fo = workcrew_stats_get (pl->frobnicate);
         json_t *vo = workcrew_stats_get (pl->validate);
-        o = json_pack ("{s:O s:O}",
+        json_t *no = validator_stats_get (pl->native);
+        o = json_pack ("{s:O s:O s:O}",
                        "frobnicator", fo,
-                       "validator", vo);
+                       "validator", vo,
+                       "native-validator", no);
         json_decref (fo);
         json_decref (vo);
+        json_decref (no);
     }
     return o ? o : json_null ();
 }
@@ -404,6 +439,7 @@ void pipeline_destroy (struct pipeline *pl)
         int saved_errno = errno;
         workcrew_destroy (pl->validate);
         workcrew_destroy (pl->frobnicate);
+        validator_destroy (pl->native);
         flux_watcher_destroy (pl->shutdown_timer);
         free (pl);
         errno = saved_errno;
@@ -438,6 +474,9 @@ struct pipeline *pipeline_create (flux_t *h)
                                NULL,
                                NULL) < 0)
         goto error;
+    if (!(pl->native = validator_create (pl->h)))
+        goto error;
+    validator_configure (pl->native, NULL, NULL, true);
     return pl;
 error:
     pipeline_destroy (pl);
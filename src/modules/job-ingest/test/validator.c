@@ -0,0 +1,222 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libutil/unlink_recursive.h"
+#include "ccan/str/str.h"
+
+#include "validator.h"
+
+static const char *jobspec_valid =
+"{\"resources\":[{\"type\":\"slot\",\"count\":1,\"label\":\"task\","
+  "\"with\":[{\"type\":\"core\",\"count\":1}]}],"
+ "\"tasks\":[{\"command\":[\"true\"],\"slot\":\"task\","
+  "\"count\":{\"per_slot\":1}}],"
+ "\"attributes\":{\"system\":{\"duration\":0}},"
+ "\"version\":1}";
+
+static bool accept_jobspec (struct validator *v, json_t *jobspec)
+{
+    struct job job = { .jobspec = jobspec };
+    return validator_accept (v, &job);
+}
+
+static json_t *jobspec_create (void)
+{
+    json_t *o;
+
+    if (!(o = json_loads (jobspec_valid, 0, NULL)))
+        BAIL_OUT ("could not decode test jobspec");
+    return o;
+}
+
+static json_t *jobspec_with_constraints (const char *s)
+{
+    json_t *o = jobspec_create ();
+    json_t *system = json_object_get (json_object_get (o, "attributes"),
+                                      "system");
+    json_t *c;
+
+    if (!(c = json_loads (s, 0, NULL))
+        || json_object_set_new (system, "constraints", c) < 0)
+        BAIL_OUT ("could not add constraints to test jobspec");
+    return o;
+}
+
+void test_configure (void)
+{
+    struct validator *v;
+    char tmpdir[] = "/tmp/validator-test.XXXXXX";
+    char path[256];
+    FILE *fp;
+
+    if (!(v = validator_create (NULL)))
+        BAIL_OUT ("validator_create failed");
+
+    validator_configure (v, NULL, NULL, true);
+    ok (validator_enabled (v) == true,
+        "native validator is enabled by default");
+    validator_configure (v, NULL, NULL, false);
+    ok (validator_enabled (v) == false,
+        "native validator can be disabled");
+    validator_configure (v, "jobspec", "--require-version=1", true);
+    ok (validator_enabled (v) == true,
+        "native validator is enabled with --require-version=1");
+    validator_configure (v, "jobspec", "--require-version,any", true);
+    ok (validator_enabled (v) == true,
+        "native validator is enabled with --require-version any");
+    validator_configure (v, "jobspec", "--require-version", true);
+    ok (validator_enabled (v) == false,
+        "native validator is disabled with missing --require-version value");
+    validator_configure (v, "jobspec", "--require-version=2", true);
+    ok (validator_enabled (v) == false,
+        "native validator is disabled with --require-version=2");
+    validator_configure (v, "jobspec,feasibility", NULL, true);
+    ok (validator_enabled (v) == false,
+        "native validator is disabled with a non-native plugin");
+    validator_configure (v, NULL, "--require-instance-minnodes=2", true);
+    ok (validator_enabled (v) == false,
+        "native validator is disabled with a non-native argument");
+
+    if (!mkdtemp (tmpdir))
+        BAIL_OUT ("mkdtemp failed");
+    snprintf (path, sizeof (path), "%s/plugin.py", tmpdir);
+    if (!(fp = fopen (path, "w")) || fclose (fp) != 0)
+        BAIL_OUT ("could not create %s", path);
+    setenv ("FLUX_CLI_PLUGINPATH_OVERRIDE", tmpdir, 1);
+    validator_configure (v, NULL, NULL, true);
+    ok (validator_enabled (v) == false,
+        "native validator is disabled when CLI plugins are present");
+    setenv ("FLUX_CLI_PLUGINPATH_OVERRIDE", "", 1);
+    validator_configure (v, NULL, NULL, true);
+    ok (validator_enabled (v) == true,
+        "native validator is enabled when CLI plugin path is empty");
+    unlink_recursive (tmpdir);
+
+    validator_destroy (v);
+}
+
+void test_accept (void)
+{
+    struct validator *v;
+    json_t *o;
+    json_t *stats;
+    json_int_t accepted = -1;
+    json_int_t deferred = -1;
+
+    if (!(v = validator_create (NULL)))
+        BAIL_OUT ("validator_create failed");
+
+    o = jobspec_create ();
+    ok (accept_jobspec (v, o) == false,
+        "unconfigured validator does not accept jobs");
+    validator_configure (v, NULL, NULL, true);
+    ok (accept_jobspec (v, o) == true,
+        "valid jobspec is accepted");
+    json_object_del (json_object_get (json_object_get (o, "attributes"),
+                                      "system"),
+                     "duration");
+    ok (accept_jobspec (v, o) == false,
+        "jobspec without duration is not accepted");
+    json_decref (o);
+
+    o = jobspec_create ();
+    json_object_set_new (o, "version", json_integer (2));
+    ok (accept_jobspec (v, o) == false,
+        "version 2 jobspec is not accepted");
+    json_decref (o);
+
+    o = jobspec_create ();
+    json_object_set_new (json_array_get (json_object_get (o, "resources"), 0),
+                         "count",
+                         json_pack ("{s:i}", "min", 1));
+    ok (accept_jobspec (v, o) == false,
+        "range count is not accepted");
+    json_decref (o);
+
+    o = jobspec_create ();
+    json_array_append_new (json_object_get (o, "tasks"), json_object ());
+    ok (accept_jobspec (v, o) == false,
+        "jobspec with an extra tasks entry is not accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"properties\":[\"foo\",\"^bar\"]}");
+    ok (accept_jobspec (v, o) == true,
+        "properties constraint is accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"properties\":[\"foo|bar\"]}");
+    ok (accept_jobspec (v, o) == false,
+        "property with invalid character is not accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"and\":[{\"ranks\":[\"0-3\"]},"
+                                  "{\"not\":[{\"hostlist\":[\"foo[1-2]\"]}]}"
+                                  "]}");
+    ok (accept_jobspec (v, o) == true,
+        "nested ranks and hostlist constraints are accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"ranks\":[\"0-\"]}");
+    ok (accept_jobspec (v, o) == false,
+        "invalid ranks constraint is not accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"hostlist\":[\"foo[1-\"]}");
+    ok (accept_jobspec (v, o) == false,
+        "invalid hostlist constraint is not accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"foo\":[\"bar\"]}");
+    ok (accept_jobspec (v, o) == false,
+        "unknown constraint operator is not accepted");
+    json_decref (o);
+
+    o = jobspec_with_constraints ("{\"properties\":\"foo\"}");
+    ok (accept_jobspec (v, o) == false,
+        "constraint with non-array argument is not accepted");
+    json_decref (o);
+
+    ok ((stats = validator_stats_get (v)) != NULL
+        && json_unpack (stats,
+                        "{s:I s:I}",
+                        "accepted", &accepted,
+                        "deferred", &deferred) == 0
+        && accepted == 3
+        && deferred == 9,
+        "validator_stats_get reports accepted and deferred jobs");
+    json_decref (stats);
+
+    validator_destroy (v);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    setenv ("FLUX_CLI_PLUGINPATH_OVERRIDE", "", 1);
+
+    test_configure ();
+    test_accept ();
+
+    done_testing ();
+    return 0;
+}
+
+// vi:ts=4 sw=4 expandtab
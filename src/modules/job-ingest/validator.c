@@ -0,0 +1,406 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* validator.c - native (in-process) implementations of validator plugins
+ *
+ * The "jobspec" plugin mirrors the default Python jobspec validator
+ * for V1 jobspec using flux_jobspec1_check() plus RFC 31 constraint
+ * checks.  flux_jobspec1_check() is stricter than the Python Jobspec
+ * class in places (e.g. it does not allow range counts), which is fine
+ * since any job the native validator does not accept falls through to
+ * the workcrew.
+ *
+ * The Python jobspec validator also calls the validate() method of any
+ * CLI plugins found on the CLI plugin search path (see CLIPluginRegistry
+ * in flux.cli.plugin).  Those have no native equivalent, so the native
+ * validator is disabled if any are present.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <glob.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libjob/jobspec1_private.h"
+#include "src/common/libidset/idset.h"
+#include "src/common/libhostlist/hostlist.h"
+#include "ccan/array_size/array_size.h"
+#include "ccan/str/str.h"
+
+#include "validator.h"
+
+struct validator;
+
+typedef bool (*native_accept_f)(struct validator *v, json_t *jobspec);
+
+struct native_plugin {
+    const char *name;
+    native_accept_f accept;
+};
+
+struct validator {
+    flux_t *h;
+    bool enabled;
+    const struct native_plugin *plugins[8];
+    int plugin_count;
+
+    struct hostlist *hostlist;  // instance hostlist, fetched on demand
+    bool hostlist_fetched;
+
+    unsigned long accepted;
+    unsigned long deferred;
+};
+
+static bool jobspec_accept (struct validator *v, json_t *jobspec);
+
+static const struct native_plugin native_plugins[] = {
+    { "jobspec", jobspec_accept },
+};
+
+static const char *default_plugins = "jobspec";
+
+static bool plugindir_empty (const char *dir)
+{
+    char *pattern;
+    glob_t gl;
+    int rc;
+
+    if (asprintf (&pattern, "%s/*.py", dir) < 0)
+        return false;
+    rc = glob (pattern, 0, NULL, &gl);
+    free (pattern);
+    if (rc == 0)
+        globfree (&gl);
+    return rc == GLOB_NOMATCH;
+}
+
+static bool pluginpath_empty (const char *path)
+{
+    char *copy;
+    char *saveptr = NULL;
+    char *dir;
+    bool result = true;
+
+    if (!(copy = strdup (path)))
+        return false;
+    dir = strtok_r (copy, ":", &saveptr);
+    while (dir) {
+        if (!plugindir_empty (dir)) {
+            result = false;
+            break;
+        }
+        dir = strtok_r (NULL, ":", &saveptr);
+    }
+    free (copy);
+    return result;
+}
+
+/* Mirror CLIPluginRegistry._get_searchpath().
+ */
+static bool cli_plugins_present (void)
+{
+    const char *path;
+    const char *confdir;
+    const char *libexecdir;
+    char *builtin;
+    bool empty;
+
+    if ((path = getenv ("FLUX_CLI_PLUGINPATH_OVERRIDE")))
+        return !pluginpath_empty (path);
+    if ((path = getenv ("FLUX_CLI_PLUGINPATH")) && !pluginpath_empty (path))
+        return true;
+    confdir = flux_conf_builtin_get ("confdir", FLUX_CONF_AUTO);
+    libexecdir = flux_conf_builtin_get ("libexecdir", FLUX_CONF_AUTO);
+    if (!confdir || !libexecdir)
+        return true;
+    if (asprintf (&builtin,
+                  "%s/cli/plugins:%s/cli/plugins",
+                  confdir,
+                  libexecdir) < 0)
+        return true;
+    empty = pluginpath_empty (builtin);
+    free (builtin);
+    return !empty;
+}
+
+/* Python _validate_property_query() rejects these characters.
+ */
+static bool property_accept (json_t *o)
+{
+    const char *name = json_string_value (o);
+
+    if (!name || name[strcspn (name, "&'\"`|()")] != '\0')
+        return false;
+    return true;
+}
+
+static struct hostlist *instance_hostlist (struct validator *v)
+{
+    if (!v->hostlist_fetched && v->h) {
+        const char *s = flux_attr_get (v->h, "hostlist");
+        if (s)
+            v->hostlist = hostlist_decode (s);
+        v->hostlist_fetched = true;
+    }
+    return v->hostlist;
+}
+
+/* Hosts must be a valid hostlist, and if the instance hostlist is
+ * available, every host must be a member of it.
+ */
+static bool hostlist_accept (struct validator *v, json_t *o)
+{
+    const char *s = json_string_value (o);
+    struct hostlist *instance;
+    struct hostlist *hl;
+    const char *host;
+    bool result = false;
+
+    if (!s || !(hl = hostlist_decode (s)))
+        return false;
+    if (hostlist_count (hl) == 0)
+        goto out;
+    if ((instance = instance_hostlist (v))) {
+        host = hostlist_first (hl);
+        while (host) {
+            if (hostlist_find (instance, host) < 0)
+                goto out;
+            host = hostlist_next (hl);
+        }
+    }
+    result = true;
+out:
+    hostlist_destroy (hl);
+    return result;
+}
+
+static bool ranks_accept (json_t *o)
+{
+    const char *s = json_string_value (o);
+    struct idset *ids;
+
+    if (!s || !(ids = idset_decode (s)))
+        return false;
+    idset_destroy (ids);
+    return true;
+}
+
+/* RFC 31 constraint object.
+ */
+static bool constraint_accept (struct validator *v, json_t *constraint)
+{
+    const char *op;
+    json_t *args;
+
+    if (!json_is_object (constraint))
+        return false;
+    json_object_foreach (constraint, op, args) {
+        size_t index;
+        json_t *arg;
+
+        if (!json_is_array (args))
+            return false;
+        json_array_foreach (args, index, arg) {
+            if (streq (op, "and") || streq (op, "or") || streq (op, "not")) {
+                if (!constraint_accept (v, arg))
+                    return false;
+            }
+            else if (streq (op, "properties")) {
+                if (!property_accept (arg))
+                    return false;
+            }
+            else if (streq (op, "hostlist")) {
+                if (!hostlist_accept (v, arg))
+                    return false;
+            }
+            else if (streq (op, "ranks")) {
+                if (!ranks_accept (arg))
+                    return false;
+            }
+            else
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool jobspec_accept (struct validator *v, json_t *jobspec)
+{
+    flux_jobspec1_t *js;
+    json_t *constraints = NULL;
+    bool result = false;
+
+    if (!(js = jobspec1_from_json (jobspec)))
+        return false;
+    if (flux_jobspec1_check (js, NULL) < 0)
+        goto out;
+    /* flux_jobspec1_check() only examines the first resources and tasks
+     * entry, while the Python validator checks all of them.
+     */
+    if (json_array_size (json_object_get (jobspec, "resources")) != 1
+        || json_array_size (json_object_get (jobspec, "tasks")) != 1)
+        goto out;
+    (void)json_unpack (jobspec,
+                       "{s:{s:{s:o}}}",
+                       "attributes",
+                         "system",
+                           "constraints", &constraints);
+    if (constraints && !constraint_accept (v, constraints))
+        goto out;
+    result = true;
+out:
+    flux_jobspec1_destroy (js);
+    return result;
+}
+
+static const struct native_plugin *native_plugin_lookup (const char *name)
+{
+    for (int i = 0; i < (int)ARRAY_SIZE (native_plugins); i++) {
+        if (streq (native_plugins[i].name, name))
+            return &native_plugins[i];
+    }
+    return NULL;
+}
+
+static bool require_version_ok (const char *value)
+{
+    return streq (value, "1") || streq (value, "any");
+}
+
+/* The only argument with a native implementation is the jobspec plugin's
+ * --require-version=1|any.  The native jobspec plugin only accepts V1
+ * jobspec, so either value is safe.
+ */
+static bool args_native (const char *args)
+{
+    char *copy;
+    char *saveptr = NULL;
+    char *arg;
+    bool expect_value = false;
+    bool result = false;
+
+    if (!args || strlen (args) == 0)
+        return true;
+    if (!(copy = strdup (args)))
+        return false;
+    arg = strtok_r (copy, ",", &saveptr);
+    while (arg) {
+        if (expect_value) {
+            if (!require_version_ok (arg))
+                goto out;
+            expect_value = false;
+        }
+        else if (streq (arg, "--require-version"))
+            expect_value = true;
+        else if (strstarts (arg, "--require-version=")) {
+            if (!require_version_ok (arg + 18))
+                goto out;
+        }
+        else
+            goto out;
+        arg = strtok_r (NULL, ",", &saveptr);
+    }
+    if (!expect_value)
+        result = true;
+out:
+    free (copy);
+    return result;
+}
+
+void validator_configure (struct validator *v,
+                          const char *plugins,
+                          const char *args,
+                          bool enable)
+{
+    char *copy;
+    char *saveptr = NULL;
+    char *name;
+
+    v->enabled = false;
+    v->plugin_count = 0;
+    if (!enable || !args_native (args) || cli_plugins_present ())
+        return;
+    if (!plugins || strlen (plugins) == 0)
+        plugins = default_plugins;
+    if (!(copy = strdup (plugins)))
+        return;
+    name = strtok_r (copy, ",", &saveptr);
+    while (name) {
+        const struct native_plugin *p;
+
+        if (!(p = native_plugin_lookup (name))
+            || v->plugin_count == (int)ARRAY_SIZE (v->plugins)) {
+            v->plugin_count = 0;
+            goto out;
+        }
+        v->plugins[v->plugin_count++] = p;
+        name = strtok_r (NULL, ",", &saveptr);
+    }
+    if (v->plugin_count > 0)
+        v->enabled = true;
+out:
+    free (copy);
+}
+
+bool validator_enabled (struct validator *v)
+{
+    return v ? v->enabled : false;
+}
+
+bool validator_accept (struct validator *v, struct job *job)
+{
+    if (!v || !v->enabled || !job || !job->jobspec)
+        return false;
+    for (int i = 0; i < v->plugin_count; i++) {
+        if (!v->plugins[i]->accept (v, job->jobspec)) {
+            v->deferred++;
+            return false;
+        }
+    }
+    v->accepted++;
+    return true;
+}
+
+json_t *validator_stats_get (struct validator *v)
+{
+    if (!v)
+        return json_null ();
+    return json_pack ("{s:b s:I s:I}",
+                      "enabled", v->enabled,
+                      "accepted", (json_int_t)v->accepted,
+                      "deferred", (json_int_t)v->deferred);
+}
+
+void validator_destroy (struct validator *v)
+{
+    if (v) {
+        int saved_errno = errno;
+        hostlist_destroy (v->hostlist);
+        free (v);
+        errno = saved_errno;
+    }
+}
+
+struct validator *validator_create (flux_t *h)
+{
+    struct validator *v;
+
+    if (!(v = calloc (1, sizeof (*v))))
+        return NULL;
+    v->h = h;
+    return v;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,57 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _JOB_INGEST_VALIDATOR_H
+#define _JOB_INGEST_VALIDATOR_H
+
+#include <stdbool.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "job.h"
+
+/* In-process (native) job validator.
+ *
+ * Native plugins reimplement flux job-validator plugins in C so that
+ * common submissions are validated without leaving the module.
+ * A native plugin may only accept a job.  Anything it cannot accept is
+ * passed on to the job-validator workcrew, which remains authoritative
+ * for rejection and its error messages.
+ */
+
+/* 'h' may be NULL, e.g. in unit tests, in which case constraint
+ * hostlists are not checked against the instance hostlist.
+ */
+struct validator *validator_create (flux_t *h);
+void validator_destroy (struct validator *v);
+
+/* Configure from the comma separated validator 'plugins' and 'args'
+ * (NULL for defaults), as they would be passed to flux job-validator.
+ * The native validator is enabled only if 'enable' is true and every
+ * configured plugin and argument has a native implementation.
+ */
+void validator_configure (struct validator *v,
+                          const char *plugins,
+                          const char *args,
+                          bool enable);
+
+bool validator_enabled (struct validator *v);
+
+/* Return true if 'job' was accepted by all native plugins.
+ * Return false if the native validator is disabled or the job must be
+ * validated by the workcrew.
+ */
+bool validator_accept (struct validator *v, struct job *job);
+
+json_t *validator_stats_get (struct validator *v);
+
+#endif /* !_JOB_INGEST_VALIDATOR_H */
+
+// vi:ts=4 sw=4 expandtab
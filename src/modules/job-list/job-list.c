@@ -64,7 +64,10 @@ static void stats_cb (flux_t *h,
     int idsync_lookups = zlistx_size (ctx->isctx->lookups);
     int idsync_waits = zhashx_size (ctx->isctx->waits);
     int stats_watchers = job_stats_watchers (ctx->jsctx->statsctx);
-    if (flux_respond_pack (h, msg, "{s:{s:i s:i s:i} s:{s:i s:i} s:i}",
+    int list_streams = list_stream_count (ctx);
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:{s:i s:i s:i} s:{s:i s:i} s:i s:i}",
                            "jobs",
                            "pending", pending,
                            "running", running,
@@ -72,7 +75,8 @@ static void stats_cb (flux_t *h,
                            "idsync",
                            "lookups", idsync_lookups,
                            "waits", idsync_waits,
-                           "stats_watchers", stats_watchers) < 0)
+                           "stats_watchers", stats_watchers,
+                           "list_streams", list_streams) < 0)
         flux_log_error (h, "error responding to stats-get request");
     return;
 error:
@@ -101,6 +105,7 @@ static void purge_cb (flux_t *h,
             if (job->state != FLUX_JOB_STATE_INACTIVE)
                 continue;
             job_stats_purge (ctx->jsctx->statsctx, job);
+            job_index_remove (ctx->jsctx->inactive_index, job);
             if (job->list_handle)
                 zlistx_delete (ctx->jsctx->inactive, job->list_handle);
             zhashx_delete (ctx->jsctx->index, &id);
@@ -128,6 +133,7 @@ static void disconnect_cb (flux_t *h,
 {
     struct list_ctx *ctx = arg;
     job_stats_disconnect (ctx->jsctx->statsctx, msg);
+    list_stream_disconnect (ctx, msg);
 }
 
 static void config_reload_cb (flux_t *h,
@@ -223,6 +229,7 @@ static void list_ctx_destroy (struct list_ctx *ctx)
     if (ctx) {
         int saved_errno = errno;
         flux_msg_handler_delvec (ctx->handlers);
+        list_stream_cleanup (ctx);
         flux_msglist_destroy (ctx->deferred_requests);
         if (ctx->jsctx)
             job_state_destroy (ctx->jsctx);
@@ -256,6 +263,8 @@ static struct list_ctx *list_ctx_create (flux_t *h)
         goto error;
     if (!(ctx->auth = job_auth_create (h)))
         goto error;
+    if (list_stream_init (ctx) < 0)
+        goto error;
     idsync_ctx_set_auth (ctx->isctx, ctx->auth, ctx->mctx);
     job_stats_set_auth (ctx->jsctx->statsctx, ctx->auth);
     return ctx;
@@ -28,6 +28,12 @@ struct list_ctx {
     struct flux_msglist *deferred_requests;
     struct match_ctx *mctx;
     struct job_auth *auth;
+
+    /* streaming list requests in progress */
+    zlistx_t *streams;
+    flux_watcher_t *stream_prep;
+    flux_watcher_t *stream_check;
+    flux_watcher_t *stream_idle;
 };
 
 const char **job_attrs (void);
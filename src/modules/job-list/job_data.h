@@ -19,6 +19,16 @@
 #include "src/common/libutil/grudgeset.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
+/* Secondary indexes of inactive jobs (see job_index.c).
+ */
+enum {
+    INDEX_USERID = 0,
+    INDEX_NAME = 1,
+    INDEX_QUEUE = 2,
+    INDEX_RESULT = 3,
+    INDEX_COUNT = 4,
+};
+
 /* timestamp of when we enter the state
  *
  * associated eventlog entries when restarting
@@ -84,6 +94,7 @@ struct job {
     unsigned int states_mask;
     unsigned int states_events_mask;
     void *list_handle;
+    void *index_handles[INDEX_COUNT]; /* inactive job index lists */
 
     int submit_version;         /* version number in submit context */
 };
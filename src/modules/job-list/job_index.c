@@ -0,0 +1,205 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* job_index.c - secondary indexes of inactive jobs */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/array_size/array_size.h"
+
+#include "job_index.h"
+
+struct job_index {
+    zlistx_comparator_fn *cmp;
+    zhashx_t *hash[INDEX_COUNT];
+    zlistx_t *empty;
+};
+
+/* zhashx_set_destructor */
+static void list_destructor (void **item)
+{
+    if (item) {
+        zlistx_destroy ((zlistx_t **)item);
+        *item = NULL;
+    }
+}
+
+void job_index_destroy (struct job_index *index)
+{
+    if (index) {
+        int saved_errno = errno;
+        for (int i = 0; i < INDEX_COUNT; i++)
+            zhashx_destroy (&index->hash[i]);
+        zlistx_destroy (&index->empty);
+        free (index);
+        errno = saved_errno;
+    }
+}
+
+struct job_index *job_index_create (zlistx_comparator_fn *cmp)
+{
+    struct job_index *index;
+
+    if (!(index = calloc (1, sizeof (*index))))
+        return NULL;
+    index->cmp = cmp;
+    for (int i = 0; i < INDEX_COUNT; i++) {
+        if (!(index->hash[i] = zhashx_new ()))
+            goto nomem;
+        zhashx_set_destructor (index->hash[i], list_destructor);
+    }
+    if (!(index->empty = zlistx_new ()))
+        goto nomem;
+    return index;
+nomem:
+    job_index_destroy (index);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/* Return the key of 'job' for index 'i', or NULL if the job has no value
+ * for the index, e.g. no queue.  Numeric keys are formatted in 'buf'.
+ */
+static const char *job_key (struct job *job, int i, char *buf, size_t size)
+{
+    switch (i) {
+        case INDEX_USERID:
+            snprintf (buf, size, "%u", (unsigned int)job->userid);
+            return buf;
+        case INDEX_NAME:
+            return job->name;
+        case INDEX_QUEUE:
+            return job->queue;
+        case INDEX_RESULT:
+            snprintf (buf, size, "%d", (int)job->result);
+            return buf;
+        default:
+            return NULL;
+    }
+}
+
+int job_index_add (struct job_index *index, struct job *job, bool sorted)
+{
+    char buf[64];
+
+    for (int i = 0; i < INDEX_COUNT; i++) {
+        const char *key;
+        zlistx_t *l;
+
+        job->index_handles[i] = NULL;
+        if (!(key = job_key (job, i, buf, sizeof (buf))))
+            continue;
+        if (!(l = zhashx_lookup (index->hash[i], key))) {
+            if (!(l = zlistx_new ()))
+                goto nomem;
+            zlistx_set_comparator (l, index->cmp);
+            (void)zhashx_insert (index->hash[i], key, l);
+        }
+        if (sorted)
+            job->index_handles[i] = zlistx_insert (l, job, true);
+        else
+            job->index_handles[i] = zlistx_add_end (l, job);
+        if (!job->index_handles[i])
+            goto nomem;
+    }
+    return 0;
+nomem:
+    job_index_remove (index, job);
+    errno = ENOMEM;
+    return -1;
+}
+
+void job_index_remove (struct job_index *index, struct job *job)
+{
+    char buf[64];
+
+    for (int i = 0; i < INDEX_COUNT; i++) {
+        const char *key;
+        zlistx_t *l;
+
+        if (!job->index_handles[i])
+            continue;
+        if ((key = job_key (job, i, buf, sizeof (buf)))
+            && (l = zhashx_lookup (index->hash[i], key))) {
+            zlistx_delete (l, job->index_handles[i]);
+            if (zlistx_size (l) == 0)
+                zhashx_delete (index->hash[i], key);
+        }
+        job->index_handles[i] = NULL;
+    }
+}
+
+/* zlistx_sort() swaps node contents, so re-acquire each job's handle
+ * (cf. job_state_sort_inactive()).
+ */
+void job_index_sort (struct job_index *index)
+{
+    for (int i = 0; i < INDEX_COUNT; i++) {
+        zlistx_t *l = zhashx_first (index->hash[i]);
+        while (l) {
+            struct job *job;
+
+            zlistx_sort (l);
+            job = zlistx_first (l);
+            while (job) {
+                job->index_handles[i] = zlistx_cursor (l);
+                job = zlistx_next (l);
+            }
+            l = zhashx_next (index->hash[i]);
+        }
+    }
+}
+
+/* Choose 'l' if it is smaller than the current choice '*best'.
+ * A missing list means no inactive job has the key.
+ */
+static void choose (struct job_index *index,
+                    int i,
+                    const char *key,
+                    zlistx_t **best)
+{
+    zlistx_t *l;
+
+    if (!(l = zhashx_lookup (index->hash[i], key)))
+        l = index->empty;
+    if (!*best || zlistx_size (l) < zlistx_size (*best))
+        *best = l;
+}
+
+zlistx_t *job_index_lookup (struct job_index *index,
+                            const struct list_constraint_plan *plan)
+{
+    zlistx_t *best = NULL;
+    char key[64];
+
+    if (plan->userid_set) {
+        snprintf (key, sizeof (key), "%u", (unsigned int)plan->userid);
+        choose (index, INDEX_USERID, key, &best);
+    }
+    if (plan->name)
+        choose (index, INDEX_NAME, plan->name, &best);
+    if (plan->queue)
+        choose (index, INDEX_QUEUE, plan->queue, &best);
+    if (plan->result_set) {
+        snprintf (key, sizeof (key), "%d", plan->result);
+        choose (index, INDEX_RESULT, key, &best);
+    }
+    return best;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
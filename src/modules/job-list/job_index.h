@@ -0,0 +1,51 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_JOB_INDEX_H
+#define _FLUX_JOB_LIST_JOB_INDEX_H
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "job_data.h"
+#include "match.h"
+
+/* Secondary indexes of inactive jobs by userid, name, queue, and result.
+ *
+ * Each index key maps to a list of jobs ordered like the main inactive
+ * list, so a query restricted to one key can walk that list instead of
+ * the whole inactive list and return jobs in the same order.  The index
+ * does not own the jobs.
+ */
+struct job_index;
+
+struct job_index *job_index_create (zlistx_comparator_fn *cmp);
+
+void job_index_destroy (struct job_index *index);
+
+/* Add inactive 'job' to the index.  If 'sorted' is false, the job is
+ * appended and job_index_sort() must be called before the next lookup.
+ */
+int job_index_add (struct job_index *index, struct job *job, bool sorted);
+
+void job_index_remove (struct job_index *index, struct job *job);
+
+void job_index_sort (struct job_index *index);
+
+/* Return the smallest index list that holds every inactive job that can
+ * match 'plan', or NULL if 'plan' does not restrict an indexed field.
+ */
+zlistx_t *job_index_lookup (struct job_index *index,
+                            const struct list_constraint_plan *plan);
+
+#endif /* ! _FLUX_JOB_LIST_JOB_INDEX_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -141,6 +141,7 @@ static void job_state_sort_inactive (struct job_state_ctx *jsctx)
         job->list_handle = zlistx_cursor (jsctx->inactive);
         job = zlistx_next (jsctx->inactive);
     }
+    job_index_sort (jsctx->inactive_index);
 }
 
 /* zlistx_insert() and zlistx_reorder() take a 'low_value' parameter
@@ -223,6 +224,10 @@ static int job_insert_list (struct job_state_ctx *jsctx,
                                                      job,
                                                      true)))
             goto enomem;
+        if (job_index_add (jsctx->inactive_index,
+                           job,
+                           jsctx->initialized) < 0)
+            goto enomem;
     }
 
     return 0;
@@ -1196,6 +1201,8 @@ struct job_state_ctx *job_state_create (struct list_ctx *ctx)
     if (!(jsctx->inactive = zlistx_new ()))
         goto error;
     zlistx_set_comparator (jsctx->inactive, job_inactive_cmp);
+    if (!(jsctx->inactive_index = job_index_create (job_inactive_cmp)))
+        goto error;
 
     if (!(jsctx->processing = zlistx_new ()))
         goto error;
@@ -1224,6 +1231,7 @@ void job_state_destroy (void *data)
         /* Destroy index last, as it is the one that will actually
          * destroy the job objects */
         zlistx_destroy (&jsctx->processing);
+        job_index_destroy (jsctx->inactive_index);
         zlistx_destroy (&jsctx->inactive);
         zlistx_destroy (&jsctx->running);
         zlistx_destroy (&jsctx->pending);
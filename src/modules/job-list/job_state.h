@@ -18,6 +18,7 @@
 
 #include "idsync.h"
 #include "stats.h"
+#include "job_index.h"
 
 /* To handle the common case of user queries on job state, we will
  * store jobs in three different lists.
@@ -46,6 +47,9 @@ struct job_state_ctx {
     zlistx_t *inactive;
     zlistx_t *processing;
 
+    /* inactive jobs by userid, name, queue, and result */
+    struct job_index *inactive_index;
+
     /*  Job statistics: */
     struct job_stats_ctx *statsctx;
 
@@ -27,6 +27,7 @@
 #include "list.h"
 #include "job_util.h"
 #include "job_data.h"
+#include "job_index.h"
 #include "match.h"
 #include "state_match.h"
 
@@ -71,7 +72,8 @@ int get_jobs_from_list (json_t *jobs,
                         int max_entries,
                         json_t *attrs,
                         double since,
-                        struct list_constraint *c)
+                        struct list_constraint *c,
+                        const struct list_constraint_plan *plan)
 {
     struct job *job;
 
@@ -85,10 +87,18 @@ int get_jobs_from_list (json_t *jobs,
          *  If job->t_inactive > since, this is a job that could potentially be returned
          *
          *  So if job->t_inactive <= since, then we're done b/c the rest of the inactive
-         *   jobs cannot be returned.
+         *   jobs cannot be returned.  The same holds for a t_inactive lower
+         *   bound in the constraint.
          */
-        if (job->t_inactive > 0. && job->t_inactive <= since)
-            break;
+        if (job->t_inactive > 0.) {
+            if (job->t_inactive <= since)
+                break;
+            if (plan->t_inactive_set
+                && (job->t_inactive < plan->t_inactive
+                    || (job->t_inactive == plan->t_inactive
+                        && !plan->t_inactive_inclusive)))
+                break;
+        }
 
         if ((ret = job_match (job, c, errp)) < 0)
             return -1;
@@ -126,6 +136,7 @@ json_t *get_jobs (struct job_state_ctx *jsctx,
                   struct list_constraint *c,
                   struct state_constraint *statec)
 {
+    struct list_constraint_plan plan;
     json_t *jobs = NULL;
     int saved_errno;
     int ret = 0;
@@ -133,6 +144,8 @@ json_t *get_jobs (struct job_state_ctx *jsctx,
     if (!(jobs = json_array ()))
         goto error_nomem;
 
+    list_constraint_plan (c, &plan);
+
     /* We return jobs in the following order, pending, running,
      * inactive */
 
@@ -143,7 +156,8 @@ json_t *get_jobs (struct job_state_ctx *jsctx,
                                        max_entries,
                                        attrs,
                                        0.,
-                                       c)) < 0)
+                                       c,
+                                       &plan)) < 0)
             goto error;
     }
 
@@ -155,20 +169,30 @@ json_t *get_jobs (struct job_state_ctx *jsctx,
                                            max_entries,
                                            attrs,
                                            0.,
-                                           c)) < 0)
+                                           c,
+                                           &plan)) < 0)
                 goto error;
         }
     }
 
     if (state_match (FLUX_JOB_STATE_INACTIVE, statec)) {
         if (!ret) {
+            /* If the constraint restricts userid, name, queue, or result,
+             * walk the smallest matching index list instead of every
+             * inactive job.  Index lists share the inactive list order.
+             */
+            zlistx_t *list;
+
+            if (!(list = job_index_lookup (jsctx->inactive_index, &plan)))
+                list = jsctx->inactive;
             if ((ret = get_jobs_from_list (jobs,
                                            errp,
-                                           jsctx->inactive,
+                                           list,
                                            max_entries,
                                            attrs,
                                            since,
-                                           c)) < 0)
+                                           c,
+                                           &plan)) < 0)
                 goto error;
         }
     }
@@ -184,6 +208,426 @@ error:
     return NULL;
 }
 
+/* Streaming list requests.
+ *
+ * A streaming job-list.list request is answered incrementally.  The ids
+ * of candidate jobs are collected up front, in the order get_jobs()
+ * would visit them, and the jobs are then matched and converted to JSON
+ * a slice at a time from prep/check/idle watchers.  Each response holds
+ * at most LIST_STREAM_CHUNK jobs, so memory held for a broad query is the
+ * id array plus one chunk, and journal events are processed between
+ * slices.  Jobs purged while the request is in progress are skipped.
+ *
+ * Once the scan reaches the inactive jobs, each response carries an
+ * opaque "cursor" naming the last inactive job examined.  A client that
+ * passes it back in a new request resumes the inactive list after that
+ * job.  Pending and running jobs are not returned when resuming.
+ *
+ * Work stops if the client disconnects.
+ */
+
+#define LIST_STREAM_CHUNK   256     /* max jobs per response */
+#define LIST_STREAM_SLICE   2048    /* max jobs examined per slice */
+
+struct list_cursor {
+    double t_inactive;
+    flux_jobid_t id;
+};
+
+struct list_stream {
+    struct list_ctx *ctx;
+    const flux_msg_t *msg;
+    json_t *attrs;
+    int max_entries;
+    struct list_constraint *c;
+    flux_jobid_t *ids;
+    size_t count;
+    size_t size;
+    size_t pos;
+    size_t inactive_start;      /* index of first inactive job in ids */
+    int sent;
+    bool cursor_set;
+    struct list_cursor cursor;  /* last inactive job examined */
+};
+
+static void list_stream_destroy (struct list_stream *ls)
+{
+    if (ls) {
+        int saved_errno = errno;
+        flux_msg_decref (ls->msg);
+        json_decref (ls->attrs);
+        list_constraint_destroy (ls->c);
+        free (ls->ids);
+        free (ls);
+        errno = saved_errno;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void list_stream_destructor (void **item)
+{
+    if (item) {
+        list_stream_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static int list_stream_push (struct list_stream *ls, flux_jobid_t id)
+{
+    if (ls->count == ls->size) {
+        size_t size = ls->size ? ls->size * 2 : 1024;
+        flux_jobid_t *ids;
+
+        if (!(ids = realloc (ls->ids, size * sizeof (ids[0])))) {
+            errno = ENOMEM;
+            return -1;
+        }
+        ls->ids = ids;
+        ls->size = size;
+    }
+    ls->ids[ls->count++] = id;
+    return 0;
+}
+
+static int list_stream_push_list (struct list_stream *ls, zlistx_t *list)
+{
+    struct job *job = zlistx_first (list);
+    while (job) {
+        if (list_stream_push (ls, job->id) < 0)
+            return -1;
+        job = zlistx_next (list);
+    }
+    return 0;
+}
+
+/* Return true if 'job' comes after 'cursor' in inactive list order
+ * (cf. job_inactive_cmp()).
+ */
+static bool after_cursor (const struct job *job,
+                          const struct list_cursor *cursor)
+{
+    if (job->t_inactive != cursor->t_inactive)
+        return job->t_inactive < cursor->t_inactive;
+    return job->id < cursor->id;
+}
+
+static int list_stream_push_inactive (struct list_stream *ls,
+                                      zlistx_t *list,
+                                      double since,
+                                      const struct list_cursor *cursor,
+                                      const struct list_constraint_plan *plan)
+{
+    struct job *job = zlistx_first (list);
+    while (job) {
+        /* See get_jobs_from_list() */
+        if (job->t_inactive <= since)
+            break;
+        if (plan->t_inactive_set
+            && (job->t_inactive < plan->t_inactive
+                || (job->t_inactive == plan->t_inactive
+                    && !plan->t_inactive_inclusive)))
+            break;
+        if (!cursor || after_cursor (job, cursor)) {
+            if (list_stream_push (ls, job->id) < 0)
+                return -1;
+        }
+        job = zlistx_next (list);
+    }
+    return 0;
+}
+
+static int list_cursor_decode (const char *s, struct list_cursor *cursor)
+{
+    char *endptr;
+
+    errno = 0;
+    cursor->t_inactive = strtod (s, &endptr);
+    if (errno != 0 || endptr == s || *endptr != ':' || cursor->t_inactive < 0.)
+        goto inval;
+    s = endptr + 1;
+    cursor->id = strtoull (s, &endptr, 10);
+    if (errno != 0 || endptr == s || *endptr != '\0')
+        goto inval;
+    return 0;
+inval:
+    errno = EINVAL;
+    return -1;
+}
+
+static void list_cursor_encode (const struct list_cursor *cursor,
+                                char *buf,
+                                size_t size)
+{
+    snprintf (buf,
+              size,
+              "%.17g:%ju",
+              cursor->t_inactive,
+              (uintmax_t)cursor->id);
+}
+
+static void list_stream_start_watchers (struct list_ctx *ctx)
+{
+    flux_watcher_start (ctx->stream_prep);
+    flux_watcher_start (ctx->stream_check);
+}
+
+static void list_stream_stop_watchers (struct list_ctx *ctx)
+{
+    flux_watcher_stop (ctx->stream_prep);
+    flux_watcher_stop (ctx->stream_check);
+    flux_watcher_stop (ctx->stream_idle);
+}
+
+/* Create a stream for 'msg' and queue it.  On success, the stream takes
+ * ownership of 'c'.
+ */
+static int list_stream_start (struct list_ctx *ctx,
+                              const flux_msg_t *msg,
+                              json_t *attrs,
+                              int max_entries,
+                              double since,
+                              const struct list_cursor *cursor,
+                              struct list_constraint *c,
+                              struct state_constraint *statec)
+{
+    struct job_state_ctx *jsctx = ctx->jsctx;
+    struct list_constraint_plan plan;
+    struct list_stream *ls;
+
+    if (!(ls = calloc (1, sizeof (*ls))))
+        return -1;
+    ls->ctx = ctx;
+    ls->msg = flux_msg_incref (msg);
+    ls->attrs = json_incref (attrs);
+    ls->max_entries = max_entries;
+
+    list_constraint_plan (c, &plan);
+
+    /* We return jobs in the following order, pending, running,
+     * inactive, as in get_jobs().
+     */
+    if (!cursor) {
+        if (state_match (FLUX_JOB_STATE_PENDING, statec)
+            && list_stream_push_list (ls, jsctx->pending) < 0)
+            goto error;
+        if (state_match (FLUX_JOB_STATE_RUNNING, statec)
+            && list_stream_push_list (ls, jsctx->running) < 0)
+            goto error;
+    }
+    ls->inactive_start = ls->count;
+    if (state_match (FLUX_JOB_STATE_INACTIVE, statec)) {
+        zlistx_t *list;
+
+        if (!(list = job_index_lookup (jsctx->inactive_index, &plan)))
+            list = jsctx->inactive;
+        if (list_stream_push_inactive (ls, list, since, cursor, &plan) < 0)
+            goto error;
+    }
+    if (!zlistx_add_end (ctx->streams, ls)) {
+        errno = ENOMEM;
+        goto error;
+    }
+    ls->c = c;
+    list_stream_start_watchers (ctx);
+    return 0;
+error:
+    list_stream_destroy (ls);
+    return -1;
+}
+
+/* Examine up to LIST_STREAM_SLICE jobs and send a response if any
+ * matched.  Return 1 if the stream is complete, 0 if not, or -1 on
+ * error with 'errp' set.
+ */
+static int list_stream_step (struct list_stream *ls, flux_error_t *errp)
+{
+    struct job_state_ctx *jsctx = ls->ctx->jsctx;
+    flux_t *h = ls->ctx->h;
+    json_t *jobs;
+    int n = 0;
+    bool done = false;
+    char cursor[64];
+
+    if (!(jobs = json_array ())) {
+        errprintf (errp, "out of memory");
+        errno = ENOMEM;
+        return -1;
+    }
+    while (n++ < LIST_STREAM_SLICE && json_array_size (jobs) < LIST_STREAM_CHUNK) {
+        struct job *job;
+        flux_jobid_t id;
+        int ret;
+
+        if (ls->pos == ls->count) {
+            done = true;
+            break;
+        }
+        id = ls->ids[ls->pos++];
+        if (!(job = zhashx_lookup (jsctx->index, &id)))
+            continue;
+        if (ls->pos > ls->inactive_start
+            && job->state == FLUX_JOB_STATE_INACTIVE) {
+            ls->cursor.t_inactive = job->t_inactive;
+            ls->cursor.id = job->id;
+            ls->cursor_set = true;
+        }
+        if ((ret = job_match (job, ls->c, errp)) < 0)
+            goto error;
+        if (ret) {
+            json_t *o;
+            if (!(o = job_to_json (job, ls->attrs, errp)))
+                goto error;
+            if (json_array_append_new (jobs, o) < 0) {
+                errprintf (errp, "out of memory");
+                errno = ENOMEM;
+                goto error;
+            }
+            if (++ls->sent == ls->max_entries) {
+                done = true;
+                break;
+            }
+        }
+    }
+    if (ls->pos == ls->count)
+        done = true;
+    if (json_array_size (jobs) > 0) {
+        json_t *o;
+
+        /* N.B. the first response carries the protocol version */
+        if (!(o = json_pack ("{s:O}", "jobs", jobs))
+            || (ls->sent == json_array_size (jobs)
+                && json_object_set_new (o, "version", json_integer (1)) < 0))
+            goto nomem;
+        if (ls->cursor_set) {
+            list_cursor_encode (&ls->cursor, cursor, sizeof (cursor));
+            if (json_object_set_new (o, "cursor", json_string (cursor)) < 0)
+                goto nomem;
+        }
+        if (flux_respond_pack (h, ls->msg, "O", o) < 0)
+            flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
+        json_decref (o);
+        goto out;
+nomem:
+        json_decref (o);
+        errprintf (errp, "out of memory");
+        errno = ENOMEM;
+        goto error;
+    }
+out:
+    json_decref (jobs);
+    return done ? 1 : 0;
+error:
+    ERRNO_SAFE_WRAP (json_decref, jobs);
+    return -1;
+}
+
+static void list_stream_prep_cb (flux_reactor_t *r,
+                                 flux_watcher_t *w,
+                                 int revents,
+                                 void *arg)
+{
+    struct list_ctx *ctx = arg;
+
+    flux_watcher_start (ctx->stream_idle);
+}
+
+static void list_stream_check_cb (flux_reactor_t *r,
+                                  flux_watcher_t *w,
+                                  int revents,
+                                  void *arg)
+{
+    struct list_ctx *ctx = arg;
+    struct list_stream *ls;
+
+    flux_watcher_stop (ctx->stream_idle);
+
+    ls = zlistx_first (ctx->streams);
+    while (ls) {
+        flux_error_t err;
+        int rc;
+
+        err.text[0] = '\0';
+        if ((rc = list_stream_step (ls, &err)) < 0) {
+            if (flux_respond_error (ctx->h,
+                                    ls->msg,
+                                    errno,
+                                    err.text[0] ? err.text : NULL) < 0)
+                flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+        }
+        else if (rc > 0) {
+            if (flux_respond_error (ctx->h, ls->msg, ENODATA, NULL) < 0)
+                flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+        }
+        if (rc != 0)
+            zlistx_delete (ctx->streams, zlistx_cursor (ctx->streams));
+        ls = zlistx_next (ctx->streams);
+    }
+    if (zlistx_size (ctx->streams) == 0)
+        list_stream_stop_watchers (ctx);
+}
+
+void list_stream_disconnect (struct list_ctx *ctx, const flux_msg_t *msg)
+{
+    struct list_stream *ls;
+
+    ls = zlistx_first (ctx->streams);
+    while (ls) {
+        if (flux_disconnect_match (msg, ls->msg))
+            zlistx_delete (ctx->streams, zlistx_cursor (ctx->streams));
+        ls = zlistx_next (ctx->streams);
+    }
+    if (zlistx_size (ctx->streams) == 0)
+        list_stream_stop_watchers (ctx);
+}
+
+int list_stream_count (struct list_ctx *ctx)
+{
+    return zlistx_size (ctx->streams);
+}
+
+int list_stream_init (struct list_ctx *ctx)
+{
+    flux_reactor_t *r = flux_get_reactor (ctx->h);
+
+    if (!(ctx->streams = zlistx_new ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    zlistx_set_destructor (ctx->streams, list_stream_destructor);
+    if (!(ctx->stream_prep = flux_prepare_watcher_create (r,
+                                                          list_stream_prep_cb,
+                                                          ctx))
+        || !(ctx->stream_check = flux_check_watcher_create (r,
+                                                            list_stream_check_cb,
+                                                            ctx))
+        || !(ctx->stream_idle = flux_idle_watcher_create (r, NULL, NULL)))
+        return -1;
+    return 0;
+}
+
+/* Fail any streams in progress at module unload.
+ */
+void list_stream_cleanup (struct list_ctx *ctx)
+{
+    struct list_stream *ls;
+
+    if (ctx->streams) {
+        while ((ls = zlistx_first (ctx->streams))) {
+            if (flux_respond_error (ctx->h,
+                                    ls->msg,
+                                    ENOSYS,
+                                    "job-list is unloading") < 0)
+                flux_log_error (ctx->h, "%s: flux_respond_error", __FUNCTION__);
+            zlistx_delete (ctx->streams, NULL);
+        }
+        zlistx_destroy (&ctx->streams);
+    }
+    flux_watcher_destroy (ctx->stream_prep);
+    flux_watcher_destroy (ctx->stream_check);
+    flux_watcher_destroy (ctx->stream_idle);
+    ctx->stream_prep = ctx->stream_check = ctx->stream_idle = NULL;
+}
+
 static int legacy_list_rpc (flux_t *h,
                             flux_msg_handler_t *mh,
                             const flux_msg_t *msg,
@@ -285,14 +729,14 @@ void list_cb (flux_t *h,
     int max_entries;
     double since = 0.;
     json_t *constraint = NULL;
+    const char *cursor = NULL;
+    struct list_cursor cur;
     json_t *legacy_constraint = NULL;
     json_t *auth_constraint = NULL;
     json_t *combined_constraint = NULL;
     struct list_constraint *c = NULL;
     struct state_constraint *statec = NULL;
     flux_error_t error;
-    size_t index;
-    json_t *value;
 
     if (!ctx->jsctx->initialized) {
         if (flux_msglist_append (ctx->deferred_requests, msg) < 0)
@@ -301,11 +745,12 @@ void list_cb (flux_t *h,
     }
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s:i s:o s?F s?o}",
+                             "{s:i s:o s?F s?o s?s}",
                              "max_entries", &max_entries,
                              "attrs", &attrs,
                              "since", &since,
-                             "constraint", &constraint) < 0) {
+                             "constraint", &constraint,
+                             "cursor", &cursor) < 0) {
         errprintf (&err, "invalid payload: %s", flux_msg_last_error (msg));
         errno = EPROTO;
         goto error;
@@ -345,6 +790,18 @@ void list_cb (flux_t *h,
         errno = EPROTO;
         goto error;
     }
+    if (cursor) {
+        if (!flux_msg_is_streaming (msg)) {
+            errprintf (&err, "invalid payload: cursor requires streaming");
+            errno = EPROTO;
+            goto error;
+        }
+        if (list_cursor_decode (cursor, &cur) < 0) {
+            errprintf (&err, "invalid payload: cursor is invalid");
+            errno = EPROTO;
+            goto error;
+        }
+    }
 
     /* In private mode, restrict non-owners to their own jobs by ANDing an
      * access policy constraint with the requested constraint.
@@ -384,43 +841,30 @@ void list_cb (flux_t *h,
         goto error;
     }
 
-    if (!(jobs = get_jobs (ctx->jsctx,
-                           &err,
-                           max_entries,
-                           since,
-                           attrs,
-                           c,
-                           statec)))
-        goto error;
-
     if (flux_msg_is_streaming (msg)) {
-        bool first = true;
-        json_array_foreach (jobs, index, value) {
-            if (first) {
-                if (flux_respond_pack (h,
-                                       msg,
-                                       "{s:[O] s:i}",
-                                       "jobs", value,
-                                       "version", 1) < 0) {
-                    flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
-                    goto error;
-                }
-                first = false;
-            }
-            else {
-                if (flux_respond_pack (h,
-                                       msg,
-                                       "{s:[O]}",
-                                       "jobs", value) < 0) {
-                    flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
-                    goto error;
-                }
-            }
+        if (list_stream_start (ctx,
+                               msg,
+                               attrs,
+                               max_entries,
+                               since,
+                               cursor ? &cur : NULL,
+                               c,
+                               statec) < 0) {
+            errprintf (&err, "error starting list stream");
+            goto error;
         }
-        if (flux_respond_error (h, msg, ENODATA, NULL) < 0)
-            flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+        c = NULL; // owned by stream now
     }
     else {
+        if (!(jobs = get_jobs (ctx->jsctx,
+                               &err,
+                               max_entries,
+                               since,
+                               attrs,
+                               c,
+                               statec)))
+            goto error;
+
         /* N.B. do not send version field for legacy "version 0" */
         if (flux_respond_pack (h, msg, "{s:O}", "jobs", jobs) < 0)
             flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
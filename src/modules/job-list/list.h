@@ -13,9 +13,22 @@
 
 #include <flux/core.h>
 
+#include "job-list.h"
+
 void list_cb (flux_t *h, flux_msg_handler_t *mh,
               const flux_msg_t *msg, void *arg);
 
+/* Streaming job-list.list requests are answered incrementally from
+ * reactor watchers (see list.c).
+ */
+int list_stream_init (struct list_ctx *ctx);
+
+void list_stream_cleanup (struct list_ctx *ctx);
+
+void list_stream_disconnect (struct list_ctx *ctx, const flux_msg_t *msg);
+
+int list_stream_count (struct list_ctx *ctx);
+
 void list_id_cb (flux_t *h, flux_msg_handler_t *mh,
                  const flux_msg_t *msg, void *arg);
 
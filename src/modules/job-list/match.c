@@ -880,6 +880,78 @@ struct list_constraint *list_constraint_create (struct match_ctx *mctx,
     return list_constraint_new (mctx, match_true, NULL, errp);
 }
 
+static void plan_t_inactive (struct list_constraint_plan *plan,
+                             struct timestamp_value *tv)
+{
+    bool inclusive;
+
+    if (tv->t_type != MATCH_T_INACTIVE)
+        return;
+    if (tv->t_comp == MATCH_GREATER_THAN_EQUAL)
+        inclusive = true;
+    else if (tv->t_comp == MATCH_GREATER_THAN)
+        inclusive = false;
+    else
+        return;
+    /* keep the tightest lower bound */
+    if (!plan->t_inactive_set
+        || tv->t_value > plan->t_inactive
+        || (tv->t_value == plan->t_inactive && !inclusive)) {
+        plan->t_inactive_set = true;
+        plan->t_inactive = tv->t_value;
+        plan->t_inactive_inclusive = inclusive;
+    }
+}
+
+static void plan_constraint (struct list_constraint *c,
+                             struct list_constraint_plan *plan)
+{
+    void *value = zlistx_first (c->values);
+
+    if (c->match == match_and) {
+        while (value) {
+            plan_constraint (value, plan);
+            value = zlistx_next (c->values);
+        }
+        return;
+    }
+    if (c->match == match_timestamp) {
+        plan_t_inactive (plan, value);
+        return;
+    }
+    /* Remaining conditions restrict an index only with a single value.
+     * The results constraint holds one bitmask, so require a single bit.
+     */
+    if (!value || zlistx_size (c->values) != 1)
+        return;
+    if (c->match == match_userid) {
+        uint32_t userid = *(uint32_t *)value;
+        if (userid != FLUX_USERID_UNKNOWN) {
+            plan->userid_set = true;
+            plan->userid = userid;
+        }
+    }
+    else if (c->match == match_name)
+        plan->name = value;
+    else if (c->match == match_queue)
+        plan->queue = value;
+    else if (c->match == match_results) {
+        int results = *(int *)value;
+        if (results && !(results & (results - 1))) {
+            plan->result_set = true;
+            plan->result = results;
+        }
+    }
+}
+
+void list_constraint_plan (struct list_constraint *constraint,
+                           struct list_constraint_plan *plan)
+{
+    memset (plan, 0, sizeof (*plan));
+    if (constraint)
+        plan_constraint (constraint, plan);
+}
+
 int job_match (const struct job *job,
                struct list_constraint *constraint,
                flux_error_t *errp)
@@ -50,6 +50,26 @@ int job_match (const struct job *job,
                struct list_constraint *constraint,
                flux_error_t *errp);
 
+/*  Summary of the conditions that every job matching a constraint must
+ *  satisfy, used to choose a job index and to bound a scan of the
+ *  inactive list.  Only conditions reachable through "and" operators
+ *  with a single value are recorded.
+ */
+struct list_constraint_plan {
+    bool userid_set;
+    uint32_t userid;
+    const char *name;           /* valid for lifetime of constraint */
+    const char *queue;          /* valid for lifetime of constraint */
+    bool result_set;
+    flux_job_result_t result;
+    bool t_inactive_set;        /* t_inactive > bound (or >= if inclusive) */
+    double t_inactive;
+    bool t_inactive_inclusive;
+};
+
+void list_constraint_plan (struct list_constraint *constraint,
+                           struct list_constraint_plan *plan);
+
 int job_match_config_reload (struct match_ctx *mctx,
                              const flux_conf_t *conf,
                              flux_error_t *errp);
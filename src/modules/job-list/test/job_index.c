@@ -0,0 +1,211 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/modules/job-list/job_data.h"
+#include "src/modules/job-list/job_index.h"
+#include "src/modules/job-list/match.h"
+
+#define NUMCMP(a,b) ((a)==(b)?0:((a)<(b)?-1:1))
+
+/* same order as the job-list inactive list */
+static int inactive_cmp (const void *a1, const void *a2)
+{
+    const struct job *j1 = a1;
+    const struct job *j2 = a2;
+    int rc;
+
+    if ((rc = NUMCMP (j2->t_inactive, j1->t_inactive)) == 0)
+        rc = NUMCMP (j2->id, j1->id);
+    return rc;
+}
+
+#define NJOBS 12
+
+static const char *names[] = { "foo", "bar", "baz" };
+
+static struct job *jobs[NJOBS];
+
+static void create_jobs (void)
+{
+    for (int i = 0; i < NJOBS; i++) {
+        if (!(jobs[i] = job_create (NULL, i + 1)))
+            BAIL_OUT ("job_create failed");
+        jobs[i]->userid = 100 + (i % 2);
+        jobs[i]->name = names[i % 3];
+        jobs[i]->queue = (i % 4) == 0 ? "debug" : NULL;
+        jobs[i]->result = (i % 2) ? FLUX_JOB_RESULT_FAILED
+                                  : FLUX_JOB_RESULT_COMPLETED;
+        jobs[i]->state = FLUX_JOB_STATE_INACTIVE;
+        jobs[i]->t_inactive = 1000. + (i * 7) % NJOBS;
+    }
+}
+
+static void destroy_jobs (void)
+{
+    for (int i = 0; i < NJOBS; i++) {
+        jobs[i]->name = NULL;
+        jobs[i]->queue = NULL;
+        job_destroy (jobs[i]);
+    }
+}
+
+/* Check that 'l' holds 'count' jobs in inactive order, all satisfying
+ * the 'plan' field that selected it.
+ */
+static bool check_list (zlistx_t *l,
+                        int count,
+                        const struct list_constraint_plan *plan)
+{
+    struct job *prev = NULL;
+    struct job *job;
+
+    if (!l || zlistx_size (l) != count)
+        return false;
+    job = zlistx_first (l);
+    while (job) {
+        if (prev && inactive_cmp (prev, job) >= 0)
+            return false;
+        if (plan->userid_set && job->userid != plan->userid)
+            return false;
+        prev = job;
+        job = zlistx_next (l);
+    }
+    return true;
+}
+
+static void test_index (bool sorted)
+{
+    struct list_constraint_plan plan;
+    struct job_index *index;
+    zlistx_t *l;
+
+    if (!(index = job_index_create (inactive_cmp)))
+        BAIL_OUT ("job_index_create failed");
+    create_jobs ();
+    for (int i = 0; i < NJOBS; i++) {
+        if (job_index_add (index, jobs[i], sorted) < 0)
+            BAIL_OUT ("job_index_add failed");
+    }
+    if (!sorted)
+        job_index_sort (index);
+
+    memset (&plan, 0, sizeof (plan));
+    ok (job_index_lookup (index, &plan) == NULL,
+        "%s: lookup with unrestricted plan returns NULL",
+        sorted ? "sorted" : "unsorted");
+
+    plan.userid_set = true;
+    plan.userid = 101;
+    l = job_index_lookup (index, &plan);
+    ok (check_list (l, NJOBS / 2, &plan),
+        "%s: userid lookup returns jobs in inactive order",
+        sorted ? "sorted" : "unsorted");
+
+    plan.queue = "debug";
+    l = job_index_lookup (index, &plan);
+    ok (l && zlistx_size (l) == NJOBS / 4,
+        "%s: lookup returns smallest candidate list",
+        sorted ? "sorted" : "unsorted");
+
+    memset (&plan, 0, sizeof (plan));
+    plan.name = "nope";
+    l = job_index_lookup (index, &plan);
+    ok (l && zlistx_size (l) == 0,
+        "%s: lookup of unknown name returns empty list",
+        sorted ? "sorted" : "unsorted");
+
+    memset (&plan, 0, sizeof (plan));
+    plan.result_set = true;
+    plan.result = FLUX_JOB_RESULT_FAILED;
+    l = job_index_lookup (index, &plan);
+    ok (check_list (l, NJOBS / 2, &plan),
+        "%s: result lookup works",
+        sorted ? "sorted" : "unsorted");
+
+    /* remove every job named "foo" */
+    for (int i = 0; i < NJOBS; i += 3)
+        job_index_remove (index, jobs[i]);
+    memset (&plan, 0, sizeof (plan));
+    plan.name = "foo";
+    l = job_index_lookup (index, &plan);
+    ok (l && zlistx_size (l) == 0,
+        "%s: removed jobs are dropped from the index",
+        sorted ? "sorted" : "unsorted");
+    plan.name = "bar";
+    l = job_index_lookup (index, &plan);
+    ok (check_list (l, NJOBS / 3, &plan),
+        "%s: other jobs remain",
+        sorted ? "sorted" : "unsorted");
+
+    job_index_destroy (index);
+    destroy_jobs ();
+}
+
+/* A name or queue key of any length is indexed.
+ */
+static void test_long_key (void)
+{
+    struct list_constraint_plan plan;
+    struct job_index *index;
+    struct job *job;
+    char name[4096];
+    zlistx_t *l;
+
+    memset (name, 'x', sizeof (name) - 1);
+    name[sizeof (name) - 1] = '\0';
+    if (!(index = job_index_create (inactive_cmp))
+        || !(job = job_create (NULL, 1)))
+        BAIL_OUT ("error creating index and job");
+    job->name = name;
+    job->queue = name;
+    job->state = FLUX_JOB_STATE_INACTIVE;
+    ok (job_index_add (index, job, true) == 0,
+        "job_index_add works with a long name and queue");
+    memset (&plan, 0, sizeof (plan));
+    plan.name = name;
+    l = job_index_lookup (index, &plan);
+    ok (l && zlistx_size (l) == 1 && zlistx_first (l) == job,
+        "lookup of long name returns the job");
+    memset (&plan, 0, sizeof (plan));
+    plan.queue = name;
+    l = job_index_lookup (index, &plan);
+    ok (l && zlistx_size (l) == 1 && zlistx_first (l) == job,
+        "lookup of long queue returns the job");
+    job_index_remove (index, job);
+    l = job_index_lookup (index, &plan);
+    ok (l && zlistx_size (l) == 0,
+        "job with long queue is removed from the index");
+    job->name = NULL;
+    job->queue = NULL;
+    job_destroy (job);
+    job_index_destroy (index);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_index (true);
+    test_index (false);
+    test_long_key ();
+
+    done_testing ();
+}
+
+/*
+ * vi:ts=4 sw=4 expandtab
+ */
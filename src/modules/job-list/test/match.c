@@ -2144,6 +2144,87 @@ static void test_realworld (void)
     }
 }
 
+static void test_plan (void)
+{
+    struct list_constraint_plan plan;
+    struct list_constraint *c;
+
+    list_constraint_plan (NULL, &plan);
+    ok (!plan.userid_set
+        && !plan.name
+        && !plan.queue
+        && !plan.result_set
+        && !plan.t_inactive_set,
+        "list_constraint_plan works with NULL constraint");
+
+    c = create_list_constraint ("{ \"and\": \
+                                   [ \
+                                     { \"userid\": [ 42 ] }, \
+                                     { \"name\": [ \"foo\" ] }, \
+                                     { \"queue\": [ \"batch\" ] }, \
+                                     { \"results\": [ \"failed\" ] }, \
+                                     { \"t_inactive\": [ \">=100.0\" ] } \
+                                   ] \
+                                 }");
+    list_constraint_plan (c, &plan);
+    ok (plan.userid_set && plan.userid == 42,
+        "list_constraint_plan records userid");
+    ok (plan.name && streq (plan.name, "foo"),
+        "list_constraint_plan records name");
+    ok (plan.queue && streq (plan.queue, "batch"),
+        "list_constraint_plan records queue");
+    ok (plan.result_set && plan.result == FLUX_JOB_RESULT_FAILED,
+        "list_constraint_plan records result");
+    ok (plan.t_inactive_set
+        && plan.t_inactive == 100.0
+        && plan.t_inactive_inclusive,
+        "list_constraint_plan records inclusive t_inactive bound");
+    list_constraint_destroy (c);
+
+    c = create_list_constraint ("{ \"and\": \
+                                   [ \
+                                     { \"and\": \
+                                       [ \
+                                         { \"t_inactive\": [ \">50.0\" ] }, \
+                                         { \"t_inactive\": [ \">=50.0\" ] }, \
+                                         { \"t_inactive\": [ \">20.0\" ] }, \
+                                         { \"t_inactive\": [ \"<500.0\" ] } \
+                                       ] \
+                                     } \
+                                   ] \
+                                 }");
+    list_constraint_plan (c, &plan);
+    ok (plan.t_inactive_set
+        && plan.t_inactive == 50.0
+        && !plan.t_inactive_inclusive,
+        "list_constraint_plan keeps tightest t_inactive bound in nested and");
+    list_constraint_destroy (c);
+
+    c = create_list_constraint ("{ \"and\": \
+                                   [ \
+                                     { \"userid\": [ 42, 43 ] }, \
+                                     { \"results\": [ \"failed\", \"canceled\" ] }, \
+                                     { \"or\": [ { \"name\": [ \"foo\" ] } ] }, \
+                                     { \"not\": [ { \"queue\": [ \"batch\" ] } ] }, \
+                                     { \"t_inactive\": [ \"<=100.0\" ] } \
+                                   ] \
+                                 }");
+    list_constraint_plan (c, &plan);
+    ok (!plan.userid_set
+        && !plan.name
+        && !plan.queue
+        && !plan.result_set
+        && !plan.t_inactive_set,
+        "list_constraint_plan ignores multiple values, or, not, upper bounds");
+    list_constraint_destroy (c);
+
+    c = create_list_constraint ("{ \"userid\": [ 4294967295 ] }");
+    list_constraint_plan (c, &plan);
+    ok (!plan.userid_set,
+        "list_constraint_plan ignores FLUX_USERID_UNKNOWN");
+    list_constraint_destroy (c);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -2161,6 +2242,7 @@ int main (int argc, char *argv[])
     test_basic_timestamp ();
     test_basic_conditionals ();
     test_realworld ();
+    test_plan ();
 
     done_testing ();
 }
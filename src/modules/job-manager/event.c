@@ -27,6 +27,14 @@
  * event_job_update(), event_job_action(), and committing the event to
  * the job eventlog, in a delayed batch.
  *
+ * Batches are committed as a group commit: if no commit is in flight, the
+ * batch is committed at the end of the current reactor loop iteration, so
+ * at low load a state transition is not delayed by the batch timer.  While
+ * a commit is in flight, events accumulate in the next batch, which is
+ * committed when the in-flight commit completes, or after batch_timeout
+ * if that comes first.  The fixed timer policy may be restored with the
+ * job-manager.set-batch-timeout RPC (adaptive=false).
+ *
  * Notes:
  * - A KVS commit failure is handled as fatal to the job-manager
  * - event_job_action() is idempotent
@@ -43,8 +51,10 @@
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libeventlog/eventlog.h"
 #include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/tstat.h"
 #include "src/common/libjob/idf58.h"
 #include "ccan/ptrint/ptrint.h"
+#include "ccan/array_size/array_size.h"
 #include "ccan/str/str.h"
 
 #include "alloc.h"
@@ -60,14 +70,39 @@
 
 #include "event.h"
 
+/* Batch size (eventlog entries) and latency (seconds from the first
+ * entry to commit completion) histogram bucket upper bounds.  Values
+ * above the last bound are counted in a final overflow bucket.
+ */
+static const double size_bounds[] = {
+    1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024,
+};
+static const double latency_bounds[] = {
+    0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1,
+};
+
+#define HIST_MAX_BUCKETS 12
+
+struct hist {
+    const double *bounds;
+    int nbounds;
+    tstat_t ts;
+    int counts[HIST_MAX_BUCKETS];
+};
+
 struct event {
     struct job_manager *ctx;
     flux_msg_handler_t **handlers;
     double batch_timeout;
+    bool batch_adaptive;
     struct event_batch *batch;
     flux_watcher_t *timer;
+    flux_watcher_t *prep;
     zlist_t *pending;
     zhashx_t *evindex;
+    int commits;
+    struct hist batch_size;
+    struct hist batch_latency;
 };
 
 struct event_batch {
@@ -77,12 +112,78 @@ struct event_batch {
     json_t *state_trans;
     struct flux_msglist *responses; // responses deferred until batch complete
     zlist_t *jobs;      // jobs held until batch complete
+    double t_start;
+    int count;          // eventlog entries in txn
 };
 
 static struct event_batch *event_batch_create (struct event *event);
 static void event_batch_destroy (struct event_batch *batch);
 static int event_job_post_deferred (struct event *event, struct job *job);
 
+static void hist_init (struct hist *h, const double *bounds, int nbounds)
+{
+    memset (h, 0, sizeof (*h));
+    h->bounds = bounds;
+    h->nbounds = nbounds;
+}
+
+static void hist_push (struct hist *h, double value)
+{
+    int i = 0;
+
+    while (i < h->nbounds && value > h->bounds[i])
+        i++;
+    h->counts[i]++;
+    tstat_push (&h->ts, value);
+}
+
+static json_t *hist_encode (struct hist *h)
+{
+    json_t *bounds = NULL;
+    json_t *counts = NULL;
+    json_t *o;
+
+    if (!(bounds = json_array ()) || !(counts = json_array ()))
+        goto nomem;
+    for (int i = 0; i < h->nbounds; i++) {
+        if (json_array_append_new (bounds, json_real (h->bounds[i])) < 0)
+            goto nomem;
+    }
+    for (int i = 0; i <= h->nbounds; i++) {
+        if (json_array_append_new (counts, json_integer (h->counts[i])) < 0)
+            goto nomem;
+    }
+    if (!(o = json_pack ("{s:i s:f s:f s:f s:O s:O}",
+                         "count", tstat_count (&h->ts),
+                         "min", tstat_min (&h->ts),
+                         "mean", tstat_mean (&h->ts),
+                         "max", tstat_max (&h->ts),
+                         "bounds", bounds,
+                         "counts", counts)))
+        goto nomem;
+    json_decref (bounds);
+    json_decref (counts);
+    return o;
+nomem:
+    json_decref (bounds);
+    json_decref (counts);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/* A batch may be committed without waiting for the timer if adaptive
+ * batching is on and no commit is in flight.  A batch with no KVS
+ * transaction is never held.
+ */
+static bool event_batch_ready (struct event *event)
+{
+    struct event_batch *batch = event->batch;
+
+    if (!batch || !event->batch_adaptive)
+        return false;
+    return !batch->txn || zlist_size (event->pending) == 0;
+}
+
 /* Batch commit has completed.
  * If there was a commit error, log it and stop the reactor.
  * Destroy 'batch'.
@@ -97,8 +198,16 @@ static void commit_continuation (flux_future_t *f, void *arg)
         flux_log_error (ctx->h, "%s: eventlog update failed", __FUNCTION__);
         flux_reactor_stop_error (flux_get_reactor (ctx->h));
     }
+    hist_push (&event->batch_latency,
+               flux_reactor_now (flux_get_reactor (ctx->h)) - batch->t_start);
     zlist_remove (event->pending, batch);
     event_batch_destroy (batch);
+
+    /* Commit the batch that accumulated while this one was in flight
+     * at the end of this loop iteration.
+     */
+    if (event_batch_ready (event))
+        flux_watcher_start (event->prep);
 }
 
 /* Close the current batch, if any, and commit it.
@@ -108,9 +217,13 @@ static void event_batch_commit (struct event *event)
     struct event_batch *batch = event->batch;
     struct job_manager *ctx = event->ctx;
 
+    flux_watcher_stop (event->timer);
+    flux_watcher_stop (event->prep);
     if (batch) {
         event->batch = NULL;
         if (batch->txn) {
+            hist_push (&event->batch_size, batch->count);
+            event->commits++;
             if (!(batch->f = flux_kvs_commit (ctx->h, NULL, 0, batch->txn)))
                 goto error;
             if (flux_future_then (batch->f, -1., commit_continuation, batch) < 0)
@@ -137,6 +250,20 @@ static void timer_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *a
     event_batch_commit (ctx->event);
 }
 
+/* Runs before the reactor blocks, after all the callbacks of this loop
+ * iteration have had a chance to add to the batch.  Committing may post
+ * deferred events that start a new batch, so repeat while ready.
+ */
+static void prep_cb (flux_reactor_t *r, flux_watcher_t *w, int revents, void *arg)
+{
+    struct job_manager *ctx = arg;
+    struct event *event = ctx->event;
+
+    flux_watcher_stop (w);
+    while (event_batch_ready (event))
+        event_batch_commit (event);
+}
+
 /* Besides cleaning up, this function has the following side effects:
  * - send listener responses (only under error scenarios, should be
  *   sent in event_batch_commit()).
@@ -195,8 +322,11 @@ static int event_batch_start (struct event *event)
     if (!event->batch) {
         if (!(event->batch = event_batch_create (event)))
             return -1;
+        event->batch->t_start = flux_reactor_now (flux_get_reactor (event->ctx->h));
         flux_timer_watcher_reset (event->timer, event->batch_timeout, 0.);
         flux_watcher_start (event->timer);
+        if (event->batch_adaptive)
+            flux_watcher_start (event->prep);
     }
     return 0;
 }
@@ -224,6 +354,7 @@ static int event_batch_commit_event (struct event *event,
         return -1;
     }
     free (entrystr);
+    event->batch->count++;
     return 0;
 }
 
@@ -945,7 +1076,6 @@ void event_ctx_destroy (struct event *event)
 {
     if (event) {
         int saved_errno = errno;
-        flux_watcher_destroy (event->timer);
         flux_msg_handler_delvec (event->handlers);
         event_batch_commit (event);
         if (event->pending) {
@@ -954,6 +1084,8 @@ void event_ctx_destroy (struct event *event)
                 event_batch_destroy (batch);
         }
         zlist_destroy (&event->pending);
+        flux_watcher_destroy (event->timer);
+        flux_watcher_destroy (event->prep);
         zhashx_destroy (&event->evindex);
         free (event);
         errno = saved_errno;
@@ -966,12 +1098,17 @@ static void set_timeout_cb (flux_t *h,
                             void *arg)
 {
     struct event *event = arg;
+    double timeout;
+    int adaptive = event->batch_adaptive;
 
     if (flux_request_unpack (msg,
                              NULL,
-                             "{s:F}",
-                             "timeout", &event->batch_timeout) < 0)
+                             "{s:F s?b}",
+                             "timeout", &timeout,
+                             "adaptive", &adaptive) < 0)
         goto error;
+    event->batch_timeout = timeout;
+    event->batch_adaptive = adaptive ? true : false;
     if (flux_respond (h, msg, NULL) < 0)
         goto error;
     return;
@@ -997,12 +1134,21 @@ struct event *event_ctx_create (struct job_manager *ctx)
         return NULL;
     event->ctx = ctx;
     event->batch_timeout = 0.01;
+    event->batch_adaptive = true;
+    hist_init (&event->batch_size, size_bounds, ARRAY_SIZE (size_bounds));
+    hist_init (&event->batch_latency,
+               latency_bounds,
+               ARRAY_SIZE (latency_bounds));
     if (!(event->timer = flux_timer_watcher_create (flux_get_reactor (ctx->h),
                                                     0.,
                                                     0.,
                                                     timer_cb,
                                                     ctx)))
         goto error;
+    if (!(event->prep = flux_prepare_watcher_create (flux_get_reactor (ctx->h),
+                                                     prep_cb,
+                                                     ctx)))
+        goto error;
     if (!(event->pending = zlist_new ()))
         goto nomem;
     if (!(event->evindex = zhashx_new ()))
@@ -1018,6 +1164,34 @@ error:
     return NULL;
 }
 
+json_t *event_get_stats (struct event *event)
+{
+    json_t *size;
+    json_t *latency = NULL;
+    json_t *o;
+
+    if (!(size = hist_encode (&event->batch_size))
+        || !(latency = hist_encode (&event->batch_latency)))
+        goto error;
+    if (!(o = json_pack ("{s:b s:f s:i s:i s:O s:O}",
+                         "adaptive", event->batch_adaptive,
+                         "timeout", event->batch_timeout,
+                         "commits", event->commits,
+                         "inflight", (int)zlist_size (event->pending),
+                         "size", size,
+                         "latency", latency))) {
+        errno = ENOMEM;
+        goto error;
+    }
+    json_decref (size);
+    json_decref (latency);
+    return o;
+error:
+    ERRNO_SAFE_WRAP (json_decref, size);
+    ERRNO_SAFE_WRAP (json_decref, latency);
+    return NULL;
+}
+
 int event_index (struct event *event, const char *name)
 {
     void *entry = zhashx_lookup (event->evindex, name);
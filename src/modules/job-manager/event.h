@@ -75,6 +75,10 @@ int event_job_post_entry (struct event *event,
                           int flags,
                           json_t *entry);
 
+/* Return eventlog batch commit statistics.  Caller must json_decref().
+ */
+json_t *event_get_stats (struct event *event);
+
 void event_ctx_destroy (struct event *event);
 struct event *event_ctx_create (struct job_manager *ctx);
 
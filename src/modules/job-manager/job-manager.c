@@ -89,7 +89,9 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
     struct flux_msg_cred cred;
     json_t *journal = journal_get_stats (ctx->journal);
     json_t *housekeeping = housekeeping_get_stats (ctx->housekeeping);
-    if (!housekeeping || !journal)
+    json_t *jobtap = jobtap_get_stats (ctx->jobtap);
+    json_t *batch = event_get_stats (ctx->event);
+    if (!housekeeping || !journal || !jobtap || !batch)
         goto error;
     if (flux_msg_get_cred (msg, &cred) < 0)
         goto error;
@@ -99,21 +101,27 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
     }
     if (flux_respond_pack (h,
                            msg,
-                           "{s:O s:i s:i s:I s:O}",
+                           "{s:O s:i s:i s:I s:O s:O s:O}",
                            "journal", journal,
                            "active_jobs", zhashx_size (ctx->active_jobs),
                            "inactive_jobs", zhashx_size (ctx->inactive_jobs),
                            "max_jobid", ctx->max_jobid,
-                           "housekeeping", housekeeping) < 0) {
+                           "housekeeping", housekeeping,
+                           "jobtap", jobtap,
+                           "eventlog_batch", batch) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
         goto error;
     }
+    json_decref (batch);
+    json_decref (jobtap);
     json_decref (housekeeping);
     json_decref (journal);
     return;
  error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+    json_decref (batch);
+    json_decref (jobtap);
     json_decref (housekeeping);
     json_decref (journal);
 }
@@ -138,6 +138,10 @@ int jobtap_notify_subscribers (struct jobtap *jobtap,
                                const char *fmt,
                                ...);
 
+/*  Return per-topic plugin call counts and latency for stats-get.
+ */
+json_t *jobtap_get_stats (struct jobtap *jobtap);
+
 #endif /* _FLUX_JOB_MANAGER_JOBTAP_H */
 
 /*
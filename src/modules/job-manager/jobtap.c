@@ -31,6 +31,7 @@
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/aux.h"
+#include "src/common/libutil/monotime.h"
 #include "src/common/libjob/idf58.h"
 #include "ccan/str/str.h"
 
@@ -88,9 +89,16 @@ struct jobtap {
     zhashx_t *plugins_byuuid;
     zlistx_t *jobstack;
     json_t *jobspec_update;
+    zhashx_t *topic_stats;
     bool configured;
 };
 
+struct topic_stats {
+    uint64_t calls;
+    double total_time;
+    double max_time;
+};
+
 struct dependency {
     bool add;
     char *description;
@@ -111,6 +119,7 @@ static int jobtap_check_dependency (struct jobtap *jobtap,
                                     flux_plugin_t *p,
                                     struct job *job,
                                     flux_plugin_arg_t *args,
+                                    int *fieldsp,
                                     int index,
                                     json_t *entry,
                                     flux_error_t *errp);
@@ -129,6 +138,15 @@ static void plugin_destroy (void **item)
     }
 }
 
+/*  zhashx_t topic_stats destructor */
+static void topic_stats_destroy (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
 static void jobtap_builtin_ex_destroy (struct jobtap_builtin_ex *ex)
 {
     if (ex) {
@@ -175,36 +193,85 @@ static const char *jobtap_plugin_name (flux_plugin_t *p)
     return "unknown";
 }
 
-static flux_plugin_arg_t *jobtap_args_create (struct jobtap *jobtap,
-                                              struct job *job)
+/*  Return the FLUX_JOBTAP_ARG_* fields declared by plugin 'p' with
+ *   flux_jobtap_set_args(), or all fields if none were declared.
+ */
+static int plugin_args_fields (flux_plugin_t *p)
+{
+    int *fields;
+    if (!p || !(fields = flux_plugin_aux_get (p, "jobtap::args")))
+        return FLUX_JOBTAP_ARG_ALL;
+    return *fields;
+}
+
+static int args_set (json_t *o, const char *key, json_t *val)
+{
+    return json_object_set_new (o, key, val);
+}
+
+/*  Pack the job data in 'want' that is not already in 'args' (per
+ *   '*fieldsp'), then update '*fieldsp'.
+ */
+static int jobtap_args_add (flux_plugin_arg_t *args,
+                            struct job *job,
+                            int *fieldsp,
+                            int want)
+{
+    int missing = want & ~*fieldsp;
+    json_t *o;
+
+    if (missing == 0)
+        return 0;
+    if (!(o = json_object ()))
+        goto nomem;
+    if (((missing & FLUX_JOBTAP_ARG_JOBSPEC) && job->jobspec_redacted
+         && args_set (o, "jobspec", json_incref (job->jobspec_redacted)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_R) && job->R_redacted
+            && args_set (o, "R", json_incref (job->R_redacted)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_END_EVENT) && job->end_event
+            && args_set (o, "end_event", json_incref (job->end_event)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_USERID)
+            && args_set (o, "userid", json_integer (job->userid)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_URGENCY)
+            && args_set (o, "urgency", json_integer (job->urgency)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_STATE)
+            && args_set (o, "state", json_integer (job->state)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_PRIORITY)
+            && args_set (o, "priority", json_integer (job->priority)) < 0)
+        || ((missing & FLUX_JOBTAP_ARG_T_SUBMIT)
+            && args_set (o, "t_submit", json_real (job->t_submit)) < 0))
+        goto nomem;
+    if (flux_plugin_arg_pack (args, FLUX_PLUGIN_ARG_IN, "O", o) < 0) {
+        json_decref (o);
+        return -1;
+    }
+    json_decref (o);
+    *fieldsp |= missing;
+    return 0;
+nomem:
+    json_decref (o);
+    errno = ENOMEM;
+    return -1;
+}
+
+/*  Create args for 'job' containing the job id and the job data in
+ *   'fields'.  The caller tracks which fields are present in '*fieldsp'
+ *   so that more may be added with jobtap_args_add() as needed.
+ */
+static flux_plugin_arg_t *jobtap_args_create_fields (struct job *job,
+                                                     int fields,
+                                                     int *fieldsp)
 {
     flux_plugin_arg_t *args = flux_plugin_arg_create ();
     if (!args)
         return NULL;
 
+    *fieldsp = 0;
     if (flux_plugin_arg_pack (args,
                               FLUX_PLUGIN_ARG_IN,
-                              "{s:O s:I s:I s:i s:i s:I s:f}",
-                              "jobspec", job->jobspec_redacted,
-                              "id", job->id,
-                              "userid", (json_int_t) job->userid,
-                              "urgency", job->urgency,
-                              "state", job->state,
-                              "priority", job->priority,
-                              "t_submit", job->t_submit) < 0)
-        goto error;
-    if (job->R_redacted) {
-        if (flux_plugin_arg_pack (args,
-                                  FLUX_PLUGIN_ARG_IN,
-                                  "{s:O}",
-                                  "R", job->R_redacted) < 0)
-            goto error;
-    }
-    if (job->end_event)
-        if (flux_plugin_arg_pack (args,
-                                  FLUX_PLUGIN_ARG_IN,
-                                  "{s:O}",
-                                  "end_event", job->end_event) < 0)
+                              "{s:I}",
+                              "id", job->id) < 0
+        || jobtap_args_add (args, job, fieldsp, fields) < 0)
         goto error;
     /*
      *  Always start with empty OUT args. This allows unpack of OUT
@@ -220,12 +287,23 @@ error:
     return NULL;
 }
 
+static flux_plugin_arg_t *jobtap_args_create (struct jobtap *jobtap,
+                                              struct job *job)
+{
+    int fields;
+    return jobtap_args_create_fields (job, FLUX_JOBTAP_ARG_ALL, &fields);
+}
+
+/*  Create args with only the job id and callback specific args from
+ *   'fmt'.  Job data is added by jobtap_stack_call() as plugins need it.
+ */
 static flux_plugin_arg_t *jobtap_args_vcreate (struct jobtap *jobtap,
                                                struct job *job,
+                                               int *fieldsp,
                                                const char *fmt,
                                                va_list ap)
 {
-    flux_plugin_arg_t *args = jobtap_args_create (jobtap, job);
+    flux_plugin_arg_t *args = jobtap_args_create_fields (job, 0, fieldsp);
     if (!args)
         return NULL;
 
@@ -268,6 +346,7 @@ static int plugin_check_dependencies (struct jobtap *jobtap,
                                      p,
                                      job,
                                      args,
+                                     NULL,
                                      index,
                                      entry,
                                      &error) < 0) {
@@ -377,6 +456,48 @@ int flux_jobtap_set_load_sort_order (flux_plugin_t *p, const char *mode)
     return 0;
 }
 
+int flux_jobtap_set_args (flux_plugin_t *p, int fields)
+{
+    int *val;
+
+    if (!p
+        || !flux_plugin_aux_get (p, "flux::jobtap")
+        || (fields & ~FLUX_JOBTAP_ARG_ALL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(val = malloc (sizeof (*val))))
+        return -1;
+    *val = fields;
+    if (flux_plugin_aux_set (p, "jobtap::args", val, free) < 0) {
+        ERRNO_SAFE_WRAP (free, val);
+        return -1;
+    }
+    return 0;
+}
+
+int flux_jobtap_get_jobinfo (flux_plugin_t *p,
+                             struct flux_jobtap_jobinfo *info)
+{
+    struct jobtap *jobtap;
+    struct job *job;
+
+    if (!p
+        || !info
+        || !(jobtap = flux_plugin_aux_get (p, "flux::jobtap"))
+        || !(job = current_job (jobtap))) {
+        errno = EINVAL;
+        return -1;
+    }
+    info->id = job->id;
+    info->userid = job->userid;
+    info->urgency = job->urgency;
+    info->state = job->state;
+    info->priority = job->priority;
+    info->t_submit = job->t_submit;
+    return 0;
+}
+
 static flux_plugin_t * jobtap_load_plugin (struct jobtap *jobtap,
                                            const char *path,
                                            json_t *conf,
@@ -386,6 +507,7 @@ static flux_plugin_t * jobtap_load_plugin (struct jobtap *jobtap,
     const char *sort_mode = NULL;
     flux_plugin_t *p = NULL;
     flux_plugin_arg_t *args;
+    int fields;
     zlistx_t *jobs = NULL;
     struct job *job;
 
@@ -409,7 +531,9 @@ static flux_plugin_t * jobtap_load_plugin (struct jobtap *jobtap,
             errprintf (errp, "Out of memory adding to jobtap jobstack");
             goto error;
         }
-        if (!(args = jobtap_args_create (jobtap, job))) {
+        if (!(args = jobtap_args_create_fields (job,
+                                                plugin_args_fields (p),
+                                                &fields))) {
             errprintf (errp, "Failed to create args for job");
             goto error;
         }
@@ -700,6 +824,7 @@ struct jobtap *jobtap_create (struct job_manager *ctx)
         goto error;
     if (!(jobtap->plugins = zlistx_new ())
         || !(jobtap->plugins_byuuid = zhashx_new ())
+        || !(jobtap->topic_stats = zhashx_new ())
         || !(jobtap->jobstack = zlistx_new ())
         || !(jobtap->builtins_ex = zlistx_new ())) {
         errno = ENOMEM;
@@ -712,6 +837,7 @@ struct jobtap *jobtap_create (struct job_manager *ctx)
     zlistx_set_destructor (jobtap->jobstack, job_destructor);
     zlistx_set_duplicator (jobtap->jobstack, job_duplicator);
     zlistx_set_destructor (jobtap->builtins_ex, builtin_ex_destructor);
+    zhashx_set_destructor (jobtap->topic_stats, topic_stats_destroy);
 
 
     if (load_builtins (jobtap) < 0) {
@@ -740,6 +866,7 @@ void jobtap_destroy (struct jobtap *jobtap)
         conf_unregister_callback (jobtap->ctx->conf, jobtap_parse_config);
         zlistx_destroy (&jobtap->plugins);
         zhashx_destroy (&jobtap->plugins_byuuid);
+        zhashx_destroy (&jobtap->topic_stats);
         zlistx_destroy (&jobtap->jobstack);
         zlistx_destroy (&jobtap->builtins_ex);
         jobtap->ctx = NULL;
@@ -787,14 +914,63 @@ static int jobtap_post_jobspec_updates (struct jobtap *jobtap,
     return rc;
 }
 
+static void topic_stats_update (struct jobtap *jobtap,
+                                const char *topic,
+                                double t)
+{
+    struct topic_stats *stats;
+
+    if (!(stats = zhashx_lookup (jobtap->topic_stats, topic))) {
+        if (!(stats = calloc (1, sizeof (*stats))))
+            return;
+        (void) zhashx_insert (jobtap->topic_stats, topic, stats);
+    }
+    stats->calls++;
+    stats->total_time += t;
+    if (t > stats->max_time)
+        stats->max_time = t;
+}
+
+json_t *jobtap_get_stats (struct jobtap *jobtap)
+{
+    json_t *topics;
+    struct topic_stats *stats;
+
+    if (!(topics = json_object ()))
+        goto nomem;
+    stats = zhashx_first (jobtap->topic_stats);
+    while (stats) {
+        const char *topic = zhashx_cursor (jobtap->topic_stats);
+        json_t *o;
+        if (!(o = json_pack ("{s:I s:f s:f}",
+                             "calls", (json_int_t) stats->calls,
+                             "total_time", stats->total_time,
+                             "max_time", stats->max_time))
+            || json_object_set_new (topics, topic, o) < 0)
+            goto nomem;
+        stats = zhashx_next (jobtap->topic_stats);
+    }
+    return topics;
+nomem:
+    json_decref (topics);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/*  Call 'topic' on each plugin in 'plugins'.  If 'fieldsp' is non-NULL,
+ *   it holds the FLUX_JOBTAP_ARG_* fields present in 'args', and job data
+ *   is added before each matching plugin is called as that plugin needs it.
+ */
 static int jobtap_stack_call (struct jobtap *jobtap,
                               zlistx_t *plugins,
                               struct job *job,
                               const char *topic,
-                              flux_plugin_arg_t *args)
+                              flux_plugin_arg_t *args,
+                              int *fieldsp)
 {
     int retcode = 0;
     flux_plugin_t *p = NULL;
+    struct timespec t0;
 
     /* Duplicate list to make jobtap_stack_call reentrant */
     zlistx_t *l = zlistx_dup (plugins);
@@ -807,9 +983,25 @@ static int jobtap_stack_call (struct jobtap *jobtap,
         return -1;
     }
 
+    monotime (&t0);
     p = zlistx_first (l);
     while (p) {
-        int rc = flux_plugin_call (p, topic, args);
+        int rc;
+        if (fieldsp
+            && (plugin_args_fields (p) & ~*fieldsp)
+            && flux_plugin_match_handler (p, topic)
+            && jobtap_args_add (args,
+                                job,
+                                fieldsp,
+                                plugin_args_fields (p)) < 0) {
+            flux_log_error (jobtap->ctx->h,
+                            "jobtap: %s: %s: failed to create plugin args",
+                            jobtap_plugin_name (p),
+                            topic);
+            retcode = -1;
+            break;
+        }
+        rc = flux_plugin_call (p, topic, args);
         if (rc < 0)  {
             flux_log (jobtap->ctx->h,
                       LOG_DEBUG,
@@ -836,6 +1028,8 @@ static int jobtap_stack_call (struct jobtap *jobtap,
         p = zlistx_next (l);
     }
     zlistx_destroy (&l);
+    if (retcode != 0)
+        topic_stats_update (jobtap, topic, monotime_since (t0) / 1000.);
     if (current_job_pop (jobtap) < 0)
         return -1;
     return retcode;
@@ -847,6 +1041,7 @@ int jobtap_get_priority (struct jobtap *jobtap,
 {
     int rc = -1;
     flux_plugin_arg_t *args;
+    int fields;
     int64_t priority = FLUX_JOBTAP_PRIORITY_UNAVAIL;
 
     if (!jobtap || !job || !pprio) {
@@ -854,14 +1049,15 @@ int jobtap_get_priority (struct jobtap *jobtap,
         return -1;
     }
 
-    if (!(args = jobtap_args_create (jobtap, job)))
+    if (!(args = jobtap_args_create_fields (job, 0, &fields)))
         return -1;
 
     rc = jobtap_stack_call (jobtap,
                             jobtap->plugins,
                             job,
                             "job.priority.get",
-                            args);
+                            args,
+                            &fields);
 
     if (rc >= 1) {
         /*
@@ -927,18 +1123,20 @@ static int jobtap_call_early (struct jobtap *jobtap,
 {
     int rc;
     flux_plugin_arg_t *args;
+    int fields;
     const char *errmsg = NULL;
 
     if (jobtap_topic_match_count (jobtap, topic) == 0)
         return 0;
-    if (!(args = jobtap_args_create (jobtap, job)))
+    if (!(args = jobtap_args_create_fields (job, 0, &fields)))
         return -1;
 
     rc = jobtap_stack_call (jobtap,
                             jobtap->plugins,
                             job,
                             topic,
-                            args);
+                            args,
+                            &fields);
 
     if (rc < 0) {
         /*
@@ -1006,6 +1204,7 @@ static int jobtap_check_dependency (struct jobtap *jobtap,
                                     flux_plugin_t *p,
                                     struct job *job,
                                     flux_plugin_arg_t *args,
+                                    int *fieldsp,
                                     int index,
                                     json_t *entry,
                                     flux_error_t *errp)
@@ -1043,7 +1242,12 @@ static int jobtap_check_dependency (struct jobtap *jobtap,
     if (p)
         rc = flux_plugin_call (p, topic, args);
     else
-        rc = jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+        rc = jobtap_stack_call (jobtap,
+                                jobtap->plugins,
+                                job,
+                                topic,
+                                args,
+                                fieldsp);
 
     if (rc == 0) {
         /*  No handler for job.dependency.<scheme>. return an error.
@@ -1114,6 +1318,7 @@ int jobtap_check_dependencies (struct jobtap *jobtap,
 {
     int rc = -1;
     flux_plugin_arg_t *args = NULL;
+    int fields;
     json_t *dependencies = NULL;
     json_t *entry;
     size_t index;
@@ -1122,7 +1327,7 @@ int jobtap_check_dependencies (struct jobtap *jobtap,
         || dependencies == NULL)
         return rc;
 
-    if (!(args = jobtap_args_create (jobtap, job))) {
+    if (!(args = jobtap_args_create_fields (job, 0, &fields))) {
         errprintf (errp,
                    "jobtap_check_dependencies: failed to create args");
         return -1;
@@ -1133,6 +1338,7 @@ int jobtap_check_dependencies (struct jobtap *jobtap,
                                       NULL,
                                       job,
                                       args,
+                                      &fields,
                                       index,
                                       entry,
                                       errp);
@@ -1163,6 +1369,7 @@ int jobtap_notify_subscribers (struct jobtap *jobtap,
                                ...)
 {
     flux_plugin_arg_t *args;
+    int fields;
     char topic [64];
     int topiclen = 64;
     va_list ap;
@@ -1181,7 +1388,7 @@ int jobtap_notify_subscribers (struct jobtap *jobtap,
     }
 
     va_start (ap, fmt);
-    args = jobtap_args_vcreate (jobtap, job, fmt, ap);
+    args = jobtap_args_vcreate (jobtap, job, &fields, fmt, ap);
     va_end (ap);
     if (!args) {
         flux_log (jobtap->ctx->h,
@@ -1192,7 +1399,12 @@ int jobtap_notify_subscribers (struct jobtap *jobtap,
         return -1;
     }
 
-    rc = jobtap_stack_call (jobtap, job->subscribers, job, topic, args);
+    rc = jobtap_stack_call (jobtap,
+                            job->subscribers,
+                            job,
+                            topic,
+                            args,
+                            &fields);
     flux_plugin_arg_destroy (args);
     return rc;
 }
@@ -1207,6 +1419,7 @@ int jobtap_call (struct jobtap *jobtap,
     json_t *note = NULL;
     json_t *R = NULL;
     flux_plugin_arg_t *args;
+    int fields;
     int64_t priority = FLUX_JOBTAP_PRIORITY_UNAVAIL;
     va_list ap;
 
@@ -1214,7 +1427,7 @@ int jobtap_call (struct jobtap *jobtap,
         return 0;
 
     va_start (ap, fmt);
-    if (!(args = jobtap_args_vcreate (jobtap, job, fmt, ap))) {
+    if (!(args = jobtap_args_vcreate (jobtap, job, &fields, fmt, ap))) {
         flux_log (jobtap->ctx->h,
                   LOG_ERR,
                   "jobtap: %s: %s: failed to create plugin args",
@@ -1226,7 +1439,12 @@ int jobtap_call (struct jobtap *jobtap,
     if (!args)
         return -1;
 
-    rc = jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+    rc = jobtap_stack_call (jobtap,
+                            jobtap->plugins,
+                            job,
+                            topic,
+                            args,
+                            &fields);
     if (rc < 0) {
         flux_log (jobtap->ctx->h,
                   LOG_ERR,
@@ -2609,13 +2827,14 @@ int jobtap_job_update (struct jobtap *jobtap,
     char topic[128];
     int topiclen = sizeof (topic);
     flux_plugin_arg_t *args = NULL;
+    int fields;
 
     if (snprintf (topic, topiclen, "job.update.%s", key) >= topiclen) {
         errprintf (errp, "topic string overflow");
         return -1;
     }
 
-    if (!(args = jobtap_args_create (jobtap, job))
+    if (!(args = jobtap_args_create_fields (job, 0, &fields))
         || flux_plugin_arg_pack (args,
                                  FLUX_PLUGIN_ARG_IN,
                                  "{s:{s:I s:I} s:s s:O}",
@@ -2629,7 +2848,12 @@ int jobtap_job_update (struct jobtap *jobtap,
         flux_plugin_arg_destroy (args);
         return -1;
     }
-    rc = jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+    rc = jobtap_stack_call (jobtap,
+                            jobtap->plugins,
+                            job,
+                            topic,
+                            args,
+                            &fields);
     if (rc == 0) {
         /* No plugin handles update of this jobspec key, reject the update.
          */
@@ -2697,15 +2921,17 @@ int jobtap_validate_updates (struct jobtap *jobtap,
     int rc = -1;
     json_t *jobspec_updated = NULL;
     flux_plugin_arg_t *args = NULL;
+    int fields;
 
     if (!(jobspec_updated = job_jobspec_with_updates (job, updates))) {
         errprintf (errp, "update: %s", strerror (errno));
         goto error;
     }
 
-    /*  Create plugin args, then override jobspec with updated version
+    /*  Create plugin args with the updated jobspec in place of the
+     *  current one.
      */
-    if (!(args = jobtap_args_create (jobtap, job))
+    if (!(args = jobtap_args_create_fields (job, 0, &fields))
         || flux_plugin_arg_pack (args,
                                  FLUX_PLUGIN_ARG_IN,
                                  "{s:O}",
@@ -2714,6 +2940,7 @@ int jobtap_validate_updates (struct jobtap *jobtap,
                    flux_plugin_arg_strerror (args));
         goto error;
     }
+    fields |= FLUX_JOBTAP_ARG_JOBSPEC;
 
     /*  Call validation stack
      */
@@ -2721,7 +2948,8 @@ int jobtap_validate_updates (struct jobtap *jobtap,
                             jobtap->plugins,
                             job,
                             "job.validate",
-                            args);
+                            args,
+                            &fields);
 
     if (rc < 0) {
         const char *errmsg;
@@ -2762,7 +2990,12 @@ int flux_jobtap_call (flux_plugin_t *p,
     }
     if (!(job = jobtap_lookup_jobid (p, id)))
         return -1;
-    return jobtap_stack_call (jobtap, jobtap->plugins, job, topic, args);
+    return jobtap_stack_call (jobtap,
+                              jobtap->plugins,
+                              job,
+                              topic,
+                              args,
+                              NULL);
 }
 
 /*
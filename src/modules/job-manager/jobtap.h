@@ -56,6 +56,50 @@ int flux_jobtap_service_register_ex (flux_plugin_t *p,
  */
 int flux_jobtap_set_load_sort_order (flux_plugin_t *p, const char *mode);
 
+/*  Job data that may be passed to job callbacks in FLUX_PLUGIN_ARG_IN.
+ *   The job id and any callback specific arguments (e.g. prev_state,
+ *   entry, dependency) are always passed.
+ */
+enum {
+    FLUX_JOBTAP_ARG_JOBSPEC =   0x01,
+    FLUX_JOBTAP_ARG_R =         0x02,
+    FLUX_JOBTAP_ARG_END_EVENT = 0x04,
+    FLUX_JOBTAP_ARG_USERID =    0x08,
+    FLUX_JOBTAP_ARG_URGENCY =   0x10,
+    FLUX_JOBTAP_ARG_STATE =     0x20,
+    FLUX_JOBTAP_ARG_PRIORITY =  0x40,
+    FLUX_JOBTAP_ARG_T_SUBMIT =  0x80,
+    FLUX_JOBTAP_ARG_ALL =       0xff,
+};
+
+/*  Declare the job data read by this plugin's job callbacks, a mask of
+ *   FLUX_JOBTAP_ARG_* values, so that the job manager may skip packing
+ *   args that no plugin in the stack needs.  Plugins that do not call
+ *   this function receive all job data.  Args requested by other plugins
+ *   may still be present.  Call from flux_plugin_init().
+ */
+int flux_jobtap_set_args (flux_plugin_t *p, int fields);
+
+/*  Scalar job data for the current job, which may be fetched from a
+ *   job callback with flux_jobtap_get_jobinfo() whether or not it was
+ *   passed in args.
+ */
+struct flux_jobtap_jobinfo {
+    flux_jobid_t id;
+    uint32_t userid;
+    int urgency;
+    flux_job_state_t state;
+    int64_t priority;
+    double t_submit;
+};
+
+/*  Fill 'info' for the current job.
+ *  Returns 0 on success, or -1 with errno set to EINVAL if there is
+ *   no current job.
+ */
+int flux_jobtap_get_jobinfo (flux_plugin_t *p,
+                             struct flux_jobtap_jobinfo *info);
+
 /*  Start a loop to re-prioritize all jobs. The plugin "priority.get"
  *   callback will be called for each job currently in SCHED or
  *   PRIORITY states.
@@ -181,6 +181,8 @@ static int depend_cb (flux_plugin_t *p,
 
 int begin_time_plugin_init (flux_plugin_t *p)
 {
+    if (flux_jobtap_set_args (p, 0) < 0)
+        return -1;
     return flux_plugin_add_handler (p,
                                     "job.dependency.begin-time",
                                     depend_cb,
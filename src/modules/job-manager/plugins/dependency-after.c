@@ -811,6 +811,10 @@ int after_plugin_init (flux_plugin_t *p)
         reflist_destroy (global_reflist);
         return -1;
     }
+    if (flux_jobtap_set_args (p,
+                              FLUX_JOBTAP_ARG_USERID
+                              | FLUX_JOBTAP_ARG_END_EVENT) < 0)
+        return -1;
     return flux_plugin_register (p, ".dependency-after", tab);
 }
 
@@ -383,6 +383,10 @@ int singleton_plugin_init (flux_plugin_t *p)
         singleton_ctx_destroy (global_ctx);
         return -1;
     }
+    if (flux_jobtap_set_args (p,
+                              FLUX_JOBTAP_ARG_JOBSPEC
+                              | FLUX_JOBTAP_ARG_USERID) < 0)
+        return -1;
     return flux_plugin_register (p, ".dependency-singleton", tab);
 }
 
@@ -350,6 +350,10 @@ int history_plugin_init (flux_plugin_t *p)
         history_destroy (hist);
         return -1;
     }
+    if (flux_jobtap_set_args (p,
+                              FLUX_JOBTAP_ARG_USERID
+                              | FLUX_JOBTAP_ARG_T_SUBMIT) < 0)
+        return -1;
     if (flux_jobtap_service_register_ex (p,
                                          "get",
                                          FLUX_ROLE_USER,
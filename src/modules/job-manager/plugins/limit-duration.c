@@ -317,6 +317,10 @@ int limit_duration_plugin_init (flux_plugin_t *p)
         limit_duration_destroy (ctx);
         return -1;
     }
+    if (flux_jobtap_set_args (p,
+                              FLUX_JOBTAP_ARG_JOBSPEC
+                              | FLUX_JOBTAP_ARG_STATE) < 0)
+        return -1;
 
     return flux_plugin_register (p, ".limit-duration", tab);
 }
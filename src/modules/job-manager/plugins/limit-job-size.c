@@ -480,6 +480,10 @@ int limit_job_size_plugin_init (flux_plugin_t *p)
         limit_job_size_destroy (ctx);
         return -1;
     }
+    if (flux_jobtap_set_args (p,
+                              FLUX_JOBTAP_ARG_JOBSPEC
+                              | FLUX_JOBTAP_ARG_STATE) < 0)
+        return -1;
 
     return flux_plugin_register (p, ".limit-job-size", tab);
 }
@@ -28,21 +28,16 @@ static int priority_cb (flux_plugin_t *p,
                         flux_plugin_arg_t *args,
                         void *data)
 {
-    int urgency = -1;
+    struct flux_jobtap_jobinfo info;
     flux_t *h = flux_jobtap_get_flux (p);
-    if (flux_plugin_arg_unpack (args,
-                                FLUX_PLUGIN_ARG_IN,
-                                "{s:i}",
-                                "urgency", &urgency) < 0) {
-        flux_log (h, LOG_ERR,
-                 "flux_plugin_arg_unpack: %s",
-                 flux_plugin_arg_strerror (args));
+    if (flux_jobtap_get_jobinfo (p, &info) < 0) {
+        flux_log_error (h, "flux_jobtap_get_jobinfo");
         return -1;
     }
     if (flux_plugin_arg_pack (args,
                               FLUX_PLUGIN_ARG_OUT,
                              "{s:i}",
-                             "priority", urgency) < 0) {
+                             "priority", info.urgency) < 0) {
         flux_log (h, LOG_ERR,
                  "flux_plugin_arg_pack: %s",
                  flux_plugin_arg_strerror (args));
@@ -53,10 +48,11 @@ static int priority_cb (flux_plugin_t *p,
 
 int priority_default_plugin_init (flux_plugin_t *p)
 {
-    if (flux_plugin_add_handler (p,
-                                 "job.state.priority",
-                                 priority_cb,
-                                 NULL) < 0
+    if (flux_jobtap_set_args (p, 0) < 0
+        || flux_plugin_add_handler (p,
+                                    "job.state.priority",
+                                    priority_cb,
+                                    NULL) < 0
         || flux_plugin_add_handler (p,
                                     "job.priority.get",
                                     priority_cb,
@@ -85,6 +85,8 @@ int update_duration_plugin_init (flux_plugin_t *p)
                              "{s:i}",
                              "owner-allow-any",
                              &owner_allow_any);
+    if (flux_jobtap_set_args (p, FLUX_JOBTAP_ARG_STATE) < 0)
+        return -1;
     return flux_plugin_add_handler (p,
                                     "job.update.attributes.system.duration",
                                     duration_update_cb,
@@ -101,6 +101,8 @@ int validate_duration_plugin_init (flux_plugin_t *p)
     flux_future_t *f;
 
     flux_plugin_set_name (p, ".validate-duration");
+    if (flux_jobtap_set_args (p, FLUX_JOBTAP_ARG_JOBSPEC) < 0)
+        return -1;
 
     h = flux_jobtap_get_flux (p);
 
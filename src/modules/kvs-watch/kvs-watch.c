@@ -23,7 +23,9 @@
 #include "src/common/libutil/blobref.h"
 #include "src/common/libcontent/content.h"
 #include "src/common/libutil/errprintf.h"
-#include "ccan/ptrint/ptrint.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/tstat.h"
+#include "src/common/libutil/monotime.h"
 
 /* State for one watcher */
 struct watcher {
@@ -50,7 +52,10 @@ struct watcher {
     int prev_start_index;       // previous start index loaded
     int prev_end_index;         // previous end index loaded
     int loaded_blob_count;      // number of indices loaded (for FLUX_KVS_STREAM)
+    int sentinel_countdown;     // loads to complete before initial sentinel
     void *handle;               // zlistx_t handle
+    zlistx_t *index;            // nsm->watchers_full or a watchers_by_key list
+    void *index_handle;         // zlistx_t handle in 'index'
 };
 
 /* Current KVS root.
@@ -70,6 +75,15 @@ struct commit {
  * and survive entry removals.  That cannot be done with zhashx_t without
  * retrieving a costly zhashx_keys() list.  Thus, we have watchers on a list
  * and a separate hash for quick lookup access to watchers.
+ *
+ * Watchers are also indexed so that a setroot event need only visit
+ * watchers whose key is in the commit's key set.  The setroot key set
+ * holds the exact (normalized) keys written by the commit, and a watch
+ * only fires on an exact match, except FLUX_KVS_WATCH_FULL watches,
+ * which must compare the value on every commit since a change beneath
+ * a directory does not appear under the directory key.  Thus non-FULL
+ * watchers are hashed by key and FULL watchers are kept on a separate
+ * list that is visited on every commit.
  */
 struct ns_monitor {
     char *ns_name;              // namespace name, hash key for ctx->namespaces
@@ -80,12 +94,37 @@ struct ns_monitor {
     struct watch_ctx *ctx;      // back-pointer to watch_ctx
     zlistx_t *watchers;         // list of watchers of this namespace
     zhashx_t *watcher_matchtags;// matchtags -> watchers quick lookup
+    zhashx_t *watchers_by_key;  // key -> zlistx_t of non-FULL watchers
+    zlistx_t *watchers_full;    // FLUX_KVS_WATCH_FULL watchers
+    int unsynced;               // watchers that have not seen a commit yet
+    tstat_t dispatch_ts;        // setroot dispatch time (ms)
+    unsigned long visited;      // watchers visited by setroot dispatch
+    unsigned long skipped;      // watchers skipped by setroot dispatch
+    zhashx_t *shared;           // in-flight lookups/loads watchers may join
+    unsigned long lookups;      // kvs.lookup-plus requests sent
+    unsigned long lookups_shared; // lookups joined instead of sent
+    unsigned long loads;        // content.load requests sent
+    unsigned long loads_shared; // loads joined instead of sent
     char *topic;                // topic string for subscription
     bool subscribed;            // subscription active
     flux_future_t *getrootf;    // initial getroot future
     flux_future_t *eventsubf;   // for event subscription
 };
 
+/* A kvs lookup or content load that identical watchers of a namespace
+ * share, so N watchers of one key cost one request per commit.  The
+ * future is referenced from each subscriber's w->lookups or w->loads
+ * list.  Subscribers are recorded by matchtag key rather than pointer,
+ * so a watcher destroyed before the response arrives is simply skipped.
+ */
+struct shared_rpc {
+    struct watch_ctx *ctx;
+    struct ns_monitor *nsm;     // NULL once removed from nsm->shared
+    char *key;                  // hash key in nsm->shared
+    zlistx_t *subscribers;      // matchtag keys of subscribed watchers
+    flux_continuation_f cb;     // per-watcher continuation
+};
+
 /* Module state.
  */
 struct watch_ctx {
@@ -192,6 +231,9 @@ static void namespace_destroy (void **data)
         commit_destroy (nsm->commit);
         zlistx_destroy (&nsm->watchers);
         zhashx_destroy (&nsm->watcher_matchtags);
+        zhashx_destroy (&nsm->watchers_by_key);
+        zlistx_destroy (&nsm->watchers_full);
+        zhashx_destroy (&nsm->shared);
         if (nsm->subscribed) {
             flux_future_t *f;
             if (!(f = flux_event_unsubscribe_ex (nsm->ctx->h,
@@ -230,6 +272,14 @@ static struct ns_monitor *namespace_create (struct watch_ctx *ctx,
     zlistx_set_destructor (nsm->watchers, watcher_destructor);
     if (!(nsm->watcher_matchtags = zhashx_new ()))
         goto error;
+    if (!(nsm->watchers_by_key = zhashx_new ()))
+        goto error;
+    zhashx_set_destructor (nsm->watchers_by_key,
+                           (zhashx_destructor_fn *)zlistx_destroy);
+    if (!(nsm->watchers_full = zlistx_new ()))
+        goto error;
+    if (!(nsm->shared = zhashx_new ()))
+        goto error;
     if (!(nsm->ns_name = strdup (ns)))
         goto error;
     nsm->owner = FLUX_USERID_UNKNOWN;
@@ -249,10 +299,47 @@ static bool key_match (json_t *o, const char *key)
     return false;
 }
 
+/* Add watcher to the key index, or to the list of watchers visited
+ * on every commit if FLUX_KVS_WATCH_FULL.
+ */
+static int watcher_index_add (struct ns_monitor *nsm, struct watcher *w)
+{
+    zlistx_t *l;
+
+    if ((w->flags & FLUX_KVS_WATCH_FULL))
+        l = nsm->watchers_full;
+    else if (!(l = zhashx_lookup (nsm->watchers_by_key, w->key))) {
+        if (!(l = zlistx_new ()))
+            goto nomem;
+        (void)zhashx_insert (nsm->watchers_by_key, w->key, l);
+    }
+    if (!(w->index_handle = zlistx_add_end (l, w)))
+        goto nomem;
+    w->index = l;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static void watcher_index_remove (struct ns_monitor *nsm, struct watcher *w)
+{
+    if (w->index) {
+        zlistx_delete (w->index, w->index_handle);
+        if (w->index != nsm->watchers_full && zlistx_size (w->index) == 0)
+            zhashx_delete (nsm->watchers_by_key, w->key);
+        w->index = NULL;
+        w->index_handle = NULL;
+    }
+}
+
 static void watcher_cleanup (struct ns_monitor *nsm, struct watcher *w)
 {
     /* it is possible lookups & loads are in flight, they will be
      * cleaned in watcher_destroy() */
+    if (w->rootseq == -1)
+        nsm->unsynced--;
+    watcher_index_remove (nsm, w);
     zhashx_delete (nsm->watcher_matchtags, w->matchtag_key);
     zhashx_delete (nsm->ctx->namespace_matchtags, w->matchtag_key);
     zlistx_delete (nsm->watchers, w->handle);
@@ -264,6 +351,122 @@ static void watcher_cleanup (struct ns_monitor *nsm, struct watcher *w)
         zhashx_delete (nsm->ctx->namespaces, nsm->ns_name);
 }
 
+static void matchtag_key_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
+static void shared_rpc_destroy (struct shared_rpc *sr)
+{
+    if (sr) {
+        int saved_errno = errno;
+        if (sr->nsm)
+            zhashx_delete (sr->nsm->shared, sr->key);
+        zlistx_destroy (&sr->subscribers);
+        free (sr->key);
+        free (sr);
+        errno = saved_errno;
+    }
+}
+
+/* A shared lookup or load has completed.  Remove it from the namespace
+ * so no more watchers join, then run the continuation of each
+ * subscriber that still exists.  Hold a reference on 'f' since the
+ * subscribers may finish, dropping theirs, and the namespace may be
+ * destroyed along with its last watcher.
+ */
+static void shared_rpc_continuation (flux_future_t *f, void *arg)
+{
+    struct shared_rpc *sr = arg;
+    const char *mkey;
+
+    if (sr->nsm) {
+        zhashx_delete (sr->nsm->shared, sr->key);
+        sr->nsm = NULL;
+    }
+    flux_future_incref (f);
+    mkey = zlistx_first (sr->subscribers);
+    while (mkey) {
+        struct ns_monitor *nsm;
+        struct watcher *w;
+
+        if ((nsm = zhashx_lookup (sr->ctx->namespace_matchtags, mkey))
+            && (w = zhashx_lookup (nsm->watcher_matchtags, mkey)))
+            sr->cb (f, w);
+        mkey = zlistx_next (sr->subscribers);
+    }
+    flux_future_decref (f);
+}
+
+static int shared_rpc_subscribe (struct shared_rpc *sr, struct watcher *w)
+{
+    if (!zlistx_add_end (sr->subscribers, w->matchtag_key)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* Make 'f' joinable by other watchers of 'nsm' under 'key', and
+ * subscribe 'w' to it.  On success, 'cb' is called for each subscriber
+ * once 'f' is fulfilled.
+ */
+static int shared_rpc_start (struct ns_monitor *nsm,
+                             flux_future_t *f,
+                             const char *key,
+                             struct watcher *w,
+                             flux_continuation_f cb)
+{
+    struct shared_rpc *sr;
+
+    if (!(sr = calloc (1, sizeof (*sr))))
+        return -1;
+    sr->ctx = nsm->ctx;
+    sr->cb = cb;
+    if (!(sr->key = strdup (key))
+        || !(sr->subscribers = zlistx_new ())) {
+        shared_rpc_destroy (sr);
+        errno = ENOMEM;
+        return -1;
+    }
+    zlistx_set_duplicator (sr->subscribers, (zlistx_duplicator_fn *)strdup);
+    zlistx_set_destructor (sr->subscribers, matchtag_key_destructor);
+    if (shared_rpc_subscribe (sr, w) < 0
+        || flux_future_aux_set (f,
+                                "kvs-watch::shared",
+                                sr,
+                                (flux_free_f)shared_rpc_destroy) < 0) {
+        shared_rpc_destroy (sr);
+        return -1;
+    }
+    if (flux_future_then (f, -1., shared_rpc_continuation, sr) < 0)
+        return -1;
+    if (zhashx_insert (nsm->shared, sr->key, f) == 0)
+        sr->nsm = nsm;
+    return 0;
+}
+
+/* Join an in-flight lookup or load shared under 'key', if any.
+ * Return a new reference on its future, or NULL if there is none.
+ */
+static flux_future_t *shared_rpc_join (struct ns_monitor *nsm,
+                                       const char *key,
+                                       struct watcher *w)
+{
+    flux_future_t *f;
+    struct shared_rpc *sr;
+
+    if (!(f = zhashx_lookup (nsm->shared, key))
+        || !(sr = flux_future_aux_get (f, "kvs-watch::shared"))
+        || shared_rpc_subscribe (sr, w) < 0)
+        return NULL;
+    flux_future_incref (f);
+    return f;
+}
+
 static void send_initial_sentinel (flux_t *h, struct watcher *w)
 {
     if (w->flags & FLUX_KVS_WATCH_INITIAL_SENTINEL
@@ -303,7 +506,7 @@ static void handle_load_response (flux_future_t *f, struct watcher *w)
         w->loaded_blob_count++;
         w->responded = true;
 
-        if (flux_future_aux_get (f, "initial_sentinel"))
+        if (w->sentinel_countdown > 0 && --w->sentinel_countdown == 0)
             send_initial_sentinel (h, w);
     }
 
@@ -357,13 +560,22 @@ static void load_continuation (flux_future_t *f, void *arg)
         watcher_cleanup (nsm, w);
 }
 
+/* Load blob 'ref', joining a load of the same blob already in flight
+ * for another watcher of the namespace.
+ */
 static flux_future_t *load_ref (flux_t *h, struct watcher *w, const char *ref)
 {
+    struct ns_monitor *nsm = w->nsm;
     flux_future_t *f = NULL;
 
-    if (!(f = content_load_byblobref (h, ref, 0))
-        || flux_future_then (f, -1., load_continuation, w) < 0)
-        goto error;
+    if ((f = shared_rpc_join (nsm, ref, w)))
+        nsm->loads_shared++;
+    else {
+        if (!(f = content_load_byblobref (h, ref, 0))
+            || shared_rpc_start (nsm, f, ref, w, load_continuation) < 0)
+            goto error;
+        nsm->loads++;
+    }
     if (zlist_append (w->loads, f) < 0) {
         errno = ENOMEM;
         goto error;
@@ -461,20 +673,12 @@ static int handle_initial_response (flux_t *h,
 
         if (w->flags & FLUX_KVS_WATCH_INITIAL_SENTINEL
             && w->initial_sentinel_sent == false) {
-            /* We want to send sentinel on the last load from
-             * load_range() call above.  We set an aux "flag" to send
-             * the sentinel after this future is completed.
+            /* We want to send sentinel after the last load from
+             * load_range() call above.  Count loads rather than flag
+             * the last future, since load futures may be shared with
+             * other watchers, and may appear more than once in w->loads.
              */
-            flux_future_t *f = zlist_tail (w->loads);
-            if (flux_future_aux_set (f,
-                                     "initial_sentinel",
-                                     int2ptr (1),
-                                     NULL) < 0) {
-                flux_log_error (h,
-                                "%s: failed to set initial_sentinel flag",
-                                __FUNCTION__);
-                goto error_respond;
-            }
+            w->sentinel_countdown = zlist_size (w->loads);
         }
         return 0;
     }
@@ -932,28 +1136,59 @@ error:
     return NULL;
 }
 
+/* Send a lookup of w->key at the current commit.  After the initial
+ * lookup, watchers with the same key, flags, and credentials look up the
+ * same thing, so join a lookup already sent for one of them if possible.
+ * The initial lookup is never shared, as its request and handling differ.
+ */
 static int process_lookup_response (struct ns_monitor *nsm, struct watcher *w)
 {
-    flux_future_t *f;
-    if (!(f = lookupat (nsm->ctx->h,
-                        w,
-                        nsm->commit->rootref,
-                        nsm->commit->rootseq,
-                        nsm->ns_name))) {
-        flux_log_error (nsm->ctx->h, "%s: lookupat", __FUNCTION__);
-        return -1;
+    flux_future_t *f = NULL;
+    char *key = NULL;
+
+    if (w->initial_rpc_sent) {
+        if (asprintf (&key,
+                      "lookup:%d:%d:%ju:%ju:%s",
+                      nsm->commit->rootseq,
+                      w->flags,
+                      (uintmax_t)w->cred.userid,
+                      (uintmax_t)w->cred.rolemask,
+                      w->key) < 0)
+            return -1;
+        if ((f = shared_rpc_join (nsm, key, w)))
+            nsm->lookups_shared++;
+    }
+    if (!f) {
+        if (!(f = lookupat (nsm->ctx->h,
+                            w,
+                            nsm->commit->rootref,
+                            nsm->commit->rootseq,
+                            nsm->ns_name))) {
+            flux_log_error (nsm->ctx->h, "%s: lookupat", __FUNCTION__);
+            goto error;
+        }
+        if (key) {
+            if (shared_rpc_start (nsm, f, key, w, lookup_continuation) < 0)
+                goto error_destroy;
+        }
+        else if (flux_future_then (f, -1., lookup_continuation, w) < 0)
+            goto error_destroy;
+        nsm->lookups++;
     }
     if (zlist_append (w->lookups, f) < 0) {
-        flux_future_destroy (f);
         errno = ENOMEM;
-        return -1;
-    }
-    if (flux_future_then (f, -1., lookup_continuation, w) < 0) {
-        flux_future_destroy (f);
-        return -1;
+        goto error_destroy;
     }
+    free (key);
+    if (w->rootseq == -1)
+        nsm->unsynced--;
     w->rootseq = nsm->commit->rootseq;
     return 0;
+error_destroy:
+    flux_future_destroy (f);
+error:
+    ERRNO_SAFE_WRAP (free, key);
+    return -1;
 }
 
 /* Respond to watcher request, if appropriate.
@@ -1037,6 +1272,102 @@ finished:
     watcher_cleanup (nsm, w);
 }
 
+/* Append watchers on list 'l' to 'targets'.
+ */
+static int append_targets (zlistx_t *targets, zlistx_t *l)
+{
+    struct watcher *w;
+
+    w = zlistx_first (l);
+    while (w) {
+        if (!zlistx_add_end (targets, w))
+            return -1;
+        w = zlistx_next (l);
+    }
+    return 0;
+}
+
+/* Build the list of watchers that may need a response to the current
+ * commit: FULL watchers, plus those whose key is in the commit key set.
+ * Look up commit keys in the index, or if the commit changed more keys
+ * than there are watched keys, check each watched key against the
+ * commit instead.
+ */
+static zlistx_t *dispatch_targets (struct ns_monitor *nsm)
+{
+    zlistx_t *targets;
+    json_t *keys = nsm->commit->keys;
+    zlistx_t *l;
+
+    if (!(targets = zlistx_new ()))
+        goto nomem;
+    if (append_targets (targets, nsm->watchers_full) < 0)
+        goto nomem;
+    if (json_object_size (keys) <= zhashx_size (nsm->watchers_by_key)) {
+        const char *key;
+        json_t *value;
+
+        json_object_foreach (keys, key, value) {
+            if ((l = zhashx_lookup (nsm->watchers_by_key, key))
+                && append_targets (targets, l) < 0)
+                goto nomem;
+        }
+    }
+    else {
+        l = zhashx_first (nsm->watchers_by_key);
+        while (l) {
+            if (key_match (keys, zhashx_cursor (nsm->watchers_by_key))
+                && append_targets (targets, l) < 0)
+                goto nomem;
+            l = zhashx_next (nsm->watchers_by_key);
+        }
+    }
+    return targets;
+nomem:
+    zlistx_destroy (&targets);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/* Respond to ready watchers of a commit with a non-empty key set.
+ * Only indexed watchers that may have changed are visited, unless
+ * a namespace error is pending or some watcher has yet to receive
+ * its initial response, in which case return -1 so the caller falls
+ * back to visiting every watcher.
+ */
+static int watcher_respond_indexed (struct ns_monitor *nsm)
+{
+    zlistx_t *targets;
+    struct watcher *w;
+    size_t total;
+
+    if (nsm->fatal_errnum != 0
+        || nsm->errnum != 0
+        || nsm->unsynced > 0
+        || !nsm->commit
+        || json_object_size (nsm->commit->keys) == 0)
+        return -1;
+    if (!(targets = dispatch_targets (nsm))) {
+        flux_log_error (nsm->ctx->h, "%s: dispatch_targets", __FUNCTION__);
+        return -1;
+    }
+    total = zlistx_size (nsm->watchers);
+    nsm->visited += zlistx_size (targets);
+    nsm->skipped += total - zlistx_size (targets);
+
+    /* N.B. watcher_respond() may destroy 'w', and 'nsm' once its last
+     * watcher is gone.  Since each watcher appears on 'targets' once,
+     * nsm is not accessed after it could have been destroyed.
+     */
+    w = zlistx_first (targets);
+    while (w) {
+        watcher_respond (nsm, w);
+        w = zlistx_next (targets);
+    }
+    zlistx_destroy (&targets);
+    return 0;
+}
+
 /* Respond to all ready watchers.
  * N.B. watcher_respond() may call zlistx_delete() on nsm->watchers.
  */
@@ -1044,6 +1375,9 @@ static void watcher_respond_ns (struct ns_monitor *nsm)
 {
     struct watcher *w;
 
+    if (watcher_respond_indexed (nsm) == 0)
+        return;
+    nsm->visited += zlistx_size (nsm->watchers);
     w = zlistx_first (nsm->watchers);
     while (w) {
         /* Note: get next watcher before calling watcher_respond() since
@@ -1268,6 +1602,7 @@ static void setroot_cb (flux_t *h,
     int owner;
     json_t *keys;
     struct commit *commit;
+    struct timespec t0;
 
     if (flux_event_unpack (msg,
                            NULL,
@@ -1293,7 +1628,11 @@ static void setroot_cb (flux_t *h,
     if (nsm->owner == FLUX_USERID_UNKNOWN)
         nsm->owner = owner;
 done:
+    monotime (&t0);
     watcher_respond_ns (nsm);
+    /* nsm is destroyed if its last watcher finished */
+    if ((nsm = zhashx_lookup (ctx->namespaces, ns)))
+        tstat_push (&nsm->dispatch_ts, monotime_since (t0));
 }
 
 /* kvs.getroot response for initial namespace creation
@@ -1489,6 +1828,11 @@ static void lookup_cb (flux_t *h,
         errno = EINVAL;
         goto error;
     }
+    nsm->unsynced++;
+    if (watcher_index_add (nsm, w) < 0) {
+        watcher_cleanup (nsm, w);
+        goto error;
+    }
     if (nsm->commit)
         watcher_respond (nsm, w);
     return;
@@ -1539,13 +1883,30 @@ static void stats_cb (flux_t *h,
         goto nomem;
     nsm = zhashx_first (ctx->namespaces);
     while (nsm) {
-        json_t *o = json_pack ("{s:i s:i s:s s:i}",
+        json_t *o = json_pack ("{s:i s:i s:s s:i s:i s:i s:{s:i s:f s:f s:f"
+                               " s:I s:I} s:{s:I s:I} s:{s:I s:I}}",
                                "owner", (int)nsm->owner,
                                "rootseq", nsm->commit ? nsm->commit->rootseq
                                                       : -1,
                                "rootref", nsm->commit ? nsm->commit->rootref
                                                       : "(null)",
-                               "watchers", (int)zlistx_size (nsm->watchers));
+                               "watchers", (int)zlistx_size (nsm->watchers),
+                               "watchers-full",
+                                 (int)zlistx_size (nsm->watchers_full),
+                               "keys", (int)zhashx_size (nsm->watchers_by_key),
+                               "dispatch",
+                                 "count", tstat_count (&nsm->dispatch_ts),
+                                 "min", tstat_min (&nsm->dispatch_ts),
+                                 "max", tstat_max (&nsm->dispatch_ts),
+                                 "mean", tstat_mean (&nsm->dispatch_ts),
+                                 "visited", (json_int_t)nsm->visited,
+                                 "skipped", (json_int_t)nsm->skipped,
+                               "lookups",
+                                 "sent", (json_int_t)nsm->lookups,
+                                 "shared", (json_int_t)nsm->lookups_shared,
+                               "loads",
+                                 "sent", (json_int_t)nsm->loads,
+                                 "shared", (json_int_t)nsm->loads_shared);
         if (!o)
             goto nomem;
         if (json_object_set_new (stats, nsm->ns_name, o) < 0) {
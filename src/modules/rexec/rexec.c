@@ -27,9 +27,12 @@
 #include "src/common/libsubprocess/server.h"
 #include "src/common/libutil/errprintf.h"
 
+#include "treeexec.h"
+
 struct rexec_ctx {
     flux_msg_handler_t **handlers;
     subprocess_server_t *ss;
+    struct treeexec *te;
     flux_t *h;
     flux_future_t *f_shutdown;
 };
@@ -102,8 +105,23 @@ static void shutdown_cb (flux_t *h,
     }
 }
 
+/* Override the subprocess server's disconnect handler so that tree-exec
+ * requests from the disconnecting client are canceled too.
+ */
+static void disconnect_cb (flux_t *h,
+                           flux_msg_handler_t *mh,
+                           const flux_msg_t *msg,
+                           void *arg)
+{
+    struct rexec_ctx *ctx = arg;
+
+    treeexec_disconnect (ctx->te, msg);
+    subprocess_server_disconnect (ctx->ss, msg);
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     { FLUX_MSGTYPE_REQUEST,  "shutdown", shutdown_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,  "disconnect", disconnect_cb, 0 },
     FLUX_MSGHANDLER_TABLE_END,
 };
 
@@ -134,6 +152,12 @@ static int mod_main (flux_t *h, int argc, char *argv[])
     }
     if (rank == 0)
         subprocess_server_set_auth_cb (ctx.ss, reject_nonlocal, &ctx);
+    if (!(ctx.te = treeexec_create (h, name))) {
+        flux_log_error (h, "error registering tree-exec service");
+        goto done;
+    }
+    if (rank == 0)
+        treeexec_set_auth_cb (ctx.te, reject_nonlocal, &ctx);
     if (flux_msg_handler_addvec_ex (h, name, htab, &ctx, &ctx.handlers) < 0) {
         flux_log_error (h, "error registering message handlers");
         goto done;
@@ -146,6 +170,7 @@ static int mod_main (flux_t *h, int argc, char *argv[])
 done:
     flux_future_destroy (ctx.f_shutdown);
     flux_msg_handler_delvec (ctx.handlers);
+    treeexec_destroy (ctx.te);
     subprocess_server_destroy (ctx.ss);
     return rc;
 }
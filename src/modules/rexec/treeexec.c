@@ -0,0 +1,1260 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* treeexec.c - launch a command on a set of ranks via the TBON
+ *
+ * A tree-exec request names a set of ranks and a command.  The broker
+ * that receives it starts the command locally if its own rank is in the
+ * set, and forwards one tree-exec request to each TBON child whose subtree
+ * intersects the set.  Process events from the local process and from
+ * children are batched and relayed upstream in aggregated responses, so a
+ * requester launching on N ranks sees traffic proportional to its number
+ * of children rather than N.
+ *
+ * tree-exec request:
+ *   {key:s ranks:s cmd:o flags:i}
+ * tree-exec responses (streaming, terminated by ENODATA):
+ *   {started?:s exited?:{status:ranks ...} failed?:[[rank,errnum,errstr]...]
+ *    output?:[ioencode object ...]}
+ *
+ * tree-kill request:
+ *   {key:s ranks:s signal:i}
+ * signals processes started by the tree-exec request with matching key.
+ *
+ * If the tree-exec request includes barrier:{topic:s id:I userid:i},
+ * processes may enter a barrier with a tree-barrier request:
+ *   {key:s ranks:s}
+ * sent to the local broker.  Barrier requests are batched like process
+ * events and sent upstream as one tree-barrier request per batch, and
+ * at the root as one request to 'topic' with {id:I ranks:s}.  The
+ * response to that request is relayed back down to release the batch.
+ * Requests from processes are authorized against 'userid'.
+ *
+ * The key is chosen by the requester and must be unique among its active
+ * tree-exec requests.  Ranks that fail to launch, or that are lost along
+ * with a TBON child, are reported in 'failed'.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <limits.h>
+#include <signal.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libsubprocess/command_private.h"
+#include "src/common/libioencode/ioencode.h"
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libutil/errprintf.h"
+
+#include "treeexec.h"
+
+/* Process events are relayed upstream at most once per batch_delay.
+ */
+static const double batch_delay = 0.01;
+
+static const char *auxkey = "treeexec::launch";
+
+struct child {
+    uint32_t rank;
+    struct idset *subtree;
+};
+
+struct forward {
+    struct launch *l;
+    uint32_t rank;
+    struct idset *ranks;
+    flux_future_t *f;
+    void *handle;
+};
+
+struct launch {
+    struct treeexec *te;
+    char *key;
+    const flux_msg_t *msg;
+    int parent;                 /* rank of forwarding broker, or -1 */
+    json_t *barrier;            /* barrier parameters, if any */
+    const char *barrier_topic;
+    flux_jobid_t id;
+    uint32_t userid;
+    struct idset *pending;      /* ranks that have not exited or failed */
+    flux_subprocess_t *p;       /* local process, if any */
+    zlistx_t *forwards;         /* active requests to TBON children */
+
+    /* events not yet relayed upstream */
+    struct idset *started;
+    zhashx_t *exited;           /* wait status => struct idset */
+    json_t *failed;
+    json_t *output;
+    struct flux_msglist *barrier_requests;
+    struct idset *barrier_ranks;
+    flux_watcher_t *timer;
+};
+
+struct treeexec {
+    flux_t *h;
+    char *service;
+    uint32_t rank;
+    char rankstr[16];
+    char exec_topic[128];
+    char kill_topic[128];
+    char barrier_topic[128];
+    flux_future_t *f_topo;
+    bool topo_ready;
+    struct child *children;
+    int nchildren;
+    zlist_t *deferred;          /* requests received before topology */
+    zhashx_t *launches;         /* key => struct launch */
+    flux_msg_handler_t **handlers;
+    subprocess_server_auth_f auth_cb;
+    void *auth_arg;
+};
+
+static void idset_destructor (void **item)
+{
+    if (item) {
+        idset_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static int object_set_idset (json_t *o,
+                             const char *key,
+                             const struct idset *ids)
+{
+    char *s;
+    json_t *val;
+
+    if (!(s = idset_encode (ids, IDSET_FLAG_RANGE))
+        || !(val = json_string (s))
+        || json_object_set_new (o, key, val) < 0) {
+        free (s);
+        errno = ENOMEM;
+        return -1;
+    }
+    free (s);
+    return 0;
+}
+
+static void forward_destroy (struct forward *fw)
+{
+    if (fw) {
+        int saved_errno = errno;
+        flux_future_destroy (fw->f);
+        idset_destroy (fw->ranks);
+        free (fw);
+        errno = saved_errno;
+    }
+}
+
+static void forward_destructor (void **item)
+{
+    if (item) {
+        forward_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void launch_destroy (struct launch *l)
+{
+    if (l) {
+        int saved_errno = errno;
+        zlistx_destroy (&l->forwards);
+        flux_subprocess_destroy (l->p);
+        flux_watcher_destroy (l->timer);
+        idset_destroy (l->started);
+        zhashx_destroy (&l->exited);
+        json_decref (l->failed);
+        json_decref (l->output);
+        flux_msglist_destroy (l->barrier_requests);
+        idset_destroy (l->barrier_ranks);
+        json_decref (l->barrier);
+        idset_destroy (l->pending);
+        flux_msg_decref (l->msg);
+        free (l->key);
+        free (l);
+        errno = saved_errno;
+    }
+}
+
+static void launch_destructor (void **item)
+{
+    if (item) {
+        launch_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/* Send batched events upstream, if any.
+ */
+static int launch_flush (struct launch *l)
+{
+    flux_t *h = l->te->h;
+    json_t *o;
+    int rc = -1;
+
+    if (idset_empty (l->started)
+        && zhashx_size (l->exited) == 0
+        && json_array_size (l->failed) == 0
+        && json_array_size (l->output) == 0)
+        return 0;
+    if (!(o = json_object ()))
+        goto nomem;
+    if (!idset_empty (l->started)) {
+        if (object_set_idset (o, "started", l->started) < 0)
+            goto error;
+        idset_range_clear (l->started, 0, INT_MAX);
+    }
+    if (zhashx_size (l->exited) > 0) {
+        json_t *exited;
+        struct idset *ids;
+
+        if (!(exited = json_object ())
+            || json_object_set_new (o, "exited", exited) < 0)
+            goto nomem;
+        ids = zhashx_first (l->exited);
+        while (ids) {
+            if (object_set_idset (exited, zhashx_cursor (l->exited), ids) < 0)
+                goto error;
+            ids = zhashx_next (l->exited);
+        }
+        zhashx_purge (l->exited);
+    }
+    if (json_array_size (l->failed) > 0) {
+        if (json_object_set (o, "failed", l->failed) < 0)
+            goto nomem;
+        json_decref (l->failed);
+        if (!(l->failed = json_array ()))
+            goto nomem;
+    }
+    if (json_array_size (l->output) > 0) {
+        if (json_object_set (o, "output", l->output) < 0)
+            goto nomem;
+        json_decref (l->output);
+        if (!(l->output = json_array ()))
+            goto nomem;
+    }
+    if (flux_respond_pack (h, l->msg, "O", o) < 0) {
+        flux_log_error (h, "error responding to tree-exec %s", l->key);
+        goto error;
+    }
+    rc = 0;
+error:
+    ERRNO_SAFE_WRAP (json_decref, o);
+    return rc;
+nomem:
+    errno = ENOMEM;
+    goto error;
+}
+
+/* Respond to all barrier requests in 'requests' and destroy it.
+ */
+static void barrier_release (flux_t *h,
+                             struct flux_msglist *requests,
+                             int errnum,
+                             const char *errstr)
+{
+    const flux_msg_t *msg;
+
+    while ((msg = flux_msglist_first (requests))) {
+        int rc;
+        if (errnum == 0)
+            rc = flux_respond (h, msg, NULL);
+        else
+            rc = flux_respond_error (h, msg, errnum, errstr);
+        if (rc < 0)
+            flux_log_error (h, "error responding to tree-barrier");
+        flux_msglist_delete (requests);
+    }
+    flux_msglist_destroy (requests);
+}
+
+static void barrier_continuation (flux_future_t *f, void *arg)
+{
+    struct treeexec *te = arg;
+    struct flux_msglist *requests = flux_future_aux_get (f, "requests");
+
+    if (flux_future_get (f, NULL) < 0)
+        barrier_release (te->h, requests, errno, future_strerror (f, errno));
+    else
+        barrier_release (te->h, requests, 0, NULL);
+    flux_future_destroy (f);
+}
+
+/* Send batched barrier requests upstream as one request, either to the
+ * parent broker or, at the root, to the barrier service.  The batch is
+ * released when the upstream request is answered, even if 'l' has been
+ * destroyed by then.
+ */
+static int barrier_flush (struct launch *l)
+{
+    struct treeexec *te = l->te;
+    struct flux_msglist *requests;
+    flux_future_t *f = NULL;
+    char *ranks = NULL;
+    int errnum;
+
+    if (flux_msglist_count (l->barrier_requests) == 0)
+        return 0;
+    requests = l->barrier_requests;
+    if (!(l->barrier_requests = flux_msglist_create ())) {
+        l->barrier_requests = requests; // retry on next flush
+        return -1;
+    }
+    if (!(ranks = idset_encode (l->barrier_ranks, IDSET_FLAG_RANGE)))
+        goto error;
+    idset_range_clear (l->barrier_ranks, 0, INT_MAX);
+    if (l->parent >= 0) {
+        f = flux_rpc_pack (te->h,
+                           te->barrier_topic,
+                           l->parent,
+                           0,
+                           "{s:s s:s}",
+                           "key", l->key,
+                           "ranks", ranks);
+    }
+    else {
+        f = flux_rpc_pack (te->h,
+                           l->barrier_topic,
+                           FLUX_NODEID_ANY,
+                           0,
+                           "{s:I s:s}",
+                           "id", l->id,
+                           "ranks", ranks);
+    }
+    if (!f
+        || flux_future_then (f, -1., barrier_continuation, te) < 0
+        || flux_future_aux_set (f, "requests", requests, NULL) < 0)
+        goto error;
+    free (ranks);
+    return 0;
+error:
+    /* Fail the batch so its processes do not hang in the barrier.
+     */
+    errnum = errno;
+    barrier_release (te->h, requests, errnum, NULL);
+    flux_future_destroy (f);
+    free (ranks);
+    errno = errnum;
+    return -1;
+}
+
+/* Flush the batch.  If all ranks are accounted for and all forwarded
+ * requests have terminated, end the response stream and destroy 'l'.
+ * N.B. this is only called from the batch timer callback so that 'l' and
+ * its local subprocess are never destroyed from within their own callbacks.
+ */
+static void launch_timer_cb (flux_reactor_t *r,
+                             flux_watcher_t *w,
+                             int revents,
+                             void *arg)
+{
+    struct launch *l = arg;
+    flux_t *h = l->te->h;
+
+    if (launch_flush (l) < 0)
+        flux_log_error (h, "tree-exec %s: error sending events", l->key);
+    if (barrier_flush (l) < 0)
+        flux_log_error (h, "tree-exec %s: error sending barrier", l->key);
+    if (idset_empty (l->pending) && zlistx_size (l->forwards) == 0) {
+        if (flux_respond_error (h, l->msg, ENODATA, NULL) < 0)
+            flux_log_error (h, "error responding to tree-exec %s", l->key);
+        zhashx_delete (l->te->launches, l->key);
+    }
+}
+
+static void launch_schedule (struct launch *l)
+{
+    if (!flux_watcher_is_active (l->timer)) {
+        flux_timer_watcher_reset (l->timer, batch_delay, 0.);
+        flux_watcher_start (l->timer);
+    }
+}
+
+static void launch_started (struct launch *l, uint32_t rank)
+{
+    if (idset_set (l->started, rank) < 0)
+        flux_log_error (l->te->h, "tree-exec %s: idset_set", l->key);
+    launch_schedule (l);
+}
+
+static void launch_exited (struct launch *l, uint32_t rank, int status)
+{
+    char key[16];
+    struct idset *ids;
+
+    snprintf (key, sizeof (key), "%d", status);
+    if (!(ids = zhashx_lookup (l->exited, key))) {
+        if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW))
+            || zhashx_insert (l->exited, key, ids) < 0) {
+            idset_destroy (ids);
+            flux_log_error (l->te->h, "tree-exec %s: exited", l->key);
+            return;
+        }
+    }
+    if (idset_set (ids, rank) < 0)
+        flux_log_error (l->te->h, "tree-exec %s: idset_set", l->key);
+    idset_clear (l->pending, rank);
+    launch_schedule (l);
+}
+
+static void launch_failed (struct launch *l,
+                           uint32_t rank,
+                           int errnum,
+                           const char *errstr)
+{
+    json_t *entry;
+
+    if (!(entry = json_pack ("[i i s]",
+                             rank,
+                             errnum,
+                             errstr ? errstr : strerror (errnum)))
+        || json_array_append_new (l->failed, entry) < 0)
+        flux_log (l->te->h, LOG_ERR, "tree-exec %s: out of memory", l->key);
+    idset_clear (l->pending, rank);
+    launch_schedule (l);
+}
+
+static void local_state_cb (flux_subprocess_t *p,
+                            flux_subprocess_state_t state)
+{
+    struct launch *l = flux_subprocess_aux_get (p, auxkey);
+
+    if (state == FLUX_SUBPROCESS_RUNNING)
+        launch_started (l, l->te->rank);
+    else if (state == FLUX_SUBPROCESS_FAILED) {
+        launch_failed (l,
+                       l->te->rank,
+                       flux_subprocess_fail_errno (p),
+                       flux_subprocess_fail_error (p));
+    }
+}
+
+static void local_completion_cb (flux_subprocess_t *p)
+{
+    struct launch *l = flux_subprocess_aux_get (p, auxkey);
+
+    launch_exited (l, l->te->rank, flux_subprocess_status (p));
+}
+
+static void local_output_cb (flux_subprocess_t *p, const char *stream)
+{
+    struct launch *l = flux_subprocess_aux_get (p, auxkey);
+    const char *s;
+    int len;
+    json_t *io;
+
+    if ((len = flux_subprocess_read (p, stream, &s)) < 0) {
+        flux_log_error (l->te->h, "tree-exec %s: read %s", l->key, stream);
+        return;
+    }
+    if (len == 0)
+        return;
+    if (!(io = ioencode (stream, l->te->rankstr, s, len, false))
+        || json_array_append_new (l->output, io) < 0) {
+        flux_log_error (l->te->h, "tree-exec %s: ioencode", l->key);
+        return;
+    }
+    launch_schedule (l);
+}
+
+/* Merge events from a child's tree-exec response into the batch.
+ */
+static int launch_merge (struct launch *l,
+                         const char *started,
+                         json_t *exited,
+                         json_t *failed,
+                         json_t *output)
+{
+    if (started && idset_decode_add (l->started, started, -1, NULL) < 0)
+        return -1;
+    if (exited) {
+        const char *key;
+        json_t *val;
+
+        json_object_foreach (exited, key, val) {
+            const char *s = json_string_value (val);
+            struct idset *ids;
+
+            if (!s)
+                goto inval;
+            if (!(ids = zhashx_lookup (l->exited, key))) {
+                if (!(ids = idset_create (0, IDSET_FLAG_AUTOGROW))
+                    || zhashx_insert (l->exited, key, ids) < 0) {
+                    idset_destroy (ids);
+                    errno = ENOMEM;
+                    return -1;
+                }
+            }
+            if (idset_decode_add (ids, s, -1, NULL) < 0
+                || idset_decode_subtract (l->pending, s, -1, NULL) < 0)
+                return -1;
+        }
+    }
+    if (failed) {
+        size_t index;
+        json_t *entry;
+
+        json_array_foreach (failed, index, entry) {
+            int rank;
+            int errnum;
+            const char *errstr;
+
+            if (json_unpack (entry, "[i i s]", &rank, &errnum, &errstr) < 0)
+                goto inval;
+            if (json_array_append (l->failed, entry) < 0) {
+                errno = ENOMEM;
+                return -1;
+            }
+            idset_clear (l->pending, rank);
+        }
+    }
+    if (output && json_array_extend (l->output, output) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    launch_schedule (l);
+    return 0;
+inval:
+    errno = EPROTO;
+    return -1;
+}
+
+/* A forwarded request has terminated.  Fail any of its ranks that are
+ * still unaccounted for, e.g. if the child was lost.
+ */
+static void forward_finish (struct forward *fw, int errnum, const char *errstr)
+{
+    struct launch *l = fw->l;
+    char buf[128];
+    unsigned int rank;
+
+    if (errnum == ENODATA) {
+        errnum = EPROTO;
+        snprintf (buf,
+                  sizeof (buf),
+                  "process was not reported by rank %lu",
+                  (unsigned long)fw->rank);
+        errstr = buf;
+    }
+    rank = idset_first (fw->ranks);
+    while (rank != IDSET_INVALID_ID) {
+        if (idset_test (l->pending, rank))
+            launch_failed (l, rank, errnum, errstr);
+        rank = idset_next (fw->ranks, rank);
+    }
+    zlistx_delete (l->forwards, fw->handle);
+    launch_schedule (l);
+}
+
+static void forward_continuation (flux_future_t *f, void *arg)
+{
+    struct forward *fw = arg;
+    struct launch *l = fw->l;
+    const char *started = NULL;
+    json_t *exited = NULL;
+    json_t *failed = NULL;
+    json_t *output = NULL;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s?s s?o s?o s?o}",
+                             "started", &started,
+                             "exited", &exited,
+                             "failed", &failed,
+                             "output", &output) < 0) {
+        if (errno != ENODATA) {
+            flux_log (l->te->h,
+                      LOG_ERR,
+                      "tree-exec %s: rank %lu: %s",
+                      l->key,
+                      (unsigned long)fw->rank,
+                      future_strerror (f, errno));
+        }
+        forward_finish (fw, errno, future_strerror (f, errno));
+        return;
+    }
+    if (launch_merge (l, started, exited, failed, output) < 0)
+        flux_log_error (l->te->h,
+                        "tree-exec %s: error merging response from rank %lu",
+                        l->key,
+                        (unsigned long)fw->rank);
+    flux_future_reset (f);
+}
+
+static int forward_start (struct launch *l,
+                          const struct child *child,
+                          json_t *cmd,
+                          int flags)
+{
+    struct treeexec *te = l->te;
+    struct forward *fw;
+    char *ranks = NULL;
+
+    if (!(fw = calloc (1, sizeof (*fw))))
+        return -1;
+    fw->l = l;
+    fw->rank = child->rank;
+    if (!(fw->ranks = idset_intersect (l->pending, child->subtree)))
+        goto error;
+    if (idset_empty (fw->ranks)) {
+        forward_destroy (fw);
+        return 0;
+    }
+    if (!(ranks = idset_encode (fw->ranks, IDSET_FLAG_RANGE))
+        || !(fw->f = flux_rpc_pack (te->h,
+                                    te->exec_topic,
+                                    child->rank,
+                                    FLUX_RPC_STREAMING,
+                                    "{s:s s:s s:O s:i s:i s:O?}",
+                                    "key", l->key,
+                                    "ranks", ranks,
+                                    "cmd", cmd,
+                                    "flags", flags,
+                                    "parent", te->rank,
+                                    "barrier", l->barrier))
+        || flux_future_then (fw->f, -1., forward_continuation, fw) < 0
+        || !(fw->handle = zlistx_add_end (l->forwards, fw)))
+        goto error;
+    free (ranks);
+    return 0;
+error:
+    ERRNO_SAFE_WRAP (free, ranks);
+    forward_destroy (fw);
+    return -1;
+}
+
+static struct launch *launch_create (struct treeexec *te,
+                                     const flux_msg_t *msg,
+                                     const char *key,
+                                     const char *ranks,
+                                     flux_error_t *error)
+{
+    struct launch *l;
+    idset_error_t e;
+
+    if (!(l = calloc (1, sizeof (*l))))
+        goto nomem;
+    l->te = te;
+    l->msg = flux_msg_incref (msg);
+    if (!(l->key = strdup (key))
+        || !(l->forwards = zlistx_new ())
+        || !(l->started = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || !(l->exited = zhashx_new ())
+        || !(l->failed = json_array ())
+        || !(l->output = json_array ())
+        || !(l->barrier_requests = flux_msglist_create ())
+        || !(l->barrier_ranks = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || !(l->timer = flux_timer_watcher_create (flux_get_reactor (te->h),
+                                                   batch_delay,
+                                                   0.,
+                                                   launch_timer_cb,
+                                                   l)))
+        goto nomem;
+    zlistx_set_destructor (l->forwards, forward_destructor);
+    zhashx_set_destructor (l->exited, idset_destructor);
+    if (!(l->pending = idset_decode_ex (ranks,
+                                        -1,
+                                        0,
+                                        IDSET_FLAG_AUTOGROW,
+                                        &e))) {
+        errprintf (error, "error decoding ranks: %s", e.text);
+        goto error;
+    }
+    return l;
+nomem:
+    errprintf (error, "out of memory");
+    errno = ENOMEM;
+error:
+    launch_destroy (l);
+    return NULL;
+}
+
+static void launch_start (struct treeexec *te, const flux_msg_t *msg)
+{
+    flux_subprocess_ops_t ops = {
+        .on_completion = local_completion_cb,
+        .on_state_change = local_state_cb,
+        .on_channel_out = local_output_cb,
+        .on_stdout = local_output_cb,
+        .on_stderr = local_output_cb,
+    };
+    const char *key;
+    const char *ranks;
+    json_t *jcmd;
+    int flags;
+    flux_cmd_t *cmd = NULL;
+    struct launch *l = NULL;
+    struct idset *unreachable = NULL;
+    flux_error_t error;
+    const char *errmsg = NULL;
+    unsigned int rank;
+    int parent = -1;
+    json_t *barrier = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:s s:o s:i s?i s?o}",
+                             "key", &key,
+                             "ranks", &ranks,
+                             "cmd", &jcmd,
+                             "flags", &flags,
+                             "parent", &parent,
+                             "barrier", &barrier) < 0)
+        goto error;
+    if (zhashx_lookup (te->launches, key)) {
+        errmsg = "tree-exec key is already in use";
+        errno = EEXIST;
+        goto error;
+    }
+    if (!(cmd = cmd_fromjson (jcmd, NULL))) {
+        errmsg = "error decoding command";
+        goto error;
+    }
+    if (!(l = launch_create (te, msg, key, ranks, &error))) {
+        errmsg = error.text;
+        goto error;
+    }
+    l->parent = parent;
+    if (idset_test (l->pending, te->rank)
+        && te->auth_cb
+        && te->auth_cb (msg, te->auth_arg, &error) < 0) {
+        launch_destroy (l);
+        errmsg = error.text;
+        errno = EPERM;
+        goto error;
+    }
+    if (barrier && !json_is_null (barrier)) {
+        json_int_t id;
+        int userid;
+
+        if (json_unpack (barrier,
+                         "{s:s s:I s:i}",
+                         "topic", &l->barrier_topic,
+                         "id", &id,
+                         "userid", &userid) < 0) {
+            launch_destroy (l);
+            errmsg = "error decoding barrier parameters";
+            errno = EPROTO;
+            goto error;
+        }
+        l->barrier = json_incref (barrier);
+        l->id = id;
+        l->userid = userid;
+    }
+    if (zhashx_insert (te->launches, key, l) < 0) {
+        launch_destroy (l);
+        errno = EEXIST;
+        goto error;
+    }
+    /* Ranks that are neither local nor in a child subtree cannot be
+     * reached from here.
+     */
+    if (!(unreachable = idset_copy (l->pending)))
+        goto error_launch;
+    idset_clear (unreachable, te->rank);
+    for (int i = 0; i < te->nchildren; i++) {
+        if (idset_subtract (unreachable, te->children[i].subtree) < 0)
+            goto error_launch;
+    }
+    rank = idset_first (unreachable);
+    while (rank != IDSET_INVALID_ID) {
+        char buf[128];
+        snprintf (buf,
+                  sizeof (buf),
+                  "rank %u is not in the TBON subtree of rank %lu",
+                  rank,
+                  (unsigned long)te->rank);
+        launch_failed (l, rank, EHOSTUNREACH, buf);
+        rank = idset_next (unreachable, rank);
+    }
+    /* Forward to children first so the subtree launch proceeds in
+     * parallel with the local one.
+     */
+    for (int i = 0; i < te->nchildren; i++) {
+        if (forward_start (l, &te->children[i], jcmd, flags) < 0) {
+            flux_log_error (te->h,
+                            "tree-exec %s: error forwarding to rank %lu",
+                            key,
+                            (unsigned long)te->children[i].rank);
+            rank = idset_first (te->children[i].subtree);
+            while (rank != IDSET_INVALID_ID) {
+                if (idset_test (l->pending, rank))
+                    launch_failed (l, rank, errno, NULL);
+                rank = idset_next (te->children[i].subtree, rank);
+            }
+        }
+    }
+    if (idset_test (l->pending, te->rank)) {
+        if (!(l->p = flux_rexec_ex (te->h,
+                                    te->service,
+                                    te->rank,
+                                    flags,
+                                    cmd,
+                                    &ops,
+                                    flux_llog,
+                                    te->h))
+            || flux_subprocess_aux_set (l->p, auxkey, l, NULL) < 0) {
+            launch_failed (l, te->rank, errno, NULL);
+            flux_subprocess_destroy (l->p);
+            l->p = NULL;
+        }
+    }
+    launch_schedule (l);
+    idset_destroy (unreachable);
+    flux_cmd_destroy (cmd);
+    return;
+error_launch:
+    ERRNO_SAFE_WRAP (zhashx_delete, te->launches, key);
+error:
+    if (flux_respond_error (te->h, msg, errno, errmsg) < 0)
+        flux_log_error (te->h, "error responding to tree-exec request");
+    idset_destroy (unreachable);
+    flux_cmd_destroy (cmd);
+}
+
+/* Recursive function to walk 'topology', adding all subtree ranks to 'ids'.
+ * Returns 0 on success, -1 on failure (errno is not set).
+ */
+static int add_subtree_ids (struct idset *ids, json_t *topology)
+{
+    int rank;
+    json_t *a;
+    size_t index;
+    json_t *entry;
+
+    if (json_unpack (topology, "{s:i s:o}", "rank", &rank, "children", &a) < 0
+        || idset_set (ids, rank) < 0)
+        return -1;
+    json_array_foreach (a, index, entry) {
+        if (add_subtree_ids (ids, entry) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int topology_parse (struct treeexec *te, json_t *children)
+{
+    size_t index;
+    json_t *entry;
+
+    if (!(te->children = calloc (json_array_size (children) + 1,
+                                 sizeof (te->children[0]))))
+        return -1;
+    json_array_foreach (children, index, entry) {
+        struct child *child = &te->children[te->nchildren++];
+        int rank;
+
+        if (json_unpack (entry, "{s:i}", "rank", &rank) < 0
+            || !(child->subtree = idset_create (0, IDSET_FLAG_AUTOGROW))
+            || add_subtree_ids (child->subtree, entry) < 0) {
+            errno = EPROTO;
+            return -1;
+        }
+        child->rank = rank;
+    }
+    return 0;
+}
+
+static void topology_continuation (flux_future_t *f, void *arg)
+{
+    struct treeexec *te = arg;
+    json_t *children;
+    flux_msg_t *msg;
+
+    if (flux_rpc_get_unpack (f, "{s:o}", "children", &children) < 0
+        || topology_parse (te, children) < 0) {
+        int errnum = errno;
+        flux_log (te->h,
+                  LOG_ERR,
+                  "overlay.topology: %s",
+                  future_strerror (f, errnum));
+        while ((msg = zlist_pop (te->deferred))) {
+            if (flux_respond_error (te->h, msg, errnum, NULL) < 0)
+                flux_log_error (te->h, "error responding to tree-exec");
+            flux_msg_decref (msg);
+        }
+        /* Allow a later request to retry.
+         */
+        for (int i = 0; i < te->nchildren; i++)
+            idset_destroy (te->children[i].subtree);
+        free (te->children);
+        te->children = NULL;
+        te->nchildren = 0;
+        flux_future_destroy (f);
+        te->f_topo = NULL;
+        return;
+    }
+    te->topo_ready = true;
+    while ((msg = zlist_pop (te->deferred))) {
+        launch_start (te, msg);
+        flux_msg_decref (msg);
+    }
+    flux_future_destroy (f);
+    te->f_topo = NULL;
+}
+
+/* The TBON subtree is fetched when the first tree-exec request arrives,
+ * since most brokers never receive one.  Requests are deferred until then.
+ */
+static void tree_exec_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct treeexec *te = arg;
+
+    if (te->topo_ready) {
+        launch_start (te, msg);
+        return;
+    }
+    if (zlist_append (te->deferred, (void *)flux_msg_incref (msg)) < 0) {
+        flux_msg_decref (msg);
+        errno = ENOMEM;
+        goto error;
+    }
+    if (!te->f_topo) {
+        if (!(te->f_topo = flux_rpc_pack (h,
+                                          "overlay.topology",
+                                          FLUX_NODEID_ANY,
+                                          0,
+                                          "{s:i}",
+                                          "rank", te->rank))
+            || flux_future_then (te->f_topo,
+                                 -1,
+                                 topology_continuation,
+                                 te) < 0) {
+            flux_future_destroy (te->f_topo);
+            te->f_topo = NULL;
+            flux_msg_decref (zlist_pop (te->deferred));
+            goto error;
+        }
+    }
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to tree-exec request");
+}
+
+static void kill_continuation (flux_future_t *f, void *arg)
+{
+    struct treeexec *te = arg;
+    const flux_msg_t *msg = flux_future_aux_get (f, "request");
+    const char *name;
+    int errnum = ESRCH;
+    const char *errstr = NULL;
+
+    /* Succeed if any process was signaled.  Otherwise, report the first
+     * error that is not ESRCH (no such process).
+     */
+    name = flux_future_first_child (f);
+    while (name) {
+        flux_future_t *cf = flux_future_get_child (f, name);
+        if (flux_future_get (cf, NULL) == 0) {
+            errnum = 0;
+            break;
+        }
+        if (errno != ESRCH && errnum == ESRCH) {
+            errnum = errno;
+            errstr = future_strerror (cf, errno);
+        }
+        name = flux_future_next_child (f);
+    }
+    if (errnum == 0) {
+        if (flux_respond (te->h, msg, NULL) < 0)
+            flux_log_error (te->h, "error responding to tree-kill request");
+    }
+    else {
+        if (flux_respond_error (te->h, msg, errnum, errstr) < 0)
+            flux_log_error (te->h, "error responding to tree-kill request");
+    }
+    flux_future_destroy (f);
+}
+
+static int kill_push (flux_future_t *f, uint32_t rank, flux_future_t *cf)
+{
+    char name[16];
+
+    snprintf (name, sizeof (name), "%lu", (unsigned long)rank);
+    if (flux_future_push (f, name, cf) < 0) {
+        flux_future_destroy (cf);
+        return -1;
+    }
+    return 0;
+}
+
+static void tree_kill_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct treeexec *te = arg;
+    const char *key;
+    const char *ranks;
+    int signum;
+    struct launch *l;
+    struct idset *ids = NULL;
+    struct idset *sub = NULL;
+    char *s = NULL;
+    flux_future_t *f = NULL;
+    flux_future_t *cf;
+    struct forward *fw;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:s s:i}",
+                             "key", &key,
+                             "ranks", &ranks,
+                             "signal", &signum) < 0)
+        goto error;
+    if (!(l = zhashx_lookup (te->launches, key))) {
+        errno = ESRCH;
+        goto error;
+    }
+    if (!(ids = idset_decode (ranks))
+        || !(f = flux_future_wait_all_create ()))
+        goto error;
+    flux_future_set_flux (f, h);
+    if (l->p
+        && idset_test (ids, te->rank)
+        && flux_subprocess_active (l->p)
+        && (cf = flux_subprocess_kill (l->p, signum))) {
+        if (kill_push (f, te->rank, cf) < 0)
+            goto error;
+    }
+    fw = zlistx_first (l->forwards);
+    while (fw) {
+        if (!(sub = idset_intersect (fw->ranks, ids)))
+            goto error;
+        if (!idset_empty (sub)) {
+            if (!(s = idset_encode (sub, IDSET_FLAG_RANGE))
+                || !(cf = flux_rpc_pack (h,
+                                         te->kill_topic,
+                                         fw->rank,
+                                         0,
+                                         "{s:s s:s s:i}",
+                                         "key", key,
+                                         "ranks", s,
+                                         "signal", signum))
+                || kill_push (f, fw->rank, cf) < 0)
+                goto error;
+            free (s);
+            s = NULL;
+        }
+        idset_destroy (sub);
+        sub = NULL;
+        fw = zlistx_next (l->forwards);
+    }
+    if (!flux_future_first_child (f)) {
+        errno = ESRCH;
+        goto error;
+    }
+    if (flux_future_aux_set (f,
+                             "request",
+                             (void *)flux_msg_incref (msg),
+                             (flux_free_f)flux_msg_decref) < 0) {
+        flux_msg_decref (msg);
+        goto error;
+    }
+    if (flux_future_then (f, -1., kill_continuation, te) < 0)
+        goto error;
+    idset_destroy (ids);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to tree-kill request");
+    free (s);
+    idset_destroy (sub);
+    idset_destroy (ids);
+    flux_future_destroy (f);
+}
+
+/* A process, or a child broker relaying a batch, enters the barrier.
+ * Processes may run as a guest, so authorize against the launch userid.
+ */
+static void tree_barrier_cb (flux_t *h,
+                             flux_msg_handler_t *mh,
+                             const flux_msg_t *msg,
+                             void *arg)
+{
+    struct treeexec *te = arg;
+    const char *key;
+    const char *ranks;
+    struct launch *l;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:s s:s}",
+                             "key", &key,
+                             "ranks", &ranks) < 0)
+        goto error;
+    if (!(l = zhashx_lookup (te->launches, key)) || !l->barrier) {
+        errmsg = "no barrier is associated with this tree-exec key";
+        errno = ENOENT;
+        goto error;
+    }
+    if (flux_msg_authorize (msg, l->userid) < 0)
+        goto error;
+    if (idset_decode_add (l->barrier_ranks, ranks, -1, NULL) < 0)
+        goto error;
+    if (flux_msglist_append (l->barrier_requests, msg) < 0)
+        goto error;
+    launch_schedule (l);
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "error responding to tree-barrier request");
+}
+
+/* Kill the processes of a launch whose requester has gone away and
+ * destroy it.  Forwarded requests are not canceled by destroying their
+ * futures, so send the children a tree-kill for the same ranks.  Their
+ * responses to the destroyed futures are dropped.
+ */
+static void launch_cancel (struct launch *l)
+{
+    struct treeexec *te = l->te;
+    struct forward *fw;
+
+    if (l->p && flux_subprocess_active (l->p)) {
+        flux_future_t *f;
+        if (!(f = flux_subprocess_kill (l->p, SIGKILL)))
+            flux_log_error (te->h, "tree-exec %s: kill", l->key);
+        flux_future_destroy (f);
+    }
+    fw = zlistx_first (l->forwards);
+    while (fw) {
+        char *ranks;
+        flux_future_t *f = NULL;
+
+        if (!(ranks = idset_encode (fw->ranks, IDSET_FLAG_RANGE))
+            || !(f = flux_rpc_pack (te->h,
+                                    te->kill_topic,
+                                    fw->rank,
+                                    FLUX_RPC_NORESPONSE,
+                                    "{s:s s:s s:i}",
+                                    "key", l->key,
+                                    "ranks", ranks,
+                                    "signal", SIGKILL))) {
+            flux_log_error (te->h,
+                            "tree-exec %s: error sending tree-kill to rank %lu",
+                            l->key,
+                            (unsigned long)fw->rank);
+        }
+        flux_future_destroy (f);
+        free (ranks);
+        fw = zlistx_next (l->forwards);
+    }
+    barrier_release (te->h, l->barrier_requests, ECONNRESET, NULL);
+    l->barrier_requests = NULL;
+    zhashx_delete (te->launches, l->key);
+}
+
+void treeexec_disconnect (struct treeexec *te, const flux_msg_t *msg)
+{
+    struct launch *l;
+    zlistx_t *cancel;
+
+    if (!te || !(cancel = zlistx_new ()))
+        return;
+    l = zhashx_first (te->launches);
+    while (l) {
+        if (flux_disconnect_match (msg, l->msg)
+            && !zlistx_add_end (cancel, l))
+            flux_log (te->h, LOG_ERR, "tree-exec %s: out of memory", l->key);
+        l = zhashx_next (te->launches);
+    }
+    l = zlistx_first (cancel);
+    while (l) {
+        launch_cancel (l);
+        l = zlistx_next (cancel);
+    }
+    zlistx_destroy (&cancel);
+}
+
+void treeexec_set_auth_cb (struct treeexec *te,
+                           subprocess_server_auth_f fn,
+                           void *arg)
+{
+    if (te) {
+        te->auth_cb = fn;
+        te->auth_arg = arg;
+    }
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST,  "tree-exec", tree_exec_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,  "tree-kill", tree_kill_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST,  "tree-barrier", tree_barrier_cb, FLUX_ROLE_USER },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+void treeexec_destroy (struct treeexec *te)
+{
+    if (te) {
+        int saved_errno = errno;
+        flux_msg_t *msg;
+
+        flux_msg_handler_delvec (te->handlers);
+        zhashx_destroy (&te->launches);
+        if (te->deferred) {
+            while ((msg = zlist_pop (te->deferred)))
+                flux_msg_decref (msg);
+            zlist_destroy (&te->deferred);
+        }
+        flux_future_destroy (te->f_topo);
+        for (int i = 0; i < te->nchildren; i++)
+            idset_destroy (te->children[i].subtree);
+        free (te->children);
+        free (te->service);
+        free (te);
+        errno = saved_errno;
+    }
+}
+
+struct treeexec *treeexec_create (flux_t *h, const char *service)
+{
+    struct treeexec *te;
+
+    if (!(te = calloc (1, sizeof (*te))))
+        return NULL;
+    te->h = h;
+    if (flux_get_rank (h, &te->rank) < 0)
+        goto error;
+    snprintf (te->rankstr,
+              sizeof (te->rankstr),
+              "%lu",
+              (unsigned long)te->rank);
+    snprintf (te->exec_topic, sizeof (te->exec_topic), "%s.tree-exec", service);
+    snprintf (te->kill_topic, sizeof (te->kill_topic), "%s.tree-kill", service);
+    snprintf (te->barrier_topic,
+              sizeof (te->barrier_topic),
+              "%s.tree-barrier",
+              service);
+    if (!(te->service = strdup (service))
+        || !(te->deferred = zlist_new ())
+        || !(te->launches = zhashx_new ()))
+        goto nomem;
+    zhashx_set_destructor (te->launches, launch_destructor);
+    if (flux_msg_handler_addvec_ex (h, service, htab, te, &te->handlers) < 0)
+        goto error;
+    return te;
+nomem:
+    errno = ENOMEM;
+error:
+    treeexec_destroy (te);
+    return NULL;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,41 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _REXEC_TREEEXEC_H
+#define _REXEC_TREEEXEC_H
+
+#include <flux/core.h>
+
+#include "src/common/libsubprocess/server.h"
+
+/* Register 'service'.tree-exec and 'service'.tree-kill handlers.
+ * Processes are launched locally through 'service', which must be
+ * the subprocess server running in the same module.
+ */
+struct treeexec *treeexec_create (flux_t *h, const char *service);
+void treeexec_destroy (struct treeexec *te);
+
+/* Register a callback to allow/deny each tree-exec request that would
+ * start a process on the local rank, as for subprocess_server_set_auth_cb().
+ */
+void treeexec_set_auth_cb (struct treeexec *te,
+                           subprocess_server_auth_f fn,
+                           void *arg);
+
+/* Kill processes and cancel forwarded requests of tree-exec requests
+ * from the sender of 'msg', a 'service'.disconnect request.  The caller
+ * must register the disconnect handler since the subprocess server
+ * also needs to receive it.
+ */
+void treeexec_disconnect (struct treeexec *te, const flux_msg_t *msg);
+
+#endif /* !_REXEC_TREEEXEC_H */
+
+// vi:ts=4 sw=4 expandtab
@@ -23,11 +23,15 @@ immediately (backfill) provided they meet both of the EASY constraints:
 Jobs submitted without a duration (``--time-limit=0``) cannot be backfilled
 because their finish time is unknown.
 
-The shadow time is computed by running the allocator against a temporary
-copy of the resource pool and advancing through expiration events until the
-head job fits.  This gives an accurate shadow time that respects topology
-and property constraints — it tightens the backfill window compared to
-count-based heuristics without over-constraining candidates.
+The shadow time is the earliest step of an availability profile
+(:class:`~flux.resource.AvailabilityProfile.AvailabilityProfile`) at which
+the head job fits.  Each step is a copy of the resource pool at a running
+job's end time, so the allocator itself decides whether the job fits.  This
+gives an accurate shadow time that respects topology and property
+constraints — it tightens the backfill window compared to count-based
+heuristics without over-constraining candidates.  The profile is updated
+incrementally as jobs start, complete and change expiration, so job
+turnover does not require replaying every release to recompute it.
 
 Load with::
 
@@ -52,6 +56,7 @@ import time
 from _flux._core import lib
 from flux.job import JobID
 from flux.resource import InfeasibleRequest, InsufficientResources
+from flux.resource.AvailabilityProfile import AvailabilityProfile
 from flux.scheduler import Scheduler
 
 
@@ -59,13 +64,15 @@ class BackfillScheduler(Scheduler):
     """EASY backfill scheduler.
 
     Overrides:
-      - :meth:`expiration` — update the pool's end-time tracking for the job
-      - :meth:`cancel`     — clear annotations before removing from queue
-      - :meth:`schedule`   — head-first with backfill for lower-priority jobs
+      - :meth:`expiration`      — update the pool's end-time tracking for the job
+      - :meth:`free`            — return resources to the pool and the profile
+      - :meth:`cancel`          — clear annotations before removing from queue
+      - :meth:`resource_update` — rebuild the availability profile
+      - :meth:`schedule`        — head-first with backfill for lower-priority jobs
 
     Helper methods (not base-class overrides):
       - :meth:`_try_alloc`        — attempt a real allocation, handling exceptions
-      - :meth:`_shadow_time`      — compute head job's reservation time via simulation
+      - :meth:`_shadow_time`      — query the head job's reservation time
       - :meth:`_annotate_pending` — send ``t_estimate`` annotation to the head job
     """
 
@@ -78,6 +85,9 @@ class BackfillScheduler(Scheduler):
         # job does not mutate the pool and therefore does not invalidate it.
         self._shadow_cache_key = None
         self._shadow_cache_value = None
+        # Availability profile of self.resources, created by resource_update()
+        # once the pool exists.
+        self._profile = None
 
     # ------------------------------------------------------------------
     # Scheduler overrides
@@ -88,12 +98,20 @@ class BackfillScheduler(Scheduler):
 
         Called when a job's time limit is extended or reduced.  Keeping the
         pool's end-time tracking current is essential for accurate shadow-time
-        computation: a stale end time would cause the simulation to free the
+        computation: a stale end time would cause the profile to release the
         job's resources at the wrong moment.
         """
         self.resources.update_expiration(jobid, expiration)
+        if self._profile is not None:
+            self._profile.update_expiration(jobid, expiration)
         self.handle.respond(msg, None)
 
+    def free(self, jobid, R, final=False):
+        """Return released resources to the pool and the availability profile."""
+        super().free(jobid, R, final)
+        if self._profile is not None:
+            self._profile.free(jobid, R, final)
+
     def cancel(self, jobid):
         """Remove a pending job from the queue, clearing its annotations first."""
         for job in self._queue:
@@ -104,6 +122,14 @@ class BackfillScheduler(Scheduler):
                 break
         super().cancel(jobid)
 
+    def resource_update(self):
+        """Rebuild the availability profile after a resource state change.
+
+        Nodes going up or down and resource expiration changes affect every
+        step of the profile, so it is discarded and rebuilt on demand.
+        """
+        self._profile = AvailabilityProfile(self.resources)
+
     # ------------------------------------------------------------------
     # Scheduling logic
     # ------------------------------------------------------------------
@@ -136,10 +162,19 @@ class BackfillScheduler(Scheduler):
         reactor = lib.flux_get_reactor(self.handle.handle)
         now = lib.flux_reactor_now(reactor)
         alloc.set_starttime(now)
+        end_time = 0.0
         if rr.duration > 0.0:
-            alloc.set_expiration(now + rr.duration)
+            end_time = now + rr.duration
         elif self.resources.expiration > 0.0:
-            alloc.set_expiration(self.resources.expiration)
+            end_time = self.resources.expiration
+        if end_time > 0.0:
+            alloc.set_expiration(end_time)
+            # The pool recorded its own wall-clock end time for the job.
+            # Replace it with the one in R so the profile and a rebuild
+            # from pool.job_end_times() agree.
+            self.resources.update_expiration(job.jobid, end_time)
+        if self._profile is not None:
+            self._profile.alloc(job.jobid, alloc, end_time)
 
         summary = alloc.dumps()
         annotations = {"sched": {"resource_summary": summary}}
@@ -166,13 +201,13 @@ class BackfillScheduler(Scheduler):
             head.request.annotate({"sched": {"t_estimate": shadow}})
 
     def _shadow_time(self, head):
-        """Compute the EASY reservation time for the head job via direct simulation.
+        """Query the EASY reservation time for the head job.
 
-        Creates a temporary deep copy of the resource pool and advances it
-        through expiration events until the head job's request fits.  Using
-        the allocator directly (rather than count-based heuristics) gives an
-        accurate shadow time that respects topology and property constraints,
-        tightening the backfill window without over-constraining candidates.
+        Returns the time of the earliest availability profile step at which
+        the head job's request fits.  The profile steps are copies of the
+        resource pool at running job end times, so the allocator itself
+        decides whether the job fits, respecting topology and property
+        constraints.
 
         The result is cached by ``(pool.generation, head.jobid)``.
         ``pool.generation`` is bumped on every pool mutation (job start/complete,
@@ -193,29 +228,12 @@ class BackfillScheduler(Scheduler):
         if self._shadow_cache_key == key:
             return self._shadow_cache_value
 
-        sim = self.resources.copy()
-        rr = head.resource_request
-        t = 0.0
+        if self._profile is None:
+            self._profile = AvailabilityProfile(self.resources)
+        t = self._profile.earliest_start(head.jobid, head.resource_request)
         shadow = None
-        while True:
-            try:
-                sim.alloc(head.jobid, rr)
-                shadow = max(t, time.time())  # map sim time to wall clock
-                break
-            except InfeasibleRequest:
-                break  # permanently infeasible — shadow stays None
-            except InsufficientResources:
-                # Not enough resources now; advance to the next expiration.
-                nxt = min(
-                    (e for _, e in sim.job_end_times() if e > t),
-                    default=None,
-                )
-                if nxt is None:
-                    break  # no future expirations — shadow stays None
-                t = nxt
-                for jid, end_time in list(sim.job_end_times()):
-                    if 0 < end_time <= t:
-                        sim.free(jid)
+        if t is not None:
+            shadow = max(t, time.time())  # map profile time to wall clock
 
         self._shadow_cache_key = key
         self._shadow_cache_value = shadow
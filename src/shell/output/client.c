@@ -21,6 +21,9 @@
  * output plugin stops reading output from local tasks until more
  * credits are received from the leader.
  *
+ * With output.binary, task data is sent in iochunk format as the raw
+ * payload of a "write-data" request instead of a JSON "write" request.
+ *
  */
 #if HAVE_CONFIG_H
 #include "config.h"
@@ -31,10 +34,13 @@
 #define FLUX_SHELL_PLUGIN_NAME "output.client"
 
 #include "src/common/libioencode/ioencode.h"
+#include "src/common/libioencode/iochunk.h"
+#include "src/common/libutil/errno_safe.h"
 #include "ccan/str/str.h"
 
 #include "internal.h"
 #include "info.h"
+#include "svc.h"
 #include "output/client.h"
 
 struct output_client {
@@ -125,22 +131,12 @@ static void getcredit_continuation (flux_future_t *f, void *arg)
     client->f_getcredit = NULL;
 }
 
-int output_client_send (struct output_client *client,
-                        const char *type,
-                        json_t *context)
+/* Account for one write request sent to the leader.
+ */
+static int output_client_debit (struct output_client *client)
 {
-    flux_future_t *f;
+    flux_future_t *f = NULL;
 
-    if (!(f = flux_shell_rpc_pack (client->shell,
-                                   "write",
-                                   0,
-                                   FLUX_RPC_NORESPONSE,
-                                   "{s:s s:i s:O}",
-                                   "name", type,
-                                   "shell_rank", client->shell_rank,
-                                   "context", context)))
-        return -1;
-    flux_future_destroy (f);
     /* Order more credits at low water mark.
      */
     if (--client->credits <= client->lwm && !client->f_getcredit) {
@@ -164,7 +160,54 @@ int output_client_send (struct output_client *client,
 error:
     flux_future_destroy (f);
     return -1;
+}
+
+int output_client_send (struct output_client *client,
+                        const char *type,
+                        json_t *context)
+{
+    flux_future_t *f;
 
+    if (!(f = flux_shell_rpc_pack (client->shell,
+                                   "write",
+                                   0,
+                                   FLUX_RPC_NORESPONSE,
+                                   "{s:s s:i s:O}",
+                                   "name", type,
+                                   "shell_rank", client->shell_rank,
+                                   "context", context)))
+        return -1;
+    flux_future_destroy (f);
+    return output_client_debit (client);
+}
+
+int output_client_send_data (struct output_client *client,
+                             const char *stream,
+                             const char *rank,
+                             const char *data,
+                             int len,
+                             bool eof)
+{
+    flux_future_t *f;
+    ssize_t size;
+    char *buf;
+
+    if ((size = iochunk_record_size (rank, len)) < 0
+        || !(buf = malloc (size)))
+        return -1;
+    if (iochunk_encode (buf, size, 0., stream, rank, data, len, eof) < 0
+        || !(f = shell_svc_raw (client->shell->svc,
+                                "write-data",
+                                0,
+                                FLUX_RPC_NORESPONSE,
+                                buf,
+                                size))) {
+        ERRNO_SAFE_WRAP (free, buf);
+        return -1;
+    }
+    free (buf);
+    flux_future_destroy (f);
+    return output_client_debit (client);
 }
 
 /* vi: ts=4 sw=4 expandtab
@@ -28,5 +28,14 @@ int output_client_send (struct output_client *client,
                         const char *type,
                         json_t *context);
 
+/* Send task data to the leader in iochunk format.
+ */
+int output_client_send_data (struct output_client *client,
+                             const char *stream,
+                             const char *rank,
+                             const char *data,
+                             int len,
+                             bool eof);
+
 #endif /* !SHELL_OUTPUT_CLIENT_H */
 
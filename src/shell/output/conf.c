@@ -15,6 +15,7 @@
  * {
  *  "output": {
  *    "mode": "truncate|append",
+ *    "binary": integer,
  *    "client": { "lwm": integer, "hwm": integer },
  *    "stdout" {
  *      "type": "kvs|file",
@@ -138,6 +139,14 @@ struct output_config *output_config_create (flux_shell_t *shell)
     if (output_stream_getopts (shell, "stderr", &conf->err) < 0)
         goto error;
 
+    if (flux_shell_getopt_unpack (shell,
+                                  "output",
+                                  "{s?i}",
+                                  "binary", &conf->binary) < 0) {
+        shell_log_error ("output.binary must be an integer");
+        goto error;
+    }
+
     return conf;
 error:
     output_config_destroy (conf);
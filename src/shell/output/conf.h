@@ -34,6 +34,7 @@ struct output_stream {
 struct output_config {
     struct output_stream out;
     struct output_stream err;
+    int binary;     // send data to leader and KVS in iochunk format
 };
 
 struct output_config *output_config_create (flux_shell_t *shell);
@@ -21,6 +21,11 @@
  *    single vs multiuser instances (see SINGLEUSER_OUTPUT_LIMIT
  *    and MULTIUSER_OUTPUT_LIMIT below) Output is truncated once
  *    the limit is reached and a warning is logged.
+ *  - With output.binary, task data is not logged as RFC 24 data events.
+ *    Records in iochunk format are coalesced into a buffer which is
+ *    appended to the "output-data" key when it reaches DATA_FLUSH_SIZE
+ *    or when the batch timeout expires.  The header event carries
+ *    options.binary=true so readers know to look there for data.
  */
 #if HAVE_CONFIG_H
 #include "config.h"
@@ -33,6 +38,7 @@
 #define FLUX_SHELL_PLUGIN_NAME "output.kvs"
 
 #include "src/common/libioencode/ioencode.h"
+#include "src/common/libioencode/iochunk.h"
 #include "src/common/libeventlog/eventlogger.h"
 #include "src/common/libutil/parse_size.h"
 #include "src/common/libutil/errno_safe.h"
@@ -44,6 +50,9 @@
 
 #define DEFAULT_BATCH_TIMEOUT 0.5
 
+#define DATA_KEY                "output-data"
+#define DATA_FLUSH_SIZE         (1024*1024)
+
 #define SINGLEUSER_OUTPUT_LIMIT "1G"
 #define MULTIUSER_OUTPUT_LIMIT  "10M"
 #define OUTPUT_LIMIT_MAX        1073741824
@@ -58,6 +67,12 @@ struct kvs_output {
     size_t stdout_bytes;
     size_t stderr_bytes;
     struct eventlogger *ev;
+
+    bool binary;
+    char *data;                 // pending iochunk records
+    size_t data_len;
+    size_t data_size;
+    flux_watcher_t *data_timer;
 };
 
 static void kvs_output_truncation_warning (struct kvs_output *kvs)
@@ -88,8 +103,59 @@ static void kvs_output_truncation_warning (struct kvs_output *kvs)
     }
 }
 
+static void data_commit_continuation (flux_future_t *f, void *arg)
+{
+    struct kvs_output *kvs = arg;
+
+    if (flux_future_get (f, NULL) < 0)
+        shell_log_errno ("error appending to %s", DATA_KEY);
+    flux_future_destroy (f);
+    flux_shell_remove_completion_ref (kvs->shell, "output.txn");
+}
+
+static int kvs_output_data_flush (struct kvs_output *kvs)
+{
+    flux_t *h = flux_shell_get_flux (kvs->shell);
+    flux_kvs_txn_t *txn;
+    flux_future_t *f = NULL;
+
+    flux_watcher_stop (kvs->data_timer);
+    if (kvs->data_len == 0)
+        return 0;
+    if (!(txn = flux_kvs_txn_create ())
+        || flux_kvs_txn_put_raw (txn,
+                                 FLUX_KVS_APPEND,
+                                 DATA_KEY,
+                                 kvs->data,
+                                 kvs->data_len) < 0
+        || !(f = flux_kvs_commit (h, NULL, 0, txn))
+        || flux_future_then (f, -1., data_commit_continuation, kvs) < 0)
+        goto error;
+    flux_kvs_txn_destroy (txn);
+    flux_shell_add_completion_ref (kvs->shell, "output.txn");
+    kvs->data_len = 0;
+    return 0;
+error:
+    flux_future_destroy (f);
+    ERRNO_SAFE_WRAP (flux_kvs_txn_destroy, txn);
+    return -1;
+}
+
+static void data_timer_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    struct kvs_output *kvs = arg;
+
+    if (kvs_output_data_flush (kvs) < 0)
+        shell_log_errno ("error flushing %s", DATA_KEY);
+}
+
 void kvs_output_flush (struct kvs_output *kvs)
 {
+    if (kvs_output_data_flush (kvs) < 0)
+        shell_log_errno ("error flushing %s", DATA_KEY);
     if (eventlogger_flush (kvs->ev) < 0)
         shell_log_errno ("eventlogger_flush");
 }
@@ -109,6 +175,8 @@ void kvs_output_destroy (struct kvs_output *kvs)
         if (kvs->ev && eventlogger_flush (kvs->ev) < 0)
             shell_log_errno ("eventlogger_flush");
         eventlogger_destroy (kvs->ev);
+        flux_watcher_destroy (kvs->data_timer);
+        free (kvs->data);
         free (kvs);
         errno = saved_errno;
     }
@@ -197,27 +265,40 @@ static int kvs_eventlogger_start (struct kvs_output *kvs,
 
 /* Write RFC 24 header event to KVS.  Assume:
  * - fixed utf-8 encoding for stdout, stderr
- * - no options
+ * - binary option only
  * - no stdlog
  */
 static int write_kvs_header (struct kvs_output *kvs)
 {
-    return eventlogger_append_pack (kvs->ev,
-                                    0,
-                                    "output",
-                                    "header",
-                                    "{s:i s:{s:s s:s} s:{s:i s:i} s:{}}",
-                                    "version", 1,
-                                    "encoding",
-                                     "stdout", "UTF-8",
-                                     "stderr", "UTF-8",
-                                    "count",
-                                     "stdout", kvs->ntasks,
-                                     "stderr", kvs->ntasks,
-                                    "options");
+    json_t *options;
+    int rc;
+
+    if (kvs->binary)
+        options = json_pack ("{s:b}", "binary", 1);
+    else
+        options = json_object ();
+    if (!options) {
+        errno = ENOMEM;
+        return -1;
+    }
+    rc = eventlogger_append_pack (kvs->ev,
+                                  0,
+                                  "output",
+                                  "header",
+                                  "{s:i s:{s:s s:s} s:{s:i s:i} s:O}",
+                                  "version", 1,
+                                  "encoding",
+                                   "stdout", "UTF-8",
+                                   "stderr", "UTF-8",
+                                  "count",
+                                   "stdout", kvs->ntasks,
+                                   "stderr", kvs->ntasks,
+                                  "options", options);
+    ERRNO_SAFE_WRAP (json_decref, options);
+    return rc;
 }
 
-struct kvs_output *kvs_output_create (flux_shell_t *shell)
+struct kvs_output *kvs_output_create (flux_shell_t *shell, bool binary)
 {
     struct kvs_output *kvs;
     double batch_timeout = DEFAULT_BATCH_TIMEOUT;
@@ -235,7 +316,17 @@ struct kvs_output *kvs_output_create (flux_shell_t *shell)
 
     kvs->shell = shell;
     kvs->ntasks = shell->info->total_ntasks;
-
+    kvs->binary = binary;
+
+    if (binary) {
+        flux_reactor_t *r = flux_get_reactor (flux_shell_get_flux (shell));
+        if (!(kvs->data_timer = flux_timer_watcher_create (r,
+                                                           batch_timeout,
+                                                           0.,
+                                                           data_timer_cb,
+                                                           kvs)))
+            goto error;
+    }
     if (get_output_limit (kvs) < 0
         || kvs_eventlogger_start (kvs, batch_timeout) < 0
         || write_kvs_header (kvs) < 0)
@@ -325,6 +416,82 @@ int kvs_output_write_entry (struct kvs_output *kvs,
     return eventlogger_append_pack (kvs->ev, 0, "output", type, "O", context);
 }
 
+static int data_append (struct kvs_output *kvs,
+                        double timestamp,
+                        const char *stream,
+                        const char *rank,
+                        const char *data,
+                        int len,
+                        bool eof)
+{
+    ssize_t size;
+    ssize_t n;
+
+    if (check_kvs_output_limit (kvs, stream, len) && !eof)
+        return 0;
+    if ((size = iochunk_record_size (rank, len)) < 0)
+        return -1;
+    if (kvs->data_len + size > kvs->data_size) {
+        size_t newsize = kvs->data_size ? kvs->data_size : 4096;
+        char *p;
+
+        while (newsize < kvs->data_len + size)
+            newsize *= 2;
+        if (!(p = realloc (kvs->data, newsize)))
+            return -1;
+        kvs->data = p;
+        kvs->data_size = newsize;
+    }
+    if ((n = iochunk_encode (kvs->data + kvs->data_len,
+                             kvs->data_size - kvs->data_len,
+                             timestamp,
+                             stream,
+                             rank,
+                             data,
+                             len,
+                             eof)) < 0)
+        return -1;
+    kvs->data_len += n;
+    if (kvs->data_len >= DATA_FLUSH_SIZE)
+        return kvs_output_data_flush (kvs);
+    flux_watcher_start (kvs->data_timer);
+    return 0;
+}
+
+int kvs_output_write_data (struct kvs_output *kvs,
+                           const char *stream,
+                           const char *rank,
+                           const char *data,
+                           int len,
+                           bool eof)
+{
+    return data_append (kvs, 0., stream, rank, data, len, eof);
+}
+
+int kvs_output_write_chunk (struct kvs_output *kvs,
+                            const void *buf,
+                            size_t size)
+{
+    struct iochunk_record rec;
+    ssize_t n;
+
+    while (size > 0) {
+        if ((n = iochunk_decode (buf, size, &rec)) < 0)
+            return -1;
+        if (data_append (kvs,
+                         rec.timestamp,
+                         rec.stream,
+                         rec.rank,
+                         rec.data,
+                         rec.len,
+                         rec.eof) < 0)
+            return -1;
+        buf = (const char *)buf + n;
+        size -= n;
+    }
+    return 0;
+}
+
 void kvs_output_reconnect (struct kvs_output *kvs)
 {
     /* during a reconnect, response to event logging may not occur,
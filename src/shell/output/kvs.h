@@ -18,7 +18,10 @@
 #include <flux/core.h>
 #include <flux/shell.h>
 
-struct kvs_output *kvs_output_create (flux_shell_t *shell);
+/* If 'binary' is true, task data is written in iochunk format to the
+ * "output-data" key instead of the output eventlog.
+ */
+struct kvs_output *kvs_output_create (flux_shell_t *shell, bool binary);
 
 void kvs_output_destroy (struct kvs_output *kvs);
 
@@ -30,6 +33,21 @@ int kvs_output_write_entry (struct kvs_output *kvs,
                             const char *type,
                             json_t *context);
 
+/* Write task data in binary mode.
+ */
+int kvs_output_write_data (struct kvs_output *kvs,
+                           const char *stream,
+                           const char *rank,
+                           const char *data,
+                           int len,
+                           bool eof);
+
+/* Write a buffer of iochunk records received from another shell.
+ */
+int kvs_output_write_chunk (struct kvs_output *kvs,
+                            const void *buf,
+                            size_t size);
+
 int kvs_output_redirect (struct kvs_output *kvs,
                          const char *stream,
                          const char *path);
@@ -39,6 +39,7 @@
 
 #include "src/common/libidset/idset.h"
 #include "src/common/libioencode/ioencode.h"
+#include "src/common/libioencode/iochunk.h"
 #include "ccan/str/str.h"
 
 #include "task.h"
@@ -125,6 +126,44 @@ int shell_output_write_entry (struct shell_output *out,
     return kvs_output_write_entry (out->kvs, type, o);
 }
 
+int shell_output_write_chunk (struct shell_output *out,
+                              const void *buf,
+                              size_t size)
+{
+    struct iochunk_record rec;
+    ssize_t n;
+
+    /* Without output files, records go to the KVS unchanged.
+     */
+    if (!out->stdout_fp && !out->stderr_fp)
+        return kvs_output_write_chunk (out->kvs, buf, size);
+
+    while (size > 0) {
+        struct file_entry *fp;
+
+        if ((n = iochunk_decode (buf, size, &rec)) < 0)
+            return -1;
+        if (streq (rec.stream, "stdout"))
+            fp = out->stdout_fp;
+        else
+            fp = out->stderr_fp;
+        if (fp) {
+            if (file_entry_write (fp, rec.rank, rec.data, rec.len) < 0)
+                return -1;
+        }
+        else if (kvs_output_write_data (out->kvs,
+                                        rec.stream,
+                                        rec.rank,
+                                        rec.data,
+                                        rec.len,
+                                        rec.eof) < 0)
+            return -1;
+        buf = (const char *)buf + n;
+        size -= n;
+    }
+    return 0;
+}
+
 static void shell_output_close (struct shell_output *out)
 {
     file_entry_close (out->stdout_fp);
@@ -232,7 +271,7 @@ struct shell_output *shell_output_create (flux_plugin_t *p,
 
         /* Create kvs output eventlog + header
          */
-        if (!(out->kvs = kvs_output_create (shell)))
+        if (!(out->kvs = kvs_output_create (shell, out->conf->binary)))
             goto error;
 
         /* If output is redirected to a file, post redirect event(s) to KVS
@@ -37,6 +37,12 @@ int shell_output_write_entry (struct shell_output *out,
                               const char *type,
                               json_t *context);
 
+/* Write a buffer of iochunk records received from another shell.
+ */
+int shell_output_write_chunk (struct shell_output *out,
+                              const void *buf,
+                              size_t size);
+
 /* Increment/decrement shell output "open" count. Once refcount goes to
  * zero, shell output destinations will be flushed and closed.
  */
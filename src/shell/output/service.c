@@ -15,7 +15,8 @@
  * client shell ranks send output (see output/client.c).
  *
  * Clients may send an RFC 24 encoded data event, or a "log" event for
- * propagation of log messages from other job shells.
+ * propagation of log messages from other job shells.  With output.binary,
+ * clients send data as iochunk records to the "write-data" method.
  *
  * Local task and logging output is not routed through this service
  * code.
@@ -93,6 +94,20 @@ static void output_service_write_cb (flux_t *h,
         shell_log_errno ("error recording write data for rank %d", shell_rank);
 }
 
+static void output_service_write_data_cb (flux_t *h,
+                                          flux_msg_handler_t *mh,
+                                          const flux_msg_t *msg,
+                                          void *arg)
+{
+    struct output_service *service = arg;
+    const void *buf;
+    size_t size;
+
+    if (flux_request_decode_raw (msg, NULL, &buf, &size) < 0
+        || shell_output_write_chunk (service->out, buf, size) < 0)
+        shell_log_errno ("error recording binary write data");
+}
+
 static void output_service_write_getcredit_cb (flux_t *h,
                                                flux_msg_handler_t *mh,
                                                const flux_msg_t *msg,
@@ -141,6 +156,10 @@ struct output_service *output_service_create (struct shell_output *out,
                                         "write",
                                         output_service_write_cb,
                                         service) < 0
+        || flux_shell_service_register (out->shell,
+                                        "write-data",
+                                        output_service_write_data_cb,
+                                        service) < 0
         || flux_shell_service_register (out->shell,
                                         "write-getcredit",
                                         output_service_write_getcredit_cb,
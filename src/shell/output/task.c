@@ -127,6 +127,13 @@ static int task_output_write_client (struct task_output *to,
     int rc;
     json_t *o;
 
+    if (to->out->conf->binary)
+        return output_client_send_data (to->out->client,
+                                        stream,
+                                        to->rank_str,
+                                        data,
+                                        len,
+                                        eof);
     if (!(o = task_output_ioencode (to, stream, data, len, eof)))
         return -1;
     rc = output_client_send (to->out->client, "data", o);
@@ -143,6 +150,13 @@ static int task_output_write_kvs (struct task_output *to,
     int rc;
     json_t *o;
 
+    if (to->out->conf->binary)
+        return kvs_output_write_data (to->out->kvs,
+                                      stream,
+                                      to->rank_str,
+                                      data,
+                                      len,
+                                      eof);
     if (!(o = task_output_ioencode (to, stream, data, len, eof)))
         return -1;
     rc = kvs_output_write_entry (to->out->kvs, "data", o);
@@ -43,6 +43,11 @@
  * shell_pmi_task_ready() logs read errors, EOF, and finalization to stderr
  * in a compatible format.
  *
+ * With pmi-simple.kvs=modex, the barrier exchanges only an index that
+ * maps each key to the shell rank that owns it.  Values stay on the
+ * owning shell until a task asks for them, then are fetched directly
+ * with a pmi-kvs-get request and cached locally.
+ *
  * Caveats:
  * - PMI kvsname parameter is ignored
  * - 64-bit Flux job id's are assigned to integer-typed PMI appnum
@@ -83,6 +88,8 @@ struct shell_pmi {
     json_t *global; // already exchanged
     json_t *pending;// pending to be exchanged
     json_t *locals;  // never exchanged
+    json_t *index;  // modex: key => owner shell rank
+    zhashx_t *fetches; // modex: key => struct kvs_fetch in progress
     struct pmi_exchange *exchange;
     bool abort;     // an abort exception has been raised
 };
@@ -211,6 +218,222 @@ static int exchange_kvs_put (void *arg,
     return put_dict (pmi->pending, key, val);
 }
 
+/**
+ ** ops for on-demand (direct modex) PMI KVS
+ ** This is used if pmi.kvs=modex option is provided.
+ **/
+
+struct kvs_fetch {
+    struct shell_pmi *pmi;
+    char *key;
+    zlist_t *clients;           // clients awaiting the value
+    flux_future_t *f;
+};
+
+static void kvs_fetch_destroy (struct kvs_fetch *fetch)
+{
+    if (fetch) {
+        int saved_errno = errno;
+        zlist_destroy (&fetch->clients);
+        flux_future_destroy (fetch->f);
+        free (fetch->key);
+        free (fetch);
+        errno = saved_errno;
+    }
+}
+
+/* zhashx_destructor_fn footprint */
+static void kvs_fetch_destructor (void **item)
+{
+    if (item) {
+        kvs_fetch_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void modex_fetch_continuation (flux_future_t *f, void *arg)
+{
+    struct kvs_fetch *fetch = arg;
+    struct shell_pmi *pmi = fetch->pmi;
+    const char *val = NULL;
+    void *cli;
+
+    if (flux_rpc_get_unpack (f, "{s:s}", "value", &val) < 0) {
+        shell_warn ("pmi-kvs-get %s: %s",
+                    fetch->key,
+                    future_strerror (f, errno));
+        val = NULL;
+    }
+    else if (put_dict (pmi->global, fetch->key, val) < 0)
+        shell_warn ("pmi-kvs-get %s: error caching value", fetch->key);
+    while ((cli = zlist_pop (fetch->clients)))
+        pmi_simple_server_kvs_get_complete (pmi->server, cli, val);
+    zhashx_delete (pmi->fetches, fetch->key); // destroys fetch and f
+}
+
+static struct kvs_fetch *modex_fetch (struct shell_pmi *pmi,
+                                      const char *key,
+                                      int owner)
+{
+    struct kvs_fetch *fetch;
+
+    if (!(fetch = calloc (1, sizeof (*fetch))))
+        return NULL;
+    fetch->pmi = pmi;
+    if (!(fetch->key = strdup (key))
+        || !(fetch->clients = zlist_new ()))
+        goto nomem;
+    if (!(fetch->f = flux_shell_rpc_pack (pmi->shell,
+                                          "pmi-kvs-get",
+                                          owner,
+                                          0,
+                                          "{s:s}",
+                                          "key", key))
+        || flux_future_then (fetch->f,
+                             -1,
+                             modex_fetch_continuation,
+                             fetch) < 0)
+        goto error;
+    if (zhashx_insert (pmi->fetches, fetch->key, fetch) < 0)
+        goto nomem;
+    return fetch;
+nomem:
+    errno = ENOMEM;
+error:
+    kvs_fetch_destroy (fetch);
+    return NULL;
+}
+
+/* pmi_simple_ops->kvs_get() signature */
+static int modex_kvs_get (void *arg,
+                          void *cli,
+                          const char *kvsname,
+                          const char *key)
+{
+    struct shell_pmi *pmi = arg;
+    struct kvs_fetch *fetch;
+    json_t *o;
+
+    if ((o = json_object_get (pmi->locals, key))
+        || (o = json_object_get (pmi->pending, key))
+        || (o = json_object_get (pmi->global, key))) {
+        pmi_simple_server_kvs_get_complete (pmi->server,
+                                            cli,
+                                            json_string_value (o));
+        return 0;
+    }
+    if (!(o = json_object_get (pmi->index, key)))
+        return -1; // PMI_ERR_INVALID_KEY
+    /* Tasks on this shell that ask for the same key share one fetch.
+     */
+    if (!(fetch = zhashx_lookup (pmi->fetches, key))
+        && !(fetch = modex_fetch (pmi, key, json_integer_value (o)))) {
+        shell_warn ("pmi-kvs-get %s: %s", key, flux_strerror (errno));
+        return -1;
+    }
+    if (zlist_append (fetch->clients, cli) < 0) {
+        shell_warn ("pmi-kvs-get %s: out of memory", key);
+        return -1;
+    }
+    return 0;
+}
+
+/* Another shell is fetching a value owned by this shell.
+ */
+static void modex_kvs_get_cb (flux_t *h,
+                              flux_msg_handler_t *mh,
+                              const flux_msg_t *msg,
+                              void *arg)
+{
+    struct shell_pmi *pmi = arg;
+    const char *key;
+    const char *val;
+    json_t *o;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "key", &key) < 0)
+        goto error;
+    if (!(o = json_object_get (pmi->global, key))
+        || !(val = json_string_value (o))) {
+        errno = ENOENT;
+        goto error;
+    }
+    if (flux_respond_pack (h, msg, "{s:s}", "value", val) < 0)
+        shell_warn ("error responding to pmi-kvs-get request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        shell_warn ("error responding to pmi-kvs-get request");
+}
+
+static void modex_exchange_cb (struct pmi_exchange *pex, void *arg)
+{
+    struct shell_pmi *pmi = arg;
+    int rank = pmi->shell->info->shell_rank;
+    json_t *dict;
+    const char *key;
+    json_t *owner;
+    int rc = -1;
+
+    if (pmi_exchange_has_error (pex)) {
+        shell_warn ("exchange failed");
+        goto done;
+    }
+    dict = pmi_exchange_get_dict (pex);
+    /* Drop cached values for keys that were put again elsewhere.
+     */
+    json_object_foreach (dict, key, owner) {
+        if (json_integer_value (owner) != rank)
+            (void)json_object_del (pmi->global, key);
+    }
+    if (json_object_update (pmi->index, dict) < 0) {
+        shell_warn ("failed to update index after successful exchange");
+        goto done;
+    }
+    rc = 0;
+done:
+    pmi_simple_server_barrier_complete (pmi->server, rc);
+}
+
+/* pmi_simple_ops->barrier_enter() signature */
+static int modex_barrier_enter (void *arg)
+{
+    struct shell_pmi *pmi = arg;
+    int rank = pmi->shell->info->shell_rank;
+    json_t *index;
+    const char *key;
+    json_t *val;
+
+    if (pmi->shell->info->shell_size == 1) {
+        pmi_simple_server_barrier_complete (pmi->server, 0);
+        return 0;
+    }
+    /* Publish only key names.  Values move from pending to global, where
+     * they are served to other shells on request.
+     */
+    if (!(index = json_object ()))
+        goto nomem;
+    json_object_foreach (pmi->pending, key, val) {
+        json_t *o;
+        if (!(o = json_integer (rank))
+            || json_object_set_new (index, key, o) < 0)
+            goto nomem;
+    }
+    if (json_object_update (pmi->global, pmi->pending) < 0)
+        goto nomem;
+    json_object_clear (pmi->pending);
+    if (pmi_exchange (pmi->exchange, index, modex_exchange_cb, pmi) < 0) {
+        shell_warn ("pmi_exchange %s", flux_strerror (errno));
+        json_decref (index);
+        return -1; // PMI_FAIL
+    }
+    json_decref (index);
+    return 0;
+nomem:
+    shell_warn ("pmi_exchange: out of memory");
+    json_decref (index);
+    return -1; // PMI_FAIL
+}
+
 /**
  ** end of KVS implementations
  **/
@@ -365,6 +588,8 @@ static void pmi_destroy (struct shell_pmi *pmi)
         json_decref (pmi->global);
         json_decref (pmi->pending);
         json_decref (pmi->locals);
+        json_decref (pmi->index);
+        zhashx_destroy (&pmi->fetches);
         free (pmi);
         errno = saved_errno;
     }
@@ -423,6 +648,26 @@ static struct shell_pmi *pmi_create (flux_shell_t *shell, json_t *config)
         if (!(pmi->exchange = pmi_exchange_create (shell, exchange_k)))
             goto error;
     }
+    else if (streq (kvs, "modex")) {
+        shell_pmi_ops.kvs_put = exchange_kvs_put;
+        shell_pmi_ops.kvs_get = modex_kvs_get;
+        shell_pmi_ops.barrier_enter = modex_barrier_enter;
+        if (!(pmi->exchange = pmi_exchange_create (shell, exchange_k)))
+            goto error;
+        if (!(pmi->index = json_object ())
+            || !(pmi->fetches = zhashx_new ())) {
+            errno = ENOMEM;
+            goto error;
+        }
+        zhashx_set_destructor (pmi->fetches, kvs_fetch_destructor);
+        zhashx_set_key_duplicator (pmi->fetches, NULL);
+        zhashx_set_key_destructor (pmi->fetches, NULL);
+        if (flux_shell_service_register (shell,
+                                         "pmi-kvs-get",
+                                         modex_kvs_get_cb,
+                                         pmi) < 0)
+            goto error;
+    }
     else {
         shell_log_error ("Unknown kvs implementation %s", kvs);
         errno = EINVAL;
@@ -1492,15 +1492,56 @@ int flux_shell_add_event_context (flux_shell_t *shell,
     return rc;
 }
 
+/*  Exit on a barrier failure.  EIO is the expected "barrier failed"
+ *   response: job-exec has already raised a job exception describing the
+ *   cause, so a diagnostic here would only duplicate it across every shell.
+ *   Any other error is not recorded elsewhere, so log it.
+ */
+static void shell_barrier_fail (int errnum, const char *errstr)
+{
+    if (errnum != EIO) {
+        shell_log_error ("shell_barrier: %s",
+                         errstr ? errstr : strerror (errnum));
+    }
+    exit (1);
+}
+
+/*  When the job was launched down the TBON, enter the barrier through the
+ *   local broker, which reduces barrier entries on the way up the tree.
+ */
+static int shell_tree_barrier (flux_shell_t *shell, const char *key)
+{
+    flux_future_t *f;
+    char rank[16];
+
+    snprintf (rank, sizeof (rank), "%d", shell->broker_rank);
+    if (!(f = flux_rpc_pack (shell->h,
+                             "rexec.tree-barrier",
+                             FLUX_NODEID_ANY,
+                             0,
+                             "{s:s s:s}",
+                             "key", key,
+                             "ranks", rank)))
+        shell_die_errno (1, "shell_barrier: flux_rpc_pack");
+    if (flux_future_get (f, NULL) < 0)
+        shell_barrier_fail (errno, future_strerror (f, errno));
+    flux_future_destroy (f);
+    return 0;
+}
+
 static int shell_barrier (flux_shell_t *shell)
 {
     flux_future_t *f;
     flux_msg_t *msg;
     struct flux_match match = FLUX_MATCH_RESPONSE;
+    const char *key;
 
     if (shell->info->shell_size == 1)
         return 0; // NO-OP
 
+    if ((key = getenv ("FLUX_EXEC_TREE_BARRIER")))
+        return shell_tree_barrier (shell, key);
+
     /*  Enter the barrier by sending a request to job-exec and blocking for
      *   the response.  A successful (empty) response releases the barrier;
      *   an error response means the barrier failed.  The request is routed
@@ -1533,20 +1574,10 @@ static int shell_barrier (flux_shell_t *shell)
     if (!(msg = flux_recv (shell->h, match, 0)))
         shell_die_errno (1, "shell_barrier: flux_recv");
     if (flux_response_decode (msg, NULL, NULL) < 0) {
-        /*  EIO is the expected "barrier failed" response: job-exec has
-         *   already raised a job exception describing the cause, so a
-         *   diagnostic here would only duplicate it across every shell.
-         *   Any other error is not recorded elsewhere, so log it.
-         */
-        if (errno != EIO) {
-            const char *errstr;
-            if (flux_response_decode_error (msg, &errstr) == 0)
-                shell_log_error ("shell_barrier: %s", errstr);
-            else
-                shell_log_error ("shell_barrier: %s", strerror (errno));
-        }
-        flux_msg_destroy (msg);
-        exit (1);
+        int errnum = errno;
+        const char *errstr = NULL;
+        (void)flux_response_decode_error (msg, &errstr);
+        shell_barrier_fail (errnum, errstr);
     }
     flux_msg_destroy (msg);
     return 0;
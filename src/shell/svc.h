@@ -33,6 +33,15 @@ flux_future_t *shell_svc_vpack (struct shell_svc *svc,
                                 const  char *fmt,
                                 va_list ap);
 
+/* Send an RPC with a raw payload to a shell 'method' by shell rank.
+ */
+flux_future_t *shell_svc_raw (struct shell_svc *svc,
+                              const char *method,
+                              int shell_rank,
+                              int flags,
+                              const void *data,
+                              int len);
+
 /* Register a message handler for 'method'.
  * The message handler is destroyed when shell->h is destroyed.
  */
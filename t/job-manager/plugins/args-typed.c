@@ -0,0 +1,82 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* args-typed.c - test job-manager jobtap plugin that declares the job
+ *  args it uses and reads job data with flux_jobtap_get_jobinfo()
+ */
+
+#include <unistd.h>
+#include <jansson.h>
+
+#include <flux/core.h>
+#include <flux/jobtap.h>
+#include "ccan/str/str.h"
+
+static int cb (flux_plugin_t *p,
+               const char *topic,
+               flux_plugin_arg_t *args,
+               void *arg)
+{
+    struct flux_jobtap_jobinfo info;
+    flux_jobid_t id = FLUX_JOBID_ANY;
+    json_t *R = NULL;
+    flux_t *h = flux_jobtap_get_flux (p);
+
+    if (flux_plugin_arg_unpack (args,
+                                FLUX_PLUGIN_ARG_IN,
+                                "{s:I s?o}",
+                                "id", &id,
+                                "R", &R) < 0) {
+        flux_log (h,
+                  LOG_ERR,
+                  "args-typed: %s: flux_plugin_arg_unpack: %s",
+                  topic,
+                  flux_plugin_arg_strerror (args));
+        return -1;
+    }
+    if (flux_jobtap_get_jobinfo (p, &info) < 0) {
+        flux_log_error (h, "args-typed: %s: flux_jobtap_get_jobinfo", topic);
+        return -1;
+    }
+    if (info.id != id
+        || info.userid != getuid ()
+        || info.urgency != 16
+        || info.t_submit == 0.) {
+        flux_log (h,
+                  LOG_ERR,
+                  "args-typed: %s: id=%ju/%ju uid=%u urg=%d t_submit=%f",
+                  topic,
+                  (uintmax_t)id,
+                  (uintmax_t)info.id,
+                  info.userid,
+                  info.urgency,
+                  info.t_submit);
+        return -1;
+    }
+    /*  No other plugin in the stack asks for R, so it should not be
+     *   passed once the job has one.
+     */
+    if (R != NULL) {
+        flux_log (h, LOG_ERR, "args-typed: %s: R was passed", topic);
+        return -1;
+    }
+    flux_log (h, LOG_INFO, "args-typed: %s: OK", topic);
+    return 0;
+}
+
+int flux_plugin_init (flux_plugin_t *p)
+{
+    flux_plugin_set_name (p, "args-typed");
+    if (flux_jobtap_set_args (p, 0) < 0)
+        return -1;
+    return flux_plugin_add_handler (p, "job.state.*", cb, NULL);
+}
+
+// vi:ts=4 sw=4 expandtab
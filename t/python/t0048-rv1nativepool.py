@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+import json
+import random
+import unittest
+
+import subflux  # noqa: F401 - for PYTHONPATH
+from flux.resource import InfeasibleRequest, InsufficientResources
+from flux.resource.ResourceCount import ResourceCount
+from flux.resource.Rv1NativePool import Rv1NativePool
+from flux.resource.Rv1Pool import ResourceRequest, Rv1Pool
+from pycotap import TAPTestRunner
+
+
+def rr(nnodes=0, nslots=1, slot_size=1, gpu_per_slot=0, constraint=None, **kw):
+    """Build a fixed-count ResourceRequest (see t0039-rv1pool.py)."""
+    exclusive = kw.get("exclusive", False)
+    if nnodes > 0:
+        spn = nslots // nnodes
+        node_count = ResourceCount(nnodes, kw.get("nnodes_max", nnodes))
+        slot_count = ResourceCount(spn, spn)
+    else:
+        node_count = None
+        slot_count = ResourceCount(nslots, kw.get("nslots_max", nslots))
+    return ResourceRequest(
+        node_count,
+        slot_count,
+        slot_size,
+        gpu_per_slot,
+        0.0,
+        constraint,
+        exclusive,
+        None,
+    )
+
+
+# 4 nodes of mixed size, two with GPUs, rank 0-1 have property "fast"
+R_mixed = {
+    "version": 1,
+    "execution": {
+        "R_lite": [
+            {"rank": "0-1", "children": {"core": "0-7", "gpu": "0-1"}},
+            {"rank": "2", "children": {"core": "0-3"}},
+            {"rank": "3", "children": {"core": "0-15"}},
+        ],
+        "starttime": 0,
+        "expiration": 0,
+        "nodelist": ["node[0-3]"],
+        "properties": {"fast": "0-1"},
+    },
+}
+
+
+def alloc_result(pool, jobid, request):
+    try:
+        R = pool.alloc(jobid, request)
+        return json.dumps(R.to_dict(), sort_keys=True)
+    except (InfeasibleRequest, InsufficientResources, ValueError) as exc:
+        return f"{type(exc).__name__}: {exc}"
+
+
+def pool_state(pool):
+    return (
+        json.dumps(pool.copy_allocated().to_dict(), sort_keys=True),
+        json.dumps(pool.copy_down().to_dict(), sort_keys=True),
+    )
+
+
+class TestRv1NativePoolSelect(unittest.TestCase):
+    def test_resource_pool_uses_native(self):
+        from flux.resource.ResourcePool import ResourcePool
+
+        pool = ResourcePool(R_mixed)
+        self.assertIsInstance(pool.impl, Rv1NativePool)
+
+    def test_worst_fit(self):
+        pool = Rv1NativePool(R_mixed)
+        R = pool.alloc(1, rr(0, 1, 1))
+        self.assertEqual(list(R._ranks), [3])
+
+    def test_constraint(self):
+        pool = Rv1NativePool(R_mixed)
+        R = pool.alloc(1, rr(0, 2, 4, constraint={"properties": ["fast"]}))
+        self.assertTrue(set(R._ranks) <= {0, 1})
+
+    def test_set_property_invalidates_constraint(self):
+        pool = Rv1NativePool(R_mixed)
+        req = rr(1, 1, 1, constraint={"properties": ["big"]})
+        with self.assertRaises(InfeasibleRequest):
+            pool.alloc(1, req)
+        pool.set_property("big", "3")
+        R = pool.alloc(1, req)
+        self.assertEqual(list(R._ranks), [3])
+
+    def test_feasibility_message(self):
+        for request in (rr(0, 1, 17), rr(5, 5, 1), rr(0, 1, 1, 4)):
+            a = alloc_result(Rv1Pool(R_mixed), 1, request)
+            b = alloc_result(Rv1NativePool(R_mixed), 1, request)
+            self.assertTrue(a.startswith("InfeasibleRequest"))
+            self.assertEqual(a, b)
+
+    def test_insufficient(self):
+        pool = Rv1NativePool(R_mixed)
+        pool.alloc(1, rr(0, 36, 1))
+        with self.assertRaises(InsufficientResources):
+            pool.alloc(2, rr(0, 1, 1))
+        pool.free(1)
+        pool.alloc(2, rr(0, 1, 1))
+
+    def test_mark_down(self):
+        pool = Rv1NativePool(R_mixed)
+        pool.mark_down("3")
+        R = pool.alloc(1, rr(0, 1, 1))
+        self.assertNotIn(3, R._ranks)
+        self.assertEqual(pool.copy_down().dumps(), "rank3/core[0-15]")
+        pool.mark_up("all")
+        self.assertEqual(pool.copy_down().dumps(), "")
+
+    def test_copy_is_independent(self):
+        pool = Rv1NativePool(R_mixed)
+        pool.alloc(1, rr(0, 4, 1))
+        cpy = pool.copy()
+        self.assertEqual(pool_state(pool), pool_state(cpy))
+        cpy.free(1)
+        cpy.alloc(2, rr(0, 36, 1))
+        self.assertEqual(pool.copy_allocated().count("core"), 4)
+        pool.free(1)
+        self.assertEqual(pool.copy_allocated().count("core"), 0)
+        self.assertEqual(cpy.copy_allocated().count("core"), 36)
+
+    def test_policy_override_uses_python(self):
+        class BestFitPool(Rv1NativePool):
+            def _sort_candidates(self, candidates):
+                return list(reversed(super()._sort_candidates(candidates)))
+
+        pool = BestFitPool(R_mixed)
+        R = pool.alloc(1, rr(0, 1, 1))
+        self.assertEqual(list(R._ranks), [2])
+        self.assertIsNone(pool._native)
+
+
+class TestRv1NativePoolParity(unittest.TestCase):
+    """Rv1NativePool makes the same decisions as Rv1Pool."""
+
+    def random_request(self, rng):
+        constraint = rng.choice([None, {"properties": ["fast"]}])
+        exclusive = rng.random() < 0.2
+        if rng.random() < 0.5:
+            nnodes = rng.randint(1, 3)
+            return rr(
+                nnodes,
+                nnodes * rng.randint(1, 2),
+                rng.choice([1, 2, 4]),
+                rng.choice([0, 0, 1]),
+                constraint,
+                exclusive=exclusive,
+                nnodes_max=rng.choice([nnodes, None]),
+            )
+        nslots = rng.randint(1, 8)
+        return rr(
+            0,
+            nslots,
+            rng.choice([1, 2, 4]),
+            rng.choice([0, 0, 1]),
+            constraint,
+            exclusive=exclusive,
+            nslots_max=rng.choice([nslots, None, 2 * nslots]),
+        )
+
+    def test_random_sequence(self):
+        rng = random.Random(42)
+        py = Rv1Pool(R_mixed)
+        native = Rv1NativePool(R_mixed)
+        jobs = []
+        for jobid in range(1, 500):
+            op = rng.random()
+            if op < 0.6:
+                request = self.random_request(rng)
+                result = alloc_result(py, jobid, request)
+                self.assertEqual(result, alloc_result(native, jobid, request))
+                if not result.startswith(("Infeasible", "Insufficient")):
+                    jobs.append(jobid)
+            elif op < 0.85 and jobs:
+                freed = jobs.pop(rng.randrange(len(jobs)))
+                py.free(freed)
+                native.free(freed)
+            elif op < 0.9:
+                ranks = str(rng.randint(0, 3))
+                py.mark_down(ranks)
+                native.mark_down(ranks)
+            elif op < 0.95:
+                py.mark_up("all")
+                native.mark_up("all")
+            else:
+                py = py.copy()
+                native = native.copy()
+            self.assertEqual(pool_state(py), pool_state(native))
+            self.assertEqual(py.generation, native.generation)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+###############################################################
+# Copyright 2026 Lawrence Livermore National Security, LLC
+# (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+#
+# This file is part of the Flux resource manager framework.
+# For details, see https://github.com/flux-framework.
+#
+# SPDX-License-Identifier: LGPL-3.0
+###############################################################
+
+import random
+import unittest
+
+import subflux  # noqa: F401 - for PYTHONPATH
+from flux.resource import InfeasibleRequest, InsufficientResources
+from flux.resource.AvailabilityProfile import AvailabilityProfile
+from flux.resource.ResourceCount import ResourceCount
+from flux.resource.Rv1NativePool import Rv1NativePool
+from flux.resource.Rv1Pool import ResourceRequest, Rv1Pool
+from pycotap import TAPTestRunner
+
+
+def rr(nnodes=0, nslots=1, slot_size=1, exclusive=False):
+    """Build a fixed-count ResourceRequest (see t0039-rv1pool.py)."""
+    if nnodes > 0:
+        node_count = ResourceCount(nnodes, nnodes)
+        slot_count = ResourceCount(1, 1)
+    else:
+        node_count = None
+        slot_count = ResourceCount(nslots, nslots)
+    return ResourceRequest(
+        node_count, slot_count, slot_size, 0, 0.0, None, exclusive, None
+    )
+
+
+# 8 nodes with 4 cores each
+R_8x4 = {
+    "version": 1,
+    "execution": {
+        "R_lite": [{"rank": "0-7", "children": {"core": "0-3"}}],
+        "starttime": 0,
+        "expiration": 0,
+        "nodelist": ["node[0-7]"],
+    },
+}
+
+
+def replay(pool, jobid, request):
+    """Reference shadow time: free jobs in end time order until it fits."""
+    sim = pool.copy()
+    t = 0.0
+    while True:
+        try:
+            sim.alloc(jobid, request)
+            return t
+        except InfeasibleRequest:
+            return None
+        except InsufficientResources:
+            ends = [end for _, end in sim.job_end_times() if end > t]
+            if not ends:
+                return None
+            t = min(ends)
+            for done, end in list(sim.job_end_times()):
+                if 0.0 < end <= t:
+                    sim.free(done)
+
+
+class TestAvailabilityProfile(unittest.TestCase):
+    pool_class = Rv1Pool
+
+    def test_fits_now(self):
+        pool = self.pool_class(R_8x4)
+        profile = AvailabilityProfile(pool)
+        self.assertEqual(profile.earliest_start(1, rr(0, 4, 1)), 0.0)
+
+    def test_waits_for_end_time(self):
+        pool = self.pool_class(R_8x4)
+        profile = AvailabilityProfile(pool)
+        for jobid, end in ((1, 10.0), (2, 20.0)):
+            R = pool.alloc(jobid, rr(4, 4, 4))
+            pool.update_expiration(jobid, end)
+            profile.alloc(jobid, R, end)
+        self.assertEqual(profile.earliest_start(3, rr(2, 2, 4)), 10.0)
+        self.assertEqual(profile.earliest_start(4, rr(6, 6, 4)), 20.0)
+        pool.free(1)
+        profile.free(1)
+        self.assertEqual(profile.earliest_start(4, rr(6, 6, 4)), 20.0)
+        pool.update_expiration(2, 15.0)
+        profile.update_expiration(2, 15.0)
+        self.assertEqual(profile.earliest_start(4, rr(6, 6, 4)), 15.0)
+
+    def test_no_end_time(self):
+        pool = self.pool_class(R_8x4)
+        profile = AvailabilityProfile(pool)
+        R = pool.alloc(1, rr(8, 8, 4))
+        profile.alloc(1, R, 0.0)
+        self.assertIsNone(profile.earliest_start(2, rr(1, 1, 1)))
+
+    def test_infeasible(self):
+        pool = self.pool_class(R_8x4)
+        profile = AvailabilityProfile(pool)
+        self.assertIsNone(profile.earliest_start(1, rr(9, 9, 1)))
+
+    def test_random_sequence(self):
+        """The profile agrees with a full replay after every pool change."""
+        for seed in range(50):
+            rng = random.Random(seed)
+            pool = self.pool_class(R_8x4)
+            profile = AvailabilityProfile(pool)
+            running = {}
+            for jobid in range(1, 60):
+                op = rng.random()
+                end = rng.choice([0.0] + [float(rng.randint(1, 20))] * 6)
+                if op < 0.45:
+                    try:
+                        R = pool.alloc(jobid, self.random_request(rng))
+                    except (InfeasibleRequest, InsufficientResources):
+                        R = None
+                    if R is not None:
+                        pool.update_expiration(jobid, end)
+                        profile.alloc(jobid, R, end)
+                        running[jobid] = R
+                elif op < 0.65 and running:
+                    done = rng.choice(list(running))
+                    R = running.pop(done)
+                    pool.free(done, R, True)
+                    profile.free(done, R, True)
+                elif op < 0.72 and running:
+                    done = rng.choice(list(running))
+                    ranks = list(running[done]._ranks)
+                    if len(ranks) > 1:
+                        part = running[done]._copy_from_ranks({ranks[0]})
+                        pool.free(done, part)
+                        profile.free(done, part)
+                        rest = running[done]._copy_from_ranks(set(ranks[1:]))
+                        running[done] = rest
+                elif op < 0.82 and running:
+                    done = rng.choice(list(running))
+                    pool.update_expiration(done, end)
+                    profile.update_expiration(done, end)
+                elif op < 0.84:
+                    pool.mark_down(str(rng.randint(0, 7)))
+                    profile.reset()
+                elif op < 0.86:
+                    pool.mark_up("all")
+                    profile.reset()
+                request = self.random_request(rng)
+                self.assertEqual(
+                    profile.earliest_start(0, request),
+                    replay(pool, 0, request),
+                    f"seed={seed} jobid={jobid}",
+                )
+                self.assertEqual(profile._generation, pool.generation)
+
+    @staticmethod
+    def random_request(rng):
+        if rng.random() < 0.4:
+            nnodes = rng.randint(1, 4)
+            return rr(nnodes, nnodes, rng.choice([1, 2, 4]), rng.random() < 0.3)
+        return rr(0, rng.randint(1, 12), rng.choice([1, 2]))
+
+
+class TestAvailabilityProfileNative(TestAvailabilityProfile):
+    pool_class = Rv1NativePool
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=TAPTestRunner())
@@ -180,6 +180,31 @@ test_expect_success 'flux module stats --clear-all works' '
 	count2=$(flux module stats --parse rx.request $REALMOD_DEFSTATS) &&
 	test $count2 -lt $count
 '
+test_expect_success 'broker stats count event copies made for modules' '
+	flux module stats broker >broker.stats &&
+	jq -e ".\"event-mcast\".copies" broker.stats &&
+	copies=$(flux module stats --parse event-mcast.copies broker) &&
+	shared=$(flux module stats --parse event-mcast.shared-bytes broker) &&
+	flux event pub -s $REALMOD_DEFSTATS.stats-clear "{\"pad\":\"xxxx\"}" &&
+	copies2=$(flux module stats --parse event-mcast.copies broker) &&
+	shared2=$(flux module stats --parse event-mcast.shared-bytes broker) &&
+	test $copies2 -gt $copies &&
+	test $shared2 -gt $shared
+'
+test_expect_success 'flux module stats --clear clears broker event stats' '
+	events=$(flux module stats --parse event-mcast.events broker) &&
+	flux module stats --clear broker &&
+	events2=$(flux module stats --parse event-mcast.events broker) &&
+	test $events2 -lt $events
+'
+test_expect_success 'flux module stats --clear-all clears broker event stats' '
+	flux event pub test.a &&
+	flux event pub test.b &&
+	events=$(flux module stats --parse event-mcast.events broker) &&
+	flux module stats --clear-all broker &&
+	events2=$(flux module stats --parse event-mcast.events broker) &&
+	test $events2 -lt $events
+'
 test_expect_success 'flux module stats --scale works' '
 	flux module stats --parse tx.request --scale=2 $REALMOD_DEFSTATS
 '
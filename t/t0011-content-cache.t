@@ -115,6 +115,13 @@ test_expect_success 'load and verify 1m blob on all ranks' '
 						>1m.0.all.output &&
 	test_cmp 1m.0.all.expect 1m.0.all.output
 '
+test_expect_success 'cache hit on rank 0 counts load-copy-bytes' '
+	flux module stats content >copy1.out &&
+	flux content load $(cat 4k.0.hash) >/dev/null &&
+	flux module stats content >copy2.out &&
+	test $(($(jq ".[\"load-copy-bytes\"]" <copy2.out) \
+	    - $(jq ".[\"load-copy-bytes\"]" <copy1.out))) -eq 4096
+'
 
 # Write on rank 3, various size blobs
 # Verify on all ranks
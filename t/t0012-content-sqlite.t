@@ -87,6 +87,22 @@ test_expect_success 'load 1m blob bypassing cache' '
 	test_cmp 1m.0.store 1m.0.load
 '
 
+test_expect_success 'compressed blob is loaded without a payload copy' '
+	flux module stats content-sqlite >loadstats1 &&
+	flux content load --bypass-cache $(cat 1m.0.hash) >/dev/null &&
+	flux module stats content-sqlite >loadstats2 &&
+	test $(($(jq .load_bytes <loadstats2) \
+	    - $(jq .load_bytes <loadstats1))) -eq 1048576 &&
+	test $(jq .load_copy_bytes <loadstats2) \
+	    -eq $(jq .load_copy_bytes <loadstats1)
+'
+test_expect_success 'uncompressed blob load is counted as a copy' '
+	flux content load --bypass-cache $(cat 64.0.hash) >/dev/null &&
+	flux module stats content-sqlite >loadstats3 &&
+	test $(($(jq .load_copy_bytes <loadstats3) \
+	    - $(jq .load_copy_bytes <loadstats2))) -eq 64
+'
+
 # validate
 
 test_expect_success 'content validate works on valid hash' '
@@ -171,6 +171,33 @@ test_expect_success 'flux module stats reports nonzero object count' '
 	test $(flux module stats \
 	    --type int --parse object_count content-files) -gt 0
 '
+test_expect_success 'content-files module load fails with unknown codec' '
+	flux module remove content-files &&
+	test_must_fail flux module load content-files codec=nope
+'
+test_expect_success 'load content-files module with codec=lz4' '
+	flux module load content-files codec=lz4
+'
+test_expect_success 'blobs stored without compression can be loaded' '
+	err=0 &&
+	for size in $SIZES; do \
+		if ! recheck_blob $size; then err=$(($err+1)); fi; \
+	done &&
+	test $err -eq 0
+'
+test_expect_success 'compressible blob is stored compressed' '
+	seq 1 10000 >seq.blob &&
+	backing_store <seq.blob >seq.hash &&
+	backing_load <seq.hash >seq.blob.check &&
+	test_cmp seq.blob seq.blob.check &&
+	ls content.files/*.lz4 >lz4.files &&
+	test $(wc -l <lz4.files) -ge 1
+'
+test_expect_success 'compressed blob can be loaded without the codec' '
+	flux module reload content-files &&
+	backing_load <seq.hash >seq.blob.check2 &&
+	test_cmp seq.blob seq.blob.check2
+'
 test_expect_success 'reload content-files with truncate option' '
 	flux module reload content-files truncate
 '
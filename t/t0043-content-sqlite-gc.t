@@ -2,7 +2,8 @@
 
 test_description='Test content-sqlite garbage collection primitives
 
-Exercise the content-backing.gc-info, .mark, and .sweep RPCs and the
+Exercise the content-backing.gc-info, .mark, .sweep, and .sweep-start
+RPCs, the reachability index RPCs (.gc-index, .gc-pin, .gc-collect), and the
 epoch stamping done by content-backing.store, directly and independent
 of the flux-gc tool.  The safety of online GC rests entirely on these
 primitives behaving exactly (mark is monotonic, sweep deletes only
@@ -233,6 +234,155 @@ test_expect_success "flux gc preserved the checkpointed root" '
 	test "$(cat gcroot.out)" = "{\"ver\":1,\"type\":\"dir\",\"data\":{}}"
 '
 
+#
+# Reachability index.  flux gc walks tree objects into the index with
+# gc-index, pins the roots with gc-pin, and drops what the roots no longer
+# reach with gc-collect.  Indexed objects are never swept.
+#
+
+# gc_index BLOBREF... -> prints response JSON {walked, pending}
+gc_index() {
+	echo "$@" | jq -R -c "{hashes:split(\" \")}" \
+	    | $RPC content-backing.gc-index
+}
+# gc_pin EPOCH BLOBREF... -> prints response JSON {pinned}
+gc_pin() {
+	epoch=$1; shift
+	echo "$@" | jq -R -c "{epoch:$epoch, roots:(split(\" \") - [\"\"])}" \
+	    | $RPC content-backing.gc-pin
+}
+gc_collect() {
+	echo "{}" | $RPC content-backing.gc-collect
+}
+# treeobj TYPE BLOBREF -> prints a valref or dirref treeobj
+treeobj() {
+	echo "{\"ver\":1,\"type\":\"$1\",\"data\":[\"$2\"]}"
+}
+# store_dir NAME=TREEOBJ... -> prints blobref of a directory holding entries
+store_dir() {
+	entries=""
+	for arg in "$@"; do
+		entries="${entries}${entries:+,}\"${arg%%=*}\":${arg#*=}"
+	done
+	printf "{\"ver\":1,\"type\":\"dir\",\"data\":{%s}}" "${entries}" \
+	    | flux content store --bypass-cache
+}
+
+test_expect_success 'store two KVS roots that share a subdirectory' '
+	store_blob index-leaf >leaf.ref &&
+	store_blob index-dropped >dropped.ref &&
+	store_blob index-garbage >garbage.ref &&
+	store_dir a="$(treeobj valref $(cat leaf.ref))" >subdir.ref &&
+	store_dir d="$(treeobj dirref $(cat subdir.ref))" \
+	    x="{\"ver\":1,\"type\":\"dir\",\"data\":{\"y\":$(treeobj valref $(cat dropped.ref))}}" \
+	    >root1.ref &&
+	store_dir d="$(treeobj dirref $(cat subdir.ref))" >root2.ref &&
+	epoch=$(gc_info 0 | jq .current_epoch)
+'
+test_expect_success 'gc-index walks a root and its subdirectories' '
+	gc_index $(cat root1.ref) >index1.out &&
+	test $(jq .walked <index1.out) -eq 2 &&
+	test $(jq ".pending | length" <index1.out) -eq 0
+'
+test_expect_success 'gc-index skips trees that are already indexed' '
+	test $(gc_index $(cat root1.ref) | jq .walked) -eq 0
+'
+test_expect_success 'gc-index of a blob that is not a directory fails' '
+	echo "{\"hashes\":[\"$(cat leaf.ref)\"]}" \
+	    | $RPC content-backing.gc-index 22 2>notdir.err &&
+	grep "not a KVS directory" notdir.err
+'
+test_expect_success 'gc-pin of a root that is not indexed fails with EAGAIN' '
+	echo "{\"epoch\":${epoch},\"roots\":[\"$(cat root2.ref)\"]}" \
+	    | $RPC content-backing.gc-pin 11
+'
+test_expect_success 'gc-pin pins indexed roots' '
+	test $(gc_pin ${epoch} $(cat gcroot.ref) $(cat root1.ref) \
+	    | jq .pinned) = "true" &&
+	test $(gc_collect | jq .collected) -eq 0
+'
+test_expect_success 'only the new root is walked when the roots change' '
+	test $(gc_index $(cat root2.ref) | jq .walked) -eq 1 &&
+	test $(gc_pin ${epoch} $(cat gcroot.ref) $(cat root2.ref) \
+	    | jq .pinned) = "true"
+'
+test_expect_success 'gc-collect drops what the pinned roots no longer reach' '
+	gc_collect >collect.out &&
+	test $(jq .collected <collect.out) -eq 2 &&
+	test $(jq .done <collect.out) = "true"
+'
+test_expect_success 'sweep deletes only objects that are not indexed' '
+	test $(gc_info 1000 | jq .candidates) -eq 3 &&
+	test $(sweep_all 1000) -eq 3 &&
+	for ref in gcroot root2 subdir leaf; do
+		flux content load --bypass-cache $(cat ${ref}.ref) >/dev/null ||
+		    return 1
+	done &&
+	for ref in root1 dropped garbage; do
+		test_must_fail flux content load --bypass-cache \
+		    $(cat ${ref}.ref) || return 1
+	done
+'
+test_expect_success 'gc-pin at an older epoch does nothing' '
+	test $(gc_pin $((epoch - 1)) | jq .pinned) = "false" &&
+	test $(gc_collect | jq .collected) -eq 0
+'
+test_expect_success 'gc-pin with no roots releases the index' '
+	test $(gc_pin ${epoch} | jq .pinned) = "true" &&
+	test $(gc_collect | jq .collected) -eq 4 &&
+	test $(gc_info 1000 | jq .candidates) -eq 4
+'
+
+#
+# Background sweep.  sweep-start sweeps in slices while the module is
+# otherwise idle, then returns free pages to the filesystem, and responds
+# when it is done.
+#
+
+# sweep_start EPOCH -> response JSON {deleted}
+sweep_start() {
+	echo "{\"epoch\":$1}" | $RPC content-backing.sweep-start
+}
+
+test_expect_success 'sweep-start deletes the sweep candidates' '
+	test $(sweep_start 1000 | jq .deleted) -eq 4 &&
+	test $(gc_info 1000 | jq .candidates) -eq 0
+'
+test_expect_success 'module stats reports the background sweep' '
+	flux module stats content-sqlite >sweep_stats.out &&
+	test $(jq .sweep.active <sweep_stats.out) = "false" &&
+	test $(jq .sweep.deleted <sweep_stats.out) -eq 4 &&
+	test $(jq .sweep.total_deleted <sweep_stats.out) -ge 4 &&
+	test $(jq .sweep.cursor <sweep_stats.out) -eq \
+	    $(jq .sweep.high_water <sweep_stats.out) &&
+	test $(jq .config.auto_vacuum <sweep_stats.out) = "true"
+'
+test_expect_success 'sweep-start with nothing to delete responds' '
+	test $(sweep_start 1000 | jq .deleted) -eq 0
+'
+test_expect_success 'sweep-start returns free pages to the filesystem' '
+	dd if=/dev/urandom bs=8192 count=128 2>/dev/null \
+	    | flux content store --bypass-cache --chunksize=8192 >big.refs &&
+	test $(sweep_start 1000 | jq .deleted) -eq $(wc -l <big.refs) &&
+	test $(flux module stats content-sqlite | jq .sweep.vacuumed_pages) -gt 0
+'
+test_expect_success 'sweep-start with a malformed request fails' '
+	echo "{}" | $RPC content-backing.sweep-start 71
+'
+test_expect_success 'module load fails with an invalid sweep-rate' '
+	flux module remove content-sqlite &&
+	test_must_fail flux module load content-sqlite sweep-rate=-1 &&
+	test_must_fail flux module load content-sqlite sweep-rate=x
+'
+test_expect_success 'a rate limited sweep completes' '
+	flux module load content-sqlite sweep-rate=100 &&
+	test $(flux module stats content-sqlite | jq .config.sweep_rate) -eq 100 &&
+	for i in $(seq 1 20); do
+		store_blob rate-${i} >/dev/null || return 1
+	done &&
+	test $(sweep_start 1000 | jq .deleted) -eq 20
+'
+
 test_expect_success 'remove content-sqlite and content modules' '
 	flux module remove content-sqlite &&
 	flux module remove content
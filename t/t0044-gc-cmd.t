@@ -28,6 +28,13 @@ test_expect_success 'flux gc reports marked and reclaimed counts' '
 	grep "gc complete: marked .* reclaimed .* blobs" gc.out
 '
 
+test_expect_success 'flux gc sweeps in the background' '
+	grep "background sweep complete" gc.out &&
+	flux module stats content-sqlite >gc_stats.out &&
+	test $(jq .sweep.runs <gc_stats.out) -ge 1 &&
+	test $(jq .sweep.active <gc_stats.out) = "false"
+'
+
 test_expect_success 'flux fsck verifies all blobs referenced after GC' '
 	flux fsck
 '
@@ -301,6 +308,34 @@ test_expect_success 'GC is a no-op when there is no garbage' '
 	test "$(flux kvs get noop.a)" = "1"
 '
 
+# With content-sqlite, GC keeps a reachability index in the backing store, so
+# a run only walks the tree objects stored since the previous run.  --full
+# walks everything instead and releases the index, so the next run has to
+# index the whole KVS again.
+indexed() {
+	sed -n "s/.*indexed \([0-9]*\) new tree objects.*/\1/p" $1
+}
+test_expect_success 'GC --full walks the whole KVS and releases the index' '
+	flux gc --full -v >gc_full.out 2>&1 &&
+	grep "gc complete" gc_full.out &&
+	grep "released .* objects from the index" gc_full.out &&
+	flux fsck
+'
+test_expect_success 'GC after --full indexes the whole KVS' '
+	flux gc -v >gc_reindex.out 2>&1 &&
+	test $(indexed gc_reindex.out) -gt 0 &&
+	flux fsck
+'
+test_expect_success 'GC after a small change only indexes the changed trees' '
+	flux kvs put incremental.a=1 &&
+	flux kvs sync &&
+	flux gc -v >gc_incremental.out 2>&1 &&
+	test $(indexed gc_incremental.out) -gt 0 &&
+	test $(indexed gc_incremental.out) -lt $(indexed gc_reindex.out) &&
+	test "$(flux kvs get incremental.a)" = "1" &&
+	flux fsck
+'
+
 # Crash safety: a run that stops between mark and sweep must leave no data at
 # risk, and a subsequent run must re-mark from scratch and complete normally.
 # --test-mark-only runs the (durable) mark phase then stops without sweeping,
@@ -0,0 +1,208 @@
+#!/bin/sh
+
+test_description='Test content-sqlite with objects sharded across databases
+
+With shards=N, content-sqlite hashes each blob to one of N databases, each
+owned by a worker thread that commits batches of stores together.  Check
+that the content-backing protocol, including the garbage collection
+primitives, behaves the same as in the unsharded case.'
+
+. `dirname $0`/content/content-helper.sh
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1 minimal
+
+RPC=${FLUX_BUILD_DIR}/t/request/rpc
+BLOBREF=${FLUX_BUILD_DIR}/t/kvs/blobref
+
+test_expect_success 'load content and content-sqlite shards=4' '
+	flux module load content &&
+	flux module load content-sqlite shards=4
+'
+
+# store_blob CONTENT -> prints blobref (stored directly to backing store)
+store_blob() {
+	printf "%s" "$1" | flux content store --bypass-cache
+}
+gc_info() {
+	echo "{\"epoch\":$1,\"get_count\":true}" | $RPC content-backing.gc-info
+}
+mark_blob() {
+	echo "{\"epoch\":$1,\"hashes\":[\"$2\"]}" | $RPC content-backing.mark
+}
+sweep() {
+	echo "{\"epoch\":$1,\"cursor\":$2,\"high_water\":$3,\"delete_cap\":$4,\"window\":$5}" \
+	    | $RPC content-backing.sweep
+}
+# sweep_all EPOCH WINDOW -> total blobs deleted below EPOCH
+sweep_all() {
+	hw=$(gc_info $1 | jq .high_water)
+	cursor=0
+	total=0
+	while test ${cursor} -lt ${hw}; do
+		out=$(sweep $1 ${cursor} ${hw} 1000000 $2) &&
+		total=$(( total + $(echo "${out}" | jq .deleted) )) &&
+		cursor=$(echo "${out}" | jq .cursor) || return 1
+	done
+	echo ${total}
+}
+
+test_expect_success 'shard databases were created' '
+	statedir=$(flux getattr statedir) &&
+	for i in 0 1 2 3; do
+		test -f ${statedir}/content.sqlite.${i} || return 1
+	done
+'
+test_expect_success 'module stats reports shard configuration' '
+	flux module stats content-sqlite >stats.out &&
+	test $(jq .config.shards <stats.out) -eq 4 &&
+	test $(jq ".shards | length" <stats.out) -eq 4
+'
+test_expect_success 'store 32 blobs' '
+	for i in $(seq 1 32); do
+		store_blob blob-${i} >blob-${i}.ref || return 1
+	done
+'
+test_expect_success 'blobs are spread over more than one shard' '
+	flux module stats content-sqlite >stats2.out &&
+	test $(jq .object_count <stats2.out) -eq 32 &&
+	test $(jq "[.shards[] | select(.object_count > 0)] | length" \
+	    <stats2.out) -gt 1
+'
+test_expect_success 'each blob can be loaded' '
+	for i in $(seq 1 32); do
+		test "$(flux content load --bypass-cache $(cat blob-${i}.ref))" \
+		    = "blob-${i}" || return 1
+	done
+'
+test_expect_success 'storing a duplicate blob does not add an object' '
+	store_blob blob-1 >dup.ref &&
+	test_cmp blob-1.ref dup.ref &&
+	test $(flux module stats content-sqlite | jq .object_count) -eq 32
+'
+test_expect_success 'loading an unknown blob fails' '
+	printf absent | $BLOBREF $(flux getattr content.hash) >absent.ref &&
+	test_must_fail flux content load --bypass-cache $(cat absent.ref)
+'
+
+test_expect_success 'gc-info counts all blobs below epoch 1' '
+	test $(gc_info 1 | jq .candidates) -eq 32 &&
+	test $(gc_info 1 | jq .current_epoch) -eq 0
+'
+test_expect_success 'checkpoint-put advances the epoch on every shard' '
+	checkpoint_put root1 &&
+	test $(gc_info 1 | jq .current_epoch) -eq 1 &&
+	store_blob after-checkpoint >after.ref &&
+	test $(gc_info 1 | jq .candidates) -eq 32 &&
+	test $(gc_info 2 | jq .candidates) -eq 33
+'
+test_expect_success 'mark moves blobs above the threshold' '
+	for i in $(seq 1 8); do
+		test $(mark_blob 1 $(cat blob-${i}.ref) | jq .marked) -eq 1 ||
+		    return 1
+	done &&
+	test $(gc_info 1 | jq .candidates) -eq 24
+'
+test_expect_success 'mark of several blobs in one request' '
+	echo "{\"epoch\":1,\"hashes\":[\"$(cat blob-9.ref)\",\"$(cat blob-10.ref)\",\"$(cat blob-11.ref)\"]}" \
+	    | $RPC content-backing.mark >mark.out &&
+	test $(jq .marked <mark.out) -eq 3
+'
+test_expect_success 'sweep with a small window deletes only unmarked blobs' '
+	test $(sweep_all 1 3) -eq 21 &&
+	test $(gc_info 1 | jq .candidates) -eq 0
+'
+test_expect_success 'marked blobs remain, swept blobs are gone' '
+	for i in $(seq 1 11); do
+		flux content load --bypass-cache $(cat blob-${i}.ref) >/dev/null ||
+		    return 1
+	done &&
+	for i in $(seq 12 32); do
+		test_must_fail flux content load --bypass-cache \
+		    $(cat blob-${i}.ref) || return 1
+	done &&
+	flux content load --bypass-cache $(cat after.ref) >/dev/null
+'
+# delete_cap applies to each shard, so 12 candidates over 4 shards
+# leaves at least one shard capped at 1 and the cursor short of hw.
+test_expect_success 'sweep delete_cap bounds deletes per shard' '
+	hw=$(gc_info 2 | jq .high_water) &&
+	sweep 2 0 ${hw} 1 1000000 >batch1.out &&
+	deleted=$(jq .deleted <batch1.out) &&
+	test ${deleted} -ge 1 && test ${deleted} -le 4 &&
+	test $(jq .cursor <batch1.out) -lt ${hw} &&
+	test $(( deleted + $(sweep_all 2 1000000) )) -eq 12 &&
+	test $(gc_info 1000 | jq .candidates) -eq 0
+'
+test_expect_success 'sweep-start sweeps every shard in the background' '
+	for i in $(seq 1 8); do
+		store_blob bg-${i} >/dev/null || return 1
+	done &&
+	echo "{\"epoch\":1000}" | $RPC content-backing.sweep-start >bg.out &&
+	test $(jq .deleted <bg.out) -eq 8 &&
+	test $(gc_info 1000 | jq .candidates) -eq 0 &&
+	flux module stats content-sqlite >bg_stats.out &&
+	test $(jq "[.shards[].sweep.runs] | add" <bg_stats.out) -eq 4
+'
+test_expect_success 'the reachability index is not supported with shards' '
+	echo "{\"hashes\":[]}" | $RPC content-backing.gc-index 38 &&
+	echo "{\"epoch\":1,\"roots\":[]}" | $RPC content-backing.gc-pin 38 &&
+	echo "{}" | $RPC content-backing.gc-collect 38
+'
+
+test_expect_success 'database survives module reload with the same shards' '
+	store_blob persist >persist.ref &&
+	flux module remove content-sqlite &&
+	flux module load content-sqlite shards=4 &&
+	test "$(flux content load --bypass-cache $(cat persist.ref))" = "persist"
+'
+test_expect_success 'module load fails with a different shards value' '
+	flux module remove content-sqlite &&
+	flux dmesg --clear &&
+	test_must_fail flux module load content-sqlite shards=2 &&
+	flux dmesg | grep "database has shards=4"
+'
+test_expect_success 'module load fails without shards' '
+	test_must_fail flux module load content-sqlite
+'
+test_expect_success 'module load with truncate can change shards' '
+	flux module load content-sqlite shards=2 truncate &&
+	test $(flux module stats content-sqlite | jq .config.shards) -eq 2 &&
+	test $(flux module stats content-sqlite | jq .object_count) -eq 0 &&
+	flux module remove content-sqlite
+'
+test_expect_success 'truncate removes shards beyond the new count' '
+	test -f ${statedir}/content.sqlite.1 &&
+	test ! -e ${statedir}/content.sqlite.2 &&
+	test ! -e ${statedir}/content.sqlite.3
+'
+test_expect_success 'shards cannot be enabled on a database with objects' '
+	flux module load content-sqlite truncate &&
+	store_blob unsharded >/dev/null &&
+	flux module remove content-sqlite &&
+	test_must_fail flux module load content-sqlite shards=2
+'
+test_expect_success 'truncate without shards removes all shards' '
+	test ! -e ${statedir}/content.sqlite.0 &&
+	test ! -e ${statedir}/content.sqlite.1
+'
+test_expect_success 'module load fails with shard files it did not create' '
+	flux module load content-sqlite truncate &&
+	flux module remove content-sqlite &&
+	touch ${statedir}/content.sqlite.0 &&
+	flux dmesg --clear &&
+	test_must_fail flux module load content-sqlite shards=2 &&
+	flux dmesg | grep "does not belong" &&
+	rm ${statedir}/content.sqlite.0
+'
+test_expect_success 'invalid shards values are rejected' '
+	test_must_fail flux module load content-sqlite shards=-1 &&
+	test_must_fail flux module load content-sqlite shards=65 &&
+	test_must_fail flux module load content-sqlite shards=x
+'
+test_expect_success 'remove content module' '
+	flux module remove content
+'
+
+test_done
@@ -0,0 +1,105 @@
+#!/bin/sh
+
+test_description='Test content-sqlite compression codecs
+
+The codec=NAME option selects how content-sqlite compresses new blobs.
+Each object records the codec it was written with, so blobs remain
+readable after the codec changes.  With zstd, a dictionary is trained
+from the first few thousand small blobs and saved in the database.'
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1 minimal
+
+# make_blobs COUNT -> COUNT small, similar 121 byte json objects
+make_blobs() {
+	awk -v count=$1 'BEGIN {
+		for (i = 0; i < count; i++)
+			printf "{\"timestamp\":%d.%03d,\"name\":\"submit\",\"context\":{\"userid\":%d,\"urgency\":16,\"flags\":0,\"version\":1},\"seq\":%08d}\n", 1700000000 + i, i % 1000, 5000 + i % 7, i
+	}'
+}
+# store_blobs FILE -> prints blobrefs (stored directly to backing store)
+store_blobs() {
+	flux content store --bypass-cache --chunksize=121 <$1
+}
+stats() {
+	flux module stats content-sqlite
+}
+
+test_expect_success 'load content module' '
+	flux module load content
+'
+test_expect_success 'module load fails with an unknown codec' '
+	test_must_fail flux module load content-sqlite codec=nope
+'
+test_expect_success 'load content-sqlite with the default codec' '
+	flux module load content-sqlite &&
+	test $(stats | jq -r .config.codec) = "lz4"
+'
+test_expect_success 'store 1000 blobs with lz4' '
+	make_blobs 1000 >lz4.blobs &&
+	store_blobs lz4.blobs >lz4.refs &&
+	test $(wc -l <lz4.refs) -eq 1000
+'
+test_expect_success 'reload content-sqlite with codec=none' '
+	flux module remove content-sqlite &&
+	flux module load content-sqlite codec=none &&
+	test $(stats | jq -r .config.codec) = "none"
+'
+test_expect_success 'blobs stored with lz4 can be loaded' '
+	flux content load --bypass-cache <lz4.refs >lz4.out &&
+	test_cmp lz4.blobs lz4.out
+'
+test_expect_success 'load content-sqlite with codec=zstd if available' '
+	flux module remove content-sqlite &&
+	if flux module load content-sqlite truncate codec=zstd; then
+		test_set_prereq ZSTD
+	else
+		flux module load content-sqlite truncate
+	fi
+'
+test_expect_success ZSTD 'no dictionary is in use initially' '
+	test $(stats | jq .dict_id) -eq 0
+'
+test_expect_success ZSTD 'store 5000 small blobs with zstd' '
+	make_blobs 5000 >zstd.blobs &&
+	store_blobs zstd.blobs >zstd.refs &&
+	test $(wc -l <zstd.refs) -eq 5000
+'
+test_expect_success ZSTD 'a dictionary was trained from the blobs' '
+	stats >stats.out &&
+	test $(jq .object_count <stats.out) -eq 5000 &&
+	test $(jq .dict_id <stats.out) -gt 0
+'
+test_expect_success ZSTD 'blobs can be loaded' '
+	flux content load --bypass-cache <zstd.refs >zstd.out &&
+	test_cmp zstd.blobs zstd.out
+'
+test_expect_success ZSTD 'the dictionary persists across module reload' '
+	flux module remove content-sqlite &&
+	flux module load content-sqlite codec=zstd &&
+	test $(stats | jq .dict_id) -eq $(jq .dict_id <stats.out)
+'
+test_expect_success ZSTD 'blobs can be loaded after switching to lz4' '
+	flux module remove content-sqlite &&
+	flux module load content-sqlite codec=lz4 &&
+	test $(stats | jq .dict_id) -eq 0 &&
+	flux content load --bypass-cache <zstd.refs >zstd.out2 &&
+	test_cmp zstd.blobs zstd.out2
+'
+test_expect_success ZSTD 'shards train their own dictionary' '
+	flux module remove content-sqlite &&
+	flux module load content-sqlite truncate shards=1 codec=zstd &&
+	store_blobs zstd.blobs >zstd.refs2 &&
+	test $(stats | jq ".shards[0].dict_id") -gt 0 &&
+	flux content load --bypass-cache <zstd.refs2 >zstd.out3 &&
+	test_cmp zstd.blobs zstd.out3
+'
+test_expect_success 'remove content-sqlite module' '
+	flux module remove content-sqlite
+'
+test_expect_success 'remove content module' '
+	flux module remove content
+'
+
+test_done
@@ -0,0 +1,82 @@
+#!/bin/sh
+
+test_description='Test content cache segmented LRU
+
+Clean cache entries start on a probation list and are promoted to a
+protected list when they are hit again.  Large entries are not promoted,
+so a single large load cannot push the working set out of the cache.'
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1 minimal
+
+PURGE_TARGET_SIZE=65536
+
+lru_stats() {
+	flux module stats content | jq "$1"
+}
+
+test_expect_success 'load content and content-sqlite modules' '
+	flux module load content \
+	    purge-target-size=$PURGE_TARGET_SIZE \
+	    purge-old-entry=0 &&
+	flux module load content-sqlite
+'
+test_expect_success 'module stats reports lru segments' '
+	flux module stats content >stats.out &&
+	jq -e .lru.probation <stats.out &&
+	jq -e .lru.protected <stats.out &&
+	jq -e .lru.misses <stats.out
+'
+test_expect_success 'store 20 small blobs and one large blob' '
+	for i in $(seq 1 20); do
+		echo small-${i} | flux content store >small-${i}.ref || return 1
+	done &&
+	dd if=/dev/urandom count=256 bs=4096 >large.store 2>/dev/null &&
+	flux content store <large.store >large.ref &&
+	flux content flush &&
+	flux content dropcache &&
+	test $(lru_stats .count) -eq 0
+'
+test_expect_success 'loading small blobs twice promotes them' '
+	for i in $(seq 1 20); do
+		flux content load $(cat small-${i}.ref) >/dev/null || return 1
+	done &&
+	test $(lru_stats .lru.probation.count) -eq 20 &&
+	test $(lru_stats .lru.misses) -ge 20 &&
+	for i in $(seq 1 20); do
+		flux content load $(cat small-${i}.ref) >/dev/null || return 1
+	done &&
+	test $(lru_stats .lru.protected.count) -eq 20 &&
+	test $(lru_stats .lru.promotions) -ge 20
+'
+test_expect_success 'a large load is evicted without disturbing them' '
+	evictions=$(lru_stats .lru.probation.evictions) &&
+	flux content load $(cat large.ref) >large.out &&
+	test_cmp large.store large.out &&
+	flux module stats content >stats2.out &&
+	test $(jq .lru.protected.count <stats2.out) -eq 20 &&
+	test $(jq .lru.probation.evictions <stats2.out) -gt ${evictions} &&
+	test $(jq .size <stats2.out) -le $PURGE_TARGET_SIZE
+'
+test_expect_success 'small blobs are still hits in the protected segment' '
+	hits=$(lru_stats .lru.protected.hits) &&
+	misses=$(lru_stats .lru.misses) &&
+	for i in $(seq 1 20); do
+		test "$(flux content load $(cat small-${i}.ref))" = "small-${i}" \
+		    || return 1
+	done &&
+	test $(lru_stats .lru.protected.hits) -eq $((hits + 20)) &&
+	test $(lru_stats .lru.misses) -eq ${misses}
+'
+test_expect_success 'dropcache empties both segments' '
+	flux content dropcache &&
+	test $(lru_stats .lru.probation.count) -eq 0 &&
+	test $(lru_stats .lru.protected.count) -eq 0
+'
+test_expect_success 'remove content-sqlite and content modules' '
+	flux module remove content-sqlite &&
+	flux module remove content
+'
+
+test_done
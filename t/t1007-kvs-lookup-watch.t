@@ -47,6 +47,46 @@ test_expect_success NO_CHAIN_LINT 'kvs-watch stats reports active watcher' '
        wait $pid
 '
 
+test_expect_success NO_CHAIN_LINT 'kvs-watch setroot skips watchers of unchanged keys' '
+       flux kvs put test.idx.a=0 test.idx.b=0
+       flux kvs get --watch --count=2 test.idx.a >idxa.out &
+       pida=$! &&
+       flux kvs get --watch --count=2 test.idx.b >idxb.out &
+       pidb=$! &&
+       $waitfile --count=1 --timeout=10 --pattern="[0-9]+" idxa.out &&
+       $waitfile --count=1 --timeout=10 --pattern="[0-9]+" idxb.out &&
+       flux module stats kvs-watch >idxstats.out &&
+       test $(jq .namespaces.primary.keys <idxstats.out) -eq 2 &&
+       test $(jq ".namespaces.primary[\"watchers-full\"]" <idxstats.out) -eq 0 &&
+       skipped=$(jq .namespaces.primary.dispatch.skipped <idxstats.out) &&
+       flux kvs put --no-merge test.idx.a=1 &&
+       wait $pida &&
+       flux module stats kvs-watch >idxstats2.out &&
+       test $(jq .namespaces.primary.dispatch.skipped <idxstats2.out) \
+           -gt $skipped &&
+       test $(jq .namespaces.primary.dispatch.count <idxstats2.out) -gt 0 &&
+       flux kvs put --no-merge test.idx.b=1 &&
+       wait $pidb
+'
+
+test_expect_success NO_CHAIN_LINT 'kvs-watch watchers of one key share lookups' '
+       flux kvs put test.share=0
+       flux kvs get --watch --count=3 test.share >share1.out &
+       pid1=$! &&
+       flux kvs get --watch --count=3 test.share >share2.out &
+       pid2=$! &&
+       $waitfile --count=1 --timeout=10 --pattern="[0-9]+" share1.out &&
+       $waitfile --count=1 --timeout=10 --pattern="[0-9]+" share2.out &&
+       flux kvs put --no-merge test.share=1 &&
+       $waitfile --count=2 --timeout=10 --pattern="[0-9]+" share1.out &&
+       $waitfile --count=2 --timeout=10 --pattern="[0-9]+" share2.out &&
+       flux module stats kvs-watch >sharestats.out &&
+       flux kvs put --no-merge test.share=2 &&
+       wait $pid1 && wait $pid2 &&
+       test_cmp share1.out share2.out &&
+       test $(jq .namespaces.primary.lookups.shared <sharestats.out) -gt 0
+'
+
 # Check that stdin contains an integer on each line that
 # is one more than the integer on the previous line.
 test_monotonicity() {
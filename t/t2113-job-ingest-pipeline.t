@@ -5,6 +5,11 @@ test_description='Test job ingest pipeline'
 
 test_under_flux 1 full -Slog-stderr-level=1
 
+# Most of these tests exercise the validator workcrew, which is not
+# used for default jobs when the native validator is enabled.
+test_expect_success 'reload job-ingest with native validator disabled' '
+	flux module reload job-ingest disable-native-validator
+'
 test_expect_success 'no workers are running at the start' '
 	flux module stats job-ingest >stats.out &&
 	jq -e ".pipeline.frobnicator.running == 0" <stats.out &&
@@ -100,5 +105,40 @@ test_expect_success 'remove job-ingest to trigger cleanup' '
 	flux module remove job-ingest &&
 	flux setattr log-stderr-level 1
 '
+test_expect_success 'load job-ingest with native validator enabled' '
+	flux module load job-ingest &&
+	flux module stats job-ingest >stats9.out &&
+	jq -e ".pipeline[\"native-validator\"].enabled == true" <stats9.out
+'
+test_expect_success 'run a job' '
+	flux run true
+'
+test_expect_success 'job was accepted by native validator without workers' '
+	flux module stats job-ingest >stats10.out &&
+	jq -e ".pipeline[\"native-validator\"].accepted == 1" <stats10.out &&
+	jq -e ".pipeline.validator.running == 0" <stats10.out
+'
+test_expect_success 'job not accepted natively is passed to the workcrew' '
+	flux run --dry-run true \
+		| jq ".attributes.user = {}" >user-empty.json &&
+	flux job submit user-empty.json &&
+	flux module stats job-ingest >stats11.out &&
+	jq -e ".pipeline[\"native-validator\"].deferred == 1" <stats11.out &&
+	jq -e ".pipeline.validator.running == 1" <stats11.out
+'
+test_expect_success 'invalid job is still rejected by the workcrew' '
+	flux run --dry-run true \
+		| jq ".tasks[0].count = {}" >count-empty.json &&
+	test_must_fail flux job submit count-empty.json 2>count-empty.err &&
+	grep "count" count-empty.err
+'
+test_expect_success 'native validator can be disabled by config' '
+	flux config load <<-EOT &&
+	[ingest.validator]
+	native = false
+	EOT
+	flux module stats job-ingest >stats12.out &&
+	jq -e ".pipeline[\"native-validator\"].enabled == false" <stats12.out
+'
 
 test_done
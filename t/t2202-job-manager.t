@@ -396,6 +396,17 @@ test_expect_success 'job-manager stats works' '
 	cat stats.out | jq -e .journal.listeners
 '
 
+test_expect_success 'job-manager stats reports eventlog batch commits' '
+	jq -e ".eventlog_batch.adaptive == true" <stats.out &&
+	jq -e ".eventlog_batch.commits > 0" <stats.out &&
+	jq -e ".eventlog_batch.size.count == .eventlog_batch.commits" \
+	    <stats.out &&
+	jq -e "(.eventlog_batch.size.counts | add) \
+	    == .eventlog_batch.size.count" <stats.out &&
+	jq -e "(.eventlog_batch.latency.counts | length) \
+	    == (.eventlog_batch.latency.bounds | length) + 1" <stats.out
+'
+
 test_expect_success 'flux module stats job-manager is open to guests' '
 	FLUX_HANDLE_ROLEMASK=0x2 \
 	    flux module stats job-manager >/dev/null
@@ -54,8 +54,10 @@ test_expect_success 'issue3218: urgency change on running job doesnt segfault' '
 test_expect_success 'issue4409: eventlog commit races with job launch' '
 	printf "{\"timeout\": \"1\"}" | \
 	    test_expect_code 1 ${RPC} job-manager.set-batch-timeout &&
-	printf "{\"timeout\": 1}" | ${RPC} job-manager.set-batch-timeout &&
+	printf "{\"timeout\": 1, \"adaptive\": false}" | \
+	    ${RPC} job-manager.set-batch-timeout &&
 	flux submit -vvv --cc=1-5 --wait --quiet hostname &&
-	printf "{\"timeout\": 0.01}" | ${RPC} job-manager.set-batch-timeout
+	printf "{\"timeout\": 0.01, \"adaptive\": true}" | \
+	    ${RPC} job-manager.set-batch-timeout
 '
 test_done
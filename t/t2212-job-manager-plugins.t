@@ -200,6 +200,23 @@ test_expect_success 'job-manager: run args test plugin' '
 	test_debug "cat args-check.log" &&
 	test $(grep -c OK args-check.log) = 21
 '
+test_expect_success 'job-manager: plugin with declared args gets jobinfo' '
+	flux dmesg --clear &&
+	flux jobtap load --remove=all ${PLUGINPATH}/args-typed.so &&
+	flux run hostname &&
+	flux dmesg | grep args-typed > args-typed.log &&
+	test_debug "cat args-typed.log" &&
+	grep "job.state.run: OK" args-typed.log &&
+	test $(grep -c OK args-typed.log) -ge 5 &&
+	test_must_fail grep -v OK args-typed.log
+'
+test_expect_success 'job-manager: stats report jobtap calls per topic' '
+	flux module stats job-manager >jm-stats.json &&
+	test_debug "jq .jobtap <jm-stats.json" &&
+	jq -e ".jobtap[\"job.state.run\"].calls > 0" <jm-stats.json &&
+	jq -e ".jobtap[\"job.state.priority\"].calls > 0" <jm-stats.json &&
+	jq -e ".jobtap[\"job.state.priority\"].max_time >= 0" <jm-stats.json
+'
 test_expect_success 'job-manager: run subscribe test plugin' '
 	flux jobtap load --remove=all ${PLUGINPATH}/subscribe.so &&
 	flux run hostname &&
@@ -2317,6 +2317,35 @@ test_expect_success 'list request with all attr works (job fail)' '
 	cat all_fail.out | jq -e ".result"
 '
 
+#
+# streaming list with resume cursor
+#
+
+test_expect_success 'job-list: streaming list returns a cursor' '
+	echo "{\"max_entries\":2,\"attrs\":[],\"constraint\":{\"states\":[\"inactive\"]}}" \
+	    | $RPC_STREAM job-list.list >stream1.out &&
+	test $(jq -s "[.[].jobs[]] | length" <stream1.out) -eq 2 &&
+	test $(head -1 stream1.out | jq .version) -eq 1 &&
+	jq -rs ".[-1].cursor" <stream1.out >cursor.out &&
+	test "$(cat cursor.out)" != "null"
+'
+test_expect_success 'job-list: streaming list resumes after the cursor' '
+	echo "{\"max_entries\":0,\"attrs\":[],\"constraint\":{\"states\":[\"inactive\"]},\"cursor\":\"$(cat cursor.out)\"}" \
+	    | $RPC_STREAM job-list.list >stream2.out &&
+	cat stream1.out stream2.out | jq -r ".jobs[].id" >stream.ids &&
+	flux job list-inactive | jq -r .id >inactive.ids &&
+	test_cmp inactive.ids stream.ids
+'
+test_expect_success 'job-list: invalid cursor is rejected' '
+	echo "{\"max_entries\":0,\"attrs\":[],\"cursor\":\"foo\"}" \
+	    | test_must_fail $RPC_STREAM job-list.list 2>cursor.err &&
+	grep "cursor is invalid" cursor.err
+'
+test_expect_success 'job-list: cursor requires a streaming request' '
+	echo "{\"max_entries\":0,\"attrs\":[],\"cursor\":\"1.0:1\"}" \
+	    | $RPC job-list.list 71
+'
+
 #
 # max comparison
 #
@@ -2352,6 +2381,11 @@ test_expect_success 'flux job list fails on low comparison count' '
 	grep "Excessive comparisons" comparisons.err
 '
 
+test_expect_success 'indexed inactive query avoids low comparison count' '
+	flux jobs -n -f inactive --name=nosuchjobname > indexed.out &&
+	test_must_be_empty indexed.out
+'
+
 test_expect_success 'job-list: update config with invalid input fails' '
 	test_must_fail flux config load <<-EOF
 [job-list]
@@ -0,0 +1,130 @@
+#!/bin/sh
+
+test_description='Test job-exec launch of job shells down the TBON'
+
+. $(dirname $0)/sharness.sh
+
+test_under_flux 4 job
+
+test_expect_success 'invalid tree-launch-threshold fails config load' '
+	test_expect_code 1 flux config load <<-EOF
+	[exec]
+	tree-launch-threshold = "all"
+	EOF
+'
+test_expect_success 'enable tree launch for jobs of 2 or more nodes' '
+	flux config load <<-EOF &&
+	[exec]
+	tree-launch-threshold = 2
+	EOF
+	flux module reload job-exec &&
+	flux module stats job-exec \
+	    | jq -e ".\"bulk-exec\".config.tree_launch_threshold == 2"
+'
+test_expect_success 'job on all ranks runs one shell per rank' '
+	flux run -N4 flux getattr rank | sort -n >ranks.out &&
+	test_write_lines 0 1 2 3 >ranks.exp &&
+	test_cmp ranks.exp ranks.out
+'
+test_expect_success 'job on a subset of ranks runs' '
+	flux run -N2 --requires=rank:2-3 flux getattr rank | sort -n >sub.out &&
+	test_write_lines 2 3 >sub.exp &&
+	test_cmp sub.exp sub.out
+'
+test_expect_success 'single node job below threshold runs' '
+	flux run -N1 true
+'
+test_expect_success 'job exit code is propagated' '
+	test_expect_code 3 flux run -N4 sh -c "exit 3"
+'
+test_expect_success 'nonzero exit on one rank is propagated' '
+	test_expect_code 4 flux run -N4 \
+	    sh -c "test \$(flux getattr rank) -ne 2 || exit 4"
+'
+test_expect_success 'job shell launch failure raises exception' '
+	test_must_fail flux run -N4 \
+	    --setattr=exec.job_shell=/nonexistent true 2>badshell.err &&
+	test_debug "cat badshell.err" &&
+	grep "/nonexistent" badshell.err
+'
+test_expect_success 'job can be canceled' '
+	id=$(flux submit -N4 sleep inf) &&
+	flux job wait-event -vt 30 $id start &&
+	flux cancel $id &&
+	flux job wait-event -vt 30 $id clean &&
+	test_must_fail flux job status $id
+'
+test_expect_success 'invalid tree-exec request is rejected' '
+	test_must_fail flux python -c "
+import flux
+h = flux.Flux()
+h.rpc(\"rexec.tree-exec\", {\"key\": \"x\", \"ranks\": \"bad\",
+      \"cmd\": {}, \"flags\": 0}).get()
+"
+'
+test_expect_success 'multi-task job passes shell barriers with tree launch' '
+	flux run -N4 -n8 -o verbose flux getattr rank >tasks.out \
+	    2>tasks.err &&
+	test_debug "cat tasks.err" &&
+	test $(wc -l <tasks.out) -eq 8
+'
+test_expect_success 'tree-barrier with unknown key is rejected' '
+	test_must_fail flux python -c "
+import flux
+h = flux.Flux()
+h.rpc(\"rexec.tree-barrier\", {\"key\": \"x\", \"ranks\": \"0\"}).get()
+" 2>nokey.err &&
+	grep "no barrier" nokey.err
+'
+test_expect_success 'configure access.allow-guest-user = true' '
+	flux config load <<-EOT
+	access.allow-guest-user = true
+	EOT
+'
+test_expect_success 'tree-exec from rank 1 to rank 0 is restricted' '
+	uri1=$(flux exec -r 1 flux getattr local-uri) &&
+	FLUX_URI=$uri1 test_must_fail flux python -c "
+import flux
+h = flux.Flux()
+cmd = {\"cmdline\": [\"true\"], \"env\": {}, \"opts\": {},
+       \"channels\": []}
+h.rpc(\"rexec.tree-exec\", {\"key\": \"x\", \"ranks\": \"0\",
+      \"cmd\": cmd, \"flags\": 0}, nodeid=0).get()
+" 2>remote0.err &&
+	test_debug "cat remote0.err" &&
+	grep "not allowed on rank 0" remote0.err
+'
+test_expect_success 'configure access.allow-guest-user = false' '
+	flux config load </dev/null
+'
+test_expect_success 'tree-exec processes are killed on requester disconnect' '
+	flux python -c "
+import flux
+import flux.constants
+import flux.idset
+h = flux.Flux()
+cmd = {\"cwd\": \"/\", \"cmdline\": [\"sleep\", \"4321\"], \"env\": {},
+       \"opts\": {}, \"channels\": []}
+f = h.rpc(\"rexec.tree-exec\", {\"key\": \"x\", \"ranks\": \"0-1\",
+          \"cmd\": cmd, \"flags\": 0}, flags=flux.constants.FLUX_RPC_STREAMING)
+started = set()
+while started != {0, 1}:
+    ranks = f.get().get(\"started\")
+    if ranks:
+        started |= set(flux.idset.decode(ranks))
+    f.reset()
+" &&
+	for rank in 0 1; do
+		i=0 &&
+		while flux sproc ps --rank $rank | grep -q "sleep 4321" \
+		    && test $i -lt 30; do
+			sleep 1 && i=$((i + 1))
+		done &&
+		test $i -lt 30 || return 1
+	done
+'
+test_expect_success 'reload job-exec to defaults' '
+	flux config load </dev/null &&
+	flux module reload job-exec
+'
+test_done
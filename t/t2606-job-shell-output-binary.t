@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+test_description='Test flux-shell binary output mode'
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 4 job
+
+test_expect_success 'invalid output.binary fails' '
+	test_must_fail flux run -o output.binary=foo true
+'
+test_expect_success 'run a job with stdout on all ranks' '
+	flux run -N4 -l flux lptest >text.out
+'
+test_expect_success 'same job with output.binary produces same output' '
+	flux run -N4 -l -o output.binary flux lptest >binary.out &&
+	sort <text.out >text.out.sorted &&
+	sort <binary.out >binary.out.sorted &&
+	test_cmp text.out.sorted binary.out.sorted
+'
+test_expect_success 'output.binary works with small flow control window' '
+	flux run -N4 -l -o output.binary \
+	    -o output.client.lwm=1 -o output.client.hwm=10 \
+	    flux lptest >binary_flow.out &&
+	sort <binary_flow.out >binary_flow.out.sorted &&
+	test_cmp text.out.sorted binary_flow.out.sorted
+'
+test_expect_success 'output.binary sets header option' '
+	id=$(flux submit -N4 -o output.binary echo hello) &&
+	flux job attach $id >/dev/null &&
+	flux job eventlog -f json -p guest.output $id \
+	    | grep header >header.out &&
+	jq -e ".context.options.binary == true" <header.out
+'
+test_expect_success 'data is not in the output eventlog' '
+	flux job eventlog -p guest.output $id >evlog.out &&
+	awk "{print \$2}" evlog.out >names.out &&
+	test_must_fail grep -x data names.out
+'
+test_expect_success 'flux job attach reads data of completed job' '
+	flux job attach $id >attach.out &&
+	test $(grep -c hello attach.out) -eq 4
+'
+test_expect_success 'stderr and binary data are preserved' '
+	flux run -o output.binary \
+	    sh -c "printf \"\\001\\002\\377\" >&2; echo out" \
+	    >bin.out 2>bin.err &&
+	echo out >bin.out.exp &&
+	test_cmp bin.out.exp bin.out &&
+	printf "\\001\\002\\377" >bin.err.exp &&
+	test_cmp bin.err.exp bin.err
+'
+test_expect_success 'flux job attach --tail works with output.binary' '
+	id=$(flux submit -o output.binary flux lptest 20) &&
+	flux job attach $id >/dev/null &&
+	flux job attach --tail=3 $id >tail.out &&
+	test_debug "cat tail.out" &&
+	test $(wc -l <tail.out) -eq 3
+'
+test_expect_success 'job with no output and output.binary works' '
+	flux run -N4 -o output.binary true
+'
+test_expect_success 'output.binary works with single output file' '
+	flux run -N4 -l -o output.binary --output=single.out flux lptest &&
+	sort <single.out >single.out.sorted &&
+	test_cmp text.out.sorted single.out.sorted
+'
+
+test_done
@@ -109,6 +109,16 @@ test_expect_success 'kvstest works with -o pmi-simple.exchange.k=SIZE+1' '
 	grep "using k=${SIZE}" kvstest_kp1.err
 '
 
+test_expect_success 'kvstest works with -o pmi-simple.kvs=modex' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.kvs=modex ${kvstest}
+'
+test_expect_success 'kvstest -N8 works with -o pmi-simple.kvs=modex' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.kvs=modex ${kvstest} -N8
+'
+test_expect_success 'pmi_info --clique works with -o pmi-simple.kvs=modex' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.kvs=modex \
+		${pmi_info} --clique
+'
 test_expect_success 'kvstest fails with -o pmi-simple.kvs=unknown' '
 	test_must_fail flux run -o pmi-simple.kvs=unknown ${kvstest}
 '